@@ -18,6 +18,7 @@ public:
 	void drawSideBar() const;
 	void drawConfigUI();
 	void drawEngineSettingsUI();
+	void drawAllocationAuditUI() const;
 	void drawMainPanels() const;
 	void drawStatusBar();
 
@@ -45,5 +46,6 @@ private:
 
 		//Experimental
 	mutable std::string m_pluginToUnload;
+	mutable std::string m_pluginToReload;
 	mutable bool m_shouldReloadAllPlugins = false;
 };
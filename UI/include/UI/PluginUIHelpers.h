@@ -15,9 +15,7 @@
 #define REGISTER_PLUGIN_UI(context, renderFunction) \
     do { \
         if (auto uiService = (context).getService<IPluginUIService>()) { \
-            if (uiService->isAvailable()) { \
-                uiService->registerPluginUIRenderer((context).getPluginName(), [this]() { renderFunction(); }); \
-            } \
+            uiService->registerPluginUIRenderer((context).getPluginName(), [this]() { renderFunction(); }); \
         } \
     } while(0)
 
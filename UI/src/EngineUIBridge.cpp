@@ -14,6 +14,12 @@
 #include "Services/Logging/LogLevel.h"
 #include "Plugin/PluginInstance.h"
 #include "Plugin/PluginManager.h"
+#include "Plugin/PluginMemoryAccount.h"
+#include "Plugin/PluginRuntimeContext.h"
+#include "Plugin/PluginWatchdog.h"
+#include "Plugin/PluginWorker.h"
+#include "Profiling/AllocationTracker.h"
+#include "Profiling/TraceRecorder.h"
 #include "Services/UI/PluginUIService_ImGui.h"
 #include "UI/UIServiceManager.h"
 
@@ -71,7 +77,7 @@ void EngineUIBridge::drawConfigUI()
 		pluginManager->setAutoScan(autoScan);
 	}
 
-	if (ImGui::InputInt("Scan Interval (sec)", &interval))
+	if (ImGui::InputInt("Poll Interval (sec)", &interval))
 	{
 		if (interval > 0)
 		{
@@ -107,9 +113,171 @@ void EngineUIBridge::drawEngineSettingsUI()
 		m_engineBridge.getEngineSettings().setDebugLogging(bEngineDebugLogging);
 	}
 
+	ImGui::Separator();
+
+	TraceRecorder& traceRecorder = TraceRecorder::instance();
+	bool bTraceCapture = m_engineBridge.getEngineSettings().isTraceCaptureEnabled();
+
+	if(ImGui::Checkbox("Capture trace", &bTraceCapture))
+	{
+		m_engineBridge.getEngineSettings().setTraceCapture(bTraceCapture);
+	}
+
+	ImGui::SameLine();
+	ImGui::Text("(%zu events)", traceRecorder.getRecordedEventCount());
+
+	if(ImGui::Button("Export trace"))
+	{
+		const auto tracePath = std::format("traces/vectorium_trace_{:%Y%m%d_%H%M%S}.json",
+			std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()));
+
+		traceRecorder.writeChromeTrace(tracePath)
+		? m_logger.log(LogLevel::Info, std::format("Trace written to '{}'", tracePath))
+		: m_logger.log(LogLevel::Error, std::format("Failed to write trace to '{}'", tracePath));
+	}
+
+	ImGui::SameLine();
+	if(ImGui::Button("Clear trace"))
+	{
+		traceRecorder.clear();
+	}
+
+	ImGui::Separator();
+	drawAllocationAuditUI();
+
 	ImGui::End();
 }
 
+void EngineUIBridge::drawAllocationAuditUI() const
+{
+	AllocationTracker& allocationTracker = AllocationTracker::instance();
+
+	if(!AllocationTracker::areHooksInstalled())
+	{
+		ImGui::TextDisabled("Allocation audit unavailable - configure with VECTORIUM_ALLOCATION_AUDIT=ON");
+		return;
+	}
+
+	bool bAllocationAudit = m_engineBridge.getEngineSettings().isAllocationAuditEnabled();
+	if(ImGui::Checkbox("Audit allocations", &bAllocationAudit))
+	{
+		m_engineBridge.getEngineSettings().setAllocationAudit(bAllocationAudit);
+	}
+
+	ImGui::SameLine();
+	bool bAbortOnForbidden = allocationTracker.isAbortOnForbiddenAllocationEnabled();
+	if(ImGui::Checkbox("Abort in no-alloc zones", &bAbortOnForbidden))
+	{
+		allocationTracker.setAbortOnForbiddenAllocation(bAbortOnForbidden);
+	}
+
+	ImGui::SameLine();
+	if(ImGui::Button("Reset counts"))
+	{
+		allocationTracker.reset();
+	}
+
+	if(ImGui::BeginTable("AllocationZones", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+	{
+		ImGui::TableSetupColumn("Zone");
+		ImGui::TableSetupColumn("Kind");
+		ImGui::TableSetupColumn("Allocs/entry");
+		ImGui::TableSetupColumn("Bytes/entry");
+		ImGui::TableSetupColumn("Max");
+		ImGui::TableSetupColumn("Forbidden");
+		ImGui::TableSetupColumn("No-alloc");
+		ImGui::TableHeadersRow();
+
+		for(const auto& zone : allocationTracker.getZoneStats())
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::TextUnformatted(zone.label.c_str());
+			ImGui::TableNextColumn(); ImGui::TextUnformatted(toString(zone.kind));
+			ImGui::TableNextColumn(); ImGui::Text("%.2f", zone.getAllocationsPerEntry());
+			ImGui::TableNextColumn(); ImGui::Text("%.1f", zone.getBytesPerEntry());
+			ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(zone.maxAllocationsPerEntry));
+			ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(zone.forbiddenAllocations));
+
+			ImGui::TableNextColumn();
+			bool bNoAlloc = zone.noAlloc;
+			const std::string checkboxId = std::format("##noalloc_{}_{}", toString(zone.kind), zone.label);
+			if(ImGui::Checkbox(checkboxId.c_str(), &bNoAlloc))
+			{
+				allocationTracker.setNoAlloc(zone.kind, zone.label, bNoAlloc);
+			}
+		}
+
+		ImGui::EndTable();
+	}
+}
+
+namespace
+{
+	void drawPluginStatus(const PluginInstance& plugin)
+	{
+		const auto& activity = plugin.getActivity();
+		const auto  stats = activity ? activity->getStats() : PluginActivityStats{};
+
+		if (stats.isStalled)
+		{
+			ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Status: Stalled past its deadline");
+		}
+		else if (plugin.getTickStride() > 1)
+		{
+			ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Status: Throttled (ticked every %u frames)", plugin.getTickStride());
+		}
+		else
+		{
+			ImGui::Text("Status: Running");
+		}
+
+		if (const PluginWorker* worker = plugin.getWorker())
+		{
+			ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "On a worker thread: %zu queued, %llu dropped",
+				worker->getQueuedPacketCount(),
+				static_cast<unsigned long long>(worker->getDroppedPacketCount()));
+		}
+
+		if (activity && activity->getHomeNode() >= 0)
+		{
+			ImGui::Text("NUMA node %d: %llu packets dispatched from other nodes", activity->getHomeNode(),
+				static_cast<unsigned long long>(stats.crossNodeDispatches));
+		}
+
+		if (stats.getOverrunCount() > 0)
+		{
+			ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Overruns: %llu tick (worst %.2fms), %llu handler (worst %.2fms)",
+				static_cast<unsigned long long>(stats.tickOverruns),
+				std::chrono::duration<double, std::milli>(stats.worstTick).count(),
+				static_cast<unsigned long long>(stats.handlerOverruns),
+				std::chrono::duration<double, std::milli>(stats.worstHandler).count());
+		}
+
+		const PluginRuntimeContext* context = plugin.getContext();
+		if (const auto* account = context ? context->getMemoryAccount().get() : nullptr)
+		{
+			constexpr double bytesPerMB = 1024.0 * 1024.0;
+			const auto memory = account->getStats();
+			const auto budget = account->getBudget();
+
+			const ImVec4 colour = memory.rejectedAllocations > 0 ? ImVec4(1.0f, 0.0f, 0.0f, 1.0f)
+				: account->isOverWarning() ? ImVec4(1.0f, 1.0f, 0.0f, 1.0f)
+				: ImGui::GetStyleColorVec4(ImGuiCol_Text);
+
+			if (budget.limitBytes != 0)
+			{
+				ImGui::TextColored(colour, "Memory: %.2fMB of %.2fMB (peak %.2fMB), %llu refused",
+					memory.currentBytes / bytesPerMB, budget.limitBytes / bytesPerMB, memory.peakBytes / bytesPerMB,
+					static_cast<unsigned long long>(memory.rejectedAllocations));
+			}
+			else
+			{
+				ImGui::TextColored(colour, "Memory: %.2fMB (peak %.2fMB)", memory.currentBytes / bytesPerMB, memory.peakBytes / bytesPerMB);
+			}
+		}
+	}
+}
+
 void EngineUIBridge::drawPluginUI() const
 {
 	if (!ImGui::Begin("Plugin UI"))
@@ -129,7 +297,7 @@ void EngineUIBridge::drawPluginUI() const
 		{
 			ImGui::Indent();
 
-			ImGui::Text("Status: Running");
+			drawPluginStatus(*plugin);
 			ImGui::Text("Debug: %s", plugin->isPluginDebugLoggingEnabled() ? "On" : "Off");
 
 			if (ImGui::Button(("Unload##" + name).c_str()))
@@ -202,6 +370,23 @@ void EngineUIBridge::drawMenuBar()
 				{
 					pluginInfo.loaded ? pluginManager->unloadPlugin(name) : pluginManager->loadPlugin(pluginInfo.path);
 				}
+
+				// Comes from the descriptor cache, so hovering an unloaded plugin never opens it
+				if (ImGui::IsItemHovered() && pluginInfo.descriptor)
+				{
+					std::string tooltip = std::format("{} v{}", pluginInfo.descriptor->name, pluginInfo.descriptor->version);
+					for (const auto& service : pluginInfo.descriptor->services)
+					{
+						tooltip += std::format("\n{} {} ({})", service.required ? "requires" : "uses", service.name, service.minVersion);
+					}
+
+					for (const auto& provided : pluginInfo.descriptor->provides)
+					{
+						tooltip += std::format("\nprovides {} ({})", provided.name, provided.version);
+					}
+
+					ImGui::SetTooltip("%s", tooltip.c_str());
+				}
 			}
 
 			ImGui::Separator();
@@ -228,6 +413,22 @@ void EngineUIBridge::drawMenuBar()
 					}
 				}
 			}
+
+			// Dormant plugins are only instantiated the first time their window is asked for
+			for (const auto& name : pluginManager->getDormantPlugins(PluginActivationPolicy::OnFirstUIOpen))
+			{
+				if (ImGui::MenuItem(std::format("{} (inactive)", name).c_str()) && pluginManager->activatePlugin(name))
+				{
+					const auto& loadedPlugins = pluginManager->getLoadedPlugins();
+					const auto activated = loadedPlugins.find(name);
+
+					auto* plugin = activated != loadedPlugins.end() ? activated->second->getPlugin() : nullptr;
+					if (plugin && plugin->hasUIWindow() && !plugin->isUIWindowVisible())
+					{
+						plugin->toggleUIWindow();
+					}
+				}
+			}
 			ImGui::EndMenu();
 		}
 
@@ -332,6 +533,11 @@ void EngineUIBridge::drawSideBar() const
                         m_pluginToUnload = pluginName;
                     }
 
+                    if (ImGui::MenuItem("Reload Plugin"))
+                    {
+                        m_pluginToReload = pluginName;
+                    }
+
                     if (ImGui::MenuItem("Toggle Debug Logging"))
                     {
                         if (plugin->isPluginDebugLoggingEnabled())
@@ -367,7 +573,6 @@ void EngineUIBridge::drawSideBar() const
     	// Quick actions
         if (ImGui::Button("Reload All"))
         {
-            // Implement reload all functionality
             m_shouldReloadAllPlugins = true;
         }
     }
@@ -380,9 +585,24 @@ void EngineUIBridge::drawSideBar() const
         m_pluginToUnload.clear();
     }
 
+    if (!m_pluginToReload.empty())
+    {
+        if (const auto reloaded = pluginManager->reloadPlugin(m_pluginToReload); !reloaded)
+        {
+            m_logger.log(LogLevel::Error, reloaded.error());
+        }
+        m_pluginToReload.clear();
+    }
+
 	if (m_shouldReloadAllPlugins)
     {
-        // Implement reload all logic
+        for (const auto& name : pluginManager->getNamesOfAllLoadedPlugins())
+        {
+            if (const auto reloaded = pluginManager->reloadPlugin(name); !reloaded)
+            {
+                m_logger.log(LogLevel::Error, reloaded.error());
+            }
+        }
         m_shouldReloadAllPlugins = false;
     }
 }
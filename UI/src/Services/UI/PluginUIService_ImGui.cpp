@@ -2,6 +2,8 @@
 #include "Services/UI/PluginUIService_ImGui.h"
 #include "Services/Logging/ILogger.h"
 #include "Services/Logging/LogLevel.h"
+#include "Profiling/AllocationTracker.h"
+#include "Profiling/TraceRecorder.h"
 #include <imgui.h>
 #include <format>
 #include <ranges>
@@ -89,10 +91,11 @@ void PluginUIService_ImGui::renderPluginUIs()
 
 	std::lock_guard lock(m_callbackMutex);
 
-	for (const auto& callback : m_pluginCallbacks | std::views::values)
+	for (const auto& [pluginName, callback] : m_pluginCallbacks)
 	{
 		if (callback)
 		{
+			VECTORIUM_ALLOCATION_ZONE(AllocationZoneKind::Render, TraceRecorder::instance().internName(pluginName));
 			callback();
 		}
 	}
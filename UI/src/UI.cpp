@@ -2,6 +2,8 @@
 #include "EngineUIBridge.h"
 #include "Services/Logging/ILogger.h"
 #include "Services/Logging/LogLevel.h"
+#include "Profiling/AllocationTracker.h"
+#include "Profiling/TraceRecorder.h"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -83,6 +85,9 @@ bool UI::init()
 
 void UI::render() const
 {
+	VECTORIUM_TRACE_ZONE("UI::render");
+	VECTORIUM_ALLOCATION_ZONE(AllocationZoneKind::Render, "UI");
+
 	if (!m_initialised || !m_window)
 	{
 		if (m_logger) {
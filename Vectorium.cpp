@@ -1,33 +1,141 @@
 ﻿
 #include "Vectorium.h"
 
+#include <atomic>
+#include <csignal>
+#include <charconv>
 #include <iostream>
+#include <optional>
+#include <string_view>
 
 #include "include/Engine.h"
+#include "Services/Logging/ILogger.h"
+#include "Services/Logging/LogLevel.h"
+#ifndef VECTORIUM_HEADLESS
 #include "UI/UI.h"
+#endif
 
-int main()
+namespace
 {
-	Engine dataEngine;
-	dataEngine.init();
+	std::atomic<Engine*> g_engine{nullptr};
+
+	extern "C" void handleShutdownSignal([[maybe_unused]] int signal)
+	{
+		if (Engine* engine = g_engine.load(std::memory_order_relaxed))
+		{
+			engine->requestShutdown();
+		}
+	}
+
+	/// <summary>
+	/// Runs without a window - plugins get the null IPluginUIService
+	/// </summary>
+	int runHeadless(Engine& dataEngine)
+	{
+		dataEngine.getLogger()->log(LogLevel::Info, "Running headless - send SIGINT/SIGTERM to stop");
+		dataEngine.run();
+		return 0;
+	}
+
+	/// <summary>
+	/// The value of a --name=value argument, none if it wasn't given
+	/// </summary>
+	std::optional<std::string_view> findArgumentValue(int argc, char** argv, std::string_view prefix)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			if (const std::string_view argument = argv[i]; argument.starts_with(prefix))
+			{
+				return argument.substr(prefix.size());
+			}
+		}
 
+		return std::nullopt;
+	}
 
-	UI ui(dataEngine);
-	if (!ui.init())
+	/// <summary>
+	/// --record=&lt;journal&gt; records the packet stream, --replay=&lt;journal&gt; [--replay-speed=&lt;n&gt;] plays one back
+	/// </summary>
+	void startJournaling(Engine& dataEngine, int argc, char** argv)
 	{
-		std::cerr << "Failed to initialize UI\n";
-		return -1;
+		if (const auto recordPath = findArgumentValue(argc, argv, "--record="))
+		{
+			(void)dataEngine.startRecording(std::filesystem::path(*recordPath));
+		}
+
+		if (const auto replayPath = findArgumentValue(argc, argv, "--replay="))
+		{
+			double speed = 1.0;
+			if (const auto speedValue = findArgumentValue(argc, argv, "--replay-speed="))
+			{
+				if (std::from_chars(speedValue->data(), speedValue->data() + speedValue->size(), speed).ec != std::errc{})
+				{
+					std::cerr << "Ignoring --replay-speed, it isn't a number - replaying in real time\n";
+					speed = 1.0;
+				}
+			}
+
+			(void)dataEngine.replayJournal(std::filesystem::path(*replayPath), speed);
+		}
 	}
 
-	while(!ui.shouldClose())
+#ifndef VECTORIUM_HEADLESS
+	bool hasArgument(int argc, char** argv, std::string_view argument)
 	{
-		dataEngine.tick();
-		ui.render();
+		for (int i = 1; i < argc; ++i)
+		{
+			if (argument == argv[i])
+			{
+				return true;
+			}
+		}
+
+		return false;
 	}
 
-	ui.shutdown();
+	int runWithUI(Engine& dataEngine)
+	{
+		UI ui(dataEngine);
+		if (!ui.init())
+		{
+			std::cerr << "Failed to initialize UI - run with --headless on machines without a display\n";
+			return -1;
+		}
+
+		while(!ui.shouldClose() && !dataEngine.isShutdownRequested())
+		{
+			dataEngine.tick();
+			ui.render();
+		}
+
+		ui.shutdown();
+		return 0;
+	}
+#endif
+}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+	Engine dataEngine;
+
+	g_engine.store(&dataEngine, std::memory_order_relaxed);
+	std::signal(SIGINT, handleShutdownSignal);
+	std::signal(SIGTERM, handleShutdownSignal);
+
+	dataEngine.init();
+	startJournaling(dataEngine, argc, argv);
+
+#ifdef VECTORIUM_HEADLESS
+	const int exitCode = runHeadless(dataEngine);
+#else
+	const int exitCode = hasArgument(argc, argv, "--headless") ? runHeadless(dataEngine) : runWithUI(dataEngine);
+#endif
+
 	dataEngine.shutdown();
 
+	std::signal(SIGINT, SIG_DFL);
+	std::signal(SIGTERM, SIG_DFL);
+	g_engine.store(nullptr, std::memory_order_relaxed);
 
-	return 0;
+	return exitCode;
 }
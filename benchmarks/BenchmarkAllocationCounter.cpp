@@ -0,0 +1,64 @@
+#include "BenchmarkAllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<std::uint64_t> g_allocationCount{0};
+	std::atomic<std::uint64_t> g_allocatedBytes{0};
+
+	void* countedAllocate(std::size_t size)
+	{
+		g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+		g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+		if (void* ptr = std::malloc(size == 0 ? 1 : size))
+		{
+			return ptr;
+		}
+
+		throw std::bad_alloc();
+	}
+}
+
+std::uint64_t BenchmarkAllocationCounter::allocationCount()
+{
+	return g_allocationCount.load(std::memory_order_relaxed);
+}
+
+std::uint64_t BenchmarkAllocationCounter::allocatedBytes()
+{
+	return g_allocatedBytes.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size)
+{
+	return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+	return countedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, [[maybe_unused]] std::size_t size) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, [[maybe_unused]] std::size_t size) noexcept
+{
+	std::free(ptr);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <benchmark/benchmark.h>
+
+/// <summary>
+/// Counts global operator new calls made by the benchmark process so each benchmark can report allocations/op
+/// </summary>
+namespace BenchmarkAllocationCounter
+{
+	std::uint64_t allocationCount();
+	std::uint64_t allocatedBytes();
+
+	/// <summary>
+	/// Snapshot taken before the timed loop; call report() after it to publish allocs/op and bytes/op counters
+	/// </summary>
+	class Scope
+	{
+	public:
+		Scope()
+			: m_startCount(allocationCount())
+			, m_startBytes(allocatedBytes())
+		{}
+
+		void report(benchmark::State& state) const
+		{
+			state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocationCount() - m_startCount), benchmark::Counter::kAvgIterations);
+			state.counters["bytes/op"]  = benchmark::Counter(static_cast<double>(allocatedBytes() - m_startBytes), benchmark::Counter::kAvgIterations);
+		}
+
+	private:
+		std::uint64_t m_startCount;
+		std::uint64_t m_startBytes;
+	};
+}
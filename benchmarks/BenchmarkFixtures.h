@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <benchmark/benchmark.h>
+
+#include "DataPacket/IDataPacketHandler.h"
+#include "Services/Logging/ILogger.h"
+
+/// <summary>
+/// Logger that discards everything, so benchmarks only measure the code under test
+/// </summary>
+class BenchmarkNullLogger final : public ILogger
+{
+public:
+	void log([[maybe_unused]] LogLevel level, [[maybe_unused]] const std::string& message) override {}
+	void enableDebugLogging() override {}
+	void disableDebugLogging() override {}
+	bool isDebugLoggingEnabled() const override { return false; }
+	void setPluginName([[maybe_unused]] const std::string& name) override {}
+};
+
+struct BenchmarkPayload
+{
+	int number;
+};
+
+/// <summary>
+/// Untyped handler that touches the packet so the call can't be optimised away
+/// </summary>
+class BenchmarkCountingHandler final : public IDataPacketHandler
+{
+public:
+	bool handle(const DataPacket& packet) override
+	{
+		benchmark::DoNotOptimize(packet.payload.get());
+		++m_handled;
+		return true;
+	}
+
+	[[nodiscard]] std::size_t getHandledCount() const { return m_handled; }
+
+private:
+	std::size_t m_handled = 0;
+};
+
+class BenchmarkTypedHandler final : public ITypedDataPacketHandler<BenchmarkPayload>
+{
+public:
+	bool handleType(const std::shared_ptr<BenchmarkPayload>& data) override
+	{
+		benchmark::DoNotOptimize(data->number);
+		return true;
+	}
+};
@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkAllocationCounter.h"
+#include "DataPacket/DataPacket.h"
+
+namespace
+{
+	struct SmallPayload
+	{
+		int number;
+	};
+
+	struct LargePayload
+	{
+		double values[32];
+	};
+}
+
+static void BM_DataPacket_CreateFromValue(benchmark::State& state)
+{
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		DataPacket packet = DataPacket::create(SmallPayload{42});
+		benchmark::DoNotOptimize(packet);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DataPacket_CreateFromValue);
+
+static void BM_DataPacket_CreateFromSharedPtr(benchmark::State& state)
+{
+	const auto payload = std::make_shared<SmallPayload>(SmallPayload{42});
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		DataPacket packet = DataPacket::create(payload);
+		benchmark::DoNotOptimize(packet);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DataPacket_CreateFromSharedPtr);
+
+static void BM_DataPacket_CreateLargeFromValue(benchmark::State& state)
+{
+	const LargePayload payload{};
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		DataPacket packet = DataPacket::create(payload);
+		benchmark::DoNotOptimize(packet);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sizeof(LargePayload)));
+}
+BENCHMARK(BM_DataPacket_CreateLargeFromValue);
+
+static void BM_DataPacket_GetMatchingType(benchmark::State& state)
+{
+	const DataPacket packet = DataPacket::create(SmallPayload{42});
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		auto result = packet.get<SmallPayload>();
+		benchmark::DoNotOptimize(result);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DataPacket_GetMatchingType);
+
+static void BM_DataPacket_GetMismatchedType(benchmark::State& state)
+{
+	const DataPacket packet = DataPacket::create(SmallPayload{42});
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		auto result = packet.get<LargePayload>();
+		benchmark::DoNotOptimize(result);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DataPacket_GetMismatchedType);
@@ -0,0 +1,111 @@
+#include <benchmark/benchmark.h>
+
+#include <format>
+#include "BenchmarkAllocationCounter.h"
+#include "BenchmarkFixtures.h"
+#include "DataPacket/DataPacket.h"
+#include "DataPacket/DataPacketRegistry.h"
+
+static void BM_Dispatch_TypedHandlers(benchmark::State& state)
+{
+	BenchmarkNullLogger logger;
+	DataPacketRegistry  registry(logger);
+
+	const auto handlerCount = static_cast<int>(state.range(0));
+	for (int i = 0; i < handlerCount; ++i)
+	{
+		registry.registerDataPacketHandler(typeid(BenchmarkPayload), std::make_shared<BenchmarkCountingHandler>(), std::format("Plugin{}", i));
+	}
+
+	const DataPacket packet = DataPacket::create(BenchmarkPayload{7});
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		registry.dispatch(packet);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+	state.counters["handler_calls/s"] = benchmark::Counter(static_cast<double>(state.iterations() * handlerCount), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Dispatch_TypedHandlers)->RangeMultiplier(2)->Range(1, 64);
+
+static void BM_Dispatch_WildcardHandlers(benchmark::State& state)
+{
+	BenchmarkNullLogger logger;
+	DataPacketRegistry  registry(logger);
+
+	const auto handlerCount = static_cast<int>(state.range(0));
+	for (int i = 0; i < handlerCount; ++i)
+	{
+		registry.registerWildcardHandler(std::make_shared<BenchmarkCountingHandler>(), std::format("Wildcard{}", i));
+	}
+
+	const DataPacket packet = DataPacket::create(BenchmarkPayload{7});
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		registry.dispatch(packet);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+	state.counters["handler_calls/s"] = benchmark::Counter(static_cast<double>(state.iterations() * handlerCount), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Dispatch_WildcardHandlers)->RangeMultiplier(2)->Range(1, 64);
+
+static void BM_Dispatch_NoSubscribers(benchmark::State& state)
+{
+	BenchmarkNullLogger logger;
+	DataPacketRegistry  registry(logger);
+
+	const DataPacket packet = DataPacket::create(BenchmarkPayload{7});
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		registry.dispatch(packet);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Dispatch_NoSubscribers);
+
+static void BM_Handler_Untyped(benchmark::State& state)
+{
+	BenchmarkCountingHandler handler;
+	const DataPacket         packet = DataPacket::create(BenchmarkPayload{7});
+	IDataPacketHandler&      baseHandler = handler;
+
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		benchmark::DoNotOptimize(baseHandler.handle(packet));
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Handler_Untyped);
+
+static void BM_Handler_TypedAdapter(benchmark::State& state)
+{
+	TypedDataPacketHandlerAdapter<BenchmarkPayload> adapter(std::make_shared<BenchmarkTypedHandler>());
+	const DataPacket                                packet = DataPacket::create(BenchmarkPayload{7});
+	IDataPacketHandler&                             baseHandler = adapter;
+
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		benchmark::DoNotOptimize(baseHandler.handle(packet));
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Handler_TypedAdapter);
@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+
+#include <spdlog/sinks/null_sink.h>
+#include "BenchmarkAllocationCounter.h"
+#include "Services/Logging/LogLevel.h"
+#include "Services/Logging/PluginLogger.h"
+#include "Services/Logging/SpdLogger.h"
+#include "Services/Logging/UILogSink.h"
+
+namespace
+{
+	const std::string kMessage = "Detected number: 42";
+
+	std::shared_ptr<SpdLogger> makeNullSinkLogger(const std::string& name)
+	{
+		std::vector<spdlog::sink_ptr> sinks { std::make_shared<spdlog::sinks::null_sink_mt>() };
+		return std::make_shared<SpdLogger>(name, sinks);
+	}
+}
+
+static void BM_SpdLogger_Info(benchmark::State& state)
+{
+	auto logger = makeNullSinkLogger("BenchInfo");
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		logger->log(LogLevel::Info, kMessage);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(kMessage.size()));
+}
+BENCHMARK(BM_SpdLogger_Info);
+
+static void BM_SpdLogger_DebugDisabled(benchmark::State& state)
+{
+	auto logger = makeNullSinkLogger("BenchDebug");
+	logger->disableDebugLogging();
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		logger->log(LogLevel::Debug, kMessage);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SpdLogger_DebugDisabled);
+
+static void BM_PluginLogger_Info(benchmark::State& state)
+{
+	PluginLogger logger(makeNullSinkLogger("BenchPlugin"), "BenchPlugin");
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		logger.log(LogLevel::Info, kMessage);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(kMessage.size()));
+}
+BENCHMARK(BM_PluginLogger_Info);
+
+static void BM_UILogSink_Insert(benchmark::State& state)
+{
+	auto sink = std::make_shared<UILogSink>();
+	sink->maxEntries = static_cast<size_t>(state.range(0));
+
+	const spdlog::details::log_msg message("Bench", spdlog::level::info, kMessage);
+
+	// Fill up first so every timed insert also evicts the oldest entry, as it does in a long-running engine
+	for (size_t i = 0; i < sink->maxEntries; ++i)
+	{
+		sink->log(message);
+	}
+
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		sink->log(message);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UILogSink_Insert)->Arg(200)->Arg(10000);
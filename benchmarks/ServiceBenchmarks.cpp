@@ -0,0 +1,154 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkAllocationCounter.h"
+#include "BenchmarkFixtures.h"
+#include "DataPacket/DataPacketRegistry.h"
+#include "Plugin/PluginRuntimeContext.h"
+#include "Services/IServiceSpecialisations.h"
+#include "Services/ServiceContainer.h"
+
+namespace
+{
+	// Only ever registered in the global container, so lookups exercise the context's fallback path
+	struct BenchmarkGlobalService
+	{
+		int value = 1;
+	};
+
+	struct BenchmarkMissingService
+	{
+	};
+}
+
+static void BM_ServiceContainer_GetServiceByType(benchmark::State& state)
+{
+	ServiceContainer container;
+	container.registerService<ILogger>(std::make_shared<BenchmarkNullLogger>());
+	container.registerService(std::make_shared<BenchmarkGlobalService>());
+
+	const std::type_index loggerType = typeid(ILogger);
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		auto service = container.getServiceByType(loggerType);
+		benchmark::DoNotOptimize(service);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ServiceContainer_GetServiceByType);
+
+static void BM_ServiceContainer_GetServiceTemplate(benchmark::State& state)
+{
+	ServiceContainer container;
+	container.registerService<ILogger>(std::make_shared<BenchmarkNullLogger>());
+
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		auto service = container.getService<ILogger>();
+		benchmark::DoNotOptimize(service);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ServiceContainer_GetServiceTemplate);
+
+namespace
+{
+	/// <summary>
+	/// Context wired up the same way PluginManager::loadPlugin does it
+	/// </summary>
+	struct ContextFixture
+	{
+		ContextFixture()
+			: engineLogger(std::make_shared<BenchmarkNullLogger>())
+			, registry(*engineLogger)
+		{
+			container.registerService<ILogger>(engineLogger);
+			container.registerService(std::make_shared<BenchmarkGlobalService>());
+
+			context = std::make_unique<PluginRuntimeContext>(std::make_shared<BenchmarkNullLogger>(), registry, "BenchmarkPlugin", container);
+		}
+
+		std::shared_ptr<ILogger>              engineLogger;
+		DataPacketRegistry                    registry;
+		ServiceContainer                      container;
+		std::unique_ptr<PluginRuntimeContext> context;
+	};
+}
+
+static void BM_PluginContext_GetLocalService(benchmark::State& state)
+{
+	ContextFixture  fixture;
+	IPluginContext& context = *fixture.context;
+
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		auto service = context.getService<ILogger>();
+		benchmark::DoNotOptimize(service);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PluginContext_GetLocalService);
+
+static void BM_PluginContext_GetGlobalService(benchmark::State& state)
+{
+	ContextFixture  fixture;
+	IPluginContext& context = *fixture.context;
+
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		auto service = context.getService<BenchmarkGlobalService>();
+		benchmark::DoNotOptimize(service);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PluginContext_GetGlobalService);
+
+static void BM_PluginContext_GetMissingService(benchmark::State& state)
+{
+	ContextFixture  fixture;
+	IPluginContext& context = *fixture.context;
+
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		auto service = context.getService<BenchmarkMissingService>();
+		benchmark::DoNotOptimize(service);
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PluginContext_GetMissingService);
+
+static void BM_PluginContext_HasService(benchmark::State& state)
+{
+	ContextFixture        fixture;
+	const IPluginContext& context = *fixture.context;
+
+	const BenchmarkAllocationCounter::Scope allocations;
+
+	for ([[maybe_unused]] auto _ : state)
+	{
+		benchmark::DoNotOptimize(context.hasService<ILogger>());
+	}
+
+	allocations.report(state);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PluginContext_HasService);
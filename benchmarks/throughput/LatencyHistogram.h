@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+/// <summary>
+/// Fixed-size log-linear latency histogram (in ns). Each power of two is split into 32 sub-buckets, so recorded values
+/// are accurate to ~3%. Plain data, so it can be copied across the plugin boundary as-is.
+/// </summary>
+struct LatencyHistogram
+{
+	static constexpr std::uint32_t kSubBucketBits = 5;
+	static constexpr std::uint32_t kSubBuckets = 1u << kSubBucketBits;
+	static constexpr std::uint32_t kMagnitudes = 64 - kSubBucketBits + 1;
+	static constexpr std::uint32_t kBucketCount = kMagnitudes * kSubBuckets;
+
+	std::array<std::uint64_t, kBucketCount> counts{};
+	std::uint64_t total = 0;
+	std::uint64_t sum = 0;
+	std::uint64_t min = std::numeric_limits<std::uint64_t>::max();
+	std::uint64_t max = 0;
+
+	void record(std::int64_t valueNs) noexcept
+	{
+		const std::uint64_t value = valueNs > 0 ? static_cast<std::uint64_t>(valueNs) : 0;
+
+		++counts[bucketIndex(value)];
+		++total;
+		sum += value;
+		min = std::min(min, value);
+		max = std::max(max, value);
+	}
+
+	void merge(const LatencyHistogram& other) noexcept
+	{
+		for (std::uint32_t i = 0; i < kBucketCount; ++i)
+		{
+			counts[i] += other.counts[i];
+		}
+
+		total += other.total;
+		sum += other.sum;
+		min = std::min(min, other.min);
+		max = std::max(max, other.max);
+	}
+
+	void reset() noexcept
+	{
+		*this = LatencyHistogram{};
+	}
+
+	/// <summary>
+	/// Returns the upper bound of the bucket containing the given percentile (0-100)
+	/// </summary>
+	[[nodiscard]] std::uint64_t percentile(double percent) const noexcept
+	{
+		if (total == 0)
+		{
+			return 0;
+		}
+
+		const auto target = static_cast<std::uint64_t>(static_cast<double>(total) * std::clamp(percent, 0.0, 100.0) / 100.0);
+		std::uint64_t seen = 0;
+
+		for (std::uint32_t i = 0; i < kBucketCount; ++i)
+		{
+			seen += counts[i];
+			if (seen > target || seen == total)
+			{
+				return std::min(bucketUpperBound(i), max);
+			}
+		}
+
+		return max;
+	}
+
+	[[nodiscard]] double mean() const noexcept
+	{
+		return total == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(total);
+	}
+
+	static constexpr std::uint32_t bucketIndex(std::uint64_t value) noexcept
+	{
+		if (value < kSubBuckets)
+		{
+			return static_cast<std::uint32_t>(value);
+		}
+
+		// Magnitude 1 starts at kSubBuckets; within a magnitude the top kSubBucketBits bits pick the sub-bucket
+		const std::uint32_t magnitude = static_cast<std::uint32_t>(std::bit_width(value)) - kSubBucketBits;
+		const std::uint32_t subBucket = static_cast<std::uint32_t>(value >> (magnitude - 1)) - kSubBuckets;
+
+		return magnitude * kSubBuckets + subBucket;
+	}
+
+	static constexpr std::uint64_t bucketUpperBound(std::uint32_t index) noexcept
+	{
+		const std::uint32_t magnitude = index / kSubBuckets;
+		const std::uint64_t subBucket = index % kSubBuckets;
+
+		if (magnitude == 0)
+		{
+			return subBucket;
+		}
+
+		return ((kSubBuckets + subBucket + 1) << (magnitude - 1)) - 1;
+	}
+};
@@ -0,0 +1,115 @@
+#include "SystemMetrics.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "ThroughputProtocol.h"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef __linux__
+	std::uint64_t readRssBytes()
+	{
+		std::ifstream statm("/proc/self/statm");
+		std::uint64_t sizePages = 0;
+		std::uint64_t residentPages = 0;
+
+		if (!(statm >> sizePages >> residentPages))
+		{
+			return 0;
+		}
+
+		return residentPages * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+	}
+
+	std::vector<SystemSample::CoreTimes> readCoreTimes()
+	{
+		std::vector<SystemSample::CoreTimes> cores;
+		std::ifstream stat("/proc/stat");
+		std::string line;
+
+		while (std::getline(stat, line))
+		{
+			// Skip the aggregate "cpu " line, keep "cpuN"
+			if (!line.starts_with("cpu") || line.size() < 4 || line[3] == ' ')
+			{
+				continue;
+			}
+
+			std::istringstream fields(line);
+			std::string label;
+			std::uint64_t user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+			fields >> label >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
+
+			const std::uint64_t idleTotal = idle + iowait;
+			const std::uint64_t total = user + nice + system + idleTotal + irq + softirq + steal;
+			cores.push_back(SystemSample::CoreTimes{
+				.busy = total - idleTotal,
+				.total = total
+			});
+		}
+
+		return cores;
+	}
+#endif
+}
+
+SystemSample SystemSample::capture()
+{
+	SystemSample sample;
+	sample.wallNs = throughputNowNs();
+
+#ifdef __linux__
+	sample.rssBytes = readRssBytes();
+	sample.cores = readCoreTimes();
+
+	rusage usage{};
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+	{
+		const auto toNs = [](const timeval& tv)
+		{
+			return static_cast<std::int64_t>(tv.tv_sec) * 1'000'000'000 + static_cast<std::int64_t>(tv.tv_usec) * 1'000;
+		};
+
+		sample.processCpuNs = toNs(usage.ru_utime) + toNs(usage.ru_stime);
+		sample.peakRssBytes = static_cast<std::uint64_t>(usage.ru_maxrss) * 1024; // ru_maxrss is in KiB on Linux
+	}
+#endif
+
+	return sample;
+}
+
+SystemUsage SystemUsage::between(const SystemSample& begin, const SystemSample& end)
+{
+	SystemUsage usage;
+
+	const std::int64_t wallNs = end.wallNs - begin.wallNs;
+	if (wallNs > 0)
+	{
+		usage.processCores = static_cast<double>(end.processCpuNs - begin.processCpuNs) / static_cast<double>(wallNs);
+	}
+
+	const std::size_t coreCount = std::min(begin.cores.size(), end.cores.size());
+	usage.coreBusyPercent.reserve(coreCount);
+
+	for (std::size_t i = 0; i < coreCount; ++i)
+	{
+		const std::uint64_t total = end.cores[i].total - begin.cores[i].total;
+		const std::uint64_t busy = end.cores[i].busy - begin.cores[i].busy;
+
+		usage.coreBusyPercent.push_back(total > 0 ? 100.0 * static_cast<double>(busy) / static_cast<double>(total) : 0.0);
+	}
+
+	usage.rssGrowthBytes = static_cast<std::int64_t>(end.rssBytes) - static_cast<std::int64_t>(begin.rssBytes);
+	usage.rssEndBytes = end.rssBytes;
+	usage.peakRssBytes = end.peakRssBytes;
+
+	return usage;
+}
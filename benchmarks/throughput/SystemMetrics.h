@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// Point-in-time process and machine counters. Only populated on Linux (from /proc and getrusage); zero elsewhere.
+/// </summary>
+struct SystemSample
+{
+	struct CoreTimes
+	{
+		std::uint64_t busy = 0;
+		std::uint64_t total = 0;
+	};
+
+	std::int64_t           wallNs = 0;
+	std::uint64_t          rssBytes = 0;
+	std::uint64_t          peakRssBytes = 0;
+	std::int64_t           processCpuNs = 0; // user + system
+	std::vector<CoreTimes> cores;
+
+	static SystemSample capture();
+};
+
+struct SystemUsage
+{
+	double              processCores = 0.0;  // process CPU time / wall time
+	std::vector<double> coreBusyPercent;     // per logical core, whole machine
+	std::int64_t        rssGrowthBytes = 0;
+	std::uint64_t       rssEndBytes = 0;
+	std::uint64_t       peakRssBytes = 0;
+
+	static SystemUsage between(const SystemSample& begin, const SystemSample& end);
+};
@@ -0,0 +1,119 @@
+#include "ThroughputConsumer_Plugin.h"
+#include "Services/IServiceSpecialisations.h"
+#include "Services/Logging/LogLevel.h"
+
+namespace
+{
+	// One consumer per loaded copy of the library
+	ThroughputConsumerPlugin* g_consumer = nullptr;
+}
+
+bool ThroughputSampleHandler::handleType(const std::shared_ptr<ThroughputSample>& data)
+{
+	if (m_config.workNs > 0)
+	{
+		const std::int64_t workUntil = throughputNowNs() + m_config.workNs;
+		while (throughputNowNs() < workUntil)
+		{
+		}
+	}
+
+	const std::int64_t now = throughputNowNs();
+	m_stats.dispatchLatency.record(now - data->createdAtNs);
+	m_stats.endToEndLatency.record(now - data->intendedAtNs);
+	++m_stats.received;
+
+	return true;
+}
+
+void ThroughputSampleHandler::configure(const ThroughputConsumerConfig& config)
+{
+	m_config = config;
+}
+
+void ThroughputSampleHandler::reset()
+{
+	m_stats.received = 0;
+	m_stats.dispatchLatency.reset();
+	m_stats.endToEndLatency.reset();
+}
+
+const ThroughputConsumerStats& ThroughputSampleHandler::getStats() const
+{
+	return m_stats;
+}
+
+std::expected<void, std::string> ThroughputConsumerPlugin::onPluginLoad(IPluginContext& context)
+{
+	m_logger = ServiceProxy(context.getService<ILogger>());
+
+	context.registerTypedHandler<ThroughputSample>(m_handler);
+	g_consumer = this;
+
+	m_logger->log(LogLevel::Info, "ThroughputConsumerPlugin registered for ThroughputSample packets");
+	return {};
+}
+
+void ThroughputConsumerPlugin::onPluginUnload()
+{
+	g_consumer = nullptr;
+	m_logger->log(LogLevel::Info, std::format("unloading after receiving {} packets", m_handler->getStats().received));
+}
+
+std::type_index ThroughputConsumerPlugin::getType() const
+{
+	return typeid(ThroughputSample);
+}
+
+ThroughputSampleHandler& ThroughputConsumerPlugin::getHandler() const
+{
+	return *m_handler;
+}
+
+EXPORT void throughputConsumerConfigure(const ThroughputConsumerConfig* config)
+{
+	if (g_consumer && config)
+	{
+		g_consumer->getHandler().configure(*config);
+	}
+}
+
+EXPORT void throughputConsumerGetStats(ThroughputConsumerStats* stats)
+{
+	if (g_consumer && stats)
+	{
+		*stats = g_consumer->getHandler().getStats();
+	}
+}
+
+EXPORT void throughputConsumerReset()
+{
+	if (g_consumer)
+	{
+		g_consumer->getHandler().reset();
+	}
+}
+
+EXPORT PluginDescriptor* getPluginDescriptor()
+{
+	static PluginDescriptor descriptor
+	{
+		.name = "ThroughputConsumer",
+		.version = "1.0.0",
+		.services = {
+			{
+				.type = typeid(ILogger),
+				.name = "logger",
+				.minVersion = ">=1.0.0",
+				.required = false
+			}
+	}
+	};
+
+	return &descriptor;
+}
+
+EXPORT IPlugin* loadPlugin()
+{
+	return new ThroughputConsumerPlugin();
+}
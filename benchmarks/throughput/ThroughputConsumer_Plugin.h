@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Plugin/IPlugin.h"
+#include "DataPacket/IDataPacketHandler.h"
+#include "Services/IService.h"
+#include "Services/Logging/ILogger.h"
+#include "ThroughputProtocol.h"
+
+/// <summary>
+/// Records the latency of every ThroughputSample it sees, after spinning for the configured amount of simulated work
+/// </summary>
+class ThroughputSampleHandler final : public ITypedDataPacketHandler<ThroughputSample>
+{
+public:
+	bool handleType(const std::shared_ptr<ThroughputSample>& data) override;
+
+	void configure(const ThroughputConsumerConfig& config);
+	void reset();
+	[[nodiscard]] const ThroughputConsumerStats& getStats() const;
+
+private:
+	ThroughputConsumerConfig m_config;
+	ThroughputConsumerStats  m_stats;
+};
+
+/// <summary>
+/// Synthetic consumer modeled on NumberLogger
+/// </summary>
+class ThroughputConsumerPlugin final : public IPlugin
+{
+	public:
+		std::expected<void, std::string> onPluginLoad(IPluginContext& context) override;
+		void            onPluginUnload() override;
+		std::type_index getType() const override;
+
+		[[nodiscard]] ThroughputSampleHandler& getHandler() const;
+
+	private:
+		std::shared_ptr<ThroughputSampleHandler> m_handler = std::make_shared<ThroughputSampleHandler>();
+		ServiceProxy<ILogger> m_logger{nullptr};
+};
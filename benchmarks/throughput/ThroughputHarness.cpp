@@ -0,0 +1,751 @@
+// vectorium_throughput - boots Engine without the UI, loads N synthetic producers and M synthetic consumers and drives
+// them through Engine::tick at a fixed or open-loop rate, then reports latency percentiles, throughput, memory and CPU.
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "Engine.h"
+#include "Plugin/PluginManager.h"
+#include "Profiling/AllocationTracker.h"
+#include "Profiling/TraceRecorder.h"
+#include "SystemMetrics.h"
+#include "ThroughputProtocol.h"
+
+#ifndef VECTORIUM_THROUGHPUT_PLUGIN_DIR
+#define VECTORIUM_THROUGHPUT_PLUGIN_DIR "plugins"
+#endif
+
+namespace
+{
+	enum class LoadMode
+	{
+		Fixed,    // packetsPerTick per producer, ticks paced at tickInterval (closed loop)
+		Saturate, // packetsPerTick per producer, ticks back to back
+		Open,     // constant arrival rate independent of how fast the engine keeps up
+		Ramp      // open loop, multiplying the rate each step until it stops being sustainable
+	};
+
+	struct HarnessOptions
+	{
+		LoadMode              mode = LoadMode::Open;
+		std::uint32_t         producers = 1;
+		std::uint32_t         consumers = 1;
+		double                rate = 100'000.0;        // packets/s across all producers (open/ramp)
+		std::uint64_t         packetsPerTick = 100;    // per producer (fixed/saturate)
+		std::int64_t          tickIntervalNs = 1'000'000;
+		double                durationSeconds = 10.0;  // per step
+		double                warmupSeconds = 1.0;     // per step
+		std::int64_t          workNs = 0;
+		double                rampFactor = 2.0;
+		std::uint32_t         maxRampSteps = 16;
+		double                sloP99Us = 5'000.0;     // a packet can wait up to one tick before it is emitted
+		double                sustainedFraction = 0.95;
+		std::filesystem::path pluginDir = VECTORIUM_THROUGHPUT_PLUGIN_DIR;
+		std::filesystem::path reportPath = "bench/vectorium_throughput.json";
+		std::filesystem::path tracePath;
+		bool                  allocationAudit = false;
+	};
+
+	struct LatencySummary
+	{
+		std::uint64_t p50 = 0;
+		std::uint64_t p90 = 0;
+		std::uint64_t p99 = 0;
+		std::uint64_t p999 = 0;
+		std::uint64_t max = 0;
+		double        mean = 0.0;
+
+		static LatencySummary from(const LatencyHistogram& histogram)
+		{
+			return LatencySummary{
+				.p50 = histogram.percentile(50.0),
+				.p90 = histogram.percentile(90.0),
+				.p99 = histogram.percentile(99.0),
+				.p999 = histogram.percentile(99.9),
+				.max = histogram.total == 0 ? 0 : histogram.max,
+				.mean = histogram.mean()
+			};
+		}
+	};
+
+	struct StepResult
+	{
+		double         targetRate = 0.0; // 0 for closed-loop modes
+		double         achievedRate = 0.0;
+		double         deliveriesPerSecond = 0.0;
+		std::uint64_t  produced = 0;
+		std::uint64_t  delivered = 0;
+		std::uint64_t  ticks = 0;
+		LatencySummary dispatchLatency;
+		LatencySummary endToEndLatency;
+		SystemUsage    usage;
+		bool           sustainable = true;
+	};
+
+	std::string_view toString(LoadMode mode)
+	{
+		switch (mode)
+		{
+			case LoadMode::Fixed:    return "fixed";
+			case LoadMode::Saturate: return "saturate";
+			case LoadMode::Open:     return "open";
+			case LoadMode::Ramp:     return "ramp";
+		}
+
+		return "unknown";
+	}
+
+	void printUsage()
+	{
+		std::cout <<
+			"Usage: vectorium_throughput [options]\n"
+			"  --mode=open|fixed|saturate|ramp  load model (default open)\n"
+			"  --producers=N --consumers=N      synthetic plugin instances (default 1/1)\n"
+			"  --rate=N                         packets/s across all producers for open/ramp (default 100000)\n"
+			"  --packets-per-tick=N             per producer for fixed/saturate (default 100)\n"
+			"  --tick-us=N                      engine tick interval (default 1000)\n"
+			"  --duration-s=N --warmup-s=N      measured/warmup time per step (default 10/1)\n"
+			"  --work-ns=N                      simulated work per packet in each consumer\n"
+			"  --ramp-factor=N --max-steps=N    ramp rate multiplier and step limit (default 2/16)\n"
+			"  --slo-p99-us=N                   end-to-end p99 a ramp step must stay under (default 5000)\n"
+			"  --plugin-dir=PATH                folder containing the synthetic plugins\n"
+			"  --report=PATH                    JSON report (default bench/vectorium_throughput.json)\n"
+			"  --trace=PATH                     also capture a Chrome trace of the run\n"
+			"  --alloc-audit=1                  report allocations per tick/handler (VECTORIUM_ALLOCATION_AUDIT builds)\n";
+	}
+
+	template<typename T>
+	bool parseNumber(std::string_view text, T& out)
+	{
+		const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+		return ec == std::errc{} && ptr == text.data() + text.size();
+	}
+
+	std::optional<HarnessOptions> parseOptions(int argc, char** argv)
+	{
+		HarnessOptions options;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string_view arg = argv[i];
+			if (arg == "--help" || arg == "-h")
+			{
+				return std::nullopt;
+			}
+
+			const auto separator = arg.find('=');
+			if (!arg.starts_with("--") || separator == std::string_view::npos)
+			{
+				std::cerr << std::format("Unrecognised argument '{}'\n", arg);
+				return std::nullopt;
+			}
+
+			const std::string_view key = arg.substr(2, separator - 2);
+			const std::string_view value = arg.substr(separator + 1);
+			bool parsed = true;
+
+			if (key == "mode")
+			{
+				if (value == "fixed")         options.mode = LoadMode::Fixed;
+				else if (value == "saturate") options.mode = LoadMode::Saturate;
+				else if (value == "open")     options.mode = LoadMode::Open;
+				else if (value == "ramp")     options.mode = LoadMode::Ramp;
+				else                          parsed = false;
+			}
+			else if (key == "producers")        parsed = parseNumber(value, options.producers);
+			else if (key == "consumers")        parsed = parseNumber(value, options.consumers);
+			else if (key == "rate")             parsed = parseNumber(value, options.rate);
+			else if (key == "packets-per-tick") parsed = parseNumber(value, options.packetsPerTick);
+			else if (key == "duration-s")       parsed = parseNumber(value, options.durationSeconds);
+			else if (key == "warmup-s")         parsed = parseNumber(value, options.warmupSeconds);
+			else if (key == "work-ns")          parsed = parseNumber(value, options.workNs);
+			else if (key == "ramp-factor")      parsed = parseNumber(value, options.rampFactor);
+			else if (key == "max-steps")        parsed = parseNumber(value, options.maxRampSteps);
+			else if (key == "slo-p99-us")       parsed = parseNumber(value, options.sloP99Us);
+			else if (key == "plugin-dir")       options.pluginDir = value;
+			else if (key == "report")           options.reportPath = value;
+			else if (key == "trace")            options.tracePath = value;
+			else if (key == "alloc-audit")      options.allocationAudit = (value == "1" || value == "true");
+			else if (key == "tick-us")
+			{
+				std::int64_t tickUs = 0;
+				parsed = parseNumber(value, tickUs) && tickUs > 0;
+				options.tickIntervalNs = tickUs * 1'000;
+			}
+			else
+			{
+				std::cerr << std::format("Unknown option '--{}'\n", key);
+				return std::nullopt;
+			}
+
+			if (!parsed)
+			{
+				std::cerr << std::format("Invalid value '{}' for '--{}'\n", value, key);
+				return std::nullopt;
+			}
+		}
+
+		if (options.producers == 0 || options.rate <= 0.0 || options.durationSeconds <= 0.0 || options.rampFactor <= 1.0)
+		{
+			std::cerr << "--producers, --rate and --duration-s must be positive and --ramp-factor greater than 1\n";
+			return std::nullopt;
+		}
+
+		return options;
+	}
+
+	/// <summary>
+	/// The harness's view of one synthetic plugin instance. Each instance is a private copy of the .so, so every
+	/// instance gets its own statics and PluginManager sees a distinct plugin name.
+	/// </summary>
+	struct SyntheticPlugin
+	{
+		std::string   name;
+		LibraryHandle handle = nullptr; // extra reference on the library PluginManager already loaded
+
+		template<typename Func>
+		Func symbol(const char* symbolName) const
+		{
+			return handle ? reinterpret_cast<Func>(GetSymbol(handle, symbolName)) : nullptr;
+		}
+	};
+
+	class SyntheticPluginSet
+	{
+	public:
+		SyntheticPluginSet(PluginManager& pluginManager, std::filesystem::path workDir)
+			: m_pluginManager(pluginManager)
+			, m_workDir(std::move(workDir))
+		{
+			std::filesystem::create_directories(m_workDir);
+		}
+
+		~SyntheticPluginSet()
+		{
+			for (auto& plugin : m_plugins)
+			{
+				if (plugin.handle)
+				{
+					UnloadLibrary(plugin.handle);
+				}
+
+				m_pluginManager.unloadPlugin(plugin.name);
+			}
+
+			std::error_code ec;
+			std::filesystem::remove_all(m_workDir, ec);
+		}
+
+		SyntheticPluginSet(const SyntheticPluginSet&) = delete;
+		SyntheticPluginSet& operator=(const SyntheticPluginSet&) = delete;
+
+		const SyntheticPlugin* load(const std::filesystem::path& library, const std::string& instanceName)
+		{
+			const auto instancePath = m_workDir / (instanceName + library.extension().string());
+
+			std::error_code ec;
+			std::filesystem::copy_file(library, instancePath, std::filesystem::copy_options::overwrite_existing, ec);
+			if (ec)
+			{
+				std::cerr << std::format("Could not copy '{}' to '{}': {}\n", library.string(), instancePath.string(), ec.message());
+				return nullptr;
+			}
+
+			if (!m_pluginManager.loadPlugin(instancePath, instanceName))
+			{
+				std::cerr << std::format("PluginManager failed to load '{}'\n", instancePath.string());
+				return nullptr;
+			}
+
+			SyntheticPlugin& plugin = m_plugins.emplace_back(SyntheticPlugin{
+				.name = instanceName,
+				.handle = LoadSharedLibrary(instancePath.string().c_str())
+			});
+
+			return &plugin;
+		}
+
+	private:
+		PluginManager&               m_pluginManager;
+		std::filesystem::path        m_workDir;
+		std::vector<SyntheticPlugin> m_plugins;
+	};
+
+	struct ProducerControl
+	{
+		ThroughputProducerSetBudgetFunc setBudget = nullptr;
+		ThroughputProducerGetStatsFunc  getStats = nullptr;
+	};
+
+	struct ConsumerControl
+	{
+		ThroughputConsumerGetStatsFunc getStats = nullptr;
+		ThroughputConsumerResetFunc    reset = nullptr;
+	};
+
+	class ThroughputHarness
+	{
+	public:
+		ThroughputHarness(Engine& engine, HarnessOptions options, std::vector<ProducerControl> producers, std::vector<ConsumerControl> consumers)
+			: m_engine(engine)
+			, m_options(std::move(options))
+			, m_producers(std::move(producers))
+			, m_consumers(std::move(consumers))
+		{}
+
+		std::vector<StepResult> run()
+		{
+			std::vector<StepResult> steps;
+
+			if (m_options.mode != LoadMode::Ramp)
+			{
+				steps.push_back(runStep(m_options.rate));
+				return steps;
+			}
+
+			double rate = m_options.rate;
+			for (std::uint32_t step = 0; step < m_options.maxRampSteps; ++step)
+			{
+				StepResult result = runStep(rate);
+				std::cout << std::format("  ramp {:>12.0f} pkt/s -> {:>12.0f} pkt/s, e2e p99 {:>10} ns{}\n",
+					result.targetRate, result.achievedRate, result.endToEndLatency.p99, result.sustainable ? "" : "  (unsustainable)");
+
+				const bool sustainable = result.sustainable;
+				steps.push_back(std::move(result));
+
+				if (!sustainable)
+				{
+					break;
+				}
+
+				rate *= m_options.rampFactor;
+			}
+
+			return steps;
+		}
+
+	private:
+		StepResult runStep(double targetRate)
+		{
+			// Warmup populates caches and allocator pools; nothing from it is reported
+			drive(targetRate, m_options.warmupSeconds);
+			resetConsumers();
+			AllocationTracker::instance().reset();
+
+			const std::uint64_t producedBefore = totalProduced();
+			const SystemSample  begin = SystemSample::capture();
+
+			const std::uint64_t ticks = drive(targetRate, m_options.durationSeconds);
+
+			const SystemSample end = SystemSample::capture();
+			const double       seconds = static_cast<double>(end.wallNs - begin.wallNs) / 1e9;
+
+			LatencyHistogram dispatchLatency;
+			LatencyHistogram endToEndLatency;
+			std::uint64_t    delivered = 0;
+
+			for (const auto& consumer : m_consumers)
+			{
+				ThroughputConsumerStats stats;
+				consumer.getStats(&stats);
+
+				delivered += stats.received;
+				dispatchLatency.merge(stats.dispatchLatency);
+				endToEndLatency.merge(stats.endToEndLatency);
+			}
+
+			StepResult result;
+			result.targetRate = isOpenLoop() ? targetRate : 0.0;
+			result.produced = totalProduced() - producedBefore;
+			result.delivered = delivered;
+			result.ticks = ticks;
+			result.achievedRate = static_cast<double>(result.produced) / seconds;
+			result.deliveriesPerSecond = static_cast<double>(delivered) / seconds;
+			result.dispatchLatency = LatencySummary::from(dispatchLatency);
+			result.endToEndLatency = LatencySummary::from(endToEndLatency);
+			result.usage = SystemUsage::between(begin, end);
+
+			if (isOpenLoop())
+			{
+				result.sustainable = result.achievedRate >= targetRate * m_options.sustainedFraction
+					&& static_cast<double>(result.endToEndLatency.p99) <= m_options.sloP99Us * 1'000.0;
+			}
+
+			return result;
+		}
+
+		/// <summary>
+		/// Ticks the engine for the given time, handing each producer its share of the packets due this tick
+		/// </summary>
+		/// <returns>Number of engine ticks</returns>
+		std::uint64_t drive(double targetRate, double seconds)
+		{
+			const std::int64_t  start = throughputNowNs();
+			const std::int64_t  end = start + static_cast<std::int64_t>(seconds * 1e9);
+			const double        intervalNs = 1e9 / targetRate;
+			const auto          producerCount = static_cast<std::uint64_t>(m_producers.size());
+
+			// Open loop: cap a single tick at 16 nominal ticks of work so a stalled engine catches up gradually and the
+			// backlog shows up as end-to-end latency instead of one enormous tick
+			const auto maxPerTick = static_cast<std::uint64_t>(std::max(1.0, 16.0 * targetRate * static_cast<double>(m_options.tickIntervalNs) / 1e9));
+
+			std::uint64_t scheduled = 0;
+			std::uint64_t ticks = 0;
+			std::int64_t  nextTick = start;
+
+			for (std::int64_t now = start; now < end; now = throughputNowNs())
+			{
+				if (isOpenLoop())
+				{
+					const auto due = static_cast<std::uint64_t>(static_cast<double>(now - start) / intervalNs);
+					const std::uint64_t packets = std::min(due > scheduled ? due - scheduled : 0, maxPerTick);
+
+					// Contiguous slices of the schedule, one per producer
+					std::uint64_t assigned = 0;
+					for (std::uint64_t p = 0; p < producerCount; ++p)
+					{
+						const std::uint64_t share = packets / producerCount + (p < packets % producerCount ? 1 : 0);
+						const std::uint64_t firstSequence = scheduled + assigned;
+
+						const ThroughputBudget budget{
+							.packets = share,
+							.firstSequence = firstSequence,
+							.firstIntendedAtNs = start + static_cast<std::int64_t>(static_cast<double>(firstSequence) * intervalNs),
+							.intervalNs = std::max<std::int64_t>(1, static_cast<std::int64_t>(intervalNs))
+						};
+						m_producers[p].setBudget(&budget);
+						assigned += share;
+					}
+
+					scheduled += packets;
+				}
+				else
+				{
+					const ThroughputBudget budget{ .packets = m_options.packetsPerTick };
+					for (const auto& producer : m_producers)
+					{
+						producer.setBudget(&budget);
+					}
+				}
+
+				m_engine.tick();
+				++ticks;
+
+				if (m_options.mode != LoadMode::Saturate)
+				{
+					nextTick += m_options.tickIntervalNs;
+					const std::int64_t sleepNs = nextTick - throughputNowNs();
+					if (sleepNs > 0)
+					{
+						std::this_thread::sleep_for(std::chrono::nanoseconds(sleepNs));
+					}
+					else
+					{
+						nextTick = throughputNowNs(); // fell behind; don't try to make up missed ticks in a burst
+					}
+				}
+			}
+
+			return ticks;
+		}
+
+		[[nodiscard]] bool isOpenLoop() const
+		{
+			return m_options.mode == LoadMode::Open || m_options.mode == LoadMode::Ramp;
+		}
+
+		[[nodiscard]] std::uint64_t totalProduced() const
+		{
+			std::uint64_t produced = 0;
+			for (const auto& producer : m_producers)
+			{
+				ThroughputProducerStats stats;
+				producer.getStats(&stats);
+				produced += stats.produced;
+			}
+
+			return produced;
+		}
+
+		void resetConsumers() const
+		{
+			for (const auto& consumer : m_consumers)
+			{
+				consumer.reset();
+			}
+		}
+
+		Engine&                      m_engine;
+		HarnessOptions               m_options;
+		std::vector<ProducerControl> m_producers;
+		std::vector<ConsumerControl> m_consumers;
+	};
+
+	nlohmann::json toJson(const LatencySummary& latency)
+	{
+		return {
+			{"p50_ns", latency.p50},
+			{"p90_ns", latency.p90},
+			{"p99_ns", latency.p99},
+			{"p999_ns", latency.p999},
+			{"max_ns", latency.max},
+			{"mean_ns", latency.mean}
+		};
+	}
+
+	nlohmann::json toJson(const StepResult& step)
+	{
+		return {
+			{"target_rate", step.targetRate},
+			{"achieved_rate", step.achievedRate},
+			{"deliveries_per_second", step.deliveriesPerSecond},
+			{"produced", step.produced},
+			{"delivered", step.delivered},
+			{"ticks", step.ticks},
+			{"sustainable", step.sustainable},
+			{"dispatch_latency", toJson(step.dispatchLatency)},
+			{"end_to_end_latency", toJson(step.endToEndLatency)},
+			{"process_cores", step.usage.processCores},
+			{"core_busy_percent", step.usage.coreBusyPercent},
+			{"rss_growth_bytes", step.usage.rssGrowthBytes}
+		};
+	}
+
+	void printStep(const StepResult& step, std::size_t consumers)
+	{
+		const auto printLatency = [](std::string_view label, const LatencySummary& latency)
+		{
+			std::cout << std::format("  {:<22} p50 {:>9} ns  p90 {:>9} ns  p99 {:>9} ns  p99.9 {:>9} ns  max {:>10} ns\n",
+				label, latency.p50, latency.p90, latency.p99, latency.p999, latency.max);
+		};
+
+		if (step.targetRate > 0.0)
+		{
+			std::cout << std::format("  target rate            {:.0f} pkt/s\n", step.targetRate);
+		}
+
+		std::cout << std::format("  achieved rate          {:.0f} pkt/s ({:.0f} deliveries/s, {} ticks)\n", step.achievedRate, step.deliveriesPerSecond, step.ticks);
+
+		if (step.delivered != step.produced * consumers)
+		{
+			std::cout << std::format("  WARNING: delivered {} packets, expected {}\n", step.delivered, step.produced * consumers);
+		}
+
+		printLatency("dispatch latency", step.dispatchLatency);
+		printLatency("end-to-end latency", step.endToEndLatency);
+		std::cout << std::format("  cpu                    {:.2f} cores used by process\n", step.usage.processCores);
+
+		for (std::size_t core = 0; core < step.usage.coreBusyPercent.size(); ++core)
+		{
+			std::cout << std::format("    cpu{:<3} {:>5.1f}% busy\n", core, step.usage.coreBusyPercent[core]);
+		}
+
+		std::cout << std::format("  rss growth             {} KiB\n", step.usage.rssGrowthBytes / 1024);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const auto parsedOptions = parseOptions(argc, argv);
+	if (!parsedOptions)
+	{
+		printUsage();
+		return 1;
+	}
+
+	const HarnessOptions& options = *parsedOptions;
+
+	const auto producerLibrary = options.pluginDir / (std::string("ThroughputProducer_Plugin") + PLUGIN_EXT);
+	const auto consumerLibrary = options.pluginDir / (std::string("ThroughputConsumer_Plugin") + PLUGIN_EXT);
+
+	if (!std::filesystem::exists(producerLibrary) || !std::filesystem::exists(consumerLibrary))
+	{
+		std::cerr << std::format("Synthetic plugins not found in '{}' - pass --plugin-dir\n", options.pluginDir.string());
+		return 1;
+	}
+
+	// Engine only - no UI. Engine::init() is skipped as well, so the user's plugin config is never loaded.
+	Engine engine;
+	engine.getEngineSettings().setPluginUpdateInterval(std::chrono::seconds(0));
+
+	if (!options.tracePath.empty())
+	{
+		engine.getEngineSettings().setTraceCapture(true);
+	}
+
+	if (options.allocationAudit)
+	{
+		engine.getEngineSettings().setAllocationAudit(true);
+	}
+
+	const SystemSample processStart = SystemSample::capture();
+	std::vector<StepResult> steps;
+
+	{
+		const auto workDir = std::filesystem::temp_directory_path() / std::format("vectorium_throughput_{}", processStart.wallNs);
+		SyntheticPluginSet plugins(*engine.getPluginManager(), workDir);
+
+		std::vector<ProducerControl> producers;
+		std::vector<ConsumerControl> consumers;
+
+		for (std::uint32_t i = 0; i < options.consumers; ++i)
+		{
+			const SyntheticPlugin* plugin = plugins.load(consumerLibrary, std::format("ThroughputConsumer_{}", i));
+			if (!plugin)
+			{
+				return 1;
+			}
+
+			const auto configure = plugin->symbol<ThroughputConsumerConfigureFunc>("throughputConsumerConfigure");
+			const ConsumerControl control{
+				.getStats = plugin->symbol<ThroughputConsumerGetStatsFunc>("throughputConsumerGetStats"),
+				.reset = plugin->symbol<ThroughputConsumerResetFunc>("throughputConsumerReset")
+			};
+
+			if (!configure || !control.getStats || !control.reset)
+			{
+				std::cerr << std::format("'{}' is missing the throughputConsumer exports\n", plugin->name);
+				return 1;
+			}
+
+			const ThroughputConsumerConfig config{ .workNs = options.workNs };
+			configure(&config);
+			consumers.push_back(control);
+		}
+
+		for (std::uint32_t i = 0; i < options.producers; ++i)
+		{
+			const SyntheticPlugin* plugin = plugins.load(producerLibrary, std::format("ThroughputProducer_{}", i));
+			if (!plugin)
+			{
+				return 1;
+			}
+
+			const auto init = plugin->symbol<ThroughputProducerInitFunc>("throughputProducerInit");
+			const ProducerControl control{
+				.setBudget = plugin->symbol<ThroughputProducerSetBudgetFunc>("throughputProducerSetBudget"),
+				.getStats = plugin->symbol<ThroughputProducerGetStatsFunc>("throughputProducerGetStats")
+			};
+
+			if (!init || !control.setBudget || !control.getStats)
+			{
+				std::cerr << std::format("'{}' is missing the throughputProducer exports\n", plugin->name);
+				return 1;
+			}
+
+			init(i);
+			producers.push_back(control);
+		}
+
+		std::cout << std::format("\nvectorium_throughput: mode={} producers={} consumers={} work={}ns tick={}us\n",
+			toString(options.mode), options.producers, options.consumers, options.workNs, options.tickIntervalNs / 1'000);
+
+		ThroughputHarness harness(engine, options, std::move(producers), std::move(consumers));
+		steps = harness.run();
+	}
+
+	const SystemUsage processUsage = SystemUsage::between(processStart, SystemSample::capture());
+
+	std::optional<double> maxSustainableRate;
+	for (const auto& step : steps)
+	{
+		if (step.targetRate > 0.0 && step.sustainable)
+		{
+			maxSustainableRate = std::max(maxSustainableRate.value_or(0.0), step.achievedRate);
+		}
+	}
+
+	std::cout << "\nResults\n";
+	printStep(steps.back(), options.consumers);
+
+	if (options.mode == LoadMode::Ramp)
+	{
+		std::cout << (maxSustainableRate
+			? std::format("  max sustainable rate   {:.0f} pkt/s (p99 <= {} us)\n", *maxSustainableRate, options.sloP99Us)
+			: std::string("  max sustainable rate   none - lower --rate\n"));
+	}
+
+	std::cout << std::format("  rss                    {} KiB now, {} KiB peak, {:+} KiB over the run\n",
+		processUsage.rssEndBytes / 1024, processUsage.peakRssBytes / 1024, processUsage.rssGrowthBytes / 1024);
+
+	nlohmann::json report = {
+		{"mode", toString(options.mode)},
+		{"producers", options.producers},
+		{"consumers", options.consumers},
+		{"work_ns", options.workNs},
+		{"tick_interval_ns", options.tickIntervalNs},
+		{"duration_seconds", options.durationSeconds},
+		{"hardware_threads", std::thread::hardware_concurrency()},
+		{"steps", nlohmann::json::array()},
+		{"rss_end_bytes", processUsage.rssEndBytes},
+		{"rss_peak_bytes", processUsage.peakRssBytes},
+		{"rss_growth_bytes", processUsage.rssGrowthBytes}
+	};
+
+	for (const auto& step : steps)
+	{
+		report["steps"].push_back(toJson(step));
+	}
+
+	if (options.allocationAudit)
+	{
+		// Counts cover the last measured step
+		std::cout << "\nAllocations\n" << AllocationTracker::instance().formatReport();
+
+		report["allocation_zones"] = nlohmann::json::array();
+		for (const auto& zone : AllocationTracker::instance().getZoneStats())
+		{
+			report["allocation_zones"].push_back({
+				{"zone", zone.label},
+				{"kind", toString(zone.kind)},
+				{"entries", zone.entries},
+				{"allocations_per_entry", zone.getAllocationsPerEntry()},
+				{"bytes_per_entry", zone.getBytesPerEntry()},
+				{"max_allocations_per_entry", zone.maxAllocationsPerEntry}
+			});
+		}
+	}
+
+	if (maxSustainableRate)
+	{
+		report["max_sustainable_rate"] = *maxSustainableRate;
+	}
+
+	std::error_code ec;
+	if (options.reportPath.has_parent_path())
+	{
+		std::filesystem::create_directories(options.reportPath.parent_path(), ec);
+	}
+
+	std::ofstream reportFile(options.reportPath);
+	if (reportFile << std::setw(4) << report << "\n")
+	{
+		std::cout << std::format("\nReport written to '{}'\n", options.reportPath.string());
+	}
+	else
+	{
+		std::cerr << std::format("Could not write report to '{}'\n", options.reportPath.string());
+	}
+
+	if (!options.tracePath.empty())
+	{
+		TraceRecorder::instance().writeChromeTrace(options.tracePath)
+			? std::cout << std::format("Trace written to '{}'\n", options.tracePath.string())
+			: std::cerr << std::format("Could not write trace to '{}'\n", options.tracePath.string());
+	}
+
+	engine.shutdown();
+	return 0;
+}
@@ -0,0 +1,117 @@
+#include "ThroughputProducer_Plugin.h"
+#include "Services/IServiceSpecialisations.h"
+#include "Services/Logging/LogLevel.h"
+
+namespace
+{
+	// One producer per loaded copy of the library
+	ThroughputProducerPlugin* g_producer = nullptr;
+}
+
+std::expected<void, std::string> ThroughputProducerPlugin::onPluginLoad(IPluginContext& context)
+{
+	m_logger = ServiceProxy(context.getService<ILogger>());
+	m_context = &context;
+	g_producer = this;
+
+	m_logger->log(LogLevel::Info, "loaded");
+	return {};
+}
+
+void ThroughputProducerPlugin::onPluginUnload()
+{
+	g_producer = nullptr;
+	m_logger->log(LogLevel::Info, std::format("unloading after producing {} packets", m_stats.produced));
+}
+
+std::type_index ThroughputProducerPlugin::getType() const
+{
+	return typeid(ThroughputSample);
+}
+
+void ThroughputProducerPlugin::tick()
+{
+	if (!m_context)
+	{
+		return;
+	}
+
+	for (std::uint64_t i = 0; i < m_budget.packets; ++i)
+	{
+		auto sample = std::make_shared<ThroughputSample>();
+		sample->sequence = m_budget.firstSequence + i;
+		sample->producerId = m_producerId;
+		sample->createdAtNs = throughputNowNs();
+		sample->intendedAtNs = m_budget.intervalNs > 0
+			? m_budget.firstIntendedAtNs + static_cast<std::int64_t>(i) * m_budget.intervalNs
+			: sample->createdAtNs;
+
+		m_context->dispatch(DataPacket::create(std::move(sample)));
+	}
+
+	m_stats.produced += m_budget.packets;
+	m_budget.packets = 0;
+}
+
+void ThroughputProducerPlugin::setProducerId(std::uint32_t producerId)
+{
+	m_producerId = producerId;
+}
+
+void ThroughputProducerPlugin::setBudget(const ThroughputBudget& budget)
+{
+	m_budget = budget;
+}
+
+ThroughputProducerStats ThroughputProducerPlugin::getStats() const
+{
+	return m_stats;
+}
+
+EXPORT void throughputProducerInit(std::uint32_t producerId)
+{
+	if (g_producer)
+	{
+		g_producer->setProducerId(producerId);
+	}
+}
+
+EXPORT void throughputProducerSetBudget(const ThroughputBudget* budget)
+{
+	if (g_producer && budget)
+	{
+		g_producer->setBudget(*budget);
+	}
+}
+
+EXPORT void throughputProducerGetStats(ThroughputProducerStats* stats)
+{
+	if (g_producer && stats)
+	{
+		*stats = g_producer->getStats();
+	}
+}
+
+EXPORT PluginDescriptor* getPluginDescriptor()
+{
+	static PluginDescriptor descriptor
+	{
+		.name = "ThroughputProducer",
+		.version = "1.0.0",
+		.services = {
+			{
+				.type = typeid(ILogger),
+				.name = "logger",
+				.minVersion = ">=1.0.0",
+				.required = false
+			}
+	}
+	};
+
+	return &descriptor;
+}
+
+EXPORT IPlugin* loadPlugin()
+{
+	return new ThroughputProducerPlugin();
+}
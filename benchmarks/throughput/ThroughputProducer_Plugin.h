@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Plugin/IPlugin.h"
+#include "Services/IService.h"
+#include "Services/Logging/ILogger.h"
+#include "ThroughputProtocol.h"
+
+/// <summary>
+/// Synthetic producer modeled on NumberGenerator. Emits the number of ThroughputSample packets the harness budgeted
+/// for each tick.
+/// </summary>
+struct ThroughputProducerPlugin final : public IPlugin
+{
+	std::expected<void, std::string> onPluginLoad(IPluginContext& context) override;
+	void onPluginUnload() override;
+
+	[[nodiscard]] std::type_index getType() const override;
+	void                          tick() override;
+
+	void setProducerId(std::uint32_t producerId);
+	void setBudget(const ThroughputBudget& budget);
+	[[nodiscard]] ThroughputProducerStats getStats() const;
+
+	private:
+		IPluginContext* m_context = nullptr;
+		ServiceProxy<ILogger> m_logger{nullptr};
+
+		std::uint32_t m_producerId = 0;
+		ThroughputBudget m_budget;
+		ThroughputProducerStats m_stats;
+};
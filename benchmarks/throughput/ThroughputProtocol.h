@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "LatencyHistogram.h"
+
+// Shared between vectorium_throughput and the synthetic plugins. The harness drives the plugins through the exported
+// functions below, looked up by symbol name on the already-loaded library.
+
+/// <summary>
+/// Packet emitted by the producer plugin and consumed by the consumer plugin
+/// </summary>
+struct ThroughputSample
+{
+	std::uint64_t sequence = 0;
+	std::int64_t  intendedAtNs = 0; // when the open-loop schedule wanted this packet sent
+	std::int64_t  createdAtNs = 0;  // when the producer actually created it
+	std::uint32_t producerId = 0;
+};
+
+/// <summary>
+/// How many packets the producer emits on its next tick. intervalNs == 0 means closed-loop: packets are stamped with
+/// their creation time rather than a schedule.
+/// </summary>
+struct ThroughputBudget
+{
+	std::uint64_t packets = 0;
+	std::uint64_t firstSequence = 0;
+	std::int64_t  firstIntendedAtNs = 0;
+	std::int64_t  intervalNs = 0;
+};
+
+struct ThroughputProducerStats
+{
+	std::uint64_t produced = 0;
+};
+
+struct ThroughputConsumerConfig
+{
+	std::int64_t workNs = 0; // simulated processing cost per packet
+};
+
+struct ThroughputConsumerStats
+{
+	std::uint64_t    received = 0;
+	LatencyHistogram dispatchLatency;  // created -> handled
+	LatencyHistogram endToEndLatency;  // intended -> handled, includes schedule lag when the engine falls behind
+};
+
+inline std::int64_t throughputNowNs() noexcept
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+using ThroughputProducerInitFunc = void(*)(std::uint32_t producerId);
+using ThroughputProducerSetBudgetFunc = void(*)(const ThroughputBudget* budget);
+using ThroughputProducerGetStatsFunc = void(*)(ThroughputProducerStats* stats);
+
+using ThroughputConsumerConfigureFunc = void(*)(const ThroughputConsumerConfig* config);
+using ThroughputConsumerGetStatsFunc = void(*)(ThroughputConsumerStats* stats);
+using ThroughputConsumerResetFunc = void(*)();
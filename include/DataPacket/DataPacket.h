@@ -1,10 +1,12 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <expected>
 #include <memory>
 #include <string>
 #include <typeindex>
+#include <type_traits>
 
 
 /// <summary>
@@ -15,6 +17,7 @@ struct DataPacket
 	std::shared_ptr<void> payload;
 	std::type_index payloadType;
 	std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::now();
+	std::uint32_t payloadSize = 0; // bytes of a trivially copyable payload, 0 if it can't be copied as raw bytes
 	//some form of ID?
 
 	template<typename T>
@@ -22,7 +25,8 @@ struct DataPacket
 	{
 		return DataPacket{
 			.payload = std::move(data),
-			.payloadType = typeid(T)
+			.payloadType = typeid(T),
+			.payloadSize = std::is_trivially_copyable_v<T> ? static_cast<std::uint32_t>(sizeof(T)) : 0u
 		};
 	}
 
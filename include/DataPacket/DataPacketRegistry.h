@@ -1,33 +1,218 @@
 #pragma once
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <typeindex>
 #include <unordered_map>
 #include <vector>
 
 #include "DataPacket/IDataPacketHandler.h"
+#include "DataPacket/PacketSpillBuffer.h"
 
 // forward declare
 class ILogger;
+class PacketJournalWriter;
+class PluginActivity;
 struct DataPacket;
+struct PacketSerializer;
 
 /// <summary>
 /// DataPacketRegistry knows about all packet types, and the handlers subscribed to each
 /// </summary>
+/// <remarks>
+/// The handler table is copy-on-write: registration builds a new table under a mutex and publishes it atomically, so
+/// plugins can register from loader threads while dispatch reads a stable snapshot without taking a lock.
+/// </remarks>
 class DataPacketRegistry
 {
 
-	using pluginNameAndHandlerPointer = std::pair<std::shared_ptr<IDataPacketHandler>, std::string>;
+	struct HandlerEntry
+	{
+		std::shared_ptr<IDataPacketHandler> handler;
+		std::string                         pluginName;
+		const char*                         traceLabel = nullptr; // interned plugin name for trace zones
+		std::shared_ptr<PluginActivity>     activity;             // times the handler for the watchdog, may be null
+	};
+
+	struct StagedHandler
+	{
+		std::type_index type;
+		HandlerEntry    entry;
+	};
+
+	struct SerializerEntry
+	{
+		const PacketSerializer* serializer = nullptr; // lives in the plugin's library
+		std::string             pluginName;
+		bool                    isStaged = false;     // registered by a reloading plugin, used once committed
+	};
+
+	struct NamedHandler
+	{
+		std::string  typeName; // typeid name
+		HandlerEntry entry;
+	};
+
+	class PacketHandoffBuffer;
+
+public:
+	/// <summary>
+	/// Told about a dispatched packet of a watched type. Called on the dispatching thread, so it must be cheap and thread-safe.
+	/// </summary>
+	using PacketWatchCallback = std::function<void(std::type_index packetType)>;
+
+	/// <summary>
+	/// Expires once every dispatch that started before the change that returned it has finished - only then is it safe to
+	/// destroy the handlers that change removed, or to close the library they came from.
+	/// </summary>
+	using DispatchFence = std::weak_ptr<const void>;
+
+private:
+	/// <summary>
+	/// One per published table. Each links to the next, so an old table still held by a dispatch keeps every later
+	/// generation - and so every fence handed out since - alive.
+	/// </summary>
+	struct TableGeneration
+	{
+		std::shared_ptr<TableGeneration> next;
+	};
+
+	struct HandlerTable
+	{
+		std::unordered_map<std::type_index, std::vector<HandlerEntry>> handlers;
+		std::vector<HandlerEntry>                                       wildcardHandlers;
+		std::vector<NamedHandler>                                       namedHandlers; // plugins in another process
+
+		// Hot reload, per plugin - staged handlers aren't dispatched to until committed, held ones are the old
+		// instance's while a handoff buffers its packets
+		std::unordered_map<std::string, std::vector<StagedHandler>>        stagedHandlers;
+		std::unordered_map<std::string, std::vector<StagedHandler>>        heldHandlers;
+		std::unordered_map<std::string, std::shared_ptr<PacketHandoffBuffer>> handoffs;
+
+		std::unordered_map<std::string, std::shared_ptr<PluginActivity>> activities; // stamped on each plugin's handlers
+
+		std::vector<std::type_index> watchedTypes;
+		bool                         watchAllTypes = false;
+		PacketWatchCallback          watchCallback;
+
+		std::shared_ptr<PacketJournalWriter> recorder;
+
+		std::unordered_map<std::type_index, std::vector<SerializerEntry>> serializers; // the newest live one is used
+
+		std::shared_ptr<TableGeneration> generation = std::make_shared<TableGeneration>();
+	};
+
 public:
 		explicit DataPacketRegistry(ILogger& log);
 
 		bool registerDataPacketHandler(std::type_index packetType, std::shared_ptr<IDataPacketHandler> handler, const std::string& pluginName);
 		bool registerWildcardHandler(std::shared_ptr<IDataPacketHandler> handler, const std::string& pluginName);
-		void unregisterDataPacketHandlerForPlugin(std::string_view pluginName);
+
+		/// <summary>
+		/// Registers a handler by typeid name rather than type_index - for out-of-process plugins, whose types only cross
+		/// the process boundary as names. Dispatch only compares names while such a handler exists.
+		/// </summary>
+		bool registerDataPacketHandlerByTypeName(std::string typeName, std::shared_ptr<IDataPacketHandler> handler, const std::string& pluginName);
+		DispatchFence unregisterDataPacketHandlerForPlugin(std::string_view pluginName);
 		void dispatch(const DataPacket& packet);
 
+		/// <summary>
+		/// Registers a handler for a plugin that is being reloaded. It only receives packets once commitHandoff() is called.
+		/// </summary>
+		bool stageDataPacketHandler(std::type_index packetType, std::shared_ptr<IDataPacketHandler> handler, const std::string& pluginName);
+		void discardStagedHandlers(const std::string& pluginName);
+
+		/// <summary>
+		/// Hands a plugin's packets from its live handlers to its staged ones without dropping any:
+		/// beginHandoff() parks the live handlers and buffers the plugin's packet types, commitHandoff() replays the buffer into
+		/// the staged handlers and makes them live, abortHandoff() replays it into the parked handlers and restores them.
+		/// </summary>
+		DispatchFence beginHandoff(const std::string& pluginName);
+		DispatchFence commitHandoff(const std::string& pluginName);
+		DispatchFence abortHandoff(const std::string& pluginName);
+
+		/// <summary>
+		/// Times the plugin's handlers against the watchdog's deadlines - those registered already and any registered later
+		/// </summary>
+		void setPluginActivity(const std::string& pluginName, std::shared_ptr<PluginActivity> activity);
+
+		/// <summary>
+		/// Replaces each of the plugin's live handlers with whatever wrap returns for it, eg. to move them to another thread.
+		/// Handlers the plugin registers afterwards aren't wrapped.
+		/// </summary>
+		/// <returns>A fence for the handlers that were replaced</returns>
+		DispatchFence wrapHandlersForPlugin(const std::string& pluginName,
+		                                    const std::function<std::shared_ptr<IDataPacketHandler>(std::shared_ptr<IDataPacketHandler>)>& wrap);
+
 		[[nodiscard]] std::vector<std::type_index> getDataPacketTypes() const;
 
+		/// <summary>
+		/// Finds a packet type some in-process handler is registered for by its typeid name
+		/// </summary>
+		[[nodiscard]] std::optional<std::type_index> findDataPacketType(std::string_view typeName) const;
+
+		/// <summary>
+		/// Reports dispatches of the given packet types (or every type) to the callback - used to activate dormant plugins.
+		/// Costs dispatch a single branch while nothing is watched.
+		/// </summary>
+		void setPacketWatches(std::vector<std::type_index> types, bool watchAllTypes, PacketWatchCallback callback);
+		void clearPacketWatches();
+
+		/// <summary>
+		/// Holds back every packet dispatched from now on instead of handing it to the handlers, eg. while the engine is
+		/// paused. A replay still catching up stops where it is, and what it had left stays ahead of the new packets.
+		/// </summary>
+		void holdPackets(const PacketRetentionLimits& limits);
+
+		/// <summary>
+		/// Replays the held packets on a thread of its own, as far apart as they arrived divided by speed - 10 is ten times
+		/// as fast, 0 as fast as the handlers take them. Packets dispatched meanwhile are held behind them until the replay
+		/// catches up, then dispatch goes straight to the handlers again. At 1x or slower it never would, as new packets
+		/// arrive at least as fast as it replays them, so such a speed is raised to minReplaySpeed.
+		/// </summary>
+		void releasePackets(double speed);
+
+		static constexpr double minReplaySpeed = 2.0; // the slowest paced replay, it halves the backlog's span
+
+		[[nodiscard]] bool isHoldingPackets() const; // held, or still being replayed
+		[[nodiscard]] std::optional<PacketSpillBuffer::Stats> getHeldPacketStats() const;
+
+		/// <summary>
+		/// Appends every packet handed to the handlers to the journal, or stops when null - packets held while paused are
+		/// recorded as they're replayed. Costs dispatch a single branch while nothing records.
+		/// </summary>
+		void setPacketRecorder(std::shared_ptr<PacketJournalWriter> recorder);
+		[[nodiscard]] std::shared_ptr<PacketJournalWriter> getPacketRecorder() const;
+
+		/// <summary>
+		/// Registers how a packet type is serialized (see PacketSchema.h), eg. so the recorder can write payloads that
+		/// aren't trivially copyable. It goes with the plugin's handlers - a staged one is used once commitHandoff() is
+		/// called, and unregistering the plugin's handlers drops it.
+		/// </summary>
+		bool registerPacketSerializer(std::type_index packetType, const PacketSerializer& serializer, const std::string& pluginName);
+		bool stagePacketSerializer(std::type_index packetType, const PacketSerializer& serializer, const std::string& pluginName);
+
+		/// <summary>
+		/// Null if nothing registered one. Holding it holds back unloading the plugin it came from, as a dispatch does -
+		/// look it up again rather than keep it.
+		/// </summary>
+		[[nodiscard]] std::shared_ptr<const PacketSerializer> findPacketSerializer(std::type_index packetType) const;
+
+		/// <summary>
+		/// The packet type a live serializer of this schema name (PacketSerializer::name) is registered for
+		/// </summary>
+		[[nodiscard]] std::optional<std::type_index> findPacketTypeBySchema(std::string_view schemaName) const;
+
+		/// <summary>
+		/// The packet's fields as text, eg. for an inspector - none if its type has no serializer
+		/// </summary>
+		[[nodiscard]] std::optional<std::string> describePacket(const DataPacket& packet) const;
+
 		template<typename T>
 		void registerTypedHandler(std::shared_ptr<ITypedDataPacketHandler<T>> typedHandler)
 		{
@@ -36,10 +221,35 @@ public:
 		}
 
 private:
-		std::unordered_map<std::type_index, std::vector<pluginNameAndHandlerPointer>> m_handlers;
-		std::vector<pluginNameAndHandlerPointer> m_wildcardHandlers;
+		/// <summary>
+		/// Copies the current table, applies the edit and publishes the result. The fence covers the replaced table.
+		/// </summary>
+		template<typename Fn>
+		DispatchFence modifyHandlers(Fn&& edit);
+
+		DispatchFence finishHandoff(const std::string& pluginName, bool useStagedHandlers);
+
+		void deliver(const DataPacket& packet);
+		bool holdPacket(const DataPacket& packet); // false if it wasn't held - dispatch it
+		void replayHeldPackets(const std::stop_token& stopToken, const std::shared_ptr<PacketSpillBuffer>& held, double speed);
+
+		static void notifyPacketWatch(const HandlerTable& table, std::type_index packetType);
+		static const PacketSerializer* findSerializer(const HandlerTable& table, std::type_index packetType);
+		static void eraseSerializers(HandlerTable& table, const std::string& pluginName, bool isStaged);
+		static std::shared_ptr<PluginActivity> findActivity(const HandlerTable& table, const std::string& pluginName);
+
+		std::atomic<std::shared_ptr<const HandlerTable>> m_table;
+		std::mutex                                       m_writeMutex; // serialises writers, readers never take it
+
+		const bool m_isNuma; // dispatches are checked against the NUMA node of the plugins they reach
 
 		ILogger& m_logger;
+
+		// Pause - dispatch only checks the flag while nothing is held
+		std::atomic_bool                                m_isHoldingPackets{false};
+		std::atomic<std::shared_ptr<PacketSpillBuffer>> m_heldPackets;
+		std::mutex                                      m_holdMutex; // serialises holdPackets and releasePackets
+		std::jthread                                    m_replayThread; // last, so it's stopped before anything it uses goes
 };
 
 
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include "DataPacket/DataPacket.h"
+
+class DataPacketRegistry;
+class ILogger;
+struct PacketSerializer;
+
+/// <summary>
+/// The journal file's layout. Records follow the header, each 8 byte aligned: a RecordHeader, then size bytes.
+/// </summary>
+namespace PacketJournalFormat
+{
+	inline constexpr char          magic[8] = {'V', 'E', 'C', 'J', 'R', 'N', 'L', '\0'};
+	inline constexpr std::uint32_t version = 2;
+
+	struct FileHeader
+	{
+		char          magic[8];
+		std::uint32_t version;
+		std::uint32_t headerSize;
+		std::uint64_t dataEnd;         // the records end here - everything before it was written completely
+		std::uint64_t packetCount;
+		std::uint64_t lastIndexOffset; // of the newest index block, 0 if there is none
+		std::uint64_t typeTableOffset; // every TypeName record again, written on close - 0 if it wasn't closed cleanly
+		std::int64_t  firstTimestampNs;
+		std::int64_t  lastTimestampNs;
+	};
+
+	enum class RecordKind : std::uint32_t
+	{
+		Packet,
+		TypeName,     // payload is a TypeNameRecord then the typeid name behind typeHash, written before the first packet of that type
+		Index,        // payload is an IndexBlock
+		EncodedPacket // payload is the PacketSerializer encoding of a packet that isn't trivially copyable
+	};
+
+	struct RecordHeader
+	{
+		RecordKind    kind;
+		std::uint32_t size;        // payload bytes, not counting the padding after them
+		std::uint64_t typeHash;    // hashPacketTypeName, mixed with the schema hash if there is one - a new schema gets a TypeName record of its own
+		std::int64_t  timestampNs; // system_clock, since epoch
+	};
+
+	struct TypeNameRecord
+	{
+		std::uint64_t schemaHash; // PacketSerializer::schemaHash the packets were written with, 0 if the type had no serializer
+	};
+
+	/// <summary>
+	/// Written every PacketJournalOptions::indexInterval packets - the blocks chain back from FileHeader::lastIndexOffset,
+	/// so a reader can find roughly where a time is without reading the packets before it
+	/// </summary>
+	struct IndexBlock
+	{
+		std::uint64_t previousIndexOffset; // 0 for the first
+		std::uint64_t firstPacketOffset;   // of the packets this block covers
+		std::uint64_t packetCount;
+		std::int64_t  firstTimestampNs;
+		std::int64_t  lastTimestampNs;
+	};
+}
+
+struct PacketJournalOptions
+{
+	std::uint32_t indexInterval = 4096;                // packets between index blocks
+	std::size_t   growBytes = 64ull * 1024 * 1024;     // the file is extended this much at a time
+	std::size_t   maxBytes = 256ull * 1024 * 1024 * 1024; // address space mapped up front, so growing never remaps - recording stops past it
+};
+
+/// <summary>
+/// Appends packets to a memory-mapped journal file - see DataPacketRegistry::setPacketRecorder. Thread-safe.
+/// </summary>
+/// <remarks>
+/// Trivially copyable payloads (DataPacket::payloadSize) are copied as raw bytes, others are encoded by their type's
+/// PacketSerializer - packets with neither are counted and skipped. An append claims its place with an atomic add and
+/// copies itself in without a lock, so producers don't queue behind each other's copies. Commits are serialized though:
+/// each record is committed to the header in the order it was placed, so an append returns only once every record
+/// placed before it is committed - one preempted between placing and committing holds up the appends behind it (they
+/// spin and yield briefly, then sleep until it commits). The header is updated after every record, so a journal is
+/// readable up to its last whole record even if the process dies while recording. POSIX only, create() fails elsewhere.
+/// </remarks>
+class PacketJournalWriter
+{
+public:
+	struct Stats
+	{
+		std::uint64_t recordedPackets = 0;
+		std::uint64_t skippedPackets = 0; // no serializer for them, or the file couldn't grow - recording stops then
+		std::uint64_t bytes = 0;
+	};
+
+	static std::expected<std::shared_ptr<PacketJournalWriter>, std::string> create(const std::filesystem::path& path, PacketJournalOptions options = {});
+
+	~PacketJournalWriter();
+
+	PacketJournalWriter(const PacketJournalWriter&) = delete;
+	PacketJournalWriter& operator=(const PacketJournalWriter&) = delete;
+
+	/// <param name="serializer">The type's, if it has one - encodes the payload if it isn't trivially copyable, and its schema hash is recorded either way</param>
+	/// <returns>False if the packet was skipped</returns>
+	bool append(const DataPacket& packet, const PacketSerializer* serializer = nullptr);
+
+	/// <summary>
+	/// Writes the last index block and trims the file to the records. Nothing is appended after this.
+	/// </summary>
+	void close();
+
+	[[nodiscard]] Stats                        getStats() const;
+	[[nodiscard]] const std::filesystem::path& getPath() const;
+
+private:
+	PacketJournalWriter(int fd, std::filesystem::path path, PacketJournalOptions options);
+
+	struct Placement
+	{
+		std::uint64_t offset;
+		std::uint64_t bytes;
+	};
+
+	struct WrittenType
+	{
+		std::type_index type;
+		std::uint64_t   typeHash;
+		std::uint64_t   schemaHash;
+	};
+
+	bool appendPacket(const DataPacket& packet, const PacketSerializer* serializer);
+	std::optional<std::uint64_t> findTypeHash(std::type_index type, std::uint64_t schemaHash, std::int64_t timestampNs); // writes its name the first time
+	bool writeTypeName(const WrittenType& type, std::int64_t timestampNs);
+	bool grow(std::uint64_t end);
+
+	/// <summary>
+	/// Reserves room for a record, copies it in and waits for every record placed before it to be committed. Until
+	/// commit() the caller has the journal to itself - the header and the index counters are only touched in that turn.
+	/// </summary>
+	std::optional<Placement> place(PacketJournalFormat::RecordKind kind, std::uint64_t typeHash, std::int64_t timestampNs, std::span<const std::byte> payload);
+	void commit(const Placement& placement);
+
+	PacketJournalFormat::IndexBlock takeIndexBlock(); // in a turn
+	void writeIndexBlock(const PacketJournalFormat::IndexBlock& block);
+	void writeTypeTable(); // once appends have stopped
+	PacketJournalFormat::FileHeader& header();
+
+	const std::filesystem::path m_path;
+	const PacketJournalOptions  m_options;
+
+	int        m_fd = -1;
+	std::byte* m_mapping = nullptr; // maxBytes of it, the file only as far as m_fileBytes
+
+	std::atomic<std::uint64_t> m_reservedEnd{0};  // where the next record is placed
+	std::atomic<std::uint64_t> m_committedEnd{0}; // the records up to here are complete, the one placed here goes next
+	std::atomic<std::uint64_t> m_fileBytes{0};
+	std::mutex                 m_growMutex;
+	std::atomic_bool           m_isFailed{false}; // the file couldn't grow, nothing after the hole can be committed
+	std::atomic<std::uint32_t> m_commits{0};      // bumped on every commit, and on failing - what appends waiting their turn park on
+
+	std::atomic_bool           m_isClosed{false};
+	std::atomic<std::uint32_t> m_activeAppends{0};
+
+	mutable std::shared_mutex                       m_typesMutex;
+	std::unordered_map<std::type_index, WrittenType> m_typeHashes;   // the schema each type's packets are written with now
+	std::vector<WrittenType>                         m_writtenTypes; // every name written, for the table close writes
+
+	// The packets since the last index block - only touched in a turn
+	std::uint64_t m_indexFirstOffset = 0;
+	std::uint64_t m_indexPacketCount = 0;
+	std::int64_t  m_indexFirstTimestampNs = 0;
+	std::int64_t  m_indexLastTimestampNs = 0;
+
+	std::atomic<std::uint64_t> m_recordedPackets{0};
+	std::atomic<std::uint64_t> m_skippedPackets{0};
+};
+
+/// <summary>
+/// One packet read back from a journal - the payload points into the mapping, valid while the reader is
+/// </summary>
+struct JournalRecord
+{
+	std::uint64_t                         typeHash;
+	std::string_view                      typeName;
+	std::uint64_t                         schemaHash; // of the type when it was recorded, 0 if it had no serializer
+	std::chrono::system_clock::time_point timestamp;
+	std::span<const std::byte>            payload;
+	bool                                  isEncoded; // by the type's PacketSerializer, rather than its raw bytes
+};
+
+/// <summary>
+/// Reads a journal PacketJournalWriter wrote, packet by packet. Everything read is bounds checked, a journal may have been
+/// cut short or damaged. POSIX only, open() fails elsewhere.
+/// </summary>
+class PacketJournalReader
+{
+public:
+	static std::expected<PacketJournalReader, std::string> open(const std::filesystem::path& path);
+
+	PacketJournalReader(PacketJournalReader&& other) noexcept;
+	PacketJournalReader& operator=(PacketJournalReader&& other) noexcept;
+	~PacketJournalReader();
+
+	PacketJournalReader(const PacketJournalReader&) = delete;
+	PacketJournalReader& operator=(const PacketJournalReader&) = delete;
+
+	/// <summary>
+	/// The next packet, none at the end of the journal
+	/// </summary>
+	std::optional<JournalRecord> next();
+
+	/// <summary>
+	/// Moves to the first packet recorded at or after the time, using the index blocks to skip most of what's before it
+	/// </summary>
+	void seek(std::chrono::system_clock::time_point time);
+	void rewind();
+
+	[[nodiscard]] std::uint64_t                         getPacketCount() const;
+	[[nodiscard]] std::chrono::system_clock::time_point getFirstTimestamp() const;
+	[[nodiscard]] std::chrono::system_clock::time_point getLastTimestamp() const;
+
+private:
+	PacketJournalReader(const std::byte* mapping, std::size_t mappedBytes);
+
+	[[nodiscard]] const PacketJournalFormat::RecordHeader* recordAt(std::uint64_t offset) const; // null past the end or if damaged
+	[[nodiscard]] std::uint64_t                            nextRecordOffset(std::uint64_t offset) const;
+	[[nodiscard]] const PacketJournalFormat::FileHeader&   header() const;
+	void readTypeName(std::uint64_t offset, const PacketJournalFormat::RecordHeader& record);
+	void readTypeNames(std::uint64_t offset); // from there to the end
+
+	struct JournalType
+	{
+		std::string_view name;
+		std::uint64_t    schemaHash;
+	};
+
+	const std::byte* m_mapping = nullptr;
+	std::size_t      m_mappedBytes = 0;
+	std::uint64_t    m_dataEnd = 0;
+	std::uint64_t    m_readOffset = 0;
+
+	std::unordered_map<std::uint64_t, JournalType> m_types;
+};
+
+/// <summary>
+/// Feeds a journal back through DataPacketRegistry::dispatch on a thread of its own, eg. to reproduce an incident or
+/// backtest a plugin faster than real time. Packets keep their recorded timestamps.
+/// </summary>
+/// <remarks>
+/// A packet type is found by its typeid name among the types some in-process handler is registered for, and an encoded
+/// payload is decoded by the type's registered PacketSerializer - packets nobody handles or can decode are skipped. So are
+/// packets recorded with a different schema than the type's serializer has now (its fields changed since), with a warning
+/// per type, rather than decoded into the wrong fields. Only this build's journals can be replayed, typeid names aren't
+/// the same across compilers.
+/// </remarks>
+class PacketJournalReplayer
+{
+public:
+	PacketJournalReplayer(DataPacketRegistry& registry, ILogger& logger);
+	~PacketJournalReplayer();
+
+	PacketJournalReplayer(const PacketJournalReplayer&) = delete;
+	PacketJournalReplayer& operator=(const PacketJournalReplayer&) = delete;
+
+	/// <summary>
+	/// Stops any replay in progress and starts this one. The packets are as far apart as they were recorded divided by
+	/// speed - 1 is real time, 10 ten times as fast, 0 as fast as the handlers take them.
+	/// </summary>
+	/// <param name="from">Start at the first packet recorded at or after this, rather than the beginning</param>
+	std::expected<void, std::string> start(const std::filesystem::path& path, double speed,
+	                                       std::optional<std::chrono::system_clock::time_point> from = std::nullopt);
+	void stop();
+
+	[[nodiscard]] bool          isReplaying() const;
+	[[nodiscard]] std::uint64_t getReplayedPacketCount() const;
+
+private:
+	void replay(const std::stop_token& stopToken, PacketJournalReader reader, double speed, std::filesystem::path path);
+
+	DataPacketRegistry& m_registry;
+	ILogger&            m_logger;
+
+	std::atomic_bool           m_isReplaying{false};
+	std::atomic<std::uint64_t> m_replayedPackets{0};
+	std::jthread               m_thread; // last, so it's stopped before anything it uses goes
+};
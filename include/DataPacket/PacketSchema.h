@@ -0,0 +1,575 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "DataPacket/DataPacket.h"
+#include "DataPacket/PacketTypeHash.h"
+
+// Serialization traits for packet payloads - opt in per type, eg. at global scope after the struct:
+//
+//     VECTORIUM_PACKET_SCHEMA(GPSDataPacket, lat, lng, alt)
+//
+// Fields are encoded in the order given, fixed width and little-endian, with strings as a varint length then their bytes.
+// A type whose fields are all fixed width, listed in declaration order and fill it without padding is encoded as a
+// plain copy of its bytes on little-endian machines, and can be read in place (viewPacket). Types without a schema
+// compile to nothing here.
+
+enum class PacketFieldKind : std::uint8_t
+{
+	Bool,
+	Int8,
+	Int16,
+	Int32,
+	Int64,
+	UInt8,
+	UInt16,
+	UInt32,
+	UInt64,
+	Float32,
+	Float64,
+	Timestamp, // system_clock, as nanoseconds since epoch
+	String
+};
+
+struct PacketFieldInfo
+{
+	std::string_view name;
+	PacketFieldKind  kind;
+};
+
+/// <summary>
+/// Reads an encoded payload front to back - every read is bounds checked
+/// </summary>
+class PacketReader
+{
+public:
+	explicit PacketReader(std::span<const std::byte> bytes)
+		: m_bytes(bytes)
+	{
+	}
+
+	bool read(void* destination, std::size_t size)
+	{
+		if (m_bytes.size() - m_offset < size)
+		{
+			return false;
+		}
+
+		std::memcpy(destination, m_bytes.data() + m_offset, size);
+		m_offset += size;
+		return true;
+	}
+
+	bool readVarint(std::uint64_t& value)
+	{
+		value = 0;
+		for (int shift = 0; shift < 64 && m_offset < m_bytes.size(); shift += 7)
+		{
+			const auto byte = std::to_integer<std::uint8_t>(m_bytes[m_offset++]);
+			value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	[[nodiscard]] bool isAtEnd() const
+	{
+		return m_offset == m_bytes.size();
+	}
+
+private:
+	std::span<const std::byte> m_bytes;
+	std::size_t                m_offset = 0;
+};
+
+namespace PacketEncoding
+{
+	template<typename T>
+	void writeLittleEndian(std::vector<std::byte>& out, T value)
+	{
+		static_assert(std::is_trivially_copyable_v<T> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8));
+
+		if constexpr (std::endian::native != std::endian::little && sizeof(T) > 1)
+		{
+			using Bits = std::conditional_t<sizeof(T) == 2, std::uint16_t, std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>;
+			value = std::bit_cast<T>(std::byteswap(std::bit_cast<Bits>(value)));
+		}
+
+		const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+		out.insert(out.end(), bytes, bytes + sizeof(T));
+	}
+
+	template<typename T>
+	bool readLittleEndian(PacketReader& in, T& value)
+	{
+		if (!in.read(&value, sizeof(T)))
+		{
+			return false;
+		}
+
+		if constexpr (std::endian::native != std::endian::little && sizeof(T) > 1)
+		{
+			using Bits = std::conditional_t<sizeof(T) == 2, std::uint16_t, std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>;
+			value = std::bit_cast<T>(std::byteswap(std::bit_cast<Bits>(value)));
+		}
+
+		return true;
+	}
+
+	inline void writeVarint(std::vector<std::byte>& out, std::uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			out.push_back(static_cast<std::byte>((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+
+		out.push_back(static_cast<std::byte>(value));
+	}
+
+	template<typename T>
+	consteval PacketFieldKind arithmeticKind()
+	{
+		if constexpr (std::is_same_v<T, bool>) return PacketFieldKind::Bool;
+		else if constexpr (std::is_floating_point_v<T>) return sizeof(T) == 4 ? PacketFieldKind::Float32 : PacketFieldKind::Float64;
+		else if constexpr (std::is_signed_v<T>)
+		{
+			return sizeof(T) == 1 ? PacketFieldKind::Int8 : sizeof(T) == 2 ? PacketFieldKind::Int16 : sizeof(T) == 4 ? PacketFieldKind::Int32 : PacketFieldKind::Int64;
+		}
+		else
+		{
+			return sizeof(T) == 1 ? PacketFieldKind::UInt8 : sizeof(T) == 2 ? PacketFieldKind::UInt16 : sizeof(T) == 4 ? PacketFieldKind::UInt32 : PacketFieldKind::UInt64;
+		}
+	}
+}
+
+/// <summary>
+/// How one field type is encoded - specialise it to support another. encodedSize is 0 for variable width, and isRaw
+/// means the encoding is the value's own bytes on a little-endian machine.
+/// </summary>
+template<typename F>
+struct PacketFieldTraits;
+
+template<typename F> requires std::is_arithmetic_v<F> && (sizeof(F) <= 8) && (!std::is_same_v<F, long double>)
+struct PacketFieldTraits<F>
+{
+	static constexpr PacketFieldKind kind = PacketEncoding::arithmeticKind<F>();
+	static constexpr std::size_t     encodedSize = sizeof(F);
+	static constexpr bool            isRaw = true;
+
+	static void encode(const F& value, std::vector<std::byte>& out) { PacketEncoding::writeLittleEndian(out, value); }
+	static bool decode(PacketReader& in, F& value) { return PacketEncoding::readLittleEndian(in, value); }
+	static void format(const F& value, std::string& out) { std::format_to(std::back_inserter(out), "{}", value); }
+};
+
+template<typename F> requires std::is_enum_v<F>
+struct PacketFieldTraits<F>
+{
+	using Underlying = std::underlying_type_t<F>;
+
+	static constexpr PacketFieldKind kind = PacketFieldTraits<Underlying>::kind;
+	static constexpr std::size_t     encodedSize = sizeof(Underlying);
+	static constexpr bool            isRaw = true;
+
+	static void encode(const F& value, std::vector<std::byte>& out) { PacketEncoding::writeLittleEndian(out, static_cast<Underlying>(value)); }
+
+	static bool decode(PacketReader& in, F& value)
+	{
+		Underlying underlying{};
+		if (!PacketEncoding::readLittleEndian(in, underlying))
+		{
+			return false;
+		}
+
+		value = static_cast<F>(underlying);
+		return true;
+	}
+
+	static void format(const F& value, std::string& out) { std::format_to(std::back_inserter(out), "{}", static_cast<Underlying>(value)); }
+};
+
+template<>
+struct PacketFieldTraits<std::chrono::system_clock::time_point>
+{
+	using TimePoint = std::chrono::system_clock::time_point;
+
+	static constexpr PacketFieldKind kind = PacketFieldKind::Timestamp;
+	static constexpr std::size_t     encodedSize = sizeof(std::int64_t);
+	static constexpr bool            isRaw = std::is_same_v<TimePoint::duration, std::chrono::nanoseconds>;
+
+	static void encode(const TimePoint& value, std::vector<std::byte>& out)
+	{
+		PacketEncoding::writeLittleEndian(out, static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(value.time_since_epoch()).count()));
+	}
+
+	static bool decode(PacketReader& in, TimePoint& value)
+	{
+		std::int64_t nanoseconds = 0;
+		if (!PacketEncoding::readLittleEndian(in, nanoseconds))
+		{
+			return false;
+		}
+
+		value = TimePoint(std::chrono::duration_cast<TimePoint::duration>(std::chrono::nanoseconds(nanoseconds)));
+		return true;
+	}
+
+	static void format(const TimePoint& value, std::string& out) { std::format_to(std::back_inserter(out), "{}", value); }
+};
+
+template<>
+struct PacketFieldTraits<std::string>
+{
+	static constexpr PacketFieldKind kind = PacketFieldKind::String;
+	static constexpr std::size_t     encodedSize = 0;
+	static constexpr bool            isRaw = false;
+
+	static void encode(const std::string& value, std::vector<std::byte>& out)
+	{
+		PacketEncoding::writeVarint(out, value.size());
+		const auto* bytes = reinterpret_cast<const std::byte*>(value.data());
+		out.insert(out.end(), bytes, bytes + value.size());
+	}
+
+	static bool decode(PacketReader& in, std::string& value)
+	{
+		std::uint64_t size = 0;
+		if (!in.readVarint(size) || size > UINT32_MAX)
+		{
+			return false;
+		}
+
+		value.resize(static_cast<std::size_t>(size));
+		return in.read(value.data(), value.size());
+	}
+
+	static void format(const std::string& value, std::string& out) { std::format_to(std::back_inserter(out), "\"{}\"", value); }
+};
+
+/// <summary>
+/// One field of a schema - VECTORIUM_PACKET_SCHEMA makes these
+/// </summary>
+template<typename T, typename F>
+struct PacketFieldDescriptor
+{
+	using Type = F;
+
+	std::string_view name;
+	F T::*           member;
+};
+
+/// <summary>
+/// A payload type's fields - specialise it with VECTORIUM_PACKET_SCHEMA
+/// </summary>
+template<typename T>
+struct PacketSchema;
+
+template<typename T>
+concept HasPacketSchema = requires
+{
+	{ PacketSchema<T>::name } -> std::convertible_to<std::string_view>;
+	PacketSchema<T>::fields;
+};
+
+namespace PacketEncoding
+{
+	template<HasPacketSchema T, typename Fn>
+	constexpr void forEachField(Fn&& fn)
+	{
+		std::apply([&](const auto&... field) { (fn(field), ...); }, PacketSchema<T>::fields);
+	}
+
+	template<HasPacketSchema T>
+	consteval std::size_t fixedEncodedSize()
+	{
+		std::size_t size = 0;
+		bool        isFixed = true;
+		forEachField<T>([&]<typename Field>(const Field&)
+		{
+			size += PacketFieldTraits<typename Field::Type>::encodedSize;
+			isFixed = isFixed && PacketFieldTraits<typename Field::Type>::encodedSize != 0;
+		});
+
+		return isFixed ? size : 0;
+	}
+
+	template<HasPacketSchema T>
+	consteval bool areAllFieldsRaw()
+	{
+		bool isRaw = true;
+		forEachField<T>([&]<typename Field>(const Field&) { isRaw = isRaw && PacketFieldTraits<typename Field::Type>::isRaw; });
+		return isRaw;
+	}
+
+	/// <summary>
+	/// Whether the type's bytes are its encoding - the fields leave no gaps, and come in the order they're declared
+	/// </summary>
+	template<HasPacketSchema T>
+	bool isLaidOutAsEncoded()
+	{
+		if constexpr (std::endian::native != std::endian::little || !std::is_trivially_copyable_v<T> || !std::is_default_constructible_v<T>
+			|| !areAllFieldsRaw<T>() || fixedEncodedSize<T>() != sizeof(T))
+		{
+			return false;
+		}
+		else
+		{
+			const T     value{};
+			const auto* base = reinterpret_cast<const std::byte*>(std::addressof(value));
+			std::size_t expectedOffset = 0;
+			bool        isInOrder = true;
+
+			forEachField<T>([&]<typename Field>(const Field& field)
+			{
+				const auto offset = static_cast<std::size_t>(reinterpret_cast<const std::byte*>(std::addressof(value.*field.member)) - base);
+				isInOrder = isInOrder && offset == expectedOffset;
+				expectedOffset += sizeof(typename Field::Type);
+			});
+
+			return isInOrder;
+		}
+	}
+
+	template<HasPacketSchema T>
+	bool isZeroCopy()
+	{
+		static const bool isZeroCopy = isLaidOutAsEncoded<T>();
+		return isZeroCopy;
+	}
+
+	template<HasPacketSchema T>
+	consteval std::size_t fieldCount()
+	{
+		return std::tuple_size_v<std::remove_cvref_t<decltype(PacketSchema<T>::fields)>>;
+	}
+
+	template<HasPacketSchema T>
+	consteval auto fieldInfos()
+	{
+		std::array<PacketFieldInfo, fieldCount<T>()> infos{};
+		std::size_t i = 0;
+		forEachField<T>([&]<typename Field>(const Field& field)
+		{
+			infos[i++] = PacketFieldInfo{ .name = field.name, .kind = PacketFieldTraits<typename Field::Type>::kind };
+		});
+
+		return infos;
+	}
+
+	template<HasPacketSchema T>
+	inline constexpr auto fieldInfosOf = fieldInfos<T>();
+
+	/// <summary>
+	/// Of the schema's name and every field's name and kind - differs between builds whose encodings differ
+	/// </summary>
+	template<HasPacketSchema T>
+	consteval std::uint64_t schemaHash()
+	{
+		std::string description(PacketSchema<T>::name);
+		for (const auto& field : fieldInfosOf<T>)
+		{
+			description += ';';
+			description += field.name;
+			description += static_cast<char>('a' + static_cast<int>(field.kind));
+		}
+
+		return hashPacketTypeName(description);
+	}
+}
+
+/// <summary>
+/// Appends the value's encoding to out
+/// </summary>
+template<HasPacketSchema T>
+void encodePacket(const T& value, std::vector<std::byte>& out)
+{
+	if (PacketEncoding::isZeroCopy<T>())
+	{
+		const auto* bytes = reinterpret_cast<const std::byte*>(std::addressof(value));
+		out.insert(out.end(), bytes, bytes + sizeof(T));
+		return;
+	}
+
+	PacketEncoding::forEachField<T>([&]<typename Field>(const Field& field)
+	{
+		PacketFieldTraits<typename Field::Type>::encode(value.*field.member, out);
+	});
+}
+
+template<HasPacketSchema T> requires std::is_default_constructible_v<T>
+std::expected<T, std::string> decodePacket(std::span<const std::byte> bytes)
+{
+	T value{};
+
+	if constexpr (std::is_trivially_copyable_v<T>)
+	{
+		if (PacketEncoding::isZeroCopy<T>())
+		{
+			if (bytes.size() != sizeof(T))
+			{
+				return std::unexpected(std::format("{} is {} bytes, not {}", PacketSchema<T>::name, sizeof(T), bytes.size()));
+			}
+
+			std::memcpy(std::addressof(value), bytes.data(), sizeof(T));
+			return value;
+		}
+	}
+
+	PacketReader reader(bytes);
+	std::string_view failedField;
+	PacketEncoding::forEachField<T>([&]<typename Field>(const Field& field)
+	{
+		if (failedField.empty() && !PacketFieldTraits<typename Field::Type>::decode(reader, value.*field.member))
+		{
+			failedField = field.name;
+		}
+	});
+
+	if (!failedField.empty())
+	{
+		return std::unexpected(std::format("{} is cut short at {}", PacketSchema<T>::name, failedField));
+	}
+
+	if (!reader.isAtEnd())
+	{
+		return std::unexpected(std::format("{} has bytes left over - encoded by a different schema?", PacketSchema<T>::name));
+	}
+
+	return value;
+}
+
+/// <summary>
+/// The value in place, without copying - null unless the type is zero-copy and bytes is exactly one suitably aligned value
+/// </summary>
+template<HasPacketSchema T>
+const T* viewPacket(std::span<const std::byte> bytes)
+{
+	if (!PacketEncoding::isZeroCopy<T>() || bytes.size() != sizeof(T) || reinterpret_cast<std::uintptr_t>(bytes.data()) % alignof(T) != 0)
+	{
+		return nullptr;
+	}
+
+	return std::launder(reinterpret_cast<const T*>(bytes.data()));
+}
+
+/// <summary>
+/// "name=value" for each field, eg. for an inspector
+/// </summary>
+template<HasPacketSchema T>
+std::string formatPacket(const T& value)
+{
+	std::string out(PacketSchema<T>::name);
+	out += " {";
+
+	const char* separator = " ";
+	PacketEncoding::forEachField<T>([&]<typename Field>(const Field& field)
+	{
+		std::format_to(std::back_inserter(out), "{}{}=", std::exchange(separator, ", "), field.name);
+		PacketFieldTraits<typename Field::Type>::format(value.*field.member, out);
+	});
+
+	out += " }";
+	return out;
+}
+
+/// <summary>
+/// A schema without its C++ type, for code that only has a DataPacket - see DataPacketRegistry::findPacketSerializer
+/// </summary>
+struct PacketSerializer
+{
+	std::string_view                 name;
+	std::uint64_t                    schemaHash;
+	std::span<const PacketFieldInfo> fields;
+	std::size_t                      fixedSize; // encoded bytes of every value, 0 if it's variable
+	bool                             isZeroCopy;
+
+	void (*encode)(const DataPacket& packet, std::vector<std::byte>& out);
+	std::expected<DataPacket, std::string> (*decode)(std::span<const std::byte> bytes); // timestamped now
+	std::string (*format)(const DataPacket& packet);
+};
+
+template<HasPacketSchema T>
+const PacketSerializer& packetSerializerFor()
+{
+	static const PacketSerializer serializer{
+		.name = PacketSchema<T>::name,
+		.schemaHash = PacketEncoding::schemaHash<T>(),
+		.fields = PacketEncoding::fieldInfosOf<T>,
+		.fixedSize = PacketEncoding::fixedEncodedSize<T>(),
+		.isZeroCopy = PacketEncoding::isZeroCopy<T>(),
+		.encode = [](const DataPacket& packet, std::vector<std::byte>& out)
+		{
+			encodePacket(*static_cast<const T*>(packet.payload.get()), out);
+		},
+		.decode = [](std::span<const std::byte> bytes) -> std::expected<DataPacket, std::string>
+		{
+			if constexpr (std::is_default_constructible_v<T>)
+			{
+				auto value = decodePacket<T>(bytes);
+				if (!value)
+				{
+					return std::unexpected(value.error());
+				}
+
+				return DataPacket::create(std::make_shared<T>(std::move(*value)));
+			}
+			else
+			{
+				return std::unexpected(std::format("{} can't be decoded, it isn't default constructible", PacketSchema<T>::name));
+			}
+		},
+		.format = [](const DataPacket& packet)
+		{
+			return formatPacket(*static_cast<const T*>(packet.payload.get()));
+		}
+	};
+
+	return serializer;
+}
+
+// Field list expansion - up to 256 fields
+#define VECTORIUM_PACKET_EXPAND(...) VECTORIUM_PACKET_EXPAND4(VECTORIUM_PACKET_EXPAND4(VECTORIUM_PACKET_EXPAND4(VECTORIUM_PACKET_EXPAND4(__VA_ARGS__))))
+#define VECTORIUM_PACKET_EXPAND4(...) VECTORIUM_PACKET_EXPAND3(VECTORIUM_PACKET_EXPAND3(VECTORIUM_PACKET_EXPAND3(VECTORIUM_PACKET_EXPAND3(__VA_ARGS__))))
+#define VECTORIUM_PACKET_EXPAND3(...) VECTORIUM_PACKET_EXPAND2(VECTORIUM_PACKET_EXPAND2(VECTORIUM_PACKET_EXPAND2(VECTORIUM_PACKET_EXPAND2(__VA_ARGS__))))
+#define VECTORIUM_PACKET_EXPAND2(...) VECTORIUM_PACKET_EXPAND1(VECTORIUM_PACKET_EXPAND1(VECTORIUM_PACKET_EXPAND1(VECTORIUM_PACKET_EXPAND1(__VA_ARGS__))))
+#define VECTORIUM_PACKET_EXPAND1(...) __VA_ARGS__
+
+#define VECTORIUM_PACKET_PARENS ()
+#define VECTORIUM_PACKET_FIELDS(Type, ...) __VA_OPT__(VECTORIUM_PACKET_EXPAND(VECTORIUM_PACKET_FIELDS_NEXT(Type, __VA_ARGS__)))
+#define VECTORIUM_PACKET_FIELDS_NEXT(Type, field, ...) \
+	PacketFieldDescriptor<Type, decltype(Type::field)>{ #field, &Type::field } \
+	__VA_OPT__(, VECTORIUM_PACKET_FIELDS_AGAIN VECTORIUM_PACKET_PARENS (Type, __VA_ARGS__))
+#define VECTORIUM_PACKET_FIELDS_AGAIN() VECTORIUM_PACKET_FIELDS_NEXT
+
+/// <summary>
+/// Gives Type a schema of the listed data members. Use it at global scope - list the fields in declaration order to keep
+/// a padding-free POD zero-copy.
+/// </summary>
+#define VECTORIUM_PACKET_SCHEMA(Type, ...) \
+	template<> \
+	struct PacketSchema<Type> \
+	{ \
+		static constexpr std::string_view name = #Type; \
+		static constexpr auto fields = std::make_tuple(VECTORIUM_PACKET_FIELDS(Type, __VA_ARGS__)); \
+	}
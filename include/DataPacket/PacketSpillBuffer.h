@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+#include "DataPacket/DataPacket.h"
+
+/// <summary>
+/// How much a PacketSpillBuffer may hold
+/// </summary>
+struct PacketRetentionLimits
+{
+	std::size_t           memoryPackets = 65536;             // kept in memory before spilling to disk
+	std::uint64_t         maxSpillBytes = 1024ull * 1024 * 1024; // of the spill file, 0 = never spill
+	std::filesystem::path spillDirectory;                     // empty = the system temp directory
+};
+
+/// <summary>
+/// A FIFO of packets held back from dispatch. The oldest stay in memory, and once that's full the rest go to a spill file.
+/// Thread-safe.
+/// </summary>
+/// <remarks>
+/// Only trivially copyable payloads (DataPacket::payloadSize) can be written out. Any other packet that arrives while the
+/// buffer is spilling is kept in memory instead, and its place in the file is marked, so order is still kept. Past the
+/// limits packets are dropped and counted.
+/// </remarks>
+class PacketSpillBuffer
+{
+public:
+	enum class PushResult
+	{
+		Held,
+		Dropped,
+		Closed // drained and closed, the packet wasn't taken - dispatch it normally
+	};
+
+	struct Stats
+	{
+		std::uint64_t heldPackets = 0;    // since it was created
+		std::uint64_t spilledPackets = 0; // of those, written to the spill file
+		std::uint64_t droppedPackets = 0;
+		std::size_t   pendingPackets = 0; // still to be popped
+	};
+
+	explicit PacketSpillBuffer(PacketRetentionLimits limits);
+	~PacketSpillBuffer(); // deletes the spill file
+
+	PacketSpillBuffer(const PacketSpillBuffer&) = delete;
+	PacketSpillBuffer& operator=(const PacketSpillBuffer&) = delete;
+
+	PushResult push(const DataPacket& packet);
+
+	/// <summary>
+	/// Takes the oldest packet. Once there is none left the buffer closes, and every later push() is refused.
+	/// </summary>
+	std::optional<DataPacket> popOrClose();
+
+	/// <summary>
+	/// Returns a packet popOrClose() handed out to the front, eg. when a replay is stopped before it could deliver it
+	/// </summary>
+	void putBack(DataPacket packet);
+
+	/// <summary>
+	/// Lets a closed buffer take packets again, eg. when the engine pauses while it's still being drained
+	/// </summary>
+	void reopen();
+
+	[[nodiscard]] Stats getStats() const;
+
+private:
+	struct SpillRecordHeader
+	{
+		std::uint32_t typeIndex = 0;   // into m_spilledTypes
+		std::uint32_t payloadSize = 0; // 0 = the packet is next in m_asidePackets
+		std::int64_t  timestampNs = 0; // system_clock, since epoch
+	};
+
+	[[nodiscard]] bool isSpilling() const; // call with m_mutex held
+	std::expected<void, std::string> openSpillFile();
+	bool                             spill(const DataPacket& packet);
+	std::optional<DataPacket>        readSpilled();
+
+	const PacketRetentionLimits m_limits;
+
+	mutable std::mutex      m_mutex;
+	std::deque<DataPacket>  m_memoryPackets;
+	std::deque<DataPacket>  m_asidePackets; // arrived while spilling but can't be written out
+	bool                    m_isClosed = false;
+
+	std::filesystem::path        m_spillPath;
+	std::fstream                 m_spillFile;
+	std::vector<std::type_index> m_spilledTypes;
+	std::uint64_t                m_spillWriteOffset = 0;
+	std::uint64_t                m_spillReadOffset = 0;
+	std::size_t                  m_spilledPending = 0; // records between the read and write offsets
+	bool                         m_isSpillFailed = false;
+
+	Stats m_stats;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+/// <summary>
+/// FNV-1a of a typeid name. The engine and its plugin hosts are built by the same compiler, so a packet type hashes the
+/// same in every process - and in every run of the same build, so it's also what PacketJournal records types by.
+/// </summary>
+constexpr std::uint64_t hashPacketTypeName(std::string_view typeName)
+{
+	std::uint64_t hash = 14695981039346656037ull;
+	for (const char c : typeName)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+#include "DataPacket/DataPacket.h"
+#include "DataPacket/IDataPacketHandler.h"
+#include "DataPacket/PacketSchema.h"
+#include "Plugin/IPluginContext.h"
+
+/// <summary>
+/// Queues the packets of a type a plugin only knows by its schema name, for the plugin to take from its tick - eg. to
+/// store or export them. Apart from the queue, only touched from the plugin's tick and onPluginUnload.
+/// </summary>
+/// <remarks>
+/// The handler only queues packets, so a subscriber costs the dispatching thread a lock and a copy of the packet, and
+/// encoding them is left to the tick. The type can only be found once the plugin dispatching it has registered its
+/// schema, so subscribe() is called from every tick until then.
+/// </remarks>
+class SchemaSubscription
+{
+public:
+	/// <summary>
+	/// What arrived since the last take()
+	/// </summary>
+	struct Batch
+	{
+		std::span<const DataPacket>             packets;
+		std::shared_ptr<const PacketSerializer> serializer;      // null if nothing arrived or the schema is gone - the packets can't be encoded then
+		bool                                    isSchemaChanged; // the serializer's schema isn't the one the caller has
+	};
+
+	explicit SchemaSubscription(std::string schemaName)
+		: m_schemaName(std::move(schemaName))
+		, m_queue(std::make_shared<Queue>())
+	{
+	}
+
+	/// <summary>
+	/// Schema names become file and directory names
+	/// </summary>
+	static bool isUsableAsFileName(std::string_view schemaName)
+	{
+		return !schemaName.empty() && schemaName != "." && schemaName != ".." && schemaName.find_first_of("/\\:") == std::string_view::npos;
+	}
+
+	[[nodiscard]] const std::string& getSchemaName() const { return m_schemaName; }
+	[[nodiscard]] bool               isSubscribed() const { return m_type.has_value(); }
+
+	/// <summary>
+	/// Registers the handler once the type's schema has been registered - until then, and after, it does nothing
+	/// </summary>
+	std::expected<void, std::string> subscribe(IPluginContext& context)
+	{
+		if (m_type)
+		{
+			return {};
+		}
+
+		const auto type = context.findPacketTypeBySchema(m_schemaName);
+		if (!type)
+		{
+			return {};
+		}
+
+		if (!context.registerHandlerForType(*type, std::make_shared<Handler>(m_queue)))
+		{
+			return std::unexpected(std::format("Could not subscribe to '{}'", m_schemaName));
+		}
+
+		m_type = *type;
+		return {};
+	}
+
+	/// <summary>
+	/// Takes what was queued, valid until the next call
+	/// </summary>
+	/// <param name="schemaHash">Of what the caller took before, to tell it when the schema changed</param>
+	Batch take(IPluginContext& context, std::uint64_t schemaHash)
+	{
+		m_taken.clear();
+		if (!m_type)
+		{
+			return Batch{ .packets = {}, .serializer = nullptr, .isSchemaChanged = false };
+		}
+
+		{
+			std::lock_guard lock(m_queue->mutex);
+			std::swap(m_queue->packets, m_taken);
+		}
+
+		// Looked up each time rather than kept, so the plugin it comes from can still be unloaded
+		auto serializer = m_taken.empty() ? nullptr : context.findPacketSerializer(*m_type);
+		const bool isSchemaChanged = serializer && serializer->schemaHash != schemaHash;
+
+		return Batch{ .packets = m_taken, .serializer = std::move(serializer), .isSchemaChanged = isSchemaChanged };
+	}
+
+	/// <summary>
+	/// Turns packets away from now on - what is queued already can still be taken
+	/// </summary>
+	void close()
+	{
+		std::lock_guard lock(m_queue->mutex);
+		m_queue->isClosed = true;
+	}
+
+private:
+	// Shared with the handler, which the registry may hold on to for a while after the subscriber is gone
+	struct Queue
+	{
+		std::mutex              mutex;
+		std::vector<DataPacket> packets;
+		bool                    isClosed = false;
+	};
+
+	class Handler final : public IDataPacketHandler
+	{
+	public:
+		explicit Handler(std::shared_ptr<Queue> queue)
+			: m_queue(std::move(queue))
+		{
+		}
+
+		bool handle(const DataPacket& packet) override
+		{
+			std::lock_guard lock(m_queue->mutex);
+			if (m_queue->isClosed)
+			{
+				return false;
+			}
+
+			m_queue->packets.push_back(packet);
+			return true;
+		}
+
+	private:
+		std::shared_ptr<Queue> m_queue;
+	};
+
+	const std::string              m_schemaName;
+	const std::shared_ptr<Queue>   m_queue;
+	std::optional<std::type_index> m_type; // once its handler is registered
+	std::vector<DataPacket>        m_taken;
+};
@@ -1,8 +1,13 @@
 #pragma once
 #include <any>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
 #include <functional>
 #include <memory>
+#include <string>
 #include "IEngineUIBridge.h"
 #include "Services/ServiceContainer.h"
 
@@ -19,11 +24,15 @@ class ILogger;
 class UILogSink;
 class PluginManager;
 class DataPacketRegistry;
+class EngineEventBus;
+class PacketJournalReplayer;
 
 class EngineSettings final
 {
 	private:
 		bool m_debugLoggingEnabled = false;
+		bool m_traceCaptureEnabled = false;
+		bool m_allocationAuditEnabled = false;
 		bool m_paused = false;
 		int m_maxPlugins = 50;
 		std::chrono::seconds m_pluginUpdateInterval{1};
@@ -32,6 +41,14 @@ class EngineSettings final
 		void setDebugLogging(bool enabled);
 		bool isDebugLoggingEnabled() const;
 
+		// Chrome trace capture of engine timing zones
+		void setTraceCapture(bool enabled);
+		bool isTraceCaptureEnabled() const;
+
+		// Per-zone operator new counting (needs a VECTORIUM_ALLOCATION_AUDIT build to see anything)
+		void setAllocationAudit(bool enabled);
+		bool isAllocationAuditEnabled() const;
+
 		// Engine state
 		bool isPaused() const
 		{
@@ -40,7 +57,14 @@ class EngineSettings final
 
 		void setPaused(bool paused)
 		{
-			m_paused = paused;
+			if (m_paused != paused)
+			{
+				m_paused = paused;
+				if (onSettingChanged)
+				{
+					onSettingChanged("paused", paused);
+				}
+			}
 		}
 
 		// Plugin settings
@@ -50,7 +74,14 @@ class EngineSettings final
 
 		void setMaxPlugins(int max)
 		{
-			m_maxPlugins = max;
+			if (m_maxPlugins != max)
+			{
+				m_maxPlugins = max;
+				if (onSettingChanged)
+				{
+					onSettingChanged("maxPlugins", max);
+				}
+			}
 		}
 
 		std::chrono::seconds getPluginUpdateInterval() const
@@ -60,7 +91,14 @@ class EngineSettings final
 
 		void setPluginUpdateInterval(std::chrono::seconds interval)
 		{
-			m_pluginUpdateInterval = interval;
+			if (m_pluginUpdateInterval != interval)
+			{
+				m_pluginUpdateInterval = interval;
+				if (onSettingChanged)
+				{
+					onSettingChanged("pluginUpdateInterval", interval);
+				}
+			}
 		}
 
 		std::function<void(const std::string& settingName, const std::any& newValue)> onSettingChanged;
@@ -78,6 +116,17 @@ public:
 	void tick();
 	void shutdown() const;
 
+	/// <summary>
+	/// Runs the engine's own loop (no UI) until requestShutdown() is called
+	/// </summary>
+	void run();
+
+	/// <summary>
+	/// Asks run() (or the UI loop) to exit. Only sets an atomic flag, so it is safe to call from a signal handler.
+	/// </summary>
+	void               requestShutdown() noexcept;
+	[[nodiscard]] bool isShutdownRequested() const noexcept;
+
 	[[nodiscard]] DataPacketRegistry* getDataPacketRegistry() const override;
 	[[nodiscard]] PluginManager*      getPluginManager() const override;
 	std::shared_ptr<ILogger>          getLogger() const override;
@@ -93,11 +142,35 @@ public:
 	void                        setUIService(std::shared_ptr<IPluginUIService> uiService) override;
 	std::shared_ptr<IPluginUIService> getUIService() const override;
 
+	/// <summary>
+	/// Swaps the REST backend (eg. Cpr for HttpLib) for the engine and every loaded plugin, without reloading them.
+	/// Requests already in progress finish on the old one.
+	/// </summary>
+	void setRESTService(std::shared_ptr<IPluginRESTService> restService);
+
+	/// <summary>
+	/// Where engine events are raised - plugins subscribe through IPluginContext::subscribeToEngineEvents
+	/// </summary>
+	[[nodiscard]] EngineEventBus& getEventBus() const;
+
+	/// <summary>
+	/// Records every dispatched packet to a journal file until stopRecording(), replacing any recording in progress
+	/// </summary>
+	std::expected<void, std::string> startRecording(const std::filesystem::path& path) const;
+	void                             stopRecording() const;
+
+	/// <summary>
+	/// Feeds a recorded journal back through dispatch - speed 1 is real time, 10 ten times as fast, 0 as fast as possible
+	/// </summary>
+	std::expected<void, std::string> replayJournal(const std::filesystem::path& path, double speed);
+
 private:
 
 	EngineSettings     m_engineSetting;
+	std::unique_ptr<EngineEventBus>     m_pEventBus;
 	std::unique_ptr<PluginManager>      m_pPluginManager;
 	std::unique_ptr<DataPacketRegistry> m_pDataPacketRegistry;
+	std::unique_ptr<PacketJournalReplayer> m_pJournalReplayer; // made on first replay
 	std::shared_ptr<UILogSink>          m_pUiLogSink;
 
 	//Services
@@ -107,6 +180,8 @@ private:
 
 
 	std::chrono::high_resolution_clock::time_point m_lastUpdateTime;
+	std::uint64_t m_tickCount = 0;
+	std::atomic_bool m_shutdownRequested{false};
 
 	std::shared_ptr<spdlog::logger> m_combinedLogger; // TODO - remove coupling with SPDLog
 	ServiceContainer m_serviceContainer;
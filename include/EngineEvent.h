@@ -1,44 +1,93 @@
 #pragma once
 #include <chrono>
-#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <variant>
 
-enum class EngineEventType
+enum class EngineEventType : std::uint8_t
 {
+	PluginLoaded,
+	PluginUnloaded,
+	SettingChanged,
+	Paused,
+	Resumed,
+	Backpressure,
+	Clock,
+	Shutdown,
 
+	Count
+};
+
+/// <summary>
+/// A set of EngineEventTypes, one bit each - see engineEventMask()
+/// </summary>
+using EngineEventMask = std::uint32_t;
+
+constexpr EngineEventMask engineEventBit(EngineEventType type)
+{
+	return EngineEventMask{1} << static_cast<unsigned>(type);
+}
+
+template<typename... Types>
+constexpr EngineEventMask engineEventMask(Types... types)
+{
+	return (EngineEventMask{0} | ... | engineEventBit(types));
+}
+
+inline constexpr EngineEventMask allEngineEvents = engineEventBit(EngineEventType::Count) - 1;
+
+// Payloads - Paused, Resumed and Shutdown don't have one
+
+struct PluginLoadedEvent
+{
+	std::string pluginName;
+	std::string version;
+	bool        isReload = false; // a new build took over from the loaded one
+};
+
+struct PluginUnloadedEvent
+{
+	std::string pluginName;
+};
+
+using SettingValue = std::variant<bool, std::int64_t, double, std::string>;
+
+struct SettingChangedEvent
+{
+	std::string  setting; // as passed to EngineSettings::onSettingChanged, eg. "debugLogging"
+	SettingValue value;
+};
+
+struct BackpressureEvent
+{
+	std::string   pluginName;
+	std::uint64_t droppedPackets = 0; // since the last event for the plugin
+	std::size_t   queuedPackets = 0;  // still waiting on its worker
+};
+
+struct ClockEvent
+{
+	std::uint64_t                         tick = 0; // counts the engine's plugin ticks
+	std::chrono::system_clock::time_point wallTime;
+	std::chrono::nanoseconds              sinceLastTick{0};
 };
 
 class EngineEvent
 {
 	public:
-		EngineEventType type;
-		std::chrono::system_clock::time_point timestamp;
-		std::unordered_map<std::string, std::any> data;
+		using Payload = std::variant<std::monostate, PluginLoadedEvent, PluginUnloadedEvent, SettingChangedEvent, BackpressureEvent, ClockEvent>;
 
-		template<typename T>
-		T getData(const std::string& key) const
-		{
-			auto it = data.find(key);
-			if (it != data.end())
-			{
-				return std::any_cast<T>(it->second);
-			}
-			throw std::runtime_error("Key not found: " + key);
-		}
+		EngineEventType type = EngineEventType::Clock;
+		std::chrono::steady_clock::time_point timestamp; // when it was raised
+		Payload payload;
 
+		/// <summary>
+		/// Returns the payload if it is a T, null otherwise
+		/// </summary>
 		template<typename T>
-		std::optional<T> tryGetData(const std::string& key) const
+		const T* get() const
 		{
-			auto it = data.find(key);
-			if (it != data.end())
-			{
-				try {
-					return std::any_cast<T>(it->second);
-				} catch (const std::bad_any_cast&)
-				{
-					return std::nullopt;
-				}
-			}
-
-			return std::nullopt;
+			return std::get_if<T>(&payload);
 		}
-};
\ No newline at end of file
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "EngineEvent.h"
+
+/// <summary>
+/// One subscriber's events, waiting to be handed over at the next tick. Bounded - past its capacity events are dropped
+/// and counted, so a subscriber that is never ticked can't grow it without limit.
+/// </summary>
+class EngineEventQueue
+{
+public:
+	EngineEventQueue(EngineEventMask types, std::size_t capacity);
+
+	EngineEventQueue(const EngineEventQueue&) = delete;
+	EngineEventQueue& operator=(const EngineEventQueue&) = delete;
+
+	[[nodiscard]] EngineEventMask getTypes() const;
+	[[nodiscard]] bool            isSubscribed(EngineEventType type) const;
+
+	/// <returns>False if the event was dropped - the queue is full</returns>
+	bool push(const EngineEvent& event);
+
+	/// <summary>
+	/// Moves the queued events into batch, replacing what it held. The two swap storage, so neither side allocates once warm.
+	/// </summary>
+	void takeAll(std::vector<EngineEvent>& batch);
+
+	/// <summary>
+	/// Cheap enough to call for every subscriber every tick
+	/// </summary>
+	[[nodiscard]] bool isEmpty() const;
+
+	/// <summary>
+	/// Returns how many events were dropped since the last call
+	/// </summary>
+	std::uint64_t takeNewDrops();
+
+private:
+	friend class EngineEventBus;
+
+	std::atomic<EngineEventMask> m_types;
+	std::size_t                  m_capacity;
+
+	mutable std::mutex       m_mutex;
+	std::vector<EngineEvent> m_events;
+	std::atomic_bool         m_hasEvents{false};
+
+	std::atomic<std::uint64_t> m_droppedEvents{0};
+	std::uint64_t              m_seenDrops = 0;
+};
+
+/// <summary>
+/// Raises engine events - plugins loading and unloading, settings changing, pause and resume, backpressure, the clock and
+/// shutdown. Each subscriber gets its own queue of the types it asked for, which the engine hands over in one batch at
+/// its next tick (see PluginInstance::deliverEngineEvents). Thread-safe.
+/// </summary>
+class EngineEventBus
+{
+public:
+	static constexpr std::size_t defaultQueueCapacity = 1024;
+
+	std::shared_ptr<EngineEventQueue> subscribe(EngineEventMask types, std::size_t capacity = defaultQueueCapacity);
+
+	/// <summary>
+	/// Changes the types a subscriber gets from now on - what it has queued stays
+	/// </summary>
+	void setSubscribedTypes(EngineEventQueue& queue, EngineEventMask types);
+	void unsubscribe(const std::shared_ptr<EngineEventQueue>& queue);
+
+	/// <summary>
+	/// Queues the event for every subscriber to its type
+	/// </summary>
+	void publish(EngineEventType type, EngineEvent::Payload payload = {});
+
+	/// <summary>
+	/// Whether anyone gets events of this type - skip building a payload nobody wants
+	/// </summary>
+	[[nodiscard]] bool hasSubscribers(EngineEventType type) const;
+
+private:
+	void updateSubscribedTypes(); // call with m_mutex held exclusively
+
+	mutable std::shared_mutex                      m_mutex;
+	std::vector<std::shared_ptr<EngineEventQueue>> m_queues;
+	std::atomic<EngineEventMask>                   m_subscribedTypes{0}; // every queue's types together
+};
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <expected>
 #include <functional>
+#include <span>
+#include <string>
+#include <string_view>
 #include <typeindex>
+#include "EngineEvent.h"
 #include "IPluginContext.h"
 #include <Services/ServiceId.h>
 
@@ -11,8 +16,6 @@
 #define EXPORT extern "C" __attribute__((visibility("default")))
 #endif
 
-enum class EngineEventType;
-
 // Used to indicate that services the plugin needs ie REST, logging, etc
 struct PluginDescriptor
 {
@@ -28,6 +31,8 @@ struct PluginDescriptor
 	std::string version;
 	std::vector<ServiceId> services; // required + optional
 	SecurityLevel requestedSecurityLevel = SecurityLevel::Standard;
+	std::vector<std::type_index> packetTypes; // packet types it handles - activates it on first packet, empty = any
+	std::vector<ProvidedService> provides;    // registered with IPluginContext::provideService from onPluginLoad
 };
 
 struct IPlugin
@@ -37,9 +42,20 @@ struct IPlugin
 
 	virtual void            tick() {}
 	virtual void            onDataPacket([[maybe_unused]] const DataPacket& packet) {}
-	virtual void            onEngineEvent([[maybe_unused]]const EngineEventType& event) {}
 	virtual std::type_index getType() const = 0;
 
+	// Engine events the plugin subscribed to with IPluginContext::subscribeToEngineEvents, in the order they were raised.
+	// Handed over at the start of an engine tick, on the thread that ticks the plugin.
+	virtual void onEngineEvents(std::span<const EngineEvent> events)
+	{
+		for (const EngineEvent& event : events)
+		{
+			onEngineEvent(event);
+		}
+	}
+
+	virtual void onEngineEvent([[maybe_unused]] const EngineEvent& event) {}
+
 	virtual ~IPlugin() = default;
 
 
@@ -51,6 +67,11 @@ struct IPlugin
 	virtual void        toggleUIWindow() { }
 	//virtual void        renderPluginUI() {} // optional UI overload
 
+	// Hot reload - the outgoing instance's state is handed to its replacement, after the replacement's onPluginLoad.
+	// Return nothing from serializeState() if there is nothing worth carrying over; a restoreState() error keeps the old instance.
+	virtual std::string                      serializeState() const { return {}; }
+	virtual std::expected<void, std::string> restoreState([[maybe_unused]] std::string_view state) { return {}; }
+
 	PluginDescriptor getPluginDescriptor()
 	{
 		return m_plugin_descriptor;
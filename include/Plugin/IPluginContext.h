@@ -1,9 +1,18 @@
 #pragma once
 
+#include <array>
 #include <format>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <typeindex>
 
 #include "DataPacket/DataPacket.h"
 #include "DataPacket/IDataPacketHandler.h"
+#include "DataPacket/PacketSchema.h"
+#include "EngineEvent.h"
+#include "Plugin/PluginAllocator.h"
 
 #include "Services/IService.h"
 
@@ -21,9 +30,9 @@ class IPluginContext
 public:
 	virtual ~IPluginContext() = default;
 
-	// Modern service access with ServiceWrapper pattern
+	// Service access - resolve a handle once, eg. in onPluginLoad, and keep it
 	template<typename T>
-	std::unique_ptr<IServiceWrapper<T>> getService();
+	ServiceHandle<std::remove_cvref_t<T>> getService();
 
 	template<typename T>
 	bool hasService() const;
@@ -34,6 +43,88 @@ public:
 
 	virtual void dispatch(const DataPacket& packet) = 0;
 
+	/// <summary>
+	/// Tells the engine how to serialize T (VECTORIUM_PACKET_SCHEMA), so its packets can be recorded and inspected - for
+	/// types the plugin dispatches. registerTypedHandler does this already for the types it handles.
+	/// </summary>
+	/// <returns>False if this context doesn't take serializers</returns>
+	template<HasPacketSchema T>
+	bool registerPacketSchema()
+	{
+		return registerPacketSerializer(typeid(T), packetSerializerFor<T>());
+	}
+
+	/// <summary>
+	/// Registers a handler for a packet type only known at runtime, eg. one found with findPacketTypeBySchema. The
+	/// handler gets the packets untyped.
+	/// </summary>
+	bool registerHandlerForType(std::type_index type, std::shared_ptr<IDataPacketHandler> handler)
+	{
+		return registerDataPacketHandler(type, std::move(handler));
+	}
+
+	/// <summary>
+	/// The packet type some plugin registered a schema of this name for (VECTORIUM_PACKET_SCHEMA), none until one has
+	/// </summary>
+	[[nodiscard]] virtual std::optional<std::type_index> findPacketTypeBySchema([[maybe_unused]] std::string_view schemaName) const { return std::nullopt; }
+
+	/// <summary>
+	/// The type's registered serializer, null if there is none. Holding it holds back unloading the plugin it came
+	/// from - look it up again rather than keep it.
+	/// </summary>
+	[[nodiscard]] virtual std::shared_ptr<const PacketSerializer> findPacketSerializer([[maybe_unused]] std::type_index type) const { return nullptr; }
+
+	// Memory - allocations through these count against the plugin's memory budget
+
+	/// <summary>
+	/// Returns the resource this plugin's memory is charged to, eg. for std::pmr containers it keeps. Valid while the plugin is loaded.
+	/// Allocations past the plugin's budget throw std::bad_alloc.
+	/// </summary>
+	std::pmr::memory_resource* getMemoryResource()
+	{
+		return getMemoryResourceShared().get();
+	}
+
+	virtual std::shared_ptr<std::pmr::memory_resource> getMemoryResourceShared();
+
+	/// <summary>
+	/// Creates a packet whose payload is charged to this plugin until the last copy of it is released
+	/// </summary>
+	template<typename T, typename... Args>
+	DataPacket makePacket(Args&&... args);
+
+	// Threads
+
+	/// <summary>
+	/// Pins the calling thread where the engine's threadPlacement config puts this plugin, and keeps what it allocates on
+	/// that NUMA node. Call it first thing on every thread the plugin starts. Does nothing for a plugin that isn't placed.
+	/// </summary>
+	virtual void placeCurrentThread() {}
+
+	// Services for other plugins
+
+	/// <summary>
+	/// Registers a service with the engine for other plugins to use, at the version the plugin's descriptor lists under
+	/// provides. Call it from onPluginLoad - plugins requiring the service are loaded after this one. It's withdrawn when
+	/// the plugin unloads, unless a newer provider replaced it.
+	/// </summary>
+	/// <returns>False if the descriptor doesn't provide it, or this context can't provide services</returns>
+	template<typename T>
+	bool provideService(std::shared_ptr<T> service)
+	{
+		return provideServiceByType(std::type_index(typeid(T)), std::move(service));
+	}
+
+	// Engine events
+
+	/// <summary>
+	/// Asks for the engine events of these types, eg. engineEventMask(EngineEventType::PluginLoaded, EngineEventType::Shutdown).
+	/// They're queued for the plugin and handed to IPlugin::onEngineEvents together at the engine's next tick. Replaces
+	/// the types asked for before - 0 stops them.
+	/// </summary>
+	/// <returns>False if this context can't deliver engine events</returns>
+	virtual bool subscribeToEngineEvents([[maybe_unused]] EngineEventMask types) { return false; }
+
 	//Redundant?
 	// Logging interface
 	virtual void log(LogLevel level, const std::string& message) const = 0;
@@ -50,8 +141,8 @@ public:
 	std::shared_ptr<T> get()
 		{
 		auto service = getService<T>();
-		if (service->isAvailable()) {
-			return std::shared_ptr<T>(&(*service), [](T*) {}); // Non-owning shared_ptr
+		if (service.isAvailable()) {
+			return std::shared_ptr<T>(service.get(), [](T*) {}); // Non-owning shared_ptr
 		}
 		return nullptr;
 	}
@@ -68,41 +159,41 @@ public:
 protected:
 	virtual bool registerDataPacketHandler(std::type_index type,
 		std::shared_ptr<IDataPacketHandler> handler) = 0;
+	virtual bool registerPacketSerializer([[maybe_unused]] std::type_index type, [[maybe_unused]] const PacketSerializer& serializer) { return false; }
+
+	// Filled in by the implementation when it's constructed, so resolving one of these services is an array load
+	std::array<const ServiceSlot*, fixedServiceSlotCount> m_fixedServiceSlots{};
 
 private:
 	// Type-erased virtual methods for service access
-	virtual std::expected<std::shared_ptr<void>, std::string> getServiceByTypeIndex(std::type_index tIdx) = 0;
+	virtual const ServiceSlot* getServiceSlot(std::type_index tIdx, std::size_t slotIndex) = 0; // null if it can't have one
 	virtual bool hasServiceByTypeIndex(std::type_index tIdx) const = 0;
+	virtual bool provideServiceByType([[maybe_unused]] std::type_index tIdx, [[maybe_unused]] std::shared_ptr<void> service) { return false; }
 };
 
 
 /// <summary>
-/// Retrieves a service wrapper for the specified type from the plugin context.
+/// Retrieves a handle to the service of the specified type from the plugin context.
 /// </summary>
 /// <typeparam name="T">The type of the service to retrieve.</typeparam>
-/// <returns>A unique pointer to an IServiceWrapper for the requested service type. If the service is available, returns a RefService wrapping the service instance. If the service is unavailable but a NullObjectImpl specialization exists, returns a NullService. Otherwise, returns a RefService with a nullptr.</returns>
+/// <returns>A handle that follows the service as it's registered or replaced. While it's missing, calls go to its NullObjectImpl if it has one.</returns>
 template <typename T>
-std::unique_ptr<IServiceWrapper<T>> IPluginContext::getService()
+ServiceHandle<std::remove_cvref_t<T>> IPluginContext::getService()
 {
 	using CleanType = std::remove_cvref_t<T>;
-	auto result     = getServiceByTypeIndex(std::type_index(typeid(CleanType)));
+	constexpr std::size_t slotIndex = serviceSlotIndex<CleanType>;
 
-	if (result.has_value())
+	// An empty slot may yet be filled from the engine's services, which only the implementation knows about
+	if constexpr (slotIndex < fixedServiceSlotCount)
 	{
-		auto service = std::static_pointer_cast<CleanType>(result.value());
-		return std::make_unique<RefService<CleanType>>(std::move(service));
+		const ServiceSlot* slot = m_fixedServiceSlots[slotIndex];
+		if (slot && slot->isOccupied())
+		{
+			return ServiceHandle<CleanType>(slot);
+		}
 	}
 
-	// Only create NullService for types that have NullObjectImpl specializations
-	if constexpr (has_null_impl<CleanType>::value)
-	{
-		return std::make_unique<NullService<CleanType>>();
-	}
-	else
-	{
-		// Return RefService with nullptr (will show as unavailable)
-		return std::make_unique<RefService<CleanType>>(nullptr);
-	}
+	return ServiceHandle<CleanType>(getServiceSlot(std::type_index(typeid(CleanType)), slotIndex));
 }
 
 /// <summary>
@@ -114,9 +205,26 @@ template <typename T>
 bool IPluginContext::hasService() const
 {
 	using CleanType = std::remove_cvref_t<T>;
+	constexpr std::size_t slotIndex = serviceSlotIndex<CleanType>;
+
+	if constexpr (slotIndex < fixedServiceSlotCount)
+	{
+		const ServiceSlot* slot = m_fixedServiceSlots[slotIndex];
+		if (slot && slot->isOccupied())
+		{
+			return true;
+		}
+	}
+
 	return hasServiceByTypeIndex(std::type_index(typeid(CleanType)));
 }
 
+template <typename T, typename... Args>
+DataPacket IPluginContext::makePacket(Args&&... args)
+{
+	return DataPacket::create(std::allocate_shared<T>(PluginAllocator<T>(getMemoryResourceShared()), std::forward<Args>(args)...));
+}
+
 /// <summary>
 /// Registers a typed data packet handler for a specific data type in the plugin context.
 /// </summary>
@@ -127,4 +235,9 @@ void IPluginContext::registerTypedHandler(const std::shared_ptr<ITypedDataPacket
 {
 	auto adapter = std::make_shared<TypedDataPacketHandlerAdapter<T>>(handler);
 	registerDataPacketHandler(typeid(T), adapter);
+
+	if constexpr (HasPacketSchema<T>)
+	{
+		registerPacketSerializer(typeid(T), packetSerializerFor<T>());
+	}
 }
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <expected>
+#include <string>
+#include <string_view>
+
+/// <summary>
+/// Control messages between the engine and a plugin host process, one JSON object per datagram on a SOCK_SEQPACKET
+/// socket. Packets go through SharedPacketRing instead - this only carries what is rare or needs an answer.
+/// </summary>
+/// <remarks>
+/// Host to engine: hello {descriptor}, register {type}, loaded {ok, error}, log {level, message}.
+/// Engine to host: load, tick, unload.
+/// </remarks>
+class PluginHostChannel
+{
+public:
+	enum class Error
+	{
+		Timeout,
+		Closed // the other process exited or closed its end
+	};
+
+	static constexpr std::size_t maxMessageSize = 64 * 1024;
+
+	// The fds the engine hands a plugin host, in that process
+	static constexpr int hostControlFd = 3;
+	static constexpr int hostToHostRingFd = 4;   // engine -> host packets
+	static constexpr int hostFromHostRingFd = 5; // host -> engine packets
+
+	explicit PluginHostChannel(int fd);
+	~PluginHostChannel();
+
+	PluginHostChannel(const PluginHostChannel&) = delete;
+	PluginHostChannel& operator=(const PluginHostChannel&) = delete;
+
+	/// <summary>
+	/// Thread-safe - each message is one datagram, so concurrent senders never interleave
+	/// </summary>
+	bool send(std::string_view message) const;
+	bool trySend(std::string_view message) const; // never blocks, false if the other side isn't keeping up
+
+	/// <summary>
+	/// Waits for the next message. Only one thread may receive.
+	/// </summary>
+	[[nodiscard]] std::expected<std::string, Error> receive(std::chrono::milliseconds timeout) const;
+
+	void shutdown() const; // wakes a blocked receive() on either side with Closed
+
+private:
+	bool sendWithFlags(std::string_view message, int flags) const;
+
+	int m_fd;
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+
+#include "Plugin/IPlugin.h"
+#include "Plugin/Isolation/PluginHostChannel.h"
+#include "Plugin/Isolation/SharedPacketRing.h"
+
+#include <sys/types.h>
+
+class DataPacketRegistry;
+enum class LogLevel;
+
+struct RemotePluginOptions
+{
+	std::filesystem::path     hostExecutable;
+	std::size_t               ringBytes = 4 * 1024 * 1024; // each direction
+	std::chrono::milliseconds startTimeout{10000};         // for the host to start and the plugin to load
+	std::chrono::milliseconds fullRingTimeout{10};         // longest a dispatch waits on a full ring before dropping - once, until the host reads again
+	std::chrono::milliseconds unloadTimeout{5000};         // before the host is killed
+};
+
+/// <summary>
+/// Stands in for a plugin that runs in its own vectorium_plugin_host process, so a crash, hang or leak in it can't take
+/// the engine down.
+/// </summary>
+/// <remarks>
+/// Packets go both ways through a SharedPacketRing each: the registry hands this plugin's packet types to a forwarder
+/// that copies them into the host's ring, and a reader thread dispatches whatever the host sends back. Only trivially
+/// copyable payloads can cross; anything else is dropped with a warning. The host can only send packet types that some
+/// in-process handler is registered for (or fundamental types), as that is the only way to turn its type names back into
+/// type_index. The plugin's context is proxied over a PluginHostChannel - logging works, other services are unavailable.
+/// If the host dies, the plugin stops handling packets and the crash is logged; the engine carries on.
+/// </remarks>
+class RemotePlugin final : public IPlugin
+{
+public:
+	RemotePlugin(std::string name, std::filesystem::path pluginPath, DataPacketRegistry& registry, RemotePluginOptions options);
+	~RemotePlugin() override;
+
+	RemotePlugin(const RemotePlugin&) = delete;
+	RemotePlugin& operator=(const RemotePlugin&) = delete;
+
+	std::expected<void, std::string> onPluginLoad(IPluginContext& context) override;
+	void                             onPluginUnload() override;
+	void                             tick() override;
+	std::type_index                  getType() const override;
+
+	[[nodiscard]] bool          isHostRunning() const;
+	[[nodiscard]] std::uint64_t getDroppedPacketCount() const;
+
+private:
+	/// <summary>
+	/// State shared with the forwarders the registry holds, which may outlive this object until dispatches drain
+	/// </summary>
+	struct HostLink
+	{
+		SharedPacketRing           toHost;
+		std::mutex                 writeMutex; // the ring has one producer, dispatching threads take turns
+		std::atomic_bool           isRunning{false};
+		std::atomic<std::uint64_t> droppedPackets{0};
+		std::chrono::milliseconds  fullRingTimeout;
+
+		// Set when a wait for room times out - until the host reads again, packets are dropped without waiting
+		std::atomic_bool           isHostStalled{false};
+		std::atomic<std::uint64_t> stalledAtReadBytes{0};
+	};
+
+	class Forwarder;
+
+	struct HostType
+	{
+		std::string                           name;
+		std::optional<std::type_index>        type;
+		std::chrono::steady_clock::time_point nextLookup; // an unresolved name is looked up again from then
+	};
+
+	std::expected<void, std::string> startHost();
+	void                             handleControlMessage(const std::string& message);
+	void                             readControl(const std::stop_token& stopToken);
+	void                             readPackets(const std::stop_token& stopToken);
+	void                             dispatchFromHost(const RingRecord& record);
+	[[nodiscard]] std::optional<std::type_index> resolveHostType(std::uint64_t typeHash);
+	void                             onHostExited();
+	void                             stopHost();
+	void                             log(LogLevel level, const std::string& message) const;
+
+	std::string           m_name;
+	std::filesystem::path m_pluginPath;
+	DataPacketRegistry&   m_registry;
+	RemotePluginOptions   m_options;
+	IPluginContext*       m_context = nullptr;
+
+	pid_t                              m_hostPid = -1;
+	std::unique_ptr<PluginHostChannel> m_channel;
+	std::shared_ptr<HostLink>          m_link;
+	std::unique_ptr<SharedPacketRing>  m_fromHost;
+	std::atomic_bool                   m_isUnloading{false};
+	std::uint64_t                      m_reportedDrops = 0;
+
+	// Set by the control reader
+	std::mutex                                      m_stateMutex;
+	std::condition_variable                         m_stateChanged;
+	std::optional<std::expected<void, std::string>> m_loadResult;
+	bool                                            m_hasHostExited = false;
+	std::string                                     m_exitDescription;
+
+	// Packet reader thread only
+	std::unordered_map<std::uint64_t, HostType> m_hostTypes;
+
+	std::jthread m_controlReader;
+	std::jthread m_packetReader;
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "DataPacket/PacketTypeHash.h"
+
+/// <summary>
+/// One record read from a SharedPacketRing - the payload points into the ring and is only valid inside the read callback
+/// </summary>
+struct RingRecord
+{
+	enum class Kind : std::uint32_t
+	{
+		Packet,
+		TypeName // payload is the typeid name behind typeHash, sent before the first packet of that type
+	};
+
+	Kind                       kind;
+	std::uint64_t              typeHash;
+	std::int64_t               timestampNs; // system_clock, since epoch
+	std::span<const std::byte> payload;
+};
+
+/// <summary>
+/// Single-producer single-consumer byte ring in a memfd, shared with a plugin host process. Packets are copied in as raw
+/// bytes, so only trivially copyable payloads can cross.
+/// </summary>
+/// <remarks>
+/// Head and tail are free-running byte counts in the shared header. A sleeping side parks on a futex word in the same
+/// mapping, and is only woken when it has said it is waiting, so a busy ring costs no system calls. Everything read
+/// from the ring is bounds checked - the other process may have crashed halfway through a write, or be hostile.
+/// Linux only.
+/// </remarks>
+class SharedPacketRing
+{
+public:
+	static std::expected<SharedPacketRing, std::string> create(std::size_t capacity);
+	static std::expected<SharedPacketRing, std::string> attach(int fd); // a memfd inherited from the process that created it
+
+	SharedPacketRing(SharedPacketRing&& other) noexcept;
+	SharedPacketRing& operator=(SharedPacketRing&& other) noexcept;
+	~SharedPacketRing();
+
+	SharedPacketRing(const SharedPacketRing&) = delete;
+	SharedPacketRing& operator=(const SharedPacketRing&) = delete;
+
+	[[nodiscard]] int getFd() const { return m_fd; }
+
+	/// <summary>
+	/// Copies one record in, waiting up to timeout for the consumer to make room. Producer side only.
+	/// </summary>
+	/// <returns>False if the record didn't fit in time - it is dropped</returns>
+	bool write(RingRecord::Kind kind, std::uint64_t typeHash, std::int64_t timestampNs, std::span<const std::byte> payload,
+		std::chrono::milliseconds timeout);
+
+	/// <summary>
+	/// Waits up to timeout for room for a record of payloadSize bytes, without writing it. Producer side, but needs no
+	/// turn at writing - other threads can keep calling write() meanwhile, so the room may be gone again on return.
+	/// </summary>
+	bool waitForRoom(std::size_t payloadSize, std::chrono::milliseconds timeout);
+
+	/// <summary>
+	/// Bytes the consumer has read so far - free-running, so any change means it made progress
+	/// </summary>
+	[[nodiscard]] std::uint64_t getReadBytes() const;
+
+	/// <summary>
+	/// Hands up to maxRecords records to fn and frees their space - the ends of the ring skipped on the way count toward
+	/// maxRecords too. Consumer side only.
+	/// </summary>
+	/// <returns>How many records were read</returns>
+	template<typename Fn>
+	std::size_t read(Fn&& fn, std::size_t maxRecords = 256);
+
+	/// <summary>
+	/// Blocks until there is something to read, the timeout passes or wakeConsumer() is called
+	/// </summary>
+	bool waitForData(std::chrono::milliseconds timeout);
+	void wakeConsumer();
+
+	[[nodiscard]] bool isCorrupted() const { return m_isCorrupted; }
+
+private:
+	// Kept apart so the two sides don't share cache lines
+	struct Header
+	{
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint64_t capacity;
+
+		alignas(64) std::atomic<std::uint64_t> head; // bytes written
+		alignas(64) std::atomic<std::uint64_t> tail; // bytes read
+
+		alignas(64) std::atomic<std::uint32_t> dataSignal;  // consumer sleeps on this
+		std::atomic<std::uint32_t>             isConsumerWaiting;
+		alignas(64) std::atomic<std::uint32_t> spaceSignal; // producer sleeps on this
+		std::atomic<std::uint32_t>             isProducerWaiting;
+	};
+
+	struct RecordHeader
+	{
+		std::uint32_t size;  // payload bytes
+		std::uint32_t kind;  // RingRecord::Kind, or wrapMarker
+		std::uint64_t typeHash;
+		std::int64_t  timestampNs;
+	};
+
+	static constexpr std::uint32_t magicValue = 0x56524e47; // "VRNG"
+	static constexpr std::uint32_t layoutVersion = 1;
+	static constexpr std::uint32_t wrapMarker = 0xffffffff; // the rest of the buffer is unused, carry on at the start
+
+	static constexpr std::uint64_t alignRecord(std::uint64_t bytes) { return (bytes + 7) & ~std::uint64_t{7}; }
+
+	SharedPacketRing(int fd, void* mapping, std::size_t mappingSize);
+
+	void notifyProducer();
+
+	int           m_fd = -1;
+	void*         m_mapping = nullptr;
+	std::size_t   m_mappingSize = 0;
+	Header*       m_header = nullptr;
+	std::byte*    m_data = nullptr;
+	std::uint64_t m_capacity = 0; // a private copy, the shared one could be overwritten
+	bool          m_isCorrupted = false;
+};
+
+template<typename Fn>
+std::size_t SharedPacketRing::read(Fn&& fn, std::size_t maxRecords)
+{
+	if (m_isCorrupted)
+	{
+		return 0;
+	}
+
+	std::uint64_t       tail = m_header->tail.load(std::memory_order_relaxed);
+	const std::uint64_t head = m_header->head.load(std::memory_order_acquire);
+
+	// Never more than the ring holds, or head - tail below would take stale bytes for records
+	if (head - tail > m_capacity)
+	{
+		m_isCorrupted = true;
+		return 0;
+	}
+
+	// Skips count toward maxRecords as well, so a ring of nothing but wrap markers can't keep the reader here
+	std::size_t count = 0;
+	std::size_t skips = 0;
+	while (tail != head && count + skips < maxRecords)
+	{
+		const std::uint64_t offset = tail % m_capacity;
+		const std::uint64_t untilEnd = m_capacity - offset;
+
+		// Too little room for a header at the end is skipped without a marker
+		if (untilEnd < sizeof(RecordHeader))
+		{
+			if (untilEnd > head - tail)
+			{
+				m_isCorrupted = true;
+				break;
+			}
+
+			tail += untilEnd;
+			++skips;
+			continue;
+		}
+
+		RecordHeader record;
+		std::memcpy(&record, m_data + offset, sizeof(record));
+
+		if (record.kind == wrapMarker)
+		{
+			if (untilEnd > head - tail)
+			{
+				m_isCorrupted = true;
+				break;
+			}
+
+			tail += untilEnd;
+			++skips;
+			continue;
+		}
+
+		const std::uint64_t recordBytes = alignRecord(sizeof(RecordHeader) + record.size);
+		if (recordBytes > untilEnd || recordBytes > head - tail || record.kind > static_cast<std::uint32_t>(RingRecord::Kind::TypeName))
+		{
+			m_isCorrupted = true;
+			break;
+		}
+
+		fn(RingRecord{
+			.kind = static_cast<RingRecord::Kind>(record.kind),
+			.typeHash = record.typeHash,
+			.timestampNs = record.timestampNs,
+			.payload = std::span<const std::byte>(m_data + offset + sizeof(RecordHeader), record.size)
+		});
+
+		tail += recordBytes;
+		++count;
+	}
+
+	m_header->tail.store(m_isCorrupted ? head : tail, std::memory_order_release);
+	notifyProducer();
+
+	return count;
+}
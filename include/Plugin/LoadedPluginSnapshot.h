@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+class PluginInstance;
+
+/// <summary>
+/// An immutable view of the loaded plugins, taken without a lock. PluginManager publishes a new one whenever a plugin is
+/// loaded, reloaded or unloaded.
+/// </summary>
+/// <remarks>
+/// Every instance in a snapshot stays alive while the snapshot is held, even if it's unloaded meanwhile. Unloaded
+/// instances are destroyed on a later PluginManager::tick, so hold a snapshot for a frame at most.
+/// </remarks>
+class LoadedPluginSnapshot
+{
+public:
+	using Map = std::unordered_map<std::string, PluginInstance*>;
+
+	[[nodiscard]] Map::const_iterator begin() const { return m_state->plugins.begin(); }
+	[[nodiscard]] Map::const_iterator end() const { return m_state->plugins.end(); }
+	[[nodiscard]] std::size_t         size() const { return m_state->plugins.size(); }
+	[[nodiscard]] bool                empty() const { return m_state->plugins.empty(); }
+
+	[[nodiscard]] Map::const_iterator find(const std::string& name) const { return m_state->plugins.find(name); }
+	[[nodiscard]] bool                contains(const std::string& name) const { return m_state->plugins.contains(name); }
+
+	/// <returns>The loaded instance, or null if no plugin of that name is loaded</returns>
+	[[nodiscard]] PluginInstance* get(const std::string& name) const
+	{
+		const auto it = m_state->plugins.find(name);
+		return it != m_state->plugins.end() ? it->second : nullptr;
+	}
+
+private:
+	friend class PluginManager;
+
+	/// <summary>
+	/// One per published snapshot, linked like DataPacketRegistry's table generations - an old snapshot still held keeps
+	/// every later generation alive, so the fence handed out when an instance left expires only once no reader can see it.
+	/// </summary>
+	struct Generation
+	{
+		std::shared_ptr<Generation> next;
+	};
+
+	struct State
+	{
+		Map                         plugins;
+		std::shared_ptr<Generation> generation = std::make_shared<Generation>();
+	};
+
+	explicit LoadedPluginSnapshot(std::shared_ptr<const State> state)
+		: m_state(std::move(state))
+	{
+	}
+
+	std::shared_ptr<const State> m_state;
+};
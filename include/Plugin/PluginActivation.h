@@ -0,0 +1,25 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string_view>
+
+/// <summary>
+/// When a plugin enabled at startup is instantiated and its onPluginLoad called
+/// </summary>
+enum class PluginActivationPolicy
+{
+	Eager,         // at startup
+	OnFirstPacket, // when a packet type it subscribes to (PluginDescriptor::packetTypes) is first dispatched
+	OnFirstUIOpen, // when its window is first opened from the UI
+	Scheduled      // a fixed delay after startup
+};
+
+const char*                           toString(PluginActivationPolicy policy);
+std::optional<PluginActivationPolicy> parseActivationPolicy(std::string_view policy);
+
+struct PluginActivation
+{
+	PluginActivationPolicy policy = PluginActivationPolicy::Eager;
+	std::chrono::seconds   delay{0}; // Scheduled only
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+/// <summary>
+/// Allocator over a plugin's memory resource that shares ownership of it, so memory handed out to the engine (eg. a
+/// packet payload still queued after the plugin unloaded) can be given back to the account it was charged to.
+/// </summary>
+/// <remarks>
+/// Use std::pmr::polymorphic_allocator with IPluginContext::getMemoryResource() for the plugin's own containers - they
+/// can't outlive it. This one is for std::allocate_shared, see IPluginContext::makePacket().
+/// </remarks>
+template<typename T>
+class PluginAllocator
+{
+public:
+	using value_type = T;
+
+	explicit PluginAllocator(std::shared_ptr<std::pmr::memory_resource> resource) noexcept
+		: m_resource(std::move(resource))
+	{
+	}
+
+	template<typename U>
+	PluginAllocator(const PluginAllocator<U>& other) noexcept
+		: m_resource(other.getResource())
+	{
+	}
+
+	[[nodiscard]] T* allocate(std::size_t count)
+	{
+		return static_cast<T*>(m_resource->allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* pointer, std::size_t count) noexcept
+	{
+		m_resource->deallocate(pointer, count * sizeof(T), alignof(T));
+	}
+
+	[[nodiscard]] const std::shared_ptr<std::pmr::memory_resource>& getResource() const noexcept
+	{
+		return m_resource;
+	}
+
+	template<typename U>
+	bool operator==(const PluginAllocator<U>& other) const noexcept
+	{
+		return m_resource == other.getResource();
+	}
+
+private:
+	std::shared_ptr<std::pmr::memory_resource> m_resource;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Plugin/PluginDescriptorCache.h"
+#include "Services/SemanticVersion.h"
+
+/// <summary>
+/// A plugin of the batch that can't be loaded with the others
+/// </summary>
+struct BlockedPlugin
+{
+	std::size_t index = 0; // as returned by PluginDependencyResolver::addPlugin
+	std::string reason;
+	bool        isDeferred = false; // waiting for a required service that may still be registered - otherwise it never can load as it is
+};
+
+/// <summary>
+/// The order to load a batch of plugins in
+/// </summary>
+struct PluginLoadPlan
+{
+	std::vector<std::vector<std::size_t>> stages; // a stage's plugins only need services from earlier stages, so they can load in parallel
+	std::vector<BlockedPlugin>            blocked;
+};
+
+/// <summary>
+/// Works out from their descriptors which plugins of a batch can be loaded, and in which order.
+/// </summary>
+/// <remarks>
+/// A required service has to be registered with the engine at a version its ServiceId::minVersion accepts, or be
+/// provided at such a version by another plugin of the batch, which then loads in an earlier stage. A plugin waiting for
+/// a service nothing has registered yet is deferred, as are the plugins waiting on it. One whose range can't be met by
+/// what is registered, or whose requirements form a cycle, is rejected. Optional services only order the plugins.
+/// </remarks>
+class PluginDependencyResolver
+{
+public:
+	/// <summary>
+	/// The version of a service registered with the engine, by its typeid name - none if it isn't
+	/// </summary>
+	using ServiceLookup = std::function<std::optional<SemanticVersion>(std::string_view typeName)>;
+
+	explicit PluginDependencyResolver(ServiceLookup findRegisteredService);
+
+	/// <summary>
+	/// Adds a plugin to the batch. Without a descriptor nothing is known about it, so it goes in the first stage.
+	/// </summary>
+	/// <returns>Its index in the plan</returns>
+	std::size_t addPlugin(std::string name, std::shared_ptr<const CachedPluginDescriptor> descriptor);
+
+	[[nodiscard]] PluginLoadPlan resolve() const;
+
+private:
+	struct Plugin
+	{
+		std::string                                   name;
+		std::shared_ptr<const CachedPluginDescriptor> descriptor;
+	};
+
+	ServiceLookup       m_findRegisteredService;
+	std::vector<Plugin> m_plugins;
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Plugin/IPlugin.h"
+
+class ILogger;
+enum class LogLevel;
+
+/// <summary>
+/// A copy of a PluginDescriptor that outlives the plugin library - types are kept by their typeid name
+/// </summary>
+struct CachedPluginDescriptor
+{
+	struct Service
+	{
+		std::string typeName;
+		std::string name;
+		std::string minVersion;
+		bool        required = true;
+	};
+
+	struct ProvidedService
+	{
+		std::string typeName;
+		std::string name;
+		std::string version;
+	};
+
+	std::string                     name;
+	std::string                     version;
+	std::vector<Service>            services;
+	PluginDescriptor::SecurityLevel securityLevel = PluginDescriptor::SecurityLevel::Standard;
+	std::vector<std::string>        packetTypeNames;
+	std::vector<ProvidedService>    provides;
+
+	static CachedPluginDescriptor fromDescriptor(const PluginDescriptor& descriptor);
+
+	[[nodiscard]] std::string                                 toJson() const;
+	static std::expected<CachedPluginDescriptor, std::string> fromJson(std::string_view json);
+};
+
+/// <summary>
+/// Identifies one build of a plugin file
+/// </summary>
+struct PluginFileFingerprint
+{
+	std::uintmax_t size = 0;
+	std::int64_t   modifiedTime = 0; // file clock ticks
+	std::uint64_t  contentHash = 0;  // FNV-1a
+};
+
+/// <summary>
+/// Persistent plugin descriptors keyed by path, so folder scans and the Plugins menu never touch the dynamic loader.
+/// </summary>
+/// <remarks>
+/// A miss runs vectorium_descriptor_probe, which loads the plugin in a child process and prints its descriptor - a plugin
+/// that crashes or hangs while loading only takes the probe down. Size and mtime are checked on every lookup; the content
+/// hash only when they change, so a rebuild that produced the same bytes keeps its entry. Errors the probe reports about
+/// the plugin are cached too, so a broken plugin is probed once per build rather than on every scan. A probe that could
+/// not start, or was killed (eg. by its time limit), is tried again on the next lookup.
+/// </remarks>
+class PluginDescriptorCache
+{
+public:
+	PluginDescriptorCache(ILogger& logger, std::filesystem::path cacheFile, std::filesystem::path probeExecutable);
+
+	bool load();
+	bool save(); // no-op unless something changed
+
+	/// <summary>
+	/// Returns the descriptor for the plugin, probing it on a miss. Thread-safe.
+	/// </summary>
+	std::expected<std::shared_ptr<const CachedPluginDescriptor>, std::string> getDescriptor(const std::filesystem::path& pluginPath);
+
+	void forget(const std::filesystem::path& pluginPath);
+
+private:
+	struct Entry
+	{
+		PluginFileFingerprint                         fingerprint;
+		std::shared_ptr<const CachedPluginDescriptor> descriptor; // null when probing failed
+		std::string                                   error;
+	};
+
+	struct ProbeError
+	{
+		std::string message;
+		bool        isReportedByProbe = false; // the probe ran and reported on the plugin - only these are cached
+	};
+
+	[[nodiscard]] std::expected<CachedPluginDescriptor, ProbeError> runProbe(const std::filesystem::path& pluginPath) const;
+	void log(LogLevel level, const std::string& message) const;
+
+	ILogger&              m_logger;
+	std::filesystem::path m_cacheFile;
+	std::filesystem::path m_probeExecutable;
+
+	mutable std::mutex                     m_mutex;
+	std::unordered_map<std::string, Entry> m_entries;
+	bool                                   m_isDirty = false;
+};
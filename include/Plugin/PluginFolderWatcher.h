@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Threading/ThreadPlacement.h"
+
+class ILogger;
+enum class LogLevel;
+
+struct PluginFolderChange
+{
+	enum class Kind
+	{
+		Changed, // added, rewritten or moved in
+		Removed
+	};
+
+	Kind                  kind;
+	std::filesystem::path path;
+};
+
+/// <summary>
+/// Reports plugin files appearing, changing or disappearing in a folder, from its own thread.
+/// </summary>
+/// <remarks>
+/// Uses inotify on Linux and falls back to comparing directory listings every pollInterval elsewhere, or if inotify
+/// can't be set up. A file is only reported once it has been left alone for the debounce period, so a plugin that is
+/// still being written or linked isn't picked up half done. Every matching file already present is reported once on start.
+/// </remarks>
+class PluginFolderWatcher
+{
+public:
+	using ChangeCallback = std::function<void(std::vector<PluginFolderChange>)>;
+
+	PluginFolderWatcher(ILogger& logger,
+		std::filesystem::path directory,
+		std::string extension,
+		std::chrono::milliseconds debounce,
+		std::chrono::milliseconds pollInterval,
+		ChangeCallback onChanges,
+		ThreadPlacement placement = {});
+
+	PluginFolderWatcher(const PluginFolderWatcher&) = delete;
+	PluginFolderWatcher& operator=(const PluginFolderWatcher&) = delete;
+
+	[[nodiscard]] const std::filesystem::path& getDirectory() const;
+
+private:
+	void run(const std::stop_token& stopToken);
+	bool watchWithInotify(const std::stop_token& stopToken);
+	void watchByPolling(const std::stop_token& stopToken);
+
+	[[nodiscard]] bool                               isPluginFile(const std::filesystem::path& path) const;
+	[[nodiscard]] std::vector<std::filesystem::path> listPluginFiles() const;
+	void                                             report(const std::vector<std::filesystem::path>& paths) const;
+	void                                             log(LogLevel level, const std::string& msg) const;
+
+	ILogger&                  m_logger;
+	std::filesystem::path     m_directory;
+	std::string               m_extension;
+	std::chrono::milliseconds m_debounce;
+	std::chrono::milliseconds m_pollInterval;
+	ChangeCallback            m_onChanges;
+	ThreadPlacement           m_placement;
+
+	std::jthread m_thread; // last, so it stops before anything it uses is destroyed
+};
@@ -1,15 +1,21 @@
 #pragma once
+#include <cstdint>
 #include <expected>
 #include <memory>
 #include <typeindex>
 #include <filesystem>
+#include <vector>
+
+#include "EngineEvent.h"
 
 enum class LogLevel;
 class ILogger;
 class IDataPacketHandler;
 
 struct IPlugin;
+class PluginActivity;
 class PluginRuntimeContext;
+class PluginWorker;
 
 
 #ifdef _WIN32
@@ -17,6 +23,7 @@ class PluginRuntimeContext;
 class PluginRuntimeContext;
 	using LibraryHandle = HMODULE;
 	#define LoadSharedLibrary(path) LoadLibraryA(path)
+	#define LoadSharedLibraryLazy(path) LoadLibraryA(path) // imports are always bound at load, use /DELAYLOAD for laziness
 	#define GetSymbol(handle, name) GetProcAddress(handle, name)
 	#define UnloadLibrary(handle)   FreeLibrary(handle)
 	#define getError() std::to_string(GetLastError())
@@ -25,6 +32,7 @@ class PluginRuntimeContext;
 	#include <dlfcn.h>
 	using LibraryHandle = void*;
 	#define LoadSharedLibrary(path) dlopen(path, RTLD_NOW)
+	#define LoadSharedLibraryLazy(path) dlopen(path, RTLD_LAZY) // functions bind on first call, missing ones fail there
 	#define GetSymbol(handle, name) dlsym(handle, name)
 	#define UnloadLibrary(handle)   dlclose(handle)
 	#define getError() dlerror()
@@ -38,7 +46,8 @@ class PluginRuntimeContext;
 class PluginInstance
 {
 public:
-	PluginInstance(LibraryHandle h, std::unique_ptr<IPlugin> p, std::unique_ptr<PluginRuntimeContext>, std::string name = "");
+	PluginInstance(LibraryHandle h, std::unique_ptr<IPlugin> p, std::unique_ptr<PluginRuntimeContext>, std::string name = "",
+	               std::shared_ptr<PluginActivity> activity = nullptr);
 	~PluginInstance();
 
 	PluginInstance(const PluginInstance&) = delete;
@@ -51,12 +60,47 @@ public:
 	//[[nodiscard]] std::expected<std::type_index, std::string> getType() const;
 	[[nodiscard]] PluginRuntimeContext* getContext() const;
 	const std::string& getPluginName();
+	[[nodiscard]] bool isInProcess() const; // false for an isolated plugin, whose library is open in a host process
 
 	void enablePluginDebugLogging();
 	void disablePluginDebugLogging();
 	bool isPluginDebugLoggingEnabled() const;
 
-	void tick() const;
+	void tick();
+
+	/// <summary>
+	/// Hands the plugin the engine events queued for it since the last call, on its worker if it has one. Call at the
+	/// start of every engine tick, whatever the tick stride.
+	/// </summary>
+	void deliverEngineEvents();
+
+	/// <summary>
+	/// Deadline bookkeeping the watchdog keeps for this instance, null if it isn't watched
+	/// </summary>
+	[[nodiscard]] const std::shared_ptr<PluginActivity>& getActivity() const;
+
+	/// <summary>
+	/// Runs the plugin's tick on a thread of its own from now on. Its packet handlers follow once they are wrapped with
+	/// the returned worker's makeQueuedHandler().
+	/// </summary>
+	PluginWorker*               moveToWorker();
+	[[nodiscard]] PluginWorker* getWorker() const;
+
+	/// <summary>
+	/// Ticks the plugin every stride-th call to tick() - 1 ticks it every time
+	/// </summary>
+	void                        setTickStride(std::uint32_t stride);
+	[[nodiscard]] std::uint32_t getTickStride() const;
+
+	/// <summary>
+	/// Returns how many deadline overruns happened since the last call
+	/// </summary>
+	std::uint64_t takeNewOverruns();
+
+	/// <summary>
+	/// Returns how many packets its worker dropped since the last call - 0 without a worker
+	/// </summary>
+	std::uint64_t takeNewDroppedPackets();
 
 private:
 
@@ -64,6 +108,15 @@ private:
 	std::unique_ptr<IPlugin> m_plugin;
 	std::unique_ptr<PluginRuntimeContext> m_context;
 	std::string m_pluginName;
+	const char* m_traceLabel = nullptr;
+
+	std::shared_ptr<PluginActivity> m_activity;
+	std::shared_ptr<PluginWorker>   m_worker;    // shared with the queued handlers in the registry
+	std::uint32_t                   m_tickStride = 1;
+	std::uint32_t                   m_ticksSkipped = 0;
+	std::uint64_t                   m_seenOverruns = 0;
+	std::uint64_t                   m_seenDroppedPackets = 0;
+	std::vector<EngineEvent>        m_engineEvents; // reused for every batch
 
 	std::chrono::steady_clock::time_point m_lastPluginUpdate;
 	std::chrono::seconds m_pluginUpdateInterval{ 5 };
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+enum class PluginLoadStatus
+{
+	Loaded,
+	AlreadyLoaded,
+	Dormant,  // descriptor read, waiting for its activation policy to trigger
+	Deferred, // a required service isn't registered yet - retried by PluginManager::retryDeferredPlugins()
+	Failed
+};
+
+const char* toString(PluginLoadStatus status);
+
+/// <summary>
+/// Where the time went while loading a single plugin
+/// </summary>
+struct PluginLoadTiming
+{
+	std::string               name;
+	PluginLoadStatus          status = PluginLoadStatus::Failed;
+	std::chrono::microseconds openTime{0};  // dlopen/LoadLibrary plus symbol and descriptor lookup
+	std::chrono::microseconds setupTime{0}; // logger, context, plugin construction and onPluginLoad
+	std::string               error;
+
+	[[nodiscard]] std::chrono::microseconds getTotalTime() const
+	{
+		return openTime + setupTime;
+	}
+};
+
+/// <summary>
+/// Per-plugin load cost for one batch of plugins (eg. the enabled plugins at startup)
+/// </summary>
+struct PluginLoadReport
+{
+	std::vector<PluginLoadTiming> plugins;
+	std::chrono::microseconds     wallTime{0};
+	unsigned                      threadCount = 1;
+
+	/// <summary>
+	/// What loading the batch would have cost one plugin after another
+	/// </summary>
+	[[nodiscard]] std::chrono::microseconds getSerialTime() const;
+	[[nodiscard]] std::string               format() const;
+};
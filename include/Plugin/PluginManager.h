@@ -1,25 +1,40 @@
 #pragma once
 
 #include <filesystem>
+#include <atomic>
+#include <expected>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <shared_mutex>
 #include <string>
 #include <thread>
+#include <typeindex>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <spdlog/spdlog.h>
 #include "PluginManagerConfig.h"
+#include "DataPacket/DataPacketRegistry.h"
+#include "Plugin/PluginActivation.h"
+#include "Plugin/PluginDescriptorCache.h"
+#include "Plugin/PluginFolderWatcher.h"
+#include "Plugin/LoadedPluginSnapshot.h"
 #include "Plugin/PluginInstance.h"
+#include "Plugin/PluginLoadReport.h"
+#include "Plugin/PluginWatchdog.h"
 
 #include "Services/ServiceContainer.h"
+#include "Task/TaskQueue.h"
 
 class UILogSink;
+class EngineEventBus;
 class IPluginRESTService;
 struct PluginDescriptor;
 class IPluginContext;
+struct IPlugin;
 enum class LogLevel;
 class PluginInstance;
-class DataPacketRegistry;
 
 struct PluginInfo
 {
@@ -27,6 +42,7 @@ struct PluginInfo
 	std::filesystem::path path;
 	bool loaded = false;
 	std::string errorMessage; // If it failed to load
+	std::shared_ptr<const CachedPluginDescriptor> descriptor; // from the descriptor cache, null if it couldn't be read
 };
 
 /// <summary>
@@ -39,8 +55,13 @@ public:
 	PluginManager(ILogger& logger,
 		DataPacketRegistry& ptrDataPacketReg,
 		spdlog::sink_ptr uiLogSink,
-		 ServiceContainer& services
+		 ServiceContainer& services,
+		 EngineEventBus& events
 		);
+	~PluginManager();
+
+	PluginManager(const PluginManager&) = delete;
+	PluginManager& operator=(const PluginManager&) = delete;
 	std::unique_ptr<IPluginContext> createContextForPlugin(const PluginDescriptor* desc, const std::string& pluginName);
 	bool loadConfig();
 	bool saveConfig() const;
@@ -50,8 +71,8 @@ public:
 	/// </summary>
 	/// <param name="pluginName">The name of the plugin. If empty, the name is derived from the pluginPath.</param>
 	/// <param name="pluginPath">The filesystem path to the plugin.</param>
-	/// <returns>A reference to the PluginInfo associated with the specified plugin name.</returns>
-	PluginInfo&                                               getOrAddPluginInfo(const std::string& pluginName, const std::filesystem::path& path = "");
+	/// <returns>A copy of the PluginInfo associated with the specified plugin name - loader threads may change the entry.</returns>
+	PluginInfo                                                getOrAddPluginInfo(const std::string& pluginName, const std::filesystem::path& path = "");
 	void                                                      removeKnownPlugin(const std::string& name);
 	void                                                      scanPluginsFolder(const std::string& pluginDirectory);
 
@@ -65,6 +86,30 @@ public:
 	bool loadPlugin(const std::filesystem::path& path, const std::string& = "");
 	bool unloadPlugin(const std::string& name);
 
+	/// <summary>
+	/// Loads a batch of plugins. Libraries are opened and plugins set up on worker threads when parallelLoading is enabled,
+	/// then published in the order given. A failing plugin only takes itself out, and one whose required services aren't
+	/// registered yet is deferred until retryDeferredPlugins().
+	/// </summary>
+	/// <param name="applyActivationPolicy">Leave plugins with a non-eager policy in the config dormant - only their descriptor is read</param>
+	/// <returns>How long each plugin took to load, and what happened to it</returns>
+	PluginLoadReport loadPlugins(const std::vector<PluginInfo>& plugins, bool applyActivationPolicy = false);
+
+	/// <summary>
+	/// Instantiates a dormant plugin now, whatever its policy. Main thread only.
+	/// </summary>
+	/// <returns>True if the plugin is loaded afterwards</returns>
+	bool                                   activatePlugin(const std::string& name);
+	[[nodiscard]] std::vector<std::string> getDormantPlugins(PluginActivationPolicy policy) const;
+
+	/// <summary>
+	/// Loads the plugins that were waiting on a required service - call after registering a service with the engine.
+	/// </summary>
+	PluginLoadReport retryDeferredPlugins();
+
+	[[nodiscard]] const PluginLoadReport&   getStartupLoadReport() const;
+	[[nodiscard]] std::vector<std::string> getDeferredPlugins() const;
+
 	/// <summary>
 	/// Retrieves the names of all currently loaded plugins.
 	/// </summary>
@@ -72,10 +117,9 @@ public:
 	[[nodiscard]] std::vector<std::string> getNamesOfAllLoadedPlugins() const;
 
 	/// <summary>
-	/// Returns a reference to the collection of loaded plugins.
+	/// Returns the current snapshot of the loaded plugins - safe to iterate from any thread while plugins load and unload.
 	/// </summary>
-	/// <returns>A constant reference to an unordered map associating plugin names (as strings) with unique pointers to PluginInstance objects.</returns>
-	[[nodiscard]] const std::unordered_map<std::string, std::unique_ptr<PluginInstance>>& getLoadedPlugins() const;
+	[[nodiscard]] LoadedPluginSnapshot getLoadedPlugins() const;
 	void init();
 
 	bool isPluginFolderWatcherEnabled() const;
@@ -107,15 +151,106 @@ public:
 
 	void tick();
 
-	//void reloadPlugin(const std::string name);
+	/// <summary>
+	/// Hands the loaded plugins the engine events queued for them. tick() does this first thing - call it to get events
+	/// out without ticking, eg. Shutdown.
+	/// </summary>
+	void deliverEngineEvents();
+
+	/// <summary>
+	/// Swaps a loaded plugin for the current build of its library without dropping packets. The new build is loaded
+	/// alongside the old one and takes over its state and handlers. The old library is closed once no dispatch can reach it.
+	/// Main thread only, and not from inside a packet handler - that dispatch would never drain.
+	/// </summary>
+	std::expected<void, std::string> reloadPlugin(const std::string& name);
 
 	private:
 	/// <summary>
-	/// Registers appropriate services for a plugin based on its descriptor and runtime context.
+	/// One plugin's way through loadPlugins()
 	/// </summary>
-	/// <param name="context">The runtime context for the plugin, used to register services.</param>
-	/// <param name="desc">The descriptor containing metadata about the plugin, such as its name.</param>
-	void registerServicesForPlugin(PluginRuntimeContext* context, const PluginDescriptor* desc) const;
+	struct PluginLoadJob
+	{
+		std::string                     name;
+		std::filesystem::path           path;
+		LibraryHandle                   handle = nullptr;  // owned by the job until the PluginInstance takes it
+		const PluginDescriptor*         descriptor = nullptr;
+		std::shared_ptr<const CachedPluginDescriptor> cachedDescriptor; // from the cache until the library is opened, then from descriptor
+		IPlugin*                        (*createPlugin)() = nullptr;
+		std::unique_ptr<PluginInstance> instance;
+		bool                            forgetPlugin = false; // the file is unusable, drop it from the known plugins
+		bool                            isReload = false;     // a shadow copy opened alongside the loaded instance, its handlers are staged
+		bool                            isIsolated = false;   // runs in a plugin host process, nothing is opened here
+		bool                            isBlocked = false;    // its required services can't be met, see planLoadOrder
+		bool                            hasReservedName = false; // see reservePluginName, released on commit
+		PluginActivation                activation;
+		std::chrono::steady_clock::time_point activateAt;     // Scheduled only
+		PluginLoadTiming                timing;
+	};
+
+	// The open and setup phases run on loader threads and only touch the job and thread-safe engine state
+	void openPluginLibrary(PluginLoadJob& job) const;
+	void setupPlugin(PluginLoadJob& job) const;
+	PluginLoadStatus commitPlugin(PluginLoadJob& job);
+	[[nodiscard]] bool reservePluginName(PluginLoadJob& job);
+	[[nodiscard]] bool     isIsolatedPlugin(const std::string& name) const;
+	[[nodiscard]] IPlugin* createIsolatedPlugin(const PluginLoadJob& job) const;
+
+	// Dormant plugins - main thread, apart from onWatchedPacket which runs on whichever thread dispatched
+	void activateDuePlugins();
+	void updatePacketWatches();
+	void onWatchedPacket(std::type_index packetType);
+
+	// Discovery - descriptors are read on the calling thread, the results are applied on the main thread
+	[[nodiscard]] std::vector<PluginInfo> describePluginFiles(const std::vector<std::filesystem::path>& pluginFiles) const;
+	void                                  addDiscoveredPlugins(std::vector<PluginInfo> plugins);
+	void                                  removeDiscoveredPlugins(const std::vector<std::filesystem::path>& pluginFiles);
+	void                                  onPluginFolderChanges(std::vector<PluginFolderChange> changes);
+
+	// Hot reload - instances leave through retirePlugin so their library stays open until dispatches have drained
+	[[nodiscard]] std::expected<std::filesystem::path, std::string> makeShadowCopy(const std::string& name, const std::filesystem::path& path);
+	[[nodiscard]] bool waitForDispatches(const DataPacketRegistry::DispatchFence& fence) const;
+	void               retirePlugin(std::unique_ptr<PluginInstance> instance, DataPacketRegistry::DispatchFence fence,
+	                                DataPacketRegistry::DispatchFence snapshotFence = {});
+	void               destroyDrainedPlugins();
+
+	/// <summary>
+	/// Publishes m_loadedPlugins as the new snapshot. Call with m_pluginsMutex held exclusively.
+	/// </summary>
+	/// <returns>A fence that expires once no reader holds a snapshot from before this one</returns>
+	DataPacketRegistry::DispatchFence publishLoadedPlugins();
+
+	// Watchdog - logs plugins that overran their deadlines and applies the configured overrunAction, main thread
+	void superviseOverruns(const LoadedPluginSnapshot& loadedPlugins);
+
+	// Memory budgets - logs plugins crossing their warning level and allocations refused by their limit, main thread
+	void superviseMemory(const LoadedPluginSnapshot& loadedPlugins);
+
+	// Backpressure - raises an event for plugins whose worker dropped packets, and logs engine events a plugin never took, main thread
+	void superviseBackpressure(const LoadedPluginSnapshot& loadedPlugins);
+
+	// Thread placement - warns about nodes and CPUs this machine doesn't have, and resolves "near" for a plugin
+	void                          validateThreadPlacement() const;
+	[[nodiscard]] ThreadPlacement resolveThreadPlacement(const std::string& pluginName) const;
+
+	/// <summary>
+	/// Resolves the jobs' dependencies from their cachedDescriptor. Jobs that can't be loaded are deferred or failed and
+	/// marked isBlocked, and their library closed.
+	/// </summary>
+	/// <returns>The stages to set the others up in - each only needs services provided by earlier ones</returns>
+	std::vector<std::vector<std::size_t>> planLoadOrder(std::vector<PluginLoadJob>& jobs, const std::vector<std::size_t>& candidates) const;
+
+	/// <summary>
+	/// Defers the job, closing its library, if a service it requires isn't registered at a version it accepts
+	/// </summary>
+	/// <returns>True if it can be set up</returns>
+	bool checkRequiredServices(PluginLoadJob& job) const;
+
+	[[nodiscard]] std::optional<std::string>     findMissingRequiredService(const CachedPluginDescriptor& desc) const;
+	[[nodiscard]] std::optional<SemanticVersion> findRegisteredServiceVersion(std::string_view typeName) const;
+	[[nodiscard]] std::shared_ptr<const CachedPluginDescriptor> findCachedDescriptor(const std::string& name, const std::filesystem::path& path) const;
+	[[nodiscard]] unsigned                   getLoadThreadCount(std::size_t pluginCount) const;
+	void                                     setPluginLoadState(const PluginLoadJob& job, bool loaded);
+
 	void log(LogLevel logLvl, const std::string& msg) const;
 	std::shared_ptr<ILogger> createPluginLogger(const std::string& pluginName) const;
 
@@ -124,7 +259,9 @@ public:
 
 private:
 	std::unordered_map<std::string, PluginInfo> m_discoveredPlugins;
-	std::unordered_map<std::string, std::unique_ptr<PluginInstance>> m_loadedPlugins;
+	std::unordered_map<std::string, std::unique_ptr<PluginInstance>> m_loadedPlugins; // owner, writers only - readers use m_loadedSnapshot
+
+	std::atomic<std::shared_ptr<const LoadedPluginSnapshot::State>> m_loadedSnapshot;
 
 	spdlog::sink_ptr m_uiLogSink;
 
@@ -133,13 +270,38 @@ private:
 	//Services from Engine
 	ILogger& m_baseLogger;
 	ServiceContainer& m_services;
+	EngineEventBus&   m_events;
 
 
 	std::string m_configurationFileName = "plugins_config.json";
 
 	PluginManagerConfig m_config;
 
-	std::jthread m_scanningThread;
-
-	mutable std::shared_mutex m_pluginsMutex;  // Add thread safety
+	mutable std::shared_mutex m_pluginsMutex; // serialises changes to m_loadedPlugins and publishing its snapshot
+	std::unordered_set<std::string> m_reservedPluginNames; // being set up, not yet in m_loadedPlugins - under m_pluginsMutex
+	mutable std::mutex        m_discoveredMutex; // loader threads read m_discoveredPlugins while the main thread updates it
+
+	std::vector<PluginInfo> m_deferredPlugins;
+	PluginLoadReport        m_startupLoadReport;
+
+	std::unique_ptr<PluginDescriptorCache> m_descriptorCache;
+	TaskQueue                              m_discoveryUpdates; // folder watcher -> main thread, drained in tick()
+	std::unique_ptr<PluginFolderWatcher>   m_folderWatcher;
+	std::unique_ptr<PluginWatchdog>        m_watchdog; // null if disabled in the config
+
+	struct RetiredPlugin
+	{
+		DataPacketRegistry::DispatchFence fence;
+		DataPacketRegistry::DispatchFence snapshotFence; // expires once no reader holds a snapshot listing the instance
+		std::unique_ptr<PluginInstance>   instance;
+	};
+
+	std::vector<RetiredPlugin> m_retiredPlugins;
+	unsigned                   m_reloadCount = 0;
+
+	std::unordered_map<std::string, PluginLoadJob> m_dormantPlugins;
+	bool                                           m_packetWatchesActive = false;
+	std::atomic_bool                               m_packetActivationPending{false};
+	std::mutex                                     m_triggeredPacketsMutex;
+	std::vector<std::type_index>                   m_triggeredPacketTypes;
 };
@@ -1,9 +1,37 @@
 #pragma once
 
+#include <chrono>
+#include <unordered_map>
+#include "DataPacket/PacketSpillBuffer.h"
+#include "Plugin/PluginActivation.h"
+#include "Plugin/PluginMemoryAccount.h"
+#include "Plugin/PluginWatchdog.h"
+#include "Threading/ThreadPlacement.h"
+
 struct PluginManagerConfig
 {
 	bool autoScan = true;
 	std::string pluginDirectory = "plugins";
-	std::chrono::seconds pluginScanInterval = std::chrono::seconds(5);
+	std::chrono::seconds pluginScanInterval = std::chrono::seconds(5); // only used where the folder can't be watched for events
+	std::chrono::milliseconds pluginChangeDebounce = std::chrono::milliseconds(500); // a changed plugin must be left alone this long
 	std::vector<std::string> enabledPluginsOnStartup;
+	bool parallelLoading = true;
+	unsigned loadThreads = 0; // 0 = one per hardware thread, at least 4
+	bool lazyBinding = true;  // open plugins that aren't activated at startup with RTLD_LAZY
+	bool descriptorCache = true; // read descriptors through vectorium_descriptor_probe and cache them
+	bool autoReload = false;     // hot reload a loaded plugin when the folder watcher sees a new build of it
+	std::chrono::milliseconds reloadDrainTimeout = std::chrono::milliseconds(2000); // longest a reload waits for in-flight dispatches
+	std::vector<std::string> isolatedPlugins; // run in their own vectorium_plugin_host process (Linux only), always eager
+	std::unordered_map<std::string, PluginActivation> activation; // plugins not listed are eager
+	bool watchdog = true; // time plugin ticks and packet handlers against the deadlines below
+	std::chrono::milliseconds tickDeadline = std::chrono::milliseconds(50);
+	std::chrono::milliseconds handlerDeadline = std::chrono::milliseconds(20);
+	unsigned watchdogStrikes = 3; // overruns before overrunAction is taken
+	PluginOverrunAction overrunAction = PluginOverrunAction::Flag; // flag or throttle - isolate is per plugin only, below
+	std::unordered_map<std::string, PluginOverrunAction> overrunActions; // per plugin, how one opts in to isolate (see PluginOverrunAction)
+	std::unordered_map<std::string, PluginMemoryBudget> memoryBudgets; // plugins not listed are accounted but unlimited
+	ThreadPlacement engineThreadPlacement; // loader, folder watcher and watchdog threads
+	std::unordered_map<std::string, ThreadPlacement> pluginThreadPlacement; // a plugin's worker and the threads it places itself
+	PacketRetentionLimits pauseRetention; // packets dispatched while the engine is paused
+	double pauseReplaySpeed = 0.0;        // for them on resume - 0 = as fast as handlers take them, N >= DataPacketRegistry::minReplaySpeed (2) = N times as fast as they arrived
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+
+/// <summary>
+/// Limits on what a plugin may hold through the engine's allocators, in bytes. 0 means no limit.
+/// </summary>
+struct PluginMemoryBudget
+{
+	std::size_t warnBytes = 0;  // logged when crossed
+	std::size_t limitBytes = 0; // allocations that would cross it fail with std::bad_alloc
+};
+
+struct PluginMemoryStats
+{
+	std::size_t   currentBytes = 0;
+	std::size_t   peakBytes = 0;
+	std::uint64_t allocations = 0;         // live ones
+	std::uint64_t rejectedAllocations = 0; // refused by the limit
+};
+
+/// <summary>
+/// Charges everything allocated through it to one plugin, and enforces its PluginMemoryBudget.
+/// </summary>
+/// <remarks>
+/// The plugin gets it from IPluginContext::getMemoryResource(); the engine allocates the packets a plugin makes with
+/// IPluginContext::makePacket() and the log lines held for it in the UI log from it as well. Memory a plugin gets from
+/// plain new isn't seen here. Thread-safe - the counters are atomics, allocation goes straight to the upstream resource.
+/// </remarks>
+class PluginMemoryAccount final : public std::pmr::memory_resource
+{
+public:
+	PluginMemoryAccount(std::string pluginName, PluginMemoryBudget budget, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+	[[nodiscard]] const std::string& getPluginName() const;
+	[[nodiscard]] PluginMemoryBudget getBudget() const;
+	[[nodiscard]] PluginMemoryStats  getStats() const;
+
+	/// <summary>
+	/// True while the plugin holds more than its warnBytes
+	/// </summary>
+	[[nodiscard]] bool isOverWarning() const;
+
+	/// <summary>
+	/// Rejected allocations since the last call, for PluginManager to report
+	/// </summary>
+	[[nodiscard]] std::uint64_t takeNewRejections();
+
+	/// <summary>
+	/// Records whether the warning was last reported as crossed
+	/// </summary>
+	/// <returns>True if that changed</returns>
+	bool setWarningReported(bool isReported);
+
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+	void  do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+	bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+	std::string                m_pluginName;
+	PluginMemoryBudget         m_budget;
+	std::pmr::memory_resource* m_upstream;
+
+	std::atomic<std::size_t>   m_currentBytes{0};
+	std::atomic<std::size_t>   m_peakBytes{0};
+	std::atomic<std::uint64_t> m_allocations{0};
+	std::atomic<std::uint64_t> m_rejectedAllocations{0};
+
+	std::uint64_t m_reportedRejections = 0;
+	bool          m_isWarningReported = false;
+};
@@ -5,14 +5,19 @@
 #include <mutex>
 #include "IPlugin.h"
 #include "Services/ServiceContainer.h"
+#include "Services/ServiceSlot.h"
 
 #include "../../UI/include/Services/UI/IPluginUIService.h"
 #include "Services/Logging/ILogger.h"
+#include "Threading/ThreadPlacement.h"
 
 
 //class IPluginUIService;
 //class ILogger;
 class DataPacketRegistry;
+class EngineEventBus;
+class EngineEventQueue;
+class PluginMemoryAccount;
 
 class PluginRuntimeContext : public IPluginContext
 {
@@ -21,10 +26,19 @@ public:
 		                     , DataPacketRegistry&    registry
 		                     , std::string            pluginName
 		                     , ServiceContainer&      services );
+	~PluginRuntimeContext() override;
 
-		// Type-erased core methods
-	void registerServiceByType(std::type_index typeIdx, std::shared_ptr<void> service);
-	void unregisterServiceByType(std::type_index typeIdx);
+		// Type-erased core methods - a handle the plugin already holds sees the change on its next call.
+		// A service registered here is the plugin's own and overrides the engine's until it's unregistered; every other
+		// slot follows the ServiceContainer, so a service swapped there reaches the plugin too.
+	void registerServiceByType(std::type_index typeIdx, std::size_t slotIndex, std::shared_ptr<void> service);
+	void unregisterServiceByType(std::type_index typeIdx, std::size_t slotIndex);
+
+	/// <summary>
+	/// Releases services replaced while a call was still using them. Cheap to skip when hasRetiredServices() is false.
+	/// </summary>
+	void               collectRetiredServices();
+	[[nodiscard]] bool hasRetiredServices() const;
 
 
 		// Template wrappers for type safety
@@ -37,33 +51,88 @@ public:
 	std::shared_ptr<ILogger> getLoggerShared() override;
 
 	void        unregisterDataPacketHandler();
+
+	/// <summary>
+	/// While set, handlers are staged for a hot reload instead of receiving packets straight away
+	/// </summary>
+	void setStagingHandlers(bool isStaging);
 	std::string getPluginName() const override;
 	void        log(LogLevel level, const std::string& message) const override;
 
+	/// <summary>
+	/// Charges what the plugin allocates through getMemoryResource() and makePacket() to the account. Set before onPluginLoad.
+	/// </summary>
+	void                                               setMemoryAccount(std::shared_ptr<PluginMemoryAccount> account);
+	[[nodiscard]] const std::shared_ptr<PluginMemoryAccount>& getMemoryAccount() const;
+	std::shared_ptr<std::pmr::memory_resource>         getMemoryResourceShared() override;
+
+	/// <summary>
+	/// Where the plugin's threads run - its worker, if it gets one, and any it starts itself. Set before onPluginLoad,
+	/// with nearPlugin already resolved.
+	/// </summary>
+	void                                 setThreadPlacement(ThreadPlacement placement);
+	[[nodiscard]] const ThreadPlacement& getThreadPlacement() const;
+	void                                 placeCurrentThread() override;
+
+	/// <summary>
+	/// The services the plugin's descriptor provides - provideService() only takes these. Set before onPluginLoad.
+	/// </summary>
+	void setProvidedServices(std::vector<ProvidedService> providedServices);
+
+	/// <summary>
+	/// Unregisters what the plugin provided, unless it was replaced since. Call before the plugin unloads.
+	/// </summary>
+	void withdrawProvidedServices();
+
+	/// <summary>
+	/// Where the plugin's engine events come from. Set before onPluginLoad - it gets none until it subscribes.
+	/// </summary>
+	void                            setEngineEventBus(EngineEventBus& eventBus);
+	bool                            subscribeToEngineEvents(EngineEventMask types) override;
+	[[nodiscard]] EngineEventQueue* getEngineEventQueue() const; // null without a bus
+
 	private:
 		void populateServices();
+		void onServiceChanged(std::type_index typeIdx, const std::shared_ptr<void>& service);
 
 private:
 	DataPacketRegistry& m_dataPacketRegistry;
 	std::shared_ptr<ILogger> m_pluginLogger;
 	std::string m_pluginName;
+	bool        m_isStagingHandlers = false;
+	std::shared_ptr<PluginMemoryAccount> m_memoryAccount;
+	ThreadPlacement                      m_threadPlacement;
+
+	ServiceContainer&     m_services;
+	ServiceSlotTable      m_serviceSlots;
+	ServiceSubscriptionId m_serviceSubscription = 0;
+
+	std::mutex               m_serviceMutex;  // orders resolving a slot against the container changing it
+	std::set<std::type_index> m_localServices; // registered with this context, not followed from the container
+
+	std::mutex                                           m_providedMutex;
+	std::vector<ProvidedService>                         m_providedServices;
+	std::vector<std::pair<std::type_index, const void*>> m_providedInstances; // registered with the container
 
-	ServiceContainer& m_services;
-	std::unordered_map<std::type_index, std::shared_ptr<void>> m_localServices;
-	mutable std::shared_mutex m_mutex;
+	EngineEventBus*                   m_engineEventBus = nullptr;
+	std::shared_ptr<EngineEventQueue> m_engineEvents;
 
 	std::function<void*()> m_getImGuiContextFunc;
 	std::function<bool(void*)> m_setImGuiContextFunc;
 
 protected:
 	bool registerDataPacketHandler(std::type_index type, std::shared_ptr<IDataPacketHandler> handler) override;
+	bool registerPacketSerializer(std::type_index type, const PacketSerializer& serializer) override;
 
 public:
 	void                         dispatch(const DataPacket& packet) override;
+	std::optional<std::type_index>          findPacketTypeBySchema(std::string_view schemaName) const override;
+	std::shared_ptr<const PacketSerializer> findPacketSerializer(std::type_index type) const override;
 
 private:
-	std::expected<std::shared_ptr<void>, std::string> getServiceByTypeIndex(std::type_index tIdx) override;
+	const ServiceSlot* getServiceSlot(std::type_index tIdx, std::size_t slotIndex) override;
 	bool hasServiceByTypeIndex(std::type_index tIdx) const override;
+	bool provideServiceByType(std::type_index tIdx, std::shared_ptr<void> service) override;
 
 public:
 	void* getMainAppImGuiContext() override;
@@ -73,10 +142,10 @@ public:
 
 template <typename T> void PluginRuntimeContext::registerService(const std::shared_ptr<T>& service)
 {
-	registerServiceByType(std::type_index(typeid(T)), service);
+	registerServiceByType(std::type_index(typeid(T)), serviceSlotIndex<T>, service);
 }
 
 template <typename T> void PluginRuntimeContext::unregisterService()
 {
-	unregisterServiceByType(std::type_index(typeid(T)));
+	unregisterServiceByType(std::type_index(typeid(T)), serviceSlotIndex<T>);
 }
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Threading/ThreadPlacement.h"
+
+class ILogger;
+enum class LogLevel;
+
+enum class PluginActivityKind : std::uint8_t
+{
+	Tick,
+	Handler
+};
+
+/// <summary>
+/// What happens to a plugin once it has overrun its deadlines watchdogStrikes times
+/// </summary>
+/// <remarks>
+/// Isolate changes which thread calls the plugin, so a plugin only gets it by opting in. From then on tick(),
+/// onEngineEvents() and its packet handlers run on its worker thread, one at a time, while drawing its UI,
+/// serializeState() and onPluginUnload() stay on the main thread. So a plugin that opts in must guard whatever those
+/// share, must not call main-thread-only APIs (eg. the UI) from tick() or a handler, and must cope with packets arriving
+/// after a delay - or being dropped once its queue is full.
+/// </remarks>
+enum class PluginOverrunAction
+{
+	Flag,     // log and show it, nothing else
+	Throttle, // tick it every other frame, then every fourth... while it keeps overrunning
+	Isolate   // move its tick and packet handlers to a thread of its own - per plugin only, see above
+};
+
+const char*                        toString(PluginOverrunAction action);
+std::optional<PluginOverrunAction> parseOverrunAction(std::string_view text);
+
+struct PluginActivityStats
+{
+	std::uint64_t            tickOverruns = 0;
+	std::uint64_t            handlerOverruns = 0;
+	std::chrono::nanoseconds worstTick{0};
+	std::chrono::nanoseconds worstHandler{0};
+	bool                     isStalled = false; // inside a call that is past its deadline right now
+	std::uint64_t            crossNodeDispatches = 0; // packets dispatched to it from another NUMA node than its home node
+
+	[[nodiscard]] std::uint64_t getOverrunCount() const { return tickOverruns + handlerOverruns; }
+};
+
+/// <summary>
+/// Deadline bookkeeping for one plugin instance, shared by the instance, its packet handlers and the watchdog. Also
+/// counts packets reaching the plugin from off its home NUMA node.
+/// </summary>
+class PluginActivity
+{
+public:
+	explicit PluginActivity(std::string pluginName);
+
+	[[nodiscard]] const std::string&  getPluginName() const;
+	[[nodiscard]] PluginActivityStats getStats() const;
+	[[nodiscard]] std::uint64_t       getOverrunCount() const;
+
+	/// <summary>
+	/// The NUMA node the plugin's threads are placed on, -1 (the default) if they aren't
+	/// </summary>
+	void              setHomeNode(int node);
+	[[nodiscard]] int getHomeNode() const;
+
+	/// <summary>
+	/// Called per dispatch with the dispatching thread's node, -1 if unknown
+	/// </summary>
+	void noteDispatchNode(int node) noexcept
+	{
+		const int homeNode = m_homeNode.load(std::memory_order_relaxed);
+		if (node >= 0 && homeNode >= 0 && node != homeNode)
+		{
+			m_crossNodeDispatches.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+private:
+	friend class ScopedPluginActivity;
+	friend class PluginWatchdog;
+
+	void recordOverrun(PluginActivityKind kind, std::uint64_t elapsedTicks) noexcept;
+
+	std::string                m_pluginName;
+	std::atomic<std::uint64_t> m_tickOverruns{0};
+	std::atomic<std::uint64_t> m_handlerOverruns{0};
+	std::atomic<std::uint64_t> m_worstTickTicks{0};
+	std::atomic<std::uint64_t> m_worstHandlerTicks{0};
+	std::atomic<std::uint32_t> m_stalledCalls{0};
+	std::atomic<int>           m_homeNode{-1};
+	std::atomic<std::uint64_t> m_crossNodeDispatches{0};
+	bool                       m_isStallReported = false; // watchdog thread only, later stalls are logged at Debug
+};
+
+/// <summary>
+/// Marks the calling thread as running plugin code until it goes out of scope. Costs a single relaxed load when no
+/// watchdog is running, or when the activity is null.
+/// </summary>
+/// <remarks>
+/// Nested scopes (a tick dispatching into another plugin's handler) hand the thread to the inner plugin until they end,
+/// so a stall is blamed on the plugin that is actually running.
+/// </remarks>
+class ScopedPluginActivity
+{
+public:
+	ScopedPluginActivity(PluginActivity* activity, PluginActivityKind kind) noexcept;
+	~ScopedPluginActivity();
+
+	ScopedPluginActivity(const ScopedPluginActivity&) = delete;
+	ScopedPluginActivity& operator=(const ScopedPluginActivity&) = delete;
+
+private:
+	void begin() noexcept;
+	void end() noexcept;
+
+	PluginActivity*    m_activity = nullptr; // null if nothing is being watched
+	PluginActivityKind m_kind;
+	std::uint64_t      m_startTicks = 0;
+	std::uint64_t      m_episode = 0;
+
+	// The scope this one interrupted on the same thread, restored when it ends
+	PluginActivity*    m_outerActivity = nullptr;
+	PluginActivityKind m_outerKind = PluginActivityKind::Tick;
+	std::uint64_t      m_outerStartTicks = 0;
+	std::uint64_t      m_outerEpisode = 0;
+};
+
+/// <summary>
+/// Watches every thread running plugin code and reports calls that run past their deadline - while they are still stuck,
+/// not just once they return. Overruns are counted on the plugin's PluginActivity; PluginManager decides what to do about them.
+/// </summary>
+/// <remarks>
+/// Calls are timed in TraceRecorder ticks, so marking a call is two TSC reads and a few relaxed stores. There is one
+/// watchdog per process - the deadlines it sets are global.
+/// </remarks>
+class PluginWatchdog
+{
+public:
+	PluginWatchdog(ILogger& logger, std::chrono::milliseconds tickDeadline, std::chrono::milliseconds handlerDeadline, ThreadPlacement placement = {});
+	~PluginWatchdog();
+
+	PluginWatchdog(const PluginWatchdog&) = delete;
+	PluginWatchdog& operator=(const PluginWatchdog&) = delete;
+
+	/// <summary>
+	/// Lets stalls of this plugin be reported by name. Untracked activities are still timed, just not logged.
+	/// </summary>
+	void track(const std::shared_ptr<PluginActivity>& activity);
+
+	[[nodiscard]] std::chrono::milliseconds getDeadline(PluginActivityKind kind) const;
+
+	[[nodiscard]] static bool isWatching() noexcept
+	{
+		return s_isWatching.load(std::memory_order_relaxed);
+	}
+
+	static std::chrono::nanoseconds ticksToDuration(std::uint64_t ticks) noexcept;
+
+private:
+	friend class ScopedPluginActivity;
+
+	void run(const std::stop_token& stopToken);
+	void calibrate();
+	void checkThreads();
+	void log(LogLevel level, const std::string& msg) const;
+
+	static std::atomic_bool           s_isWatching;
+	static std::atomic<std::uint64_t> s_deadlineTicks[2]; // by PluginActivityKind
+	static std::atomic<double>        s_nsPerTick;
+
+	ILogger&                  m_logger;
+	std::chrono::milliseconds m_deadlines[2];
+	ThreadPlacement           m_placement;
+
+	std::mutex                                 m_trackedMutex;
+	std::vector<std::weak_ptr<PluginActivity>> m_tracked;
+
+	std::jthread m_thread;
+};
+
+inline ScopedPluginActivity::ScopedPluginActivity(PluginActivity* activity, PluginActivityKind kind) noexcept
+	: m_kind(kind)
+{
+	if (activity && PluginWatchdog::isWatching())
+	{
+		m_activity = activity;
+		begin();
+	}
+}
+
+inline ScopedPluginActivity::~ScopedPluginActivity()
+{
+	if (m_activity)
+	{
+		end();
+	}
+}
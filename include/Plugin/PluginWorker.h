@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DataPacket/DataPacket.h"
+#include "EngineEvent.h"
+
+class IDataPacketHandler;
+class IPluginContext;
+class PluginActivity;
+struct IPlugin;
+
+/// <summary>
+/// A thread of its own for a plugin the watchdog caught overrunning its deadlines, so it stops holding up
+/// PluginManager::tick and the threads that dispatch to it. Runs the plugin's tick and its packet handlers one at a time.
+/// </summary>
+/// <remarks>
+/// Ticks coalesce - a plugin that can't keep up is ticked once for however many frames it missed. Packets are queued up
+/// to a bound and dropped beyond it, so a stuck plugin can't grow the queue without limit. Engine events go first, then
+/// packets, then the tick.
+/// </remarks>
+class PluginWorker : public std::enable_shared_from_this<PluginWorker>
+{
+public:
+	/// <param name="context">Places the worker's thread, as it would any other thread of the plugin's</param>
+	PluginWorker(IPlugin& plugin, IPluginContext& context, std::string pluginName, std::shared_ptr<PluginActivity> activity, std::size_t packetCapacity = 4096);
+	~PluginWorker();
+
+	PluginWorker(const PluginWorker&) = delete;
+	PluginWorker& operator=(const PluginWorker&) = delete;
+
+	void postTick();
+
+	/// <summary>
+	/// Hands a batch of engine events to the plugin on the worker's thread. Takes the events, leaving the vector empty.
+	/// </summary>
+	void postEngineEvents(std::vector<EngineEvent>& events);
+
+	/// <returns>False if the packet was dropped - the queue is full, or the worker is stopped</returns>
+	bool postPacket(const std::shared_ptr<IDataPacketHandler>& handler, const DataPacket& packet);
+
+	/// <summary>
+	/// Returns a handler that queues packets for this worker instead of handling them on the dispatching thread
+	/// </summary>
+	[[nodiscard]] std::shared_ptr<IDataPacketHandler> makeQueuedHandler(std::shared_ptr<IDataPacketHandler> handler);
+
+	/// <summary>
+	/// Waits for the call in progress, then discards anything still queued. The worker takes nothing after this.
+	/// </summary>
+	void stop();
+
+	[[nodiscard]] std::uint64_t getDroppedPacketCount() const;
+	[[nodiscard]] std::size_t   getQueuedPacketCount() const;
+
+private:
+	struct QueuedPacket
+	{
+		std::shared_ptr<IDataPacketHandler> handler;
+		DataPacket                          packet;
+	};
+
+	void run(const std::stop_token& stopToken);
+
+	IPlugin&                        m_plugin;
+	IPluginContext&                 m_context;
+	std::string                     m_pluginName;
+	const char*                     m_traceLabel = nullptr;
+	std::shared_ptr<PluginActivity> m_activity;
+	std::size_t                     m_packetCapacity;
+
+	mutable std::mutex          m_mutex;
+	std::condition_variable_any m_wake;
+	std::deque<QueuedPacket>    m_packets;
+	std::vector<EngineEvent>    m_engineEvents;
+	bool                        m_isTickPending = false;
+	bool                        m_isStopped = false;
+
+	std::atomic<std::uint64_t> m_droppedPackets{0};
+
+	std::jthread m_thread;
+};
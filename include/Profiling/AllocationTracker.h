@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// The engine zones allocations are attributed to
+/// </summary>
+enum class AllocationZoneKind : std::uint8_t
+{
+	PluginTick,
+	Handler,
+	Render
+};
+
+const char* toString(AllocationZoneKind kind);
+
+struct AllocationZoneStats
+{
+	AllocationZoneKind kind = AllocationZoneKind::PluginTick;
+	std::string        label;
+	std::uint64_t      entries = 0;      // times the zone was entered - ticks, handled packets or frames
+	std::uint64_t      allocations = 0;  // excludes allocations made by nested zones
+	std::uint64_t      bytes = 0;
+	std::uint64_t      maxAllocationsPerEntry = 0;
+	std::uint64_t      forbiddenAllocations = 0;
+	bool               noAlloc = false;
+
+	[[nodiscard]] double getAllocationsPerEntry() const
+	{
+		return entries == 0 ? 0.0 : static_cast<double>(allocations) / static_cast<double>(entries);
+	}
+
+	[[nodiscard]] double getBytesPerEntry() const
+	{
+		return entries == 0 ? 0.0 : static_cast<double>(bytes) / static_cast<double>(entries);
+	}
+};
+
+class ScopedAllocationZone;
+
+/// <summary>
+/// Counts global operator new calls per thread and attributes them to the innermost active engine zone.
+/// </summary>
+/// <remarks>
+/// Counting needs the replacement operator new from AllocationHooks.cpp, which is only linked into executables built with
+/// VECTORIUM_ALLOCATION_AUDIT. Without it the tracker and zones still compile, they just never see an allocation.
+/// </remarks>
+class AllocationTracker
+{
+public:
+	static AllocationTracker& instance();
+
+	AllocationTracker(const AllocationTracker&) = delete;
+	AllocationTracker& operator=(const AllocationTracker&) = delete;
+
+	void setEnabled(bool enabled);
+	[[nodiscard]] bool isEnabled() const noexcept
+	{
+		return m_enabled.load(std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// True when the counting operator new is linked into this process
+	/// </summary>
+	[[nodiscard]] static bool areHooksInstalled() noexcept;
+
+	/// <summary>
+	/// When set, an allocation inside a no-alloc zone prints the zone and aborts, so a debugger stops on the offending call
+	/// </summary>
+	void               setAbortOnForbiddenAllocation(bool shouldAbort);
+	[[nodiscard]] bool isAbortOnForbiddenAllocationEnabled() const;
+
+	/// <summary>
+	/// Marks a zone (eg. a plugin's tick) as one that must not allocate. Takes effect the next time the zone is entered.
+	/// </summary>
+	void               setNoAlloc(AllocationZoneKind kind, std::string_view label, bool noAlloc);
+	[[nodiscard]] bool isNoAlloc(AllocationZoneKind kind, const char* label) const;
+
+	/// <summary>
+	/// Per-zone totals, worst offender (allocations per entry) first
+	/// </summary>
+	[[nodiscard]] std::vector<AllocationZoneStats> getZoneStats() const;
+	[[nodiscard]] std::string                      formatReport() const;
+	void                                           reset();
+
+	// Called from the operator new/delete replacements
+	static void onAllocation(std::size_t bytes) noexcept;
+	static void markHooksInstalled() noexcept;
+
+private:
+	friend class ScopedAllocationZone;
+
+	AllocationTracker() = default;
+
+	using ZoneKey = std::pair<AllocationZoneKind, const char*>; // labels are interned, so the pointer identifies the zone
+
+	void recordZone(const ScopedAllocationZone& zone, std::uint64_t allocations, std::uint64_t bytes);
+	[[noreturn]] static void abortOnForbiddenAllocation(const ScopedAllocationZone& zone) noexcept;
+
+	std::atomic_bool m_enabled{false};
+	std::atomic_bool m_abortOnForbiddenAllocation{false};
+	std::atomic_bool m_hasNoAllocZones{false};
+
+	mutable std::mutex                  m_mutex;
+	std::map<ZoneKey, AllocationZoneStats> m_zones;
+	std::set<ZoneKey>                   m_noAllocZones;
+};
+
+/// <summary>
+/// RAII zone that allocations on this thread are attributed to. Costs a single relaxed load when the tracker is disabled.
+/// </summary>
+class ScopedAllocationZone
+{
+public:
+	/// <param name="label">Must outlive the tracker - use TraceRecorder::internName() for dynamic names</param>
+	ScopedAllocationZone(AllocationZoneKind kind, const char* label) noexcept;
+	~ScopedAllocationZone();
+
+	ScopedAllocationZone(const ScopedAllocationZone&) = delete;
+	ScopedAllocationZone& operator=(const ScopedAllocationZone&) = delete;
+
+private:
+	friend class AllocationTracker;
+
+	AllocationZoneKind    m_kind;
+	const char*           m_label;
+	bool                  m_active = false;
+	bool                  m_noAlloc = false;
+	ScopedAllocationZone* m_parent = nullptr;
+
+	std::uint64_t m_startAllocations = 0;
+	std::uint64_t m_startBytes = 0;
+	std::uint64_t m_childAllocations = 0;
+	std::uint64_t m_childBytes = 0;
+	std::uint64_t m_forbiddenAllocations = 0;
+};
+
+#define VECTORIUM_ALLOCATION_CONCAT_INNER(a, b) a##b
+#define VECTORIUM_ALLOCATION_CONCAT(a, b) VECTORIUM_ALLOCATION_CONCAT_INNER(a, b)
+
+// Zones compile away entirely unless the audit build is enabled
+#ifdef VECTORIUM_ALLOCATION_AUDIT
+	#define VECTORIUM_ALLOCATION_ZONE(kind, label) ScopedAllocationZone VECTORIUM_ALLOCATION_CONCAT(allocationZone_, __LINE__)(kind, label)
+#else
+	#define VECTORIUM_ALLOCATION_ZONE(kind, label) ((void)0)
+#endif
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#include <intrin.h>
+	#define VECTORIUM_TRACE_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h>
+	#define VECTORIUM_TRACE_HAS_TSC 1
+#endif
+
+/// <summary>
+/// A single completed timing zone, in raw clock ticks. Names must outlive the recorder - use string literals or TraceRecorder::internName().
+/// </summary>
+struct TraceEvent
+{
+	const char*   name = nullptr;
+	const char*   detail = nullptr;
+	std::uint64_t startTicks = 0;
+	std::uint64_t durationTicks = 0;
+};
+
+/// <summary>
+/// Captures scoped timing zones into bounded per-thread ring buffers and exports them in the Chrome Trace Event format
+/// (loadable in Perfetto and chrome://tracing).
+/// </summary>
+/// <remarks>
+/// Each thread only ever writes to its own buffer, so recording a zone is two clock reads and a store - no locks.
+/// When a buffer is full the oldest events are overwritten. A thread's buffer outlives it until an export has written
+/// it out, then goes to the next thread to start recording - so threads coming and going don't add buffers.
+/// </remarks>
+class TraceRecorder
+{
+public:
+	static TraceRecorder& instance();
+
+	TraceRecorder(const TraceRecorder&) = delete;
+	TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+	void setEnabled(bool enabled);
+	[[nodiscard]] bool isEnabled() const noexcept
+	{
+		return m_enabled.load(std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Sets the ring buffer size (rounded up to a power of two) used by threads that record their first zone after this call.
+	/// </summary>
+	void                 setEventsPerThread(std::size_t capacity);
+	[[nodiscard]] size_t getEventsPerThread() const;
+
+	/// <summary>
+	/// Returns a stable pointer for a dynamic name (eg. a plugin name) that can be used as a zone name or detail.
+	/// </summary>
+	const char* internName(std::string_view name);
+
+	/// <summary>
+	/// Names the calling thread in exported traces
+	/// </summary>
+	void setCurrentThreadName(std::string_view name);
+
+	void record(const char* name, const char* detail, std::uint64_t startTicks, std::uint64_t endTicks) noexcept;
+
+	/// <summary>
+	/// Discards everything captured so far
+	/// </summary>
+	void clear();
+
+	[[nodiscard]] std::size_t getRecordedEventCount() const; // since the last clear()
+
+	/// <summary>
+	/// Writes all captured zones to a Chrome Trace Event JSON file
+	/// </summary>
+	/// <returns>True if the file was written</returns>
+	bool writeChromeTrace(const std::filesystem::path& path) const;
+
+	/// <summary>
+	/// Raw timestamp used for zones - the TSC where available (a fraction of the cost of steady_clock), converted to ns on export
+	/// </summary>
+	static std::uint64_t nowTicks() noexcept
+	{
+#ifdef VECTORIUM_TRACE_HAS_TSC
+		return __rdtsc();
+#else
+		return static_cast<std::uint64_t>(nowNs());
+#endif
+	}
+
+	static std::int64_t nowNs() noexcept
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+private:
+	TraceRecorder() = default;
+
+	struct ThreadBuffer;
+	struct ThreadBufferLease;
+	ThreadBuffer* currentThreadBuffer(); // null once the calling thread is exiting
+
+	// Buffers of exited threads kept for an export, at most - past it the oldest is reused even if never exported
+	static constexpr std::size_t maxRetiredBuffers = 16;
+
+	struct ClockSample
+	{
+		std::uint64_t ticks = 0;
+		std::int64_t  ns = 0;
+	};
+
+	static ClockSample sampleClock() noexcept;
+
+	std::atomic_bool           m_enabled{false};
+	std::atomic<std::size_t>   m_eventsPerThread{1u << 16};
+	std::atomic<std::uint64_t> m_clearedAtTicks{0};
+	ClockSample                m_calibration = sampleClock(); // tick -> ns reference point
+
+	mutable std::mutex                         m_buffersMutex;
+	std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+	std::uint32_t                              m_nextThreadId = 1;
+
+	struct NameHash
+	{
+		using is_transparent = void;
+		std::size_t operator()(std::string_view name) const noexcept
+		{
+			return std::hash<std::string_view>{}(name);
+		}
+	};
+
+	std::mutex                                                   m_namesMutex;
+	std::unordered_set<std::string, NameHash, std::equal_to<>> m_internedNames;
+};
+
+/// <summary>
+/// RAII timing zone. Costs a single relaxed load when tracing is disabled.
+/// </summary>
+class ScopedTraceZone
+{
+public:
+	explicit ScopedTraceZone(const char* name, const char* detail = nullptr) noexcept
+		: m_name(name)
+		, m_detail(detail)
+	{
+		if (TraceRecorder::instance().isEnabled())
+		{
+			m_startTicks = TraceRecorder::nowTicks();
+		}
+	}
+
+	~ScopedTraceZone()
+	{
+		if (m_startTicks != 0)
+		{
+			TraceRecorder::instance().record(m_name, m_detail, m_startTicks, TraceRecorder::nowTicks());
+		}
+	}
+
+	ScopedTraceZone(const ScopedTraceZone&) = delete;
+	ScopedTraceZone& operator=(const ScopedTraceZone&) = delete;
+
+private:
+	const char*   m_name;
+	const char*   m_detail;
+	std::uint64_t m_startTicks = 0;
+};
+
+#define VECTORIUM_TRACE_CONCAT_INNER(a, b) a##b
+#define VECTORIUM_TRACE_CONCAT(a, b) VECTORIUM_TRACE_CONCAT_INNER(a, b)
+
+#define VECTORIUM_TRACE_ZONE(name) ScopedTraceZone VECTORIUM_TRACE_CONCAT(traceZone_, __LINE__)(name)
+#define VECTORIUM_TRACE_ZONE_DETAIL(name, detail) ScopedTraceZone VECTORIUM_TRACE_CONCAT(traceZone_, __LINE__)(name, detail)
@@ -5,14 +5,17 @@
 #include <type_traits>
 #include <utility>
 
+#include "Services/ServiceSlot.h"
+
 template<typename T>
 struct NullObjectImpl;
 
 template<typename T, typename = void>
 struct has_null_impl : std::false_type {};
 
+// sizeof() only compiles once a NullObjectImpl<T> specialisation has been defined
 template<typename T>
-struct has_null_impl<T, std::void_t<decltype(std::declval<NullObjectImpl<T>>())>> : std::true_type {};
+struct has_null_impl<T, std::void_t<decltype(sizeof(NullObjectImpl<T>))>> : std::true_type {};
 
 
 template<typename T>
@@ -87,68 +90,149 @@ private:
 };
 
 /// <summary>
-/// A proxy class that manages access to a service implementation via an IServiceWrapper. Provides pointer-like semantics and availability checking.
+/// The null object standing in for a missing service, or null if T has no NullObjectImpl
 /// </summary>
-/// <typeparam name="T">The type of the service interface being proxied.</typeparam>
 template<typename T>
-class ServiceProxy
+T* getNullService()
 {
-	std::unique_ptr<IServiceWrapper<T>> wrapper_;
+	if constexpr (has_null_impl<T>::value)
+	{
+		static NullObjectImpl<T> instance;
+		return &instance;
+	}
+	else
+	{
+		return nullptr;
+	}
+}
 
+/// <summary>
+/// One call through a ServiceHandle. Keeps the service it resolved alive until the end of the full expression, even if
+/// it's replaced meanwhile - handle->call() is one ServiceCall.
+/// </summary>
+template<typename T>
+class ServiceCall
+{
 public:
-	ServiceProxy() : wrapper_(std::make_unique <NullService<T>>())
+	explicit ServiceCall(const ServiceSlot* slot) noexcept
+		: m_slot(slot)
+		, m_service(slot ? static_cast<T*>(slot->enter()) : nullptr)
 	{
-		if constexpr (has_null_impl<T>::value)
-		{
-			wrapper_ = std::make_unique<NullService<T>>();
-		}
-		else
+	}
+
+	~ServiceCall()
+	{
+		if (m_slot)
 		{
-			wrapper_ = std::make_unique<RefService<T>>(nullptr);
+			m_slot->leave();
 		}
 	}
 
-	explicit ServiceProxy(std::unique_ptr<IServiceWrapper<T>> wrapper)
-		: wrapper_(std::move(wrapper)) {}
+	ServiceCall(const ServiceCall&) = delete;
+	ServiceCall& operator=(const ServiceCall&) = delete;
 
-	// Forward all calls to the wrapper
-	T* operator->()
+	T* operator->() const noexcept
 	{
-		if(!wrapper_)
-		{
-			if constexpr (has_null_impl<T>::value)
-			{
-				wrapper_ = std::make_unique<NullService<T>>();
-			}
-			else
-			{
-				// Return nullptr and let it crash with a more obvious error
-				return nullptr;
-			}
-		}
+		return m_service ? m_service : getNullService<T>();
+	}
+
+private:
+	const ServiceSlot* m_slot;
+	T*                 m_service;
+};
+
+/// <summary>
+/// A plugin's handle to a service, resolved once and valid for the life of its context. Always sees the current
+/// instance - a replaced service takes effect on the next call without the plugin asking again.
+/// </summary>
+/// <remarks>
+/// Copying it copies a pointer. Calls through operator-> are safe against the service being replaced mid-call;
+/// get() and operator* aren't, so don't hold on to what they return.
+/// </remarks>
+template<typename T>
+class ServiceHandle
+{
+public:
+	ServiceHandle() = default;
 
-		return wrapper_->operator->();
+	explicit ServiceHandle(const ServiceSlot* slot) noexcept
+		: m_slot(slot)
+	{
 	}
 
-	T& operator*()
+	ServiceCall<T> operator->() const noexcept
 	{
-		if (!wrapper_)
-		{
-			wrapper_ = std::make_unique<NullService<T>>();
-		}
-		return wrapper_->operator*();
+		return ServiceCall<T>(m_slot);
 	}
 
-	bool isAvailable() const
+	T& operator*() const noexcept
 	{
-		if (!wrapper_)
-		{
-			return false;  // Safe return instead of crash
-		}
-		return wrapper_->isAvailable();
+		return *get();
+	}
+
+	/// <returns>The current instance, the null object if it's missing, or null if T has none</returns>
+	[[nodiscard]] T* get() const noexcept
+	{
+		T* service = m_slot ? static_cast<T*>(m_slot->peek()) : nullptr;
+		return service ? service : getNullService<T>();
+	}
+
+	[[nodiscard]] bool isAvailable() const noexcept
+	{
+		return m_slot && m_slot->isOccupied();
+	}
+
+	explicit operator bool() const noexcept
+	{
+		return isAvailable();
+	}
+
+	/// <summary>
+	/// Changes whenever the service is registered, replaced or removed
+	/// </summary>
+	[[nodiscard]] std::uint64_t getVersion() const noexcept
+	{
+		return m_slot ? m_slot->getVersion() : 0;
+	}
+
+private:
+	const ServiceSlot* m_slot = nullptr;
+};
+
+/// <summary>
+/// A plugin's member holding a service - a ServiceHandle that can start out empty.
+/// </summary>
+/// <typeparam name="T">The type of the service interface being proxied.</typeparam>
+template<typename T>
+class ServiceProxy
+{
+	ServiceHandle<T> m_handle;
+
+public:
+	ServiceProxy() = default;
+
+	ServiceProxy(std::nullptr_t) noexcept {}
+
+	explicit ServiceProxy(ServiceHandle<T> handle) noexcept
+		: m_handle(handle) {}
+
+	ServiceCall<T> operator->() const noexcept
+	{
+		return m_handle.operator->();
 	}
 
-	// Move semantics
-	ServiceProxy(ServiceProxy&&) = default;
-	ServiceProxy& operator=(ServiceProxy&&) = default;
-};
\ No newline at end of file
+	T& operator*() const noexcept
+	{
+		return *m_handle;
+	}
+
+	bool isAvailable() const noexcept
+	{
+		return m_handle.isAvailable();
+	}
+
+	[[nodiscard]] const ServiceHandle<T>& getHandle() const noexcept
+	{
+		return m_handle;
+	}
+};
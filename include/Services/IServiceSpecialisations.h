@@ -16,7 +16,9 @@
 
 // UI
 #include "../../UI/include/Services/UI/IPluginUIService.h"
-#include "../../UI/include/Services/UI/PluginUIService_ImGui.h"
+
+// Time series
+#include "Services/TimeSeries/ITimeSeriesStore.h"
 
 class PluginUIService_ImGui;
 
@@ -143,3 +145,21 @@ struct NullObjectImpl<IPluginUIService> : IPluginUIService
 	void          setErrorCallback([[maybe_unused]] std::function<void(const std::string&)> callback) override {}
 	bool isUIAvailable() const override { return false; }
 };
+
+// Time series
+template<>
+struct NullObjectImpl<ITimeSeriesStore> : ITimeSeriesStore
+{
+	bool                     track([[maybe_unused]] std::string_view schemaName) override { return false; }
+	std::vector<std::string> getTrackedSchemas() const override { return {}; }
+
+	std::expected<TimeSeriesRange, std::string> query([[maybe_unused]] std::string_view schemaName, [[maybe_unused]] TimePoint from, [[maybe_unused]] TimePoint to) override
+	{
+		return std::unexpected("Service not available");
+	}
+
+	std::expected<std::vector<DataPacket>, std::string> queryPackets([[maybe_unused]] std::type_index packetType, [[maybe_unused]] TimePoint from, [[maybe_unused]] TimePoint to) override
+	{
+		return std::unexpected("Service not available");
+	}
+};
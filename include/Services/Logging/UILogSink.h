@@ -4,13 +4,18 @@
 #include <spdlog/sinks/base_sink.h>
 #include <spdlog/details/log_msg.h>
 #include <spdlog/common.h>
+#include <map>
+#include <memory>
+#include <memory_resource>
 #include <mutex>
 #include <deque>
 #include <string>
+#include <string_view>
 
 struct UILogEntry
 {
-	std::string message;
+	std::shared_ptr<std::pmr::memory_resource> resource; // keeps message's resource alive, so it's declared first
+	std::pmr::string message;
 	spdlog::level::level_enum level;
 	std::chrono::system_clock::time_point timestamp;
 };
@@ -23,7 +28,17 @@ public:
 
 	void clearBuffer();
 
+	/// <summary>
+	/// Holds lines logged by the named logger in memory from resource, eg. a plugin's PluginMemoryAccount. A line the
+	/// resource refuses is dropped.
+	/// </summary>
+	void setMemoryResource(const std::string& loggerName, std::shared_ptr<std::pmr::memory_resource> resource);
+	void removeMemoryResource(const std::string& loggerName);
+
 protected:
 	void sink_it_(const spdlog::details::log_msg& msg) override;
 	void flush_() override;
-};
\ No newline at end of file
+
+private:
+	std::map<std::string, std::shared_ptr<std::pmr::memory_resource>, std::less<>> m_memoryResources;
+};
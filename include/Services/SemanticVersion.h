@@ -0,0 +1,61 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// <summary>
+/// major.minor.patch - a pre-release or build suffix is accepted and ignored
+/// </summary>
+struct SemanticVersion
+{
+	std::uint32_t major = 0;
+	std::uint32_t minor = 0;
+	std::uint32_t patch = 0;
+
+	/// <summary>
+	/// Parses "1", "1.2" or "1.2.3" (missing parts are 0), with an optional leading 'v'
+	/// </summary>
+	static std::expected<SemanticVersion, std::string> parse(std::string_view text);
+
+	[[nodiscard]] std::string toString() const;
+
+	auto operator<=>(const SemanticVersion&) const = default;
+};
+
+/// <summary>
+/// The versions a ServiceId::minVersion accepts. Comparators separated by spaces must all hold ("&gt;=1.2.0 &lt;2.0.0"),
+/// "||" separates alternatives. Also takes npm's shorthands: "^1.2" (same major), "~1.2.3" (same minor), "1.2.x", "*",
+/// and hyphen ranges, "1.2.3 - 2.3" being "&gt;=1.2.3 &lt;2.4.0". An empty range accepts anything.
+/// </summary>
+class VersionRange
+{
+public:
+	static std::expected<VersionRange, std::string> parse(std::string_view text);
+
+	[[nodiscard]] bool contains(const SemanticVersion& version) const;
+
+private:
+	enum class Operator
+	{
+		Less,
+		LessOrEqual,
+		GreaterOrEqual,
+		Equal
+	};
+
+	struct Comparator
+	{
+		Operator        op = Operator::GreaterOrEqual;
+		SemanticVersion version;
+	};
+
+	using ComparatorSet = std::vector<Comparator>; // all must hold
+
+	static std::expected<void, std::string> parseComparator(std::string_view text, ComparatorSet& comparators);
+
+	std::vector<ComparatorSet> m_alternatives; // any may hold, none means any version
+};
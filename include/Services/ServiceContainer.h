@@ -1,25 +1,89 @@
 #pragma once
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
 #include <unordered_map>
 #include <typeindex>
+#include <vector>
 
+#include "Services/SemanticVersion.h"
+
+/// <summary>
+/// Called after a service was registered, replaced or unregistered (service is null then). revision counts the changes
+/// to that type. Called on the thread that made the change, in the order they were made - it mustn't change the
+/// container itself.
+/// </summary>
+using ServiceChangedCallback = std::function<void(std::type_index type, const std::shared_ptr<void>& service, std::uint64_t revision)>;
+using ServiceSubscriptionId = std::uint64_t;
+
+// What a service is registered as unless it says otherwise - the version plugins' ServiceId::minVersion is checked against
+inline constexpr SemanticVersion defaultServiceVersion{1, 0, 0};
+
+/// <summary>
+/// The engine's services, by type. Thread-safe. A service can be swapped while plugins are using it - their contexts
+/// subscribe here and move their slots over, see PluginRuntimeContext.
+/// </summary>
 class ServiceContainer
 {
 public:
 
 	// Type-erased core methods
-	void registerServiceByType(std::type_index typeIdx, std::shared_ptr<void> service);
+	void registerServiceByType(std::type_index typeIdx, std::shared_ptr<void> service, SemanticVersion version = defaultServiceVersion);
 	void unregisterServiceByType(std::type_index typeIdx);
 	std::shared_ptr<void> getServiceByType(std::type_index typeIdx) const;
 	bool hasServiceByType(std::type_index tIdx) const;
+	bool hasServiceByTypeName(std::string_view typeName) const; // matches std::type_info::name(), for types known only by name
 	void clear();
 
+	/// <summary>
+	/// Swaps in a new instance of a service and tells the subscribers
+	/// </summary>
+	/// <returns>The instance it replaced, if any</returns>
+	std::shared_ptr<void> replaceServiceByType(std::type_index typeIdx, std::shared_ptr<void> service, SemanticVersion version = defaultServiceVersion);
+
+	/// <summary>
+	/// Unregisters the service only if it's still this instance - for a provider leaving after it was replaced
+	/// </summary>
+	bool withdrawServiceByType(std::type_index typeIdx, const void* instance);
+
+	/// <summary>
+	/// The version the registered service was registered as, none if it isn't registered
+	/// </summary>
+	std::optional<SemanticVersion> getServiceVersionByType(std::type_index typeIdx) const;
+	std::optional<SemanticVersion> getServiceVersionByTypeName(std::string_view typeName) const;
+
+	/// <summary>
+	/// Number of times the service was registered, replaced or unregistered
+	/// </summary>
+	std::uint64_t getServiceRevisionByType(std::type_index typeIdx) const;
+
+	/// <summary>
+	/// Subscribes to changes of every service, or of one type with subscribeByType
+	/// </summary>
+	ServiceSubscriptionId subscribe(ServiceChangedCallback callback);
+	ServiceSubscriptionId subscribeByType(std::type_index typeIdx, ServiceChangedCallback callback);
+
+	/// <summary>
+	/// Once it returns, the callback isn't running and won't be called again
+	/// </summary>
+	void unsubscribe(ServiceSubscriptionId id);
+
 
 		// Template wrapper for type safety
 	template<typename T>
-	void registerService(std::shared_ptr<T> service)
+	void registerService(std::shared_ptr<T> service, SemanticVersion version = defaultServiceVersion)
 	{
-		registerServiceByType(std::type_index(typeid(T)), service);
+		registerServiceByType(std::type_index(typeid(T)), service, version);
+	}
+
+	template<typename T>
+	std::shared_ptr<T> replaceService(std::shared_ptr<T> service, SemanticVersion version = defaultServiceVersion)
+	{
+		return std::static_pointer_cast<T>(replaceServiceByType(std::type_index(typeid(T)), std::move(service), version));
 	}
 
 	template<typename T>
@@ -44,6 +108,38 @@ public:
 		return existed;
 	}
 
+	template<typename T>
+	ServiceSubscriptionId subscribe(std::function<void(const std::shared_ptr<T>& service, std::uint64_t revision)> callback)
+	{
+		return subscribeByType(std::type_index(typeid(T)), [callback = std::move(callback)](std::type_index, const std::shared_ptr<void>& service, const std::uint64_t revision)
+		{
+			callback(std::static_pointer_cast<T>(service), revision);
+		});
+	}
+
 private:
-	std::unordered_map<std::type_index, std::shared_ptr<void>> m_services;
+	struct ServiceEntry
+	{
+		std::shared_ptr<void> service; // null once unregistered, the entry stays for its revision
+		SemanticVersion       version = defaultServiceVersion;
+		std::uint64_t         revision = 0;
+	};
+
+	struct Subscriber
+	{
+		ServiceSubscriptionId  id = 0;
+		bool                   isAllTypes = true;
+		std::type_index        type = typeid(void);
+		ServiceChangedCallback callback;
+	};
+
+	std::shared_ptr<void> setService(std::type_index typeIdx, std::shared_ptr<void> service, SemanticVersion version, const void* expected = nullptr);
+
+	mutable std::shared_mutex                        m_mutex;
+	std::unordered_map<std::type_index, ServiceEntry> m_services;
+
+	// Held across a change and its notifications, so subscribers see changes in order and unsubscribe can wait for them
+	std::recursive_mutex    m_changeMutex;
+	std::vector<Subscriber> m_subscribers;
+	ServiceSubscriptionId   m_nextSubscriptionId = 1;
 };
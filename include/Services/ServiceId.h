@@ -1,9 +1,20 @@
 #pragma once
 
+#include <string>
+#include <typeindex>
+
 struct ServiceId
 {
 	std::type_index type;
 	std::string     name;      // stable string id
 	std::string     minVersion; // semver-ish, e.g., ">=1.2.0"
 	bool            required{true};
-};
\ No newline at end of file
+};
+
+// A service a plugin registers for other plugins to require, see IPluginContext::provideService
+struct ProvidedService
+{
+	std::type_index type;
+	std::string     name;
+	std::string     version; // semver, e.g., "1.2.0"
+};
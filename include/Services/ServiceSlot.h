@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class ILogger;
+class IPluginRESTService;
+class IPluginUIService;
+
+/// <summary>
+/// Compile-time slot of the services every plugin context resolves when it's created. Any other service type gets a
+/// slot the first time it's asked for.
+/// </summary>
+inline constexpr std::size_t dynamicServiceSlot = static_cast<std::size_t>(-1);
+
+template<typename T>
+inline constexpr std::size_t serviceSlotIndex = dynamicServiceSlot;
+
+template<> inline constexpr std::size_t serviceSlotIndex<ILogger> = 0;
+template<> inline constexpr std::size_t serviceSlotIndex<IPluginRESTService> = 1;
+template<> inline constexpr std::size_t serviceSlotIndex<IPluginUIService> = 2;
+
+inline constexpr std::size_t fixedServiceSlotCount = 3;
+
+/// <summary>
+/// Holds one service for a plugin context. Readers take it without a lock; replacing it swaps the pointer and keeps the
+/// old instance alive until no call that could have picked it up is still in progress.
+/// </summary>
+/// <remarks>
+/// Everything a plugin calls is inline, so plugins needn't link the engine. A call costs an atomic increment and
+/// decrement of a reader count around the pointer load. The count is split into cache-line sized stripes and each thread
+/// keeps to one, so threads of the same plugin calling the same service don't contend on it; the writer adds them up.
+/// </remarks>
+class ServiceSlot
+{
+public:
+	ServiceSlot() = default;
+
+	ServiceSlot(const ServiceSlot&) = delete;
+	ServiceSlot& operator=(const ServiceSlot&) = delete;
+
+	// Reader side - every enter() must be matched by a leave() on the same thread once the pointer it returned is no
+	// longer used
+
+	[[nodiscard]] void* enter() const noexcept
+	{
+		m_readers[getReaderStripe()].count.fetch_add(1, std::memory_order_seq_cst);
+		return m_instance.load(std::memory_order_seq_cst);
+	}
+
+	void leave() const noexcept
+	{
+		m_readers[getReaderStripe()].count.fetch_sub(1, std::memory_order_release);
+	}
+
+	/// <summary>
+	/// The current instance, without protecting it against being replaced
+	/// </summary>
+	[[nodiscard]] void* peek() const noexcept
+	{
+		return m_instance.load(std::memory_order_acquire);
+	}
+
+	[[nodiscard]] bool isOccupied() const noexcept
+	{
+		return peek() != nullptr;
+	}
+
+	/// <summary>
+	/// Bumped on every store, so a reader can tell the service was replaced
+	/// </summary>
+	[[nodiscard]] std::uint64_t getVersion() const noexcept
+	{
+		return m_version.load(std::memory_order_acquire);
+	}
+
+	// Writer side - serialised by the owner (ServiceSlotTable)
+
+	void store(std::shared_ptr<void> service)
+	{
+		// Published before the reader count is checked, so a reader the check misses can only see the new instance
+		m_instance.store(service.get(), std::memory_order_seq_cst);
+		m_version.fetch_add(1, std::memory_order_acq_rel);
+
+		if (auto previous = std::exchange(m_owner, std::move(service)))
+		{
+			m_retired.push_back(std::move(previous));
+		}
+
+		collectRetired();
+	}
+
+	/// <summary>
+	/// Releases replaced instances if no call is in progress
+	/// </summary>
+	/// <returns>True if some are still waiting</returns>
+	bool collectRetired()
+	{
+		if (!m_retired.empty() && getReaderCount() == 0)
+		{
+			m_retired.clear();
+		}
+
+		return !m_retired.empty();
+	}
+
+	[[nodiscard]] const std::shared_ptr<void>& getShared() const
+	{
+		return m_owner;
+	}
+
+private:
+	static constexpr std::size_t readerStripeCount = 8;
+
+	struct alignas(64) ReaderStripe
+	{
+		std::atomic<std::uint32_t> count{0};
+	};
+
+	/// <summary>
+	/// The calling thread's stripe - threads are dealt out round robin as they first call a service
+	/// </summary>
+	static std::size_t getReaderStripe() noexcept
+	{
+		static std::atomic<std::size_t> nextStripe{0};
+		thread_local const std::size_t stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % readerStripeCount;
+		return stripe;
+	}
+
+	[[nodiscard]] std::uint32_t getReaderCount() const noexcept
+	{
+		std::uint32_t readers = 0;
+		for (const ReaderStripe& stripe : m_readers)
+		{
+			readers += stripe.count.load(std::memory_order_seq_cst);
+		}
+
+		return readers;
+	}
+
+	mutable std::array<ReaderStripe, readerStripeCount> m_readers;
+	std::atomic<void*>                                  m_instance{nullptr};
+	std::atomic<std::uint64_t>                          m_version{0};
+
+	std::shared_ptr<void>              m_owner;
+	std::vector<std::shared_ptr<void>> m_retired;
+};
+
+/// <summary>
+/// A plugin context's services - a fixed array for the compile-time slots, a map for the rest. Slots are never removed
+/// or moved, so a ServiceHandle stays valid for as long as the table.
+/// </summary>
+class ServiceSlotTable
+{
+public:
+	[[nodiscard]] ServiceSlot&       getFixedSlot(std::size_t slotIndex);
+	[[nodiscard]] ServiceSlot&       getSlot(std::type_index type, std::size_t slotIndex); // creates a dynamic one
+	[[nodiscard]] const ServiceSlot* findSlot(std::type_index type, std::size_t slotIndex) const;
+
+	/// <summary>
+	/// Stores the service in its slot, or empties the slot if it's null
+	/// </summary>
+	void store(std::type_index type, std::size_t slotIndex, std::shared_ptr<void> service);
+
+	/// <summary>
+	/// Fills the slot only if it's empty
+	/// </summary>
+	/// <returns>The slot</returns>
+	ServiceSlot& storeIfEmpty(std::type_index type, std::size_t slotIndex, std::shared_ptr<void> service);
+
+	/// <summary>
+	/// Releases replaced services no call is using any more
+	/// </summary>
+	void collectRetired();
+
+	[[nodiscard]] bool hasRetired() const noexcept
+	{
+		return m_hasRetired.load(std::memory_order_relaxed);
+	}
+
+private:
+	ServiceSlot& getSlotLocked(std::type_index type, std::size_t slotIndex);
+
+	std::array<ServiceSlot, fixedServiceSlotCount> m_fixed;
+
+	mutable std::mutex                                                m_mutex; // writers only
+	std::unordered_map<std::type_index, std::unique_ptr<ServiceSlot>> m_dynamic;
+	std::atomic_bool                                                  m_hasRetired{false};
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+#include <typeindex>
+#include <variant>
+#include <vector>
+
+#include "DataPacket/DataPacket.h"
+#include "DataPacket/PacketSchema.h"
+
+/// <summary>
+/// One field's values, a row per stored packet
+/// </summary>
+struct TimeSeriesColumn
+{
+	std::string     name;
+	PacketFieldKind kind;
+
+	// Integers, bools and timestamps (nanoseconds since epoch) as int64 - a UInt64 keeps its bits. Floats as double.
+	std::variant<std::vector<std::int64_t>, std::vector<double>, std::vector<std::string>> values;
+};
+
+/// <summary>
+/// Stored packets of one type, column by column in the order they were stored
+/// </summary>
+struct TimeSeriesRange
+{
+	std::string                   schemaName;
+	std::vector<std::int64_t>     timestampsNs; // the packets' own, system_clock since epoch
+	std::vector<TimeSeriesColumn> columns;      // the schema's fields, in its order
+
+	[[nodiscard]] std::size_t getRowCount() const { return timestampsNs.size(); }
+};
+
+/// <summary>
+/// Keeps the packets of selected types on disk and answers time range queries over them - provided by the TimeSeriesStore
+/// plugin. Types are picked by their packet schema's name (VECTORIUM_PACKET_SCHEMA), so only types with a schema can be
+/// stored.
+/// </summary>
+class ITimeSeriesStore
+{
+public:
+	using TimePoint = std::chrono::system_clock::time_point;
+
+	virtual ~ITimeSeriesStore() = default;
+
+	/// <summary>
+	/// Starts storing the type with this schema name. Its packets are picked up once the plugin dispatching them has
+	/// registered the schema. What's already on disk for it can be queried straight away.
+	/// </summary>
+	virtual bool                                   track(std::string_view schemaName) = 0;
+	[[nodiscard]] virtual std::vector<std::string> getTrackedSchemas() const = 0;
+
+	/// <summary>
+	/// The stored packets timestamped in [from, to). Packets dispatched since the store's last tick aren't in it yet.
+	/// </summary>
+	virtual std::expected<TimeSeriesRange, std::string> query(std::string_view schemaName, TimePoint from, TimePoint to) = 0;
+
+	/// <summary>
+	/// The same, decoded back into packets with their stored timestamps - needs the type's schema registered
+	/// </summary>
+	virtual std::expected<std::vector<DataPacket>, std::string> queryPackets(std::type_index packetType, TimePoint from, TimePoint to) = 0;
+
+	template<HasPacketSchema T>
+	std::expected<TimeSeriesRange, std::string> query(TimePoint from, TimePoint to)
+	{
+		return query(PacketSchema<T>::name, from, to);
+	}
+
+	template<HasPacketSchema T>
+	std::expected<std::vector<DataPacket>, std::string> queryPackets(TimePoint from, TimePoint to)
+	{
+		return queryPackets(typeid(T), from, to);
+	}
+};
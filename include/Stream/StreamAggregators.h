@@ -0,0 +1,569 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+/// <summary>
+/// Incremental aggregators for the stream windows (StreamWindows.h). Each takes values one at a time with add() or a
+/// run at a time with addBatch(), and two of them merge into the aggregate of both - which is how sliding windows are
+/// built from panes, and sessions joined. Values come with the timestamp they're keyed by, in nanoseconds since epoch.
+/// Not thread-safe.
+/// </summary>
+namespace Stream
+{
+	template<typename A>
+	concept Aggregator = std::copyable<A> && requires(A aggregator, const A& other, std::int64_t timestampNs, double value,
+	                                                  std::span<const std::int64_t> timestampsNs, std::span<const double> values)
+	{
+		typename A::Result;
+		aggregator.add(timestampNs, value);
+		aggregator.addBatch(timestampsNs, values);
+		aggregator.merge(other);
+		{ other.getResult() } -> std::convertible_to<typename A::Result>;
+		{ other.getCount() } -> std::convertible_to<std::uint64_t>;
+	};
+
+	/// <summary>
+	/// The loops the batches run through. Each keeps independent lanes, or compares without branching, so they
+	/// vectorise without -ffast-math.
+	/// </summary>
+	/// <remarks>
+	/// The lanes add the values in another order than add() one at a time would, so a Sum, Mean or Variance built with
+	/// addBatch() is equal to one built with add() up to rounding, not bit for bit. Min and Max are exact.
+	/// </remarks>
+	namespace BatchKernels
+	{
+		inline double sum(std::span<const double> values)
+		{
+			double      lanes[4] = {};
+			std::size_t i = 0;
+			for (; i + 4 <= values.size(); i += 4)
+			{
+				lanes[0] += values[i];
+				lanes[1] += values[i + 1];
+				lanes[2] += values[i + 2];
+				lanes[3] += values[i + 3];
+			}
+
+			double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+			for (; i < values.size(); ++i)
+			{
+				total += values[i];
+			}
+
+			return total;
+		}
+
+		inline double sumOfSquaredDeviations(std::span<const double> values, double mean)
+		{
+			double      lanes[4] = {};
+			std::size_t i = 0;
+			for (; i + 4 <= values.size(); i += 4)
+			{
+				for (std::size_t lane = 0; lane < 4; ++lane)
+				{
+					const double deviation = values[i + lane] - mean;
+					lanes[lane] += deviation * deviation;
+				}
+			}
+
+			double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+			for (; i < values.size(); ++i)
+			{
+				total += (values[i] - mean) * (values[i] - mean);
+			}
+
+			return total;
+		}
+
+		inline double min(std::span<const double> values, double initial)
+		{
+			double result = initial;
+			for (const double value : values)
+			{
+				result = value < result ? value : result;
+			}
+
+			return result;
+		}
+
+		inline double max(std::span<const double> values, double initial)
+		{
+			double result = initial;
+			for (const double value : values)
+			{
+				result = value > result ? value : result;
+			}
+
+			return result;
+		}
+	}
+
+	class Sum
+	{
+	public:
+		using Result = double;
+
+		void add(std::int64_t, double value)
+		{
+			m_sum += value;
+			++m_count;
+		}
+
+		void addBatch(std::span<const std::int64_t>, std::span<const double> values)
+		{
+			m_sum += BatchKernels::sum(values);
+			m_count += values.size();
+		}
+
+		void merge(const Sum& other)
+		{
+			m_sum += other.m_sum;
+			m_count += other.m_count;
+		}
+
+		[[nodiscard]] Result        getResult() const { return m_sum; }
+		[[nodiscard]] std::uint64_t getCount() const { return m_count; }
+
+	private:
+		double        m_sum = 0;
+		std::uint64_t m_count = 0;
+	};
+
+	class Min
+	{
+	public:
+		using Result = double;
+
+		void add(std::int64_t, double value)
+		{
+			m_min = value < m_min ? value : m_min;
+			++m_count;
+		}
+
+		void addBatch(std::span<const std::int64_t>, std::span<const double> values)
+		{
+			m_min = BatchKernels::min(values, m_min);
+			m_count += values.size();
+		}
+
+		void merge(const Min& other)
+		{
+			m_min = std::min(m_min, other.m_min);
+			m_count += other.m_count;
+		}
+
+		[[nodiscard]] Result        getResult() const { return m_min; } // infinity while empty
+		[[nodiscard]] std::uint64_t getCount() const { return m_count; }
+
+	private:
+		double        m_min = std::numeric_limits<double>::infinity();
+		std::uint64_t m_count = 0;
+	};
+
+	class Max
+	{
+	public:
+		using Result = double;
+
+		void add(std::int64_t, double value)
+		{
+			m_max = value > m_max ? value : m_max;
+			++m_count;
+		}
+
+		void addBatch(std::span<const std::int64_t>, std::span<const double> values)
+		{
+			m_max = BatchKernels::max(values, m_max);
+			m_count += values.size();
+		}
+
+		void merge(const Max& other)
+		{
+			m_max = std::max(m_max, other.m_max);
+			m_count += other.m_count;
+		}
+
+		[[nodiscard]] Result        getResult() const { return m_max; } // -infinity while empty
+		[[nodiscard]] std::uint64_t getCount() const { return m_count; }
+
+	private:
+		double        m_max = -std::numeric_limits<double>::infinity();
+		std::uint64_t m_count = 0;
+	};
+
+	class Mean
+	{
+	public:
+		using Result = double;
+
+		void add(std::int64_t timestampNs, double value) { m_sum.add(timestampNs, value); }
+		void addBatch(std::span<const std::int64_t> timestampsNs, std::span<const double> values) { m_sum.addBatch(timestampsNs, values); }
+		void merge(const Mean& other) { m_sum.merge(other.m_sum); }
+
+		[[nodiscard]] Result getResult() const // NaN while empty
+		{
+			return getCount() != 0 ? m_sum.getResult() / static_cast<double>(getCount()) : std::numeric_limits<double>::quiet_NaN();
+		}
+
+		[[nodiscard]] std::uint64_t getCount() const { return m_sum.getCount(); }
+
+	private:
+		Sum m_sum;
+	};
+
+	/// <summary>
+	/// Sample variance, kept as a count, mean and sum of squared deviations - Welford's update one at a time, and Chan's
+	/// to add a batch or merge, so it stays accurate where the values are large and close together
+	/// </summary>
+	class Variance
+	{
+	public:
+		using Result = double;
+
+		void add(std::int64_t, double value)
+		{
+			++m_count;
+			const double delta = value - m_mean;
+			m_mean += delta / static_cast<double>(m_count);
+			m_squaredDeviations += delta * (value - m_mean);
+		}
+
+		void addBatch(std::span<const std::int64_t>, std::span<const double> values)
+		{
+			if (values.empty())
+			{
+				return;
+			}
+
+			const double mean = BatchKernels::sum(values) / static_cast<double>(values.size());
+			combine(values.size(), mean, BatchKernels::sumOfSquaredDeviations(values, mean));
+		}
+
+		void merge(const Variance& other) { combine(other.m_count, other.m_mean, other.m_squaredDeviations); }
+
+		[[nodiscard]] Result getResult() const // 0 until there are two values
+		{
+			return m_count > 1 ? m_squaredDeviations / static_cast<double>(m_count - 1) : 0.0;
+		}
+
+		[[nodiscard]] double        getMean() const { return m_mean; }
+		[[nodiscard]] double        getStandardDeviation() const { return std::sqrt(getResult()); }
+		[[nodiscard]] std::uint64_t getCount() const { return m_count; }
+
+	private:
+		void combine(std::uint64_t count, double mean, double squaredDeviations)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			const std::uint64_t total = m_count + count;
+			const double        delta = mean - m_mean;
+			m_squaredDeviations += squaredDeviations + delta * delta * static_cast<double>(m_count) * static_cast<double>(count) / static_cast<double>(total);
+			m_mean += delta * static_cast<double>(count) / static_cast<double>(total);
+			m_count = total;
+		}
+
+		std::uint64_t m_count = 0;
+		double        m_mean = 0;
+		double        m_squaredDeviations = 0;
+	};
+
+	struct OhlcBar
+	{
+		double open = 0;
+		double high = 0;
+		double low = 0;
+		double close = 0;
+	};
+
+	/// <summary>
+	/// Open and close are the values with the earliest and latest timestamps, rather than the first and last to arrive,
+	/// so late values land where they belong. Of values timestamped alike, the first to arrive opens and the last closes.
+	/// </summary>
+	class Ohlc
+	{
+	public:
+		using Result = OhlcBar;
+
+		void add(std::int64_t timestampNs, double value)
+		{
+			if (timestampNs < m_openNs)
+			{
+				m_openNs = timestampNs;
+				m_bar.open = value;
+			}
+
+			if (timestampNs >= m_closeNs)
+			{
+				m_closeNs = timestampNs;
+				m_bar.close = value;
+			}
+
+			m_bar.high = m_count == 0 || value > m_bar.high ? value : m_bar.high;
+			m_bar.low = m_count == 0 || value < m_bar.low ? value : m_bar.low;
+			++m_count;
+		}
+
+		void addBatch(std::span<const std::int64_t> timestampsNs, std::span<const double> values)
+		{
+			if (values.empty())
+			{
+				return;
+			}
+
+			// Usually in order already, so both are found in one pass without a branch mispredicted
+			std::size_t first = 0;
+			std::size_t last = 0;
+			for (std::size_t i = 1; i < timestampsNs.size(); ++i)
+			{
+				first = timestampsNs[i] < timestampsNs[first] ? i : first;
+				last = timestampsNs[i] >= timestampsNs[last] ? i : last;
+			}
+
+			const double high = BatchKernels::max(values, values[0]);
+			const double low = BatchKernels::min(values, values[0]);
+
+			Ohlc batch;
+			batch.m_bar = OhlcBar{ .open = values[first], .high = high, .low = low, .close = values[last] };
+			batch.m_openNs = timestampsNs[first];
+			batch.m_closeNs = timestampsNs[last];
+			batch.m_count = values.size();
+			merge(batch);
+		}
+
+		void merge(const Ohlc& other)
+		{
+			if (other.m_count == 0)
+			{
+				return;
+			}
+
+			if (m_count == 0)
+			{
+				*this = other;
+				return;
+			}
+
+			if (other.m_openNs < m_openNs)
+			{
+				m_openNs = other.m_openNs;
+				m_bar.open = other.m_bar.open;
+			}
+
+			if (other.m_closeNs >= m_closeNs)
+			{
+				m_closeNs = other.m_closeNs;
+				m_bar.close = other.m_bar.close;
+			}
+
+			m_bar.high = std::max(m_bar.high, other.m_bar.high);
+			m_bar.low = std::min(m_bar.low, other.m_bar.low);
+			m_count += other.m_count;
+		}
+
+		[[nodiscard]] Result        getResult() const { return m_bar; }
+		[[nodiscard]] std::uint64_t getCount() const { return m_count; }
+
+	private:
+		OhlcBar       m_bar;
+		std::int64_t  m_openNs = std::numeric_limits<std::int64_t>::max();
+		std::int64_t  m_closeNs = std::numeric_limits<std::int64_t>::min();
+		std::uint64_t m_count = 0;
+	};
+
+	/// <summary>
+	/// Estimates quantiles to within a relative error, from a histogram with logarithmically sized buckets (DDSketch).
+	/// Merging two is adding their buckets, so a window's quantiles are exact to the same error however it was built.
+	/// The result is the sketch, ask it for the quantiles wanted.
+	/// </summary>
+	/// <remarks>
+	/// Values closer to 0 than minIndexableValue count as 0, and infinities and NaN aren't counted. Past maxBuckets buckets
+	/// for either sign, the buckets nearest 0 are folded together, so only the smallest magnitudes lose accuracy.
+	/// </remarks>
+	class QuantileSketch
+	{
+	public:
+		using Result = QuantileSketch;
+
+		explicit QuantileSketch(double relativeAccuracy = 0.01, std::size_t maxBuckets = 2048)
+			: m_gamma((1 + relativeAccuracy) / (1 - relativeAccuracy))
+			, m_inverseLogGamma(1 / std::log(m_gamma))
+			, m_maxBuckets(std::max<std::size_t>(maxBuckets, 1))
+		{
+		}
+
+		void add(std::int64_t, double value)
+		{
+			// An infinity has no bucket, and NaN no order
+			if (!std::isfinite(value))
+			{
+				return;
+			}
+
+			if (value > minIndexableValue)
+			{
+				m_positive.add(getIndex(value), 1, m_maxBuckets);
+			}
+			else if (value < -minIndexableValue)
+			{
+				m_negative.add(getIndex(-value), 1, m_maxBuckets);
+			}
+			else
+			{
+				++m_zeroCount;
+			}
+
+			++m_count;
+		}
+
+		void addBatch(std::span<const std::int64_t> timestampsNs, std::span<const double> values)
+		{
+			for (std::size_t i = 0; i < values.size(); ++i)
+			{
+				add(timestampsNs[i], values[i]);
+			}
+		}
+
+		/// <summary>
+		/// Adds the other's counts - it's only accurate to this sketch's error if both were made alike
+		/// </summary>
+		void merge(const QuantileSketch& other)
+		{
+			m_positive.merge(other.m_positive, m_maxBuckets);
+			m_negative.merge(other.m_negative, m_maxBuckets);
+			m_zeroCount += other.m_zeroCount;
+			m_count += other.m_count;
+		}
+
+		/// <summary>
+		/// The value at quantile q in [0, 1], NaN while empty
+		/// </summary>
+		[[nodiscard]] double getQuantile(double q) const
+		{
+			if (m_count == 0)
+			{
+				return std::numeric_limits<double>::quiet_NaN();
+			}
+
+			const auto rank = static_cast<std::uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(m_count - 1));
+			std::uint64_t seen = 0;
+
+			// Most negative first
+			for (std::size_t i = m_negative.counts.size(); i-- > 0;)
+			{
+				seen += m_negative.counts[i];
+				if (seen > rank)
+				{
+					return -getValue(m_negative.offset + static_cast<std::int32_t>(i));
+				}
+			}
+
+			seen += m_zeroCount;
+			if (seen > rank)
+			{
+				return 0;
+			}
+
+			for (std::size_t i = 0; i < m_positive.counts.size(); ++i)
+			{
+				seen += m_positive.counts[i];
+				if (seen > rank)
+				{
+					return getValue(m_positive.offset + static_cast<std::int32_t>(i));
+				}
+			}
+
+			return getValue(m_positive.offset + static_cast<std::int32_t>(m_positive.counts.size()) - 1);
+		}
+
+		[[nodiscard]] const QuantileSketch& getResult() const { return *this; }
+		[[nodiscard]] std::uint64_t         getCount() const { return m_count; }
+
+		static constexpr double minIndexableValue = 1e-300;
+
+	private:
+		// Counts of consecutive bucket indices, from offset
+		struct Buckets
+		{
+			std::vector<std::uint64_t> counts;
+			std::int32_t               offset = 0;
+
+			void add(std::int32_t index, std::uint64_t count, std::size_t maxBuckets)
+			{
+				if (counts.empty())
+				{
+					offset = index;
+					counts.push_back(count);
+					return;
+				}
+
+				// The range kept once the index is in, at most maxBuckets wide
+				const std::int64_t high = std::max<std::int64_t>(index, offset + static_cast<std::int64_t>(counts.size()) - 1);
+				const std::int64_t low = std::max<std::int64_t>(std::min<std::int64_t>(index, offset), high - static_cast<std::int64_t>(maxBuckets) + 1);
+
+				// Buckets below it are folded into its lowest before growing, so a far away index never makes all the ones between
+				std::uint64_t folded = 0;
+				if (low > offset)
+				{
+					const std::size_t excess = std::min(counts.size(), static_cast<std::size_t>(low - offset));
+					for (std::size_t i = 0; i < excess; ++i)
+					{
+						folded += counts[i];
+					}
+
+					counts.erase(counts.begin(), counts.begin() + static_cast<std::ptrdiff_t>(excess));
+				}
+				else if (low < offset)
+				{
+					counts.insert(counts.begin(), static_cast<std::size_t>(offset - low), 0);
+				}
+
+				offset = static_cast<std::int32_t>(low);
+				counts.resize(static_cast<std::size_t>(high - low) + 1, 0);
+				counts.front() += folded;
+				counts[static_cast<std::size_t>(std::max<std::int64_t>(index, low) - low)] += count;
+			}
+
+			void merge(const Buckets& other, std::size_t maxBuckets)
+			{
+				for (std::size_t i = 0; i < other.counts.size(); ++i)
+				{
+					if (other.counts[i] != 0)
+					{
+						add(other.offset + static_cast<std::int32_t>(i), other.counts[i], maxBuckets);
+					}
+				}
+			}
+		};
+
+		[[nodiscard]] std::int32_t getIndex(double magnitude) const
+		{
+			// Clamped so it fits whatever the accuracy - a very fine one puts the largest doubles past an int32
+			constexpr double maxIndex = 1 << 30;
+			return static_cast<std::int32_t>(std::clamp(std::ceil(std::log(magnitude) * m_inverseLogGamma), -maxIndex, maxIndex));
+		}
+
+		// The middle of the bucket, by relative error
+		[[nodiscard]] double getValue(std::int32_t index) const
+		{
+			return 2 * std::pow(m_gamma, index) / (m_gamma + 1);
+		}
+
+		double        m_gamma;
+		double        m_inverseLogGamma;
+		std::size_t   m_maxBuckets;
+		Buckets       m_positive;
+		Buckets       m_negative;
+		std::uint64_t m_zeroCount = 0;
+		std::uint64_t m_count = 0;
+	};
+}
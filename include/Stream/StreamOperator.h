@@ -0,0 +1,158 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "DataPacket/DataPacket.h"
+#include "DataPacket/IDataPacketHandler.h"
+#include "Plugin/IPluginContext.h"
+#include "Stream/StreamWindows.h"
+
+namespace Stream
+{
+	template<typename W>
+	concept Window = requires(W window, std::int64_t timestampNs, double value, std::span<const std::int64_t> timestampsNs,
+	                          std::span<const double> values, std::vector<typename W::Result>& closed)
+	{
+		window.add(timestampNs, value, closed);
+		window.addBatch(timestampsNs, values, closed);
+		window.advanceWatermark(timestampNs, closed);
+		window.flush(closed);
+	};
+
+	/// <summary>
+	/// Windows the packets of type In a plugin gets, and dispatches a packet of type Out for each window that closes,
+	/// timestamped at its end. Thread-safe.
+	/// </summary>
+	/// <remarks>
+	/// eg. one minute bars from ticks:
+	///		auto bars = std::make_shared<Stream::WindowedPacketOperator<Tick, Stream::TumblingWindow<Stream::Ohlc>, Bar>>(
+	///			context, Stream::TumblingWindow<Stream::Ohlc>(std::chrono::minutes(1), std::chrono::seconds(5)),
+	///			[](const Tick& tick) { return tick.price; },
+	///			[](const auto& window) { return Bar{ window.value.open, window.value.high, window.value.low, window.value.close }; });
+	///		context.registerHandlerForType(typeid(Tick), bars);
+	/// Out's schema is registered if it has one, so the bars can be recorded and stored like any other packet. Windows
+	/// are dispatched in the order they closed, after the operator's lock is let go of: one thread at a time dispatches,
+	/// and windows closed meanwhile by other threads (or by a handler feeding back into this one) are left for it to
+	/// dispatch next, rather than waited on.
+	/// </remarks>
+	template<typename In, Window W, typename Out>
+	class WindowedPacketOperator final : public IDataPacketHandler
+	{
+	public:
+		using Result = typename W::Result;
+		using Extract = std::function<double(const In&)>;
+		using Emit = std::function<Out(const Result&)>;
+
+		WindowedPacketOperator(IPluginContext& context, W window, Extract extract, Emit emit)
+			: m_context(context)
+			, m_window(std::move(window))
+			, m_extract(std::move(extract))
+			, m_emit(std::move(emit))
+		{
+			if constexpr (HasPacketSchema<Out>)
+			{
+				m_context.registerPacketSchema<Out>();
+			}
+		}
+
+		bool handle(const DataPacket& packet) override
+		{
+			if (packet.payloadType != typeid(In))
+			{
+				return false;
+			}
+
+			const double       value = m_extract(*static_cast<const In*>(packet.payload.get()));
+			const std::int64_t timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(packet.timestamp.time_since_epoch()).count();
+
+			std::unique_lock lock(m_mutex);
+			m_window.add(timestampNs, value, m_closed);
+			dispatchClosed(std::move(lock));
+			return true;
+		}
+
+		/// <summary>
+		/// Closes the windows ending by then - eg. from the plugin's tick with the time now less some lateness, so a stream
+		/// that stops doesn't hold its last window back
+		/// </summary>
+		void advanceWatermark(std::chrono::system_clock::time_point watermark)
+		{
+			std::unique_lock lock(m_mutex);
+			m_window.advanceWatermark(std::chrono::duration_cast<std::chrono::nanoseconds>(watermark.time_since_epoch()).count(), m_closed);
+			dispatchClosed(std::move(lock));
+		}
+
+		/// <summary>
+		/// Closes every window - from the plugin's onPluginUnload. If another thread is still dispatching, the windows are
+		/// left for it.
+		/// </summary>
+		void flush()
+		{
+			std::unique_lock lock(m_mutex);
+			m_window.flush(m_closed);
+			dispatchClosed(std::move(lock));
+		}
+
+	private:
+		// Takes m_mutex held, with what just closed in m_closed
+		void dispatchClosed(std::unique_lock<std::mutex> lock)
+		{
+			if (m_isDispatching || m_closed.empty())
+			{
+				return;
+			}
+
+			m_isDispatching = true;
+			try
+			{
+				while (!m_closed.empty())
+				{
+					std::vector<Result> closed;
+					std::swap(closed, m_closed);
+
+					lock.unlock();
+					dispatch(closed);
+					lock.lock();
+				}
+			}
+			catch (...)
+			{
+				if (!lock.owns_lock())
+				{
+					lock.lock();
+				}
+				m_isDispatching = false;
+				throw;
+			}
+
+			m_isDispatching = false;
+		}
+
+		void dispatch(const std::vector<Result>& closed)
+		{
+			for (const Result& result : closed)
+			{
+				DataPacket packet = m_context.makePacket<Out>(m_emit(result));
+				packet.timestamp = std::chrono::system_clock::time_point(
+					std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(result.endNs)));
+				m_context.dispatch(packet);
+			}
+		}
+
+		IPluginContext& m_context;
+		std::mutex      m_mutex;
+		W               m_window;
+		Extract         m_extract;
+		Emit            m_emit;
+
+		std::vector<Result> m_closed;        // closed and not dispatched yet, oldest first
+		bool                m_isDispatching = false; // a thread is dispatching m_closed
+	};
+}
@@ -0,0 +1,466 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Stream/StreamAggregators.h"
+
+/// <summary>
+/// Windows over a stream of timestamped values, aggregated as they arrive (StreamAggregators.h). Timestamps are the
+/// packets', in nanoseconds since epoch, and needn't arrive in order.
+/// </summary>
+/// <remarks>
+/// A window closes, and is appended to the caller's closed results, once the watermark passes its end. The watermark
+/// trails the latest timestamp seen by allowedLateness, or is moved on with advanceWatermark - eg. from a plugin's tick
+/// while a stream is quiet. A value for a window that has closed already is late: it's dropped, and counted. Not
+/// thread-safe.
+/// </remarks>
+namespace Stream
+{
+	template<typename R>
+	struct WindowResult
+	{
+		std::int64_t  startNs; // [startNs, endNs)
+		std::int64_t  endNs;
+		std::uint64_t count;
+		R             value;
+	};
+
+	/// <summary>
+	/// The watermark every window keeps
+	/// </summary>
+	class Watermark
+	{
+	public:
+		explicit Watermark(std::chrono::nanoseconds allowedLateness)
+			: m_allowedLatenessNs(std::max<std::int64_t>(allowedLateness.count(), 0))
+		{
+		}
+
+		void observe(std::int64_t timestampNs)
+		{
+			if (timestampNs - m_allowedLatenessNs > m_watermarkNs)
+			{
+				m_watermarkNs = timestampNs - m_allowedLatenessNs;
+			}
+		}
+
+		void advanceTo(std::int64_t watermarkNs) { m_watermarkNs = std::max(m_watermarkNs, watermarkNs); }
+
+		[[nodiscard]] std::int64_t get() const { return m_watermarkNs; }
+
+	private:
+		std::int64_t m_allowedLatenessNs;
+		std::int64_t m_watermarkNs = std::numeric_limits<std::int64_t>::min();
+	};
+
+	namespace WindowDetail
+	{
+		// The start of the window of this size holding the timestamp, windows starting at multiples of the size
+		inline std::int64_t alignDown(std::int64_t timestampNs, std::int64_t sizeNs)
+		{
+			const std::int64_t remainder = timestampNs % sizeNs;
+			return timestampNs - (remainder < 0 ? remainder + sizeNs : remainder);
+		}
+
+		inline std::int64_t maxOf(std::span<const std::int64_t> timestampsNs)
+		{
+			std::int64_t result = std::numeric_limits<std::int64_t>::min();
+			for (const std::int64_t timestampNs : timestampsNs)
+			{
+				result = timestampNs > result ? timestampNs : result;
+			}
+
+			return result;
+		}
+	}
+
+	/// <summary>
+	/// Back to back windows of a fixed size, eg. one minute bars
+	/// </summary>
+	template<Aggregator A>
+	class TumblingWindow
+	{
+	public:
+		using Result = WindowResult<typename A::Result>;
+
+		/// <param name="prototype">What each window starts as - for aggregators that take settings</param>
+		explicit TumblingWindow(std::chrono::nanoseconds size, std::chrono::nanoseconds allowedLateness = {}, A prototype = {})
+			: m_sizeNs(std::max<std::int64_t>(size.count(), 1))
+			, m_watermark(allowedLateness)
+			, m_prototype(std::move(prototype))
+		{
+		}
+
+		/// <returns>False if the value was late</returns>
+		bool add(std::int64_t timestampNs, double value, std::vector<Result>& closed)
+		{
+			const std::int64_t startNs = WindowDetail::alignDown(timestampNs, m_sizeNs);
+			if (startNs + m_sizeNs <= m_watermark.get())
+			{
+				++m_lateCount;
+				return false;
+			}
+
+			getWindow(startNs).add(timestampNs, value);
+			m_watermark.observe(timestampNs);
+			close(closed);
+			return true;
+		}
+
+		/// <summary>
+		/// Adds each run of values falling in the same window with a single addBatch
+		/// </summary>
+		void addBatch(std::span<const std::int64_t> timestampsNs, std::span<const double> values, std::vector<Result>& closed)
+		{
+			const std::size_t count = std::min(timestampsNs.size(), values.size());
+			for (std::size_t first = 0; first < count;)
+			{
+				const std::int64_t startNs = WindowDetail::alignDown(timestampsNs[first], m_sizeNs);
+				const std::int64_t endNs = startNs + m_sizeNs;
+
+				std::size_t last = first + 1;
+				while (last < count && timestampsNs[last] >= startNs && timestampsNs[last] < endNs)
+				{
+					++last;
+				}
+
+				// Nothing in the run can move the watermark past the window's end, so it's late whole or not at all
+				if (endNs <= m_watermark.get())
+				{
+					m_lateCount += last - first;
+				}
+				else
+				{
+					const auto runTimestamps = timestampsNs.subspan(first, last - first);
+					getWindow(startNs).addBatch(runTimestamps, values.subspan(first, last - first));
+					m_watermark.observe(WindowDetail::maxOf(runTimestamps));
+				}
+
+				first = last;
+			}
+
+			close(closed);
+		}
+
+		void advanceWatermark(std::int64_t watermarkNs, std::vector<Result>& closed)
+		{
+			m_watermark.advanceTo(watermarkNs);
+			close(closed);
+		}
+
+		/// <summary>
+		/// Closes every window, eg. when the stream ends
+		/// </summary>
+		void flush(std::vector<Result>& closed)
+		{
+			advanceWatermark(std::numeric_limits<std::int64_t>::max(), closed);
+		}
+
+		[[nodiscard]] std::int64_t  getWatermarkNs() const { return m_watermark.get(); }
+		[[nodiscard]] std::uint64_t getLateCount() const { return m_lateCount; }
+
+	private:
+		A& getWindow(std::int64_t startNs)
+		{
+			// Values mostly land in the newest window
+			if (!m_windows.empty() && std::prev(m_windows.end())->first == startNs)
+			{
+				return std::prev(m_windows.end())->second;
+			}
+
+			return m_windows.try_emplace(startNs, m_prototype).first->second;
+		}
+
+		void close(std::vector<Result>& closed)
+		{
+			while (!m_windows.empty() && m_windows.begin()->first + m_sizeNs <= m_watermark.get())
+			{
+				auto& [startNs, aggregator] = *m_windows.begin();
+				closed.push_back(Result{ .startNs = startNs, .endNs = startNs + m_sizeNs, .count = aggregator.getCount(), .value = aggregator.getResult() });
+				m_windows.erase(m_windows.begin());
+			}
+		}
+
+		std::int64_t                m_sizeNs;
+		Watermark                   m_watermark;
+		A                           m_prototype;
+		std::map<std::int64_t, A>   m_windows; // open, by start
+		std::uint64_t               m_lateCount = 0;
+	};
+
+	/// <summary>
+	/// Windows of a fixed size starting every slide, eg. a five minute moving average each minute. Values are aggregated
+	/// into panes a slide long, and each window merges its panes as it closes, so a value is added once however many
+	/// windows it's in. Windows without values aren't emitted.
+	/// </summary>
+	template<Aggregator A>
+	class SlidingWindow
+	{
+	public:
+		using Result = WindowResult<typename A::Result>;
+
+		/// <param name="size">Rounded up to a whole number of slides</param>
+		SlidingWindow(std::chrono::nanoseconds size, std::chrono::nanoseconds slide, std::chrono::nanoseconds allowedLateness = {}, A prototype = {})
+			: m_slideNs(std::max<std::int64_t>(slide.count(), 1))
+			, m_sizeNs((std::max<std::int64_t>(size.count(), 1) + m_slideNs - 1) / m_slideNs * m_slideNs)
+			, m_watermark(allowedLateness)
+			, m_prototype(std::move(prototype))
+		{
+		}
+
+		/// <returns>False if the value was late</returns>
+		bool add(std::int64_t timestampNs, double value, std::vector<Result>& closed)
+		{
+			const std::int64_t paneNs = WindowDetail::alignDown(timestampNs, m_slideNs);
+			if (isLate(paneNs))
+			{
+				++m_lateCount;
+				return false;
+			}
+
+			getPane(paneNs).add(timestampNs, value);
+			m_watermark.observe(timestampNs);
+			close(closed);
+			return true;
+		}
+
+		/// <summary>
+		/// Adds each run of values falling in the same pane with a single addBatch
+		/// </summary>
+		void addBatch(std::span<const std::int64_t> timestampsNs, std::span<const double> values, std::vector<Result>& closed)
+		{
+			const std::size_t count = std::min(timestampsNs.size(), values.size());
+			for (std::size_t first = 0; first < count;)
+			{
+				const std::int64_t paneNs = WindowDetail::alignDown(timestampsNs[first], m_slideNs);
+
+				std::size_t last = first + 1;
+				while (last < count && timestampsNs[last] >= paneNs && timestampsNs[last] < paneNs + m_slideNs)
+				{
+					++last;
+				}
+
+				if (isLate(paneNs))
+				{
+					m_lateCount += last - first;
+				}
+				else
+				{
+					const auto runTimestamps = timestampsNs.subspan(first, last - first);
+					getPane(paneNs).addBatch(runTimestamps, values.subspan(first, last - first));
+					m_watermark.observe(WindowDetail::maxOf(runTimestamps));
+				}
+
+				first = last;
+			}
+
+			close(closed);
+		}
+
+		void advanceWatermark(std::int64_t watermarkNs, std::vector<Result>& closed)
+		{
+			m_watermark.advanceTo(watermarkNs);
+			close(closed);
+		}
+
+		void flush(std::vector<Result>& closed)
+		{
+			advanceWatermark(std::numeric_limits<std::int64_t>::max(), closed);
+		}
+
+		[[nodiscard]] std::int64_t  getWatermarkNs() const { return m_watermark.get(); }
+		[[nodiscard]] std::uint64_t getLateCount() const { return m_lateCount; }
+
+	private:
+		// Every window the pane is in has closed, or been emitted already - it would be erased unseen otherwise
+		[[nodiscard]] bool isLate(std::int64_t paneNs) const
+		{
+			return paneNs + m_sizeNs <= m_watermark.get() || paneNs + m_sizeNs < m_nextEndNs;
+		}
+
+		A& getPane(std::int64_t paneNs)
+		{
+			if (!m_panes.empty() && std::prev(m_panes.end())->first == paneNs)
+			{
+				return std::prev(m_panes.end())->second;
+			}
+
+			return m_panes.try_emplace(paneNs, m_prototype).first->second;
+		}
+
+		void close(std::vector<Result>& closed)
+		{
+			while (!m_panes.empty())
+			{
+				// Skip the windows no pane is in - only once the watermark has passed them, a pane added before then may be in one
+				const std::int64_t endNs = std::max(m_nextEndNs, m_panes.begin()->first + m_slideNs);
+				if (endNs > m_watermark.get())
+				{
+					break;
+				}
+
+				m_nextEndNs = endNs;
+
+				const std::int64_t startNs = m_nextEndNs - m_sizeNs;
+
+				A window = m_prototype;
+				for (auto pane = m_panes.lower_bound(startNs); pane != m_panes.end() && pane->first < m_nextEndNs; ++pane)
+				{
+					window.merge(pane->second);
+				}
+
+				closed.push_back(Result{ .startNs = startNs, .endNs = m_nextEndNs, .count = window.getCount(), .value = window.getResult() });
+				m_nextEndNs += m_slideNs;
+
+				// Panes before the next window's start aren't in any window still to come
+				m_panes.erase(m_panes.begin(), m_panes.lower_bound(m_nextEndNs - m_sizeNs));
+			}
+		}
+
+		std::int64_t              m_slideNs;
+		std::int64_t              m_sizeNs;
+		Watermark                 m_watermark;
+		A                         m_prototype;
+		std::map<std::int64_t, A> m_panes; // by start
+		std::int64_t              m_nextEndNs = std::numeric_limits<std::int64_t>::min();
+		std::uint64_t             m_lateCount = 0;
+	};
+
+	/// <summary>
+	/// Windows of activity, eg. a burst of trades: a session lasts until no value has arrived for gap, and ends gap
+	/// after its last value. A value between two sessions within gap of both joins them.
+	/// </summary>
+	template<Aggregator A>
+	class SessionWindow
+	{
+	public:
+		using Result = WindowResult<typename A::Result>;
+
+		explicit SessionWindow(std::chrono::nanoseconds gap, std::chrono::nanoseconds allowedLateness = {}, A prototype = {})
+			: m_gapNs(std::max<std::int64_t>(gap.count(), 1))
+			, m_watermark(allowedLateness)
+			, m_prototype(std::move(prototype))
+		{
+		}
+
+		/// <returns>False if the value was late - a session of it alone would have closed already</returns>
+		bool add(std::int64_t timestampNs, double value, std::vector<Result>& closed)
+		{
+			if (timestampNs + m_gapNs <= m_watermark.get())
+			{
+				++m_lateCount;
+				return false;
+			}
+
+			A aggregator = m_prototype;
+			aggregator.add(timestampNs, value);
+			insert(timestampNs, timestampNs, std::move(aggregator));
+
+			m_watermark.observe(timestampNs);
+			close(closed);
+			return true;
+		}
+
+		/// <summary>
+		/// Adds each run of values in order and within gap of each other as one session, with a single addBatch
+		/// </summary>
+		void addBatch(std::span<const std::int64_t> timestampsNs, std::span<const double> values, std::vector<Result>& closed)
+		{
+			const std::size_t count = std::min(timestampsNs.size(), values.size());
+			for (std::size_t first = 0; first < count;)
+			{
+				if (timestampsNs[first] + m_gapNs <= m_watermark.get())
+				{
+					++m_lateCount;
+					++first;
+					continue;
+				}
+
+				// In order, so none of the run is late once its first value isn't
+				std::size_t last = first + 1;
+				while (last < count && timestampsNs[last] >= timestampsNs[last - 1] && timestampsNs[last] - timestampsNs[last - 1] < m_gapNs)
+				{
+					++last;
+				}
+
+				A aggregator = m_prototype;
+				aggregator.addBatch(timestampsNs.subspan(first, last - first), values.subspan(first, last - first));
+				insert(timestampsNs[first], timestampsNs[last - 1], std::move(aggregator));
+
+				m_watermark.observe(timestampsNs[last - 1]);
+				first = last;
+			}
+
+			close(closed);
+		}
+
+		void advanceWatermark(std::int64_t watermarkNs, std::vector<Result>& closed)
+		{
+			m_watermark.advanceTo(watermarkNs);
+			close(closed);
+		}
+
+		void flush(std::vector<Result>& closed)
+		{
+			advanceWatermark(std::numeric_limits<std::int64_t>::max(), closed);
+		}
+
+		[[nodiscard]] std::int64_t  getWatermarkNs() const { return m_watermark.get(); }
+		[[nodiscard]] std::uint64_t getLateCount() const { return m_lateCount; }
+
+	private:
+		struct Session
+		{
+			std::int64_t lastNs; // of its latest value
+			A            aggregator;
+		};
+
+		void insert(std::int64_t firstNs, std::int64_t lastNs, A aggregator)
+		{
+			// Sessions don't overlap, so those it joins are the ones just before the first starting too late to
+			auto session = m_sessions.lower_bound(lastNs + m_gapNs);
+			while (session != m_sessions.begin())
+			{
+				const auto previous = std::prev(session);
+				if (previous->second.lastNs + m_gapNs <= firstNs)
+				{
+					break;
+				}
+
+				firstNs = std::min(firstNs, previous->first);
+				lastNs = std::max(lastNs, previous->second.lastNs);
+				aggregator.merge(previous->second.aggregator);
+				session = m_sessions.erase(previous);
+			}
+
+			m_sessions.emplace(firstNs, Session{ .lastNs = lastNs, .aggregator = std::move(aggregator) });
+		}
+
+		void close(std::vector<Result>& closed)
+		{
+			// In order of both start and end
+			while (!m_sessions.empty() && m_sessions.begin()->second.lastNs + m_gapNs <= m_watermark.get())
+			{
+				const auto& [startNs, session] = *m_sessions.begin();
+				closed.push_back(Result{ .startNs = startNs, .endNs = session.lastNs + m_gapNs, .count = session.aggregator.getCount(),
+				                         .value = session.aggregator.getResult() });
+				m_sessions.erase(m_sessions.begin());
+			}
+		}
+
+		std::int64_t                    m_gapNs;
+		Watermark                       m_watermark;
+		A                               m_prototype;
+		std::map<std::int64_t, Session> m_sessions; // open, by start
+		std::uint64_t                   m_lateCount = 0;
+	};
+}
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+
 class TaskQueue
 {
 public:
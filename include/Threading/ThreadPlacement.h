@@ -0,0 +1,60 @@
+#pragma once
+
+#include <expected>
+#include <span>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Where a thread may run. An empty placement leaves the thread to the scheduler.
+/// </summary>
+/// <remarks>
+/// Config form: {"node": 1}, {"cpus": [4, 5]} or {"near": "PolygonIO"} - the last puts a plugin's threads on the same
+/// node as another plugin's, eg. next to the producer of the packets it consumes.
+/// </remarks>
+struct ThreadPlacement
+{
+	int                   numaNode = -1; // -1 = any
+	std::vector<unsigned> cpus;          // restricts the thread further, or alone picks its node
+	std::string           nearPlugin;    // resolved by PluginManager into numaNode
+
+	[[nodiscard]] bool isEmpty() const { return numaNode < 0 && cpus.empty() && nearPlugin.empty(); }
+};
+
+/// <summary>
+/// The machine's NUMA nodes and the CPUs in each, read once from /sys/devices/system/node. Elsewhere, or on a machine
+/// without NUMA, there is a single node 0 holding every CPU.
+/// </summary>
+class CpuTopology
+{
+public:
+	[[nodiscard]] static const CpuTopology& get();
+
+	[[nodiscard]] unsigned                 getNodeCount() const;
+	[[nodiscard]] std::span<const unsigned> getNodeCpus(unsigned node) const;
+	[[nodiscard]] int                      getNodeOfCpu(unsigned cpu) const; // -1 if unknown
+	[[nodiscard]] bool                     isNuma() const { return getNodeCount() > 1; }
+
+	/// <summary>
+	/// The node the calling thread is running on right now, -1 if it can't be told. Cheap (sched_getcpu), but only a
+	/// snapshot for a thread that isn't pinned.
+	/// </summary>
+	[[nodiscard]] int getCurrentNode() const;
+
+	/// <summary>
+	/// The node a thread with this placement ends up on, -1 if it isn't held to one
+	/// </summary>
+	[[nodiscard]] int getPlacementNode(const ThreadPlacement& placement) const;
+
+private:
+	CpuTopology();
+
+	std::vector<std::vector<unsigned>> m_nodeCpus;
+	std::vector<int>                   m_cpuNodes; // by CPU id
+};
+
+/// <summary>
+/// Pins the calling thread to its placement's CPUs (all of its node's if it names only a node), and prefers that node
+/// for the memory the thread allocates - so packets it creates are local to it. Linux only, elsewhere a no-op.
+/// </summary>
+std::expected<void, std::string> placeCurrentThread(const ThreadPlacement& placement);
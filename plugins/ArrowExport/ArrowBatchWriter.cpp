@@ -0,0 +1,523 @@
+#include "ArrowBatchWriter.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <type_traits>
+#include <utility>
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/util/compression.h>
+#include <arrow/util/key_value_metadata.h>
+
+#ifdef VECTORIUM_ARROW_PARQUET
+#include <parquet/arrow/writer.h>
+#include <parquet/properties.h>
+#endif
+
+#include "Services/Logging/ILogger.h"
+
+namespace
+{
+	std::shared_ptr<arrow::DataType> toArrowType(PacketFieldKind kind)
+	{
+		switch (kind)
+		{
+		case PacketFieldKind::Bool: return arrow::boolean();
+		case PacketFieldKind::Int8: return arrow::int8();
+		case PacketFieldKind::Int16: return arrow::int16();
+		case PacketFieldKind::Int32: return arrow::int32();
+		case PacketFieldKind::Int64: return arrow::int64();
+		case PacketFieldKind::UInt8: return arrow::uint8();
+		case PacketFieldKind::UInt16: return arrow::uint16();
+		case PacketFieldKind::UInt32: return arrow::uint32();
+		case PacketFieldKind::UInt64: return arrow::uint64();
+		case PacketFieldKind::Float32: return arrow::float32();
+		case PacketFieldKind::Float64: return arrow::float64();
+		case PacketFieldKind::Timestamp: return arrow::timestamp(arrow::TimeUnit::NANO, "UTC");
+		case PacketFieldKind::String: return arrow::utf8();
+		}
+
+		return arrow::null();
+	}
+
+	// Encoded bytes of one value, 0 for strings
+	std::size_t encodedSizeOf(PacketFieldKind kind)
+	{
+		switch (kind)
+		{
+		case PacketFieldKind::Bool:
+		case PacketFieldKind::Int8:
+		case PacketFieldKind::UInt8: return 1;
+		case PacketFieldKind::Int16:
+		case PacketFieldKind::UInt16: return 2;
+		case PacketFieldKind::Int32:
+		case PacketFieldKind::UInt32:
+		case PacketFieldKind::Float32: return 4;
+		case PacketFieldKind::Int64:
+		case PacketFieldKind::UInt64:
+		case PacketFieldKind::Float64:
+		case PacketFieldKind::Timestamp: return 8;
+		case PacketFieldKind::String: return 0;
+		}
+
+		return 0;
+	}
+
+	/// <summary>
+	/// Calls fn.template operator()<Value, Builder>() with the type a field is encoded as and the builder of its column
+	/// </summary>
+	template<typename Fn>
+	decltype(auto) visitFieldKind(PacketFieldKind kind, Fn&& fn)
+	{
+		switch (kind)
+		{
+		case PacketFieldKind::Bool: return fn.template operator()<std::uint8_t, arrow::BooleanBuilder>();
+		case PacketFieldKind::Int8: return fn.template operator()<std::int8_t, arrow::Int8Builder>();
+		case PacketFieldKind::Int16: return fn.template operator()<std::int16_t, arrow::Int16Builder>();
+		case PacketFieldKind::Int32: return fn.template operator()<std::int32_t, arrow::Int32Builder>();
+		case PacketFieldKind::Int64: return fn.template operator()<std::int64_t, arrow::Int64Builder>();
+		case PacketFieldKind::UInt8: return fn.template operator()<std::uint8_t, arrow::UInt8Builder>();
+		case PacketFieldKind::UInt16: return fn.template operator()<std::uint16_t, arrow::UInt16Builder>();
+		case PacketFieldKind::UInt32: return fn.template operator()<std::uint32_t, arrow::UInt32Builder>();
+		case PacketFieldKind::UInt64: return fn.template operator()<std::uint64_t, arrow::UInt64Builder>();
+		case PacketFieldKind::Float32: return fn.template operator()<float, arrow::FloatBuilder>();
+		case PacketFieldKind::Float64: return fn.template operator()<double, arrow::DoubleBuilder>();
+		case PacketFieldKind::Timestamp: return fn.template operator()<std::int64_t, arrow::TimestampBuilder>();
+		case PacketFieldKind::String: break;
+		}
+
+		return fn.template operator()<std::string, arrow::StringBuilder>();
+	}
+
+	template<typename T>
+	T loadLittleEndian(const std::byte* bytes)
+	{
+		T value;
+		std::memcpy(&value, bytes, sizeof(T));
+
+		if constexpr (std::endian::native != std::endian::little && sizeof(T) > 1)
+		{
+			using Bits = std::conditional_t<sizeof(T) == 2, std::uint16_t, std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>;
+			value = std::bit_cast<T>(std::byteswap(std::bit_cast<Bits>(value)));
+		}
+
+		return value;
+	}
+
+	template<typename Builder, typename T>
+	void unsafeAppend(Builder& builder, T value)
+	{
+		if constexpr (std::is_same_v<Builder, arrow::BooleanBuilder>)
+		{
+			builder.UnsafeAppend(value != 0);
+		}
+		else
+		{
+			builder.UnsafeAppend(value);
+		}
+	}
+
+	arrow::Result<std::shared_ptr<arrow::RecordBatch>> makeRecordBatch(const std::shared_ptr<arrow::Schema>& schema, const ArrowExportBatch& batch)
+	{
+		const std::size_t rowCount = batch.timestampsNs.size();
+
+		std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders;
+		for (const auto& field : schema->fields())
+		{
+			ARROW_ASSIGN_OR_RAISE(auto builder, arrow::MakeBuilder(field->type()));
+			ARROW_RETURN_NOT_OK(builder->Reserve(static_cast<std::int64_t>(rowCount)));
+			builders.push_back(std::move(builder));
+		}
+
+		ARROW_RETURN_NOT_OK(static_cast<arrow::TimestampBuilder&>(*builders[0]).AppendValues(batch.timestampsNs));
+
+		std::size_t rowSize = 0;
+		for (const auto& field : batch.fields)
+		{
+			const std::size_t size = encodedSizeOf(field.kind);
+			rowSize = size == 0 || rowSize == SIZE_MAX ? SIZE_MAX : rowSize + size;
+		}
+
+		if (rowSize != SIZE_MAX)
+		{
+			// Every row is as wide, so each column is a strided copy out of the rows
+			if (batch.rows.size() != rowCount * rowSize)
+			{
+				return arrow::Status::Invalid(std::format("{} bytes aren't {} rows of {} bytes", batch.rows.size(), rowCount, rowSize));
+			}
+
+			std::size_t offset = 0;
+			for (std::size_t column = 0; column < batch.fields.size(); ++column)
+			{
+				const std::byte* values = batch.rows.data() + offset;
+				visitFieldKind(batch.fields[column].kind, [&]<typename T, typename Builder>()
+				{
+					if constexpr (std::is_arithmetic_v<T>)
+					{
+						auto& builder = static_cast<Builder&>(*builders[column + 1]);
+						for (std::size_t row = 0; row < rowCount; ++row)
+						{
+							unsafeAppend(builder, loadLittleEndian<T>(values + row * rowSize));
+						}
+					}
+				});
+
+				offset += encodedSizeOf(batch.fields[column].kind);
+			}
+		}
+		else
+		{
+			PacketReader reader(batch.rows);
+			std::string  text;
+
+			for (std::size_t row = 0; row < rowCount; ++row)
+			{
+				for (std::size_t column = 0; column < batch.fields.size(); ++column)
+				{
+					const arrow::Status status = visitFieldKind(batch.fields[column].kind, [&]<typename T, typename Builder>() -> arrow::Status
+					{
+						auto& builder = static_cast<Builder&>(*builders[column + 1]);
+						if constexpr (std::is_arithmetic_v<T>)
+						{
+							T value{};
+							if (!PacketEncoding::readLittleEndian(reader, value))
+							{
+								return arrow::Status::Invalid(std::format("Row {} ends early", row));
+							}
+
+							unsafeAppend(builder, value);
+							return arrow::Status::OK();
+						}
+						else
+						{
+							std::uint64_t size = 0;
+							if (!reader.readVarint(size) || size > batch.rows.size())
+							{
+								return arrow::Status::Invalid(std::format("Row {} ends early", row));
+							}
+
+							text.resize(size);
+							if (!reader.read(text.data(), size))
+							{
+								return arrow::Status::Invalid(std::format("Row {} ends early", row));
+							}
+
+							return builder.Append(text);
+						}
+					});
+
+					ARROW_RETURN_NOT_OK(status);
+				}
+			}
+
+			if (!reader.isAtEnd())
+			{
+				return arrow::Status::Invalid(std::format("{} rows don't take up all {} bytes", rowCount, batch.rows.size()));
+			}
+		}
+
+		std::vector<std::shared_ptr<arrow::Array>> arrays;
+		for (auto& builder : builders)
+		{
+			ARROW_ASSIGN_OR_RAISE(auto array, builder->Finish());
+			arrays.push_back(std::move(array));
+		}
+
+		return arrow::RecordBatch::Make(schema, static_cast<std::int64_t>(rowCount), std::move(arrays));
+	}
+
+	std::shared_ptr<arrow::Schema> makeSchema(const ArrowExportBatch& batch)
+	{
+		// The packets' own timestamp leads - named so it can't clash with a field
+		std::string timestampName = "timestamp";
+		while (std::ranges::any_of(batch.fields, [&](const ArrowExportBatch::Field& field) { return field.name == timestampName; }))
+		{
+			timestampName.insert(0, "_");
+		}
+
+		arrow::FieldVector fields{ arrow::field(timestampName, toArrowType(PacketFieldKind::Timestamp), false) };
+		for (const auto& field : batch.fields)
+		{
+			fields.push_back(arrow::field(field.name, toArrowType(field.kind), false));
+		}
+
+		auto metadata = arrow::key_value_metadata({ "vectorium.schema", "vectorium.schema_hash" },
+		                                          { batch.schemaName, std::format("{:016x}", batch.schemaHash) });
+		return arrow::schema(std::move(fields), std::move(metadata));
+	}
+}
+
+ArrowBatchWriter::ArrowBatchWriter(ArrowExportConfig config, std::shared_ptr<ILogger> logger)
+	: m_config(std::move(config))
+	, m_logger(std::move(logger))
+	, m_thread([this](const std::stop_token& stopToken) { run(stopToken); })
+{
+}
+
+ArrowBatchWriter::~ArrowBatchWriter()
+{
+	m_thread.request_stop();
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+void ArrowBatchWriter::push(ArrowExportBatch batch)
+{
+	if (batch.timestampsNs.empty())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard lock(m_mutex);
+		if (m_queue.size() < m_config.maxQueuedBatches)
+		{
+			m_queue.push_back(std::move(batch));
+			m_wake.notify_one();
+			return;
+		}
+
+		m_stats.droppedRows += batch.timestampsNs.size();
+	}
+
+	log(LogLevel::Warning, std::format("Dropped {} '{}' row(s), {} batches are waiting to be written already", batch.timestampsNs.size(), batch.schemaName,
+	                                   m_config.maxQueuedBatches));
+}
+
+ArrowBatchWriter::Stats ArrowBatchWriter::getStats() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_stats;
+}
+
+void ArrowBatchWriter::run(const std::stop_token& stopToken)
+{
+	std::deque<ArrowExportBatch> batches;
+
+	while (true)
+	{
+		{
+			std::unique_lock lock(m_mutex);
+			m_wake.wait_for(lock, stopToken, std::chrono::seconds(1), [this] { return !m_queue.empty(); });
+
+			// Once stopping, only after what was queued is written
+			if (m_queue.empty() && stopToken.stop_requested())
+			{
+				break;
+			}
+
+			std::swap(batches, m_queue);
+		}
+
+		for (const ArrowExportBatch& batch : batches)
+		{
+			if (auto status = write(batch); !status.ok())
+			{
+				log(LogLevel::Error, std::format("Dropped {} '{}' row(s): {}", batch.timestampsNs.size(), batch.schemaName, status.ToString()));
+
+				std::lock_guard lock(m_mutex);
+				m_stats.droppedRows += batch.timestampsNs.size();
+			}
+		}
+
+		batches.clear();
+
+		// Files of types that went quiet are finished too
+		const auto now = std::chrono::steady_clock::now();
+		for (auto& [schemaName, file] : m_files)
+		{
+			if (file.stream && now - file.opened >= m_config.rollInterval)
+			{
+				finish(schemaName, file);
+			}
+		}
+	}
+
+	for (auto& [schemaName, file] : m_files)
+	{
+		finish(schemaName, file);
+	}
+}
+
+arrow::Status ArrowBatchWriter::write(const ArrowExportBatch& batch)
+{
+	OpenFile& file = m_files[batch.schemaName];
+
+	if (file.stream && file.schemaHash != batch.schemaHash)
+	{
+		finish(batch.schemaName, file);
+	}
+
+	if (!file.stream)
+	{
+		if (auto status = open(batch, file); !status.ok())
+		{
+			file = OpenFile{};
+			return status;
+		}
+	}
+
+	auto status = [&]() -> arrow::Status
+	{
+		ARROW_ASSIGN_OR_RAISE(auto recordBatch, makeRecordBatch(file.schema, batch));
+
+#ifdef VECTORIUM_ARROW_PARQUET
+		if (file.parquetWriter)
+		{
+			return file.parquetWriter->WriteRecordBatch(*recordBatch);
+		}
+#endif
+
+		return file.ipcWriter->WriteRecordBatch(*recordBatch);
+	}();
+
+	if (!status.ok())
+	{
+		// What the file holds already is kept, the next batch starts another
+		finish(batch.schemaName, file);
+		return status;
+	}
+
+	file.rows += batch.timestampsNs.size();
+	{
+		std::lock_guard lock(m_mutex);
+		m_stats.writtenRows += batch.timestampsNs.size();
+	}
+
+	if (file.rows >= m_config.rollRows || std::chrono::steady_clock::now() - file.opened >= m_config.rollInterval)
+	{
+		finish(batch.schemaName, file);
+	}
+
+	return arrow::Status::OK();
+}
+
+arrow::Status ArrowBatchWriter::open(const ArrowExportBatch& batch, OpenFile& file)
+{
+	const std::filesystem::path directory = m_config.directory / batch.schemaName;
+	const std::string_view      extension = m_config.format == ArrowExportFormat::Parquet ? ".parquet" : ".arrow";
+
+	std::error_code ec;
+	std::filesystem::create_directories(directory, ec);
+
+	// Named after its first timestamp, sorting as they were written
+	const std::int64_t firstTimestampNs = batch.timestampsNs.front();
+	file.path = directory / std::format("{}-{:020}{}", batch.schemaName, firstTimestampNs, extension);
+	for (int suffix = 1; std::filesystem::exists(file.path, ec); ++suffix)
+	{
+		file.path = directory / std::format("{}-{:020}-{}{}", batch.schemaName, firstTimestampNs, suffix, extension);
+	}
+
+	file.schemaHash = batch.schemaHash;
+	file.rows = 0;
+	file.opened = std::chrono::steady_clock::now();
+	file.schema = makeSchema(batch);
+
+	ARROW_ASSIGN_OR_RAISE(file.stream, arrow::io::FileOutputStream::Open(file.path.string() + ".partial"));
+
+	arrow::Compression::type compression = arrow::Compression::UNCOMPRESSED;
+	if (m_config.compression == "zstd")
+	{
+		compression = arrow::Compression::ZSTD;
+	}
+	else if (m_config.compression == "lz4")
+	{
+		compression = arrow::Compression::LZ4_FRAME;
+	}
+
+#ifdef VECTORIUM_ARROW_PARQUET
+	if (m_config.format == ArrowExportFormat::Parquet)
+	{
+		auto properties = parquet::WriterProperties::Builder()
+			.compression(compression == arrow::Compression::LZ4_FRAME ? arrow::Compression::LZ4 : compression)
+			->build();
+
+		// Column chunks are encoded and compressed on Arrow's thread pool
+		auto arrowProperties = parquet::ArrowWriterProperties::Builder()
+			.set_use_threads(true)
+			->store_schema()
+			->build();
+
+		ARROW_ASSIGN_OR_RAISE(file.parquetWriter, parquet::arrow::FileWriter::Open(*file.schema, arrow::default_memory_pool(), file.stream, properties, arrowProperties));
+		return arrow::Status::OK();
+	}
+#endif
+
+	// Buffers are compressed on Arrow's thread pool, a column each
+	auto options = arrow::ipc::IpcWriteOptions::Defaults();
+	options.use_threads = true;
+	if (compression != arrow::Compression::UNCOMPRESSED)
+	{
+		ARROW_ASSIGN_OR_RAISE(options.codec, arrow::util::Codec::Create(compression));
+	}
+
+	ARROW_ASSIGN_OR_RAISE(file.ipcWriter, arrow::ipc::MakeFileWriter(file.stream, file.schema, options));
+	return arrow::Status::OK();
+}
+
+void ArrowBatchWriter::finish(const std::string& schemaName, OpenFile& file)
+{
+	if (!file.stream)
+	{
+		return;
+	}
+
+	arrow::Status status;
+	if (file.ipcWriter)
+	{
+		status = file.ipcWriter->Close();
+	}
+
+#ifdef VECTORIUM_ARROW_PARQUET
+	if (file.parquetWriter)
+	{
+		status = file.parquetWriter->Close();
+	}
+#endif
+
+	if (!file.stream->closed())
+	{
+		status &= file.stream->Close();
+	}
+
+	std::filesystem::path partialPath = file.path;
+	partialPath += ".partial";
+
+	std::error_code ec;
+	if (file.rows == 0)
+	{
+		std::filesystem::remove(partialPath, ec);
+	}
+	else if (!status.ok())
+	{
+		log(LogLevel::Error, std::format("Could not finish '{}', its {} '{}' row(s) are left in '{}': {}", file.path.string(), file.rows, schemaName,
+		                                 partialPath.string(), status.ToString()));
+	}
+	else if (std::filesystem::rename(partialPath, file.path, ec); ec)
+	{
+		log(LogLevel::Error, std::format("Could not rename '{}': {}", partialPath.string(), ec.message()));
+	}
+	else
+	{
+		log(LogLevel::Info, std::format("Wrote {} '{}' row(s) to '{}'", file.rows, schemaName, file.path.string()));
+
+		std::lock_guard lock(m_mutex);
+		++m_stats.finishedFiles;
+	}
+
+	file = OpenFile{};
+}
+
+void ArrowBatchWriter::log(LogLevel level, const std::string& message) const
+{
+	if (m_logger)
+	{
+		m_logger->log(level, std::format("[ArrowExport] - {}", message));
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <arrow/io/type_fwd.h>
+#include <arrow/ipc/type_fwd.h>
+#include <arrow/status.h>
+#include <arrow/type_fwd.h>
+
+#include "DataPacket/PacketSchema.h"
+#include "Services/Logging/LogLevel.h"
+
+class ILogger;
+
+#ifdef VECTORIUM_ARROW_PARQUET
+namespace parquet::arrow
+{
+	class FileWriter;
+}
+#endif
+
+enum class ArrowExportFormat
+{
+	ArrowIPC,
+	Parquet
+};
+
+struct ArrowExportConfig
+{
+	std::filesystem::path    directory = "data/arrow"; // a directory per type below it
+	std::vector<std::string> series;                   // schema names of the types to export
+	ArrowExportFormat        format = ArrowExportFormat::ArrowIPC;
+	std::string              compression = "zstd";     // "zstd", "lz4" or "none"
+	std::size_t              batchRows = 65536;        // rows per record batch, at most
+	std::chrono::seconds     batchInterval{5};         // a batch is handed over at least this often, full or not
+	std::uint64_t            rollRows = 10'000'000;    // a file is finished after this many rows...
+	std::chrono::minutes     rollInterval{60};         // ...or once it's been open this long
+	std::size_t              maxQueuedBatches = 64;    // waiting for the writer thread, past this they're dropped
+};
+
+/// <summary>
+/// Rows of one packet type on their way to a file: each packet's PacketSerializer encoding, one after the other
+/// </summary>
+struct ArrowExportBatch
+{
+	struct Field
+	{
+		std::string     name;
+		PacketFieldKind kind;
+	};
+
+	std::string               schemaName;
+	std::uint64_t             schemaHash = 0;
+	std::vector<Field>        fields;
+	std::vector<std::int64_t> timestampsNs; // the packets', system_clock since epoch
+	std::vector<std::byte>    rows;
+};
+
+/// <summary>
+/// Turns batches into Arrow record batches and writes them on a thread of its own, so the packet handlers only append
+/// bytes. Each type gets its own rolling files, written as <name>.partial and renamed when finished, so a reader never
+/// sees one half written. Thread-safe.
+/// </summary>
+class ArrowBatchWriter
+{
+public:
+	struct Stats
+	{
+		std::uint64_t writtenRows = 0;
+		std::uint64_t droppedRows = 0; // queue full, or the file couldn't be written
+		std::uint64_t finishedFiles = 0;
+	};
+
+	ArrowBatchWriter(ArrowExportConfig config, std::shared_ptr<ILogger> logger);
+	~ArrowBatchWriter(); // writes what is queued and finishes the files
+
+	ArrowBatchWriter(const ArrowBatchWriter&) = delete;
+	ArrowBatchWriter& operator=(const ArrowBatchWriter&) = delete;
+
+	void push(ArrowExportBatch batch);
+
+	[[nodiscard]] Stats getStats() const;
+
+private:
+	struct OpenFile
+	{
+		std::uint64_t                                     schemaHash = 0;
+		std::filesystem::path                             path; // what it's renamed to when finished
+		std::uint64_t                                     rows = 0;
+		std::chrono::steady_clock::time_point             opened;
+		std::shared_ptr<arrow::Schema>                    schema;
+		std::shared_ptr<arrow::io::FileOutputStream>      stream;
+		std::shared_ptr<arrow::ipc::RecordBatchWriter>    ipcWriter;
+#ifdef VECTORIUM_ARROW_PARQUET
+		std::unique_ptr<parquet::arrow::FileWriter>       parquetWriter;
+#endif
+	};
+
+	void run(const std::stop_token& stopToken);
+
+	// On the writer thread
+	arrow::Status write(const ArrowExportBatch& batch);
+	arrow::Status open(const ArrowExportBatch& batch, OpenFile& file);
+	void          finish(const std::string& schemaName, OpenFile& file);
+	void          log(LogLevel level, const std::string& message) const;
+
+	const ArrowExportConfig        m_config;
+	const std::shared_ptr<ILogger> m_logger;
+
+	mutable std::mutex           m_mutex;
+	std::condition_variable_any  m_wake;
+	std::deque<ArrowExportBatch> m_queue;
+	Stats                        m_stats;
+
+	std::unordered_map<std::string, OpenFile> m_files; // by schema name, writer thread only
+
+	std::jthread m_thread; // last, so it's stopped before anything it uses goes
+};
@@ -0,0 +1,132 @@
+#include "ArrowExport_Plugin.h"
+#include "Services/IServiceSpecialisations.h"
+
+#include <format>
+#include <fstream>
+
+#include <nlohmann/json.hpp>
+
+#include "Services/Logging/ILogger.h"
+#include "Services/Logging/LogLevel.h"
+
+std::expected<void, std::string> ArrowExportPlugin::onPluginLoad(IPluginContext& context)
+{
+	m_logger = ServiceProxy(context.getService<ILogger>());
+
+	auto config = loadConfig();
+	if (!config)
+	{
+		return std::unexpected(config.error());
+	}
+
+	m_exporter = std::make_unique<ArrowExporter>(context, std::move(*config));
+
+	m_logger->log(LogLevel::Info, "loaded");
+	return {};
+}
+
+void ArrowExportPlugin::onPluginUnload()
+{
+	if (m_exporter)
+	{
+		m_exporter->close();
+	}
+
+	m_logger->log(LogLevel::Info, "unloading");
+}
+
+std::type_index ArrowExportPlugin::getType() const
+{
+	return typeid(ArrowExportBatch);
+}
+
+void ArrowExportPlugin::tick()
+{
+	if (m_exporter)
+	{
+		m_exporter->tick();
+	}
+}
+
+std::expected<ArrowExportConfig, std::string> ArrowExportPlugin::loadConfig() const
+{
+	ArrowExportConfig config;
+
+	std::ifstream file(m_configPath);
+	if (!file)
+	{
+		m_logger->log(LogLevel::Info, std::format("No config at '{}', exporting nothing", m_configPath.string()));
+		return config;
+	}
+
+	try
+	{
+		nlohmann::json j;
+		file >> j;
+
+		if (j.contains("directory")) config.directory = j["directory"].get<std::string>();
+		if (j.contains("series")) config.series = j["series"].get<std::vector<std::string>>();
+		if (j.contains("compression")) config.compression = j["compression"].get<std::string>();
+		if (j.contains("batchRows")) config.batchRows = std::max<std::size_t>(j["batchRows"].get<std::size_t>(), 1);
+		if (j.contains("batchInterval_seconds")) config.batchInterval = std::chrono::seconds(j["batchInterval_seconds"].get<int>());
+		if (j.contains("rollRows")) config.rollRows = std::max<std::uint64_t>(j["rollRows"].get<std::uint64_t>(), 1);
+		if (j.contains("rollInterval_minutes")) config.rollInterval = std::chrono::minutes(j["rollInterval_minutes"].get<int>());
+		if (j.contains("maxQueuedBatches")) config.maxQueuedBatches = std::max<std::size_t>(j["maxQueuedBatches"].get<std::size_t>(), 1);
+
+		if (j.contains("format"))
+		{
+			const auto format = j["format"].get<std::string>();
+			if (format == "parquet")
+			{
+				config.format = ArrowExportFormat::Parquet;
+			}
+			else if (format != "arrow")
+			{
+				return std::unexpected(std::format("'{}': format is \"arrow\" or \"parquet\", not \"{}\"", m_configPath.string(), format));
+			}
+		}
+	}
+	catch (const nlohmann::json::exception& e)
+	{
+		return std::unexpected(std::format("Could not read '{}': {}", m_configPath.string(), e.what()));
+	}
+
+	if (config.compression != "zstd" && config.compression != "lz4" && config.compression != "none")
+	{
+		return std::unexpected(std::format("'{}': compression is \"zstd\", \"lz4\" or \"none\", not \"{}\"", m_configPath.string(), config.compression));
+	}
+
+#ifndef VECTORIUM_ARROW_PARQUET
+	if (config.format == ArrowExportFormat::Parquet)
+	{
+		m_logger->log(LogLevel::Warning, "Built without Parquet, writing Arrow IPC files instead");
+		config.format = ArrowExportFormat::ArrowIPC;
+	}
+#endif
+
+	return config;
+}
+
+EXPORT PluginDescriptor* getPluginDescriptor()
+{
+	static PluginDescriptor descriptor
+	{
+		.name = "ArrowExport",
+		.version = "1.0.0",
+		.services = {
+			{
+				.type = typeid(ILogger),
+				.name = "logger",
+				.minVersion = ">=1.0.0",
+				.required = false
+			}
+		}
+	};
+
+	return &descriptor;
+}
+
+EXPORT IPlugin* loadPlugin()
+{
+	return new ArrowExportPlugin();
+}
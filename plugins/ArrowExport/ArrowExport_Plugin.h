@@ -0,0 +1,32 @@
+#pragma once
+
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "ArrowExporter.h"
+#include "Plugin/IPlugin.h"
+#include "Services/IService.h"
+
+class ILogger;
+
+/// <summary>
+/// Writes the packet types listed in config/arrow_export.json to rolling Arrow IPC or Parquet files, for pandas, DuckDB
+/// and the like
+/// </summary>
+struct ArrowExportPlugin final : public IPlugin
+{
+	std::expected<void, std::string> onPluginLoad(IPluginContext& context) override;
+	void                             onPluginUnload() override;
+
+	[[nodiscard]] std::type_index getType() const override;
+	void                          tick() override;
+
+	private:
+		std::expected<ArrowExportConfig, std::string> loadConfig() const;
+
+		ServiceProxy<ILogger>          m_logger{nullptr};
+		std::unique_ptr<ArrowExporter> m_exporter;
+		std::filesystem::path          m_configPath = std::filesystem::path("config") / "arrow_export.json";
+};
@@ -0,0 +1,166 @@
+#include "ArrowExporter.h"
+
+#include <chrono>
+#include <format>
+#include <utility>
+
+#include "DataPacket/SchemaSubscription.h"
+#include "Plugin/IPluginContext.h"
+#include "Services/Logging/ILogger.h"
+
+struct ArrowExporter::Series
+{
+	explicit Series(std::string name)
+		: name(std::move(name))
+		, subscription(this->name)
+	{
+	}
+
+	const std::string name;
+
+	// Only touched by tick() and close()
+	SchemaSubscription                    subscription;
+	ArrowExportBatch                      rows;
+	std::size_t                           fixedSize = 0; // of a row, 0 if it's variable
+	std::chrono::steady_clock::time_point batchStarted;
+	std::uint64_t                         failedPackets = 0;
+};
+
+ArrowExporter::ArrowExporter(IPluginContext& context, ArrowExportConfig config)
+	: m_config(std::move(config))
+	, m_logger(context.getLoggerShared())
+	, m_context(&context)
+	, m_writer(std::make_unique<ArrowBatchWriter>(m_config, m_logger))
+{
+	for (const auto& schemaName : m_config.series)
+	{
+		if (!SchemaSubscription::isUsableAsFileName(schemaName))
+		{
+			log(LogLevel::Warning, std::format("Can't export '{}', it isn't usable as a file name", schemaName));
+			continue;
+		}
+
+		m_series.push_back(std::make_shared<Series>(schemaName));
+	}
+
+	log(LogLevel::Info, std::format("Exporting {} type(s) to '{}' as {}", m_series.size(), m_config.directory.string(),
+	                                m_config.format == ArrowExportFormat::Parquet ? "Parquet" : "Arrow IPC"));
+}
+
+ArrowExporter::~ArrowExporter()
+{
+	close();
+}
+
+void ArrowExporter::tick()
+{
+	if (!m_context)
+	{
+		return;
+	}
+
+	for (const auto& series : m_series)
+	{
+		if (auto subscribed = series->subscription.subscribe(*m_context); !subscribed)
+		{
+			log(LogLevel::Warning, subscribed.error());
+		}
+
+		batch(*series, false);
+	}
+}
+
+void ArrowExporter::close()
+{
+	if (!m_context)
+	{
+		return;
+	}
+
+	for (const auto& series : m_series)
+	{
+		series->subscription.close();
+		batch(*series, true);
+	}
+
+	// Writes out what is queued first
+	m_writer.reset();
+	m_context = nullptr;
+}
+
+void ArrowExporter::batch(Series& series, bool isClosing)
+{
+	const auto [packets, serializer, isSchemaChanged] = series.subscription.take(*m_context, series.rows.schemaHash);
+	const std::uint64_t failedBefore = series.failedPackets;
+
+	if (isSchemaChanged)
+	{
+		// A new version of the schema starts a file of its own
+		handOver(series);
+
+		series.rows.schemaName = series.name;
+		series.rows.schemaHash = serializer->schemaHash;
+		series.rows.fields.clear();
+		for (const PacketFieldInfo& field : serializer->fields)
+		{
+			series.rows.fields.push_back(ArrowExportBatch::Field{ .name = std::string(field.name), .kind = field.kind });
+		}
+
+		series.fixedSize = serializer->fixedSize;
+	}
+
+	for (const DataPacket& packet : packets)
+	{
+		if (!serializer)
+		{
+			++series.failedPackets;
+			continue;
+		}
+
+		if (series.rows.timestampsNs.empty())
+		{
+			series.batchStarted = std::chrono::steady_clock::now();
+			series.rows.timestampsNs.reserve(m_config.batchRows);
+			series.rows.rows.reserve(series.fixedSize * m_config.batchRows);
+		}
+
+		// For a type laid out as it's encoded, a copy of its bytes
+		serializer->encode(packet, series.rows.rows);
+		series.rows.timestampsNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(packet.timestamp.time_since_epoch()).count());
+
+		if (series.rows.timestampsNs.size() >= m_config.batchRows)
+		{
+			handOver(series);
+		}
+	}
+
+	if (isClosing || (!series.rows.timestampsNs.empty() && std::chrono::steady_clock::now() - series.batchStarted >= m_config.batchInterval))
+	{
+		handOver(series);
+	}
+
+	if (series.failedPackets != failedBefore)
+	{
+		log(LogLevel::Warning, std::format("{} '{}' packet(s) couldn't be exported, {} so far", series.failedPackets - failedBefore, series.name, series.failedPackets));
+	}
+}
+
+void ArrowExporter::handOver(Series& series)
+{
+	if (series.rows.timestampsNs.empty())
+	{
+		return;
+	}
+
+	// The next batch keeps the fields
+	ArrowExportBatch next{ .schemaName = series.rows.schemaName, .schemaHash = series.rows.schemaHash, .fields = series.rows.fields, .timestampsNs = {}, .rows = {} };
+	m_writer->push(std::exchange(series.rows, std::move(next)));
+}
+
+void ArrowExporter::log(LogLevel level, const std::string& message) const
+{
+	if (m_logger)
+	{
+		m_logger->log(level, std::format("[ArrowExport] - {}", message));
+	}
+}
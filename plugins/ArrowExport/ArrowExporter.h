@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ArrowBatchWriter.h"
+#include "Services/Logging/LogLevel.h"
+
+class ILogger;
+class IPluginContext;
+
+/// <summary>
+/// Exports the packet types in the config, a batch of rows at a time, to an ArrowBatchWriter.
+/// </summary>
+/// <remarks>
+/// Each type is a SchemaSubscription, as in the time series store - packets are encoded from tick(), and the Arrow
+/// columns are built and written on the writer's thread.
+/// </remarks>
+class ArrowExporter
+{
+public:
+	ArrowExporter(IPluginContext& context, ArrowExportConfig config);
+	~ArrowExporter();
+
+	ArrowExporter(const ArrowExporter&) = delete;
+	ArrowExporter& operator=(const ArrowExporter&) = delete;
+
+	/// <summary>
+	/// Subscribes to the types whose schema has been registered since, and batches what arrived - from the plugin's tick
+	/// </summary>
+	void tick();
+
+	/// <summary>
+	/// Stops exporting, and waits for everything batched to be written and the files finished - from the plugin's
+	/// onPluginUnload
+	/// </summary>
+	void close();
+
+private:
+	struct Series;
+
+	void batch(Series& series, bool isClosing);
+	void handOver(Series& series);
+	void log(LogLevel level, const std::string& message) const;
+
+	const ArrowExportConfig        m_config;
+	const std::shared_ptr<ILogger> m_logger;
+
+	IPluginContext*                      m_context;
+	std::vector<std::shared_ptr<Series>> m_series;
+	std::unique_ptr<ArrowBatchWriter>    m_writer;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "DataPacket/PacketSchema.h"
 #include "Plugin/IPlugin.h"
 #include "Services/IService.h"
 
@@ -12,6 +13,8 @@ struct GPSDataPacket
 	float alt;
 };
 
+VECTORIUM_PACKET_SCHEMA(GPSDataPacket, lat, lng, alt);
+
 struct GPSDataHandler final : ITypedDataPacketHandler<GPSDataPacket>
 {
 	bool handleType(const std::shared_ptr<GPSDataPacket>& packet) override;
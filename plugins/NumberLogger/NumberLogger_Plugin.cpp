@@ -52,7 +52,8 @@ EXPORT PluginDescriptor* getPluginDescriptor()
 				.minVersion = ">=1.0.0",
 				.required = false
 			}
-	}
+	},
+		.packetTypes = { typeid(int) }
 	};
 
 	return &descriptor;
@@ -35,6 +35,10 @@ std::expected<void, std::string> PolygonIO_Plugin::onPluginLoad(IPluginContext&
 		context.log(LogLevel::Error, "Context does not have the service 'ILogger'");
 	}
 
+	// So the engine can record and inspect what this plugin fetches
+	context.registerPacketSchema<PolygonIO_Candle>();
+	context.registerPacketSchema<PolygonIO_MarketStatus>();
+
 	if (context.hasService<IPluginRESTService>())
 	{
 		m_RESTClient = ServiceProxy(context.getService<IPluginRESTService>());
@@ -85,8 +89,9 @@ std::expected<void, std::string> PolygonIO_Plugin::onPluginLoad(IPluginContext&
 	m_running = true;
 	m_showMainWindow = true;
 
-	m_apiThread = std::jthread([this](const std::stop_token& token)
+	m_apiThread = std::jthread([this, &context](const std::stop_token& token)
 	{
+		context.placeCurrentThread();
 		runAPIThread(token);
 	});
 
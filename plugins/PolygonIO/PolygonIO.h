@@ -7,6 +7,7 @@
 #include <chrono>
 #include <condition_variable>
 
+#include "DataPacket/PacketSchema.h"
 #include "Plugin/IPlugin.h"
 #include "UI/PluginUIHelpers.h"
 
@@ -20,6 +21,8 @@ struct PolygonIO_Candle
 	uint64_t volume;
 };
 
+VECTORIUM_PACKET_SCHEMA(PolygonIO_Candle, timestamp, open, high, low, close, volume);
+
 struct PolygonIO_MarketStatus
 {
 	std::string market;
@@ -29,6 +32,8 @@ struct PolygonIO_MarketStatus
 	bool earlyHours = false;
 };
 
+VECTORIUM_PACKET_SCHEMA(PolygonIO_MarketStatus, market, serverTime, exchanges, afterHours, earlyHours);
+
 struct PolygonIO_UIState
 {
 	char apiKeyBuffer[256] = "EQYZuQWtWMRKXg9_kmjdSLU6pEy2FVzv";
@@ -0,0 +1,714 @@
+#include "TimeSeriesCodec.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#ifdef VECTORIUM_TIMESERIES_ZSTD
+#include <zstd.h>
+#endif
+
+namespace
+{
+	using Integers = std::vector<std::int64_t>;
+	using Floats = std::vector<double>;
+	using Strings = std::vector<std::string>;
+
+	std::uint64_t zigzag(std::int64_t value)
+	{
+		return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+	}
+
+	std::int64_t unzigzag(std::uint64_t value)
+	{
+		return static_cast<std::int64_t>((value >> 1) ^ (~(value & 1) + 1));
+	}
+
+	/// <summary>
+	/// Packs values of up to 64 bits, most significant bit first
+	/// </summary>
+	class BitWriter
+	{
+	public:
+		explicit BitWriter(std::vector<std::byte>& out)
+			: m_out(out)
+		{
+		}
+
+		void write(std::uint64_t value, int count)
+		{
+			while (count > 0)
+			{
+				const int free = 64 - m_used;
+				const int take = std::min(free, count);
+				const std::uint64_t mask = take == 64 ? ~0ull : (1ull << take) - 1;
+
+				m_buffer |= ((value >> (count - take)) & mask) << (free - take);
+				m_used += take;
+				count -= take;
+
+				if (m_used == 64)
+				{
+					emit(8);
+				}
+			}
+		}
+
+		void finish()
+		{
+			emit((m_used + 7) / 8);
+		}
+
+	private:
+		void emit(int bytes)
+		{
+			for (int i = 0; i < bytes; ++i)
+			{
+				m_out.push_back(static_cast<std::byte>(m_buffer >> (56 - i * 8)));
+			}
+
+			m_buffer = 0;
+			m_used = 0;
+		}
+
+		std::vector<std::byte>& m_out;
+		std::uint64_t           m_buffer = 0;
+		int                     m_used = 0;
+	};
+
+	class BitReader
+	{
+	public:
+		explicit BitReader(std::span<const std::byte> bytes)
+			: m_bytes(bytes)
+		{
+		}
+
+		bool read(int count, std::uint64_t& value)
+		{
+			if (m_position + count > m_bytes.size() * 8)
+			{
+				return false;
+			}
+
+			value = 0;
+			while (count > 0)
+			{
+				const auto byte = std::to_integer<unsigned>(m_bytes[m_position / 8]);
+				const int  available = 8 - static_cast<int>(m_position % 8);
+				const int  take = std::min(available, count);
+
+				value = (value << take) | ((byte >> (available - take)) & ((1u << take) - 1));
+				m_position += take;
+				count -= take;
+			}
+
+			return true;
+		}
+
+	private:
+		std::span<const std::byte> m_bytes;
+		std::size_t                m_position = 0;
+	};
+
+	void encodeTimestamps(const Integers& values, std::vector<std::byte>& out)
+	{
+		std::uint64_t previous = 0;
+		std::uint64_t previousDelta = 0;
+
+		for (const std::int64_t value : values)
+		{
+			// Unsigned, so it wraps rather than overflows - ticks a steady interval apart cost a byte each
+			const std::uint64_t delta = static_cast<std::uint64_t>(value) - previous;
+			PacketEncoding::writeVarint(out, zigzag(static_cast<std::int64_t>(delta - previousDelta)));
+			previous = static_cast<std::uint64_t>(value);
+			previousDelta = delta;
+		}
+	}
+
+	void encodeIntegers(const Integers& values, std::vector<std::byte>& out)
+	{
+		std::uint64_t previous = 0;
+
+		for (const std::int64_t value : values)
+		{
+			PacketEncoding::writeVarint(out, zigzag(static_cast<std::int64_t>(static_cast<std::uint64_t>(value) - previous)));
+			previous = static_cast<std::uint64_t>(value);
+		}
+	}
+
+	void encodeFloats(const Floats& values, std::vector<std::byte>& out)
+	{
+		BitWriter writer(out);
+
+		std::uint64_t previous = 0;
+		int           previousLeading = -1; // no window yet
+		int           previousTrailing = 0;
+
+		for (std::size_t i = 0; i < values.size(); ++i)
+		{
+			const auto bits = std::bit_cast<std::uint64_t>(values[i]);
+			if (i == 0)
+			{
+				writer.write(bits, 64);
+				previous = bits;
+				continue;
+			}
+
+			const std::uint64_t difference = bits ^ previous;
+			previous = bits;
+
+			if (difference == 0)
+			{
+				writer.write(0, 1);
+				continue;
+			}
+
+			const int leading = std::countl_zero(difference);
+			const int trailing = std::countr_zero(difference);
+
+			// The meaningful bits fit the last value's window, so only they are written
+			if (previousLeading >= 0 && leading >= previousLeading && trailing >= previousTrailing)
+			{
+				writer.write(0b10, 2);
+				writer.write(difference >> previousTrailing, 64 - previousLeading - previousTrailing);
+				continue;
+			}
+
+			const int meaningful = 64 - leading - trailing;
+			writer.write(0b11, 2);
+			writer.write(static_cast<std::uint64_t>(leading), 6);
+			writer.write(static_cast<std::uint64_t>(meaningful - 1), 6);
+			writer.write(difference >> trailing, meaningful);
+			previousLeading = leading;
+			previousTrailing = trailing;
+		}
+
+		writer.finish();
+	}
+
+	void encodeStrings(const Strings& values, std::vector<std::byte>& out)
+	{
+		for (const std::string& value : values)
+		{
+			PacketEncoding::writeVarint(out, value.size());
+			const auto* bytes = reinterpret_cast<const std::byte*>(value.data());
+			out.insert(out.end(), bytes, bytes + value.size());
+		}
+	}
+
+	// Each column goes behind its byte length, so a damaged one can't be read past
+	template<typename Encode>
+	void writeColumn(std::vector<std::byte>& out, std::vector<std::byte>& scratch, Encode&& encode)
+	{
+		scratch.clear();
+		encode(scratch);
+		PacketEncoding::writeVarint(out, scratch.size());
+		out.insert(out.end(), scratch.begin(), scratch.end());
+	}
+
+	std::expected<std::span<const std::byte>, std::string> readColumn(std::span<const std::byte> bytes, std::size_t& offset)
+	{
+		PacketReader  reader(bytes.subspan(offset));
+		std::uint64_t size = 0;
+		if (!reader.readVarint(size))
+		{
+			return std::unexpected("Column length is cut short");
+		}
+
+		// The varint's own length, which PacketReader doesn't report
+		offset += 1;
+		for (std::uint64_t rest = size; rest >= 0x80; rest >>= 7)
+		{
+			++offset;
+		}
+
+		if (size > bytes.size() - offset)
+		{
+			return std::unexpected(std::format("Column of {} bytes runs past the block", size));
+		}
+
+		const auto column = bytes.subspan(offset, size);
+		offset += size;
+		return column;
+	}
+
+	// Decodes a column's rowCount values, handing each with its row number to keep()
+	template<typename Keep>
+	bool decodeTimestamps(std::span<const std::byte> bytes, std::size_t rowCount, Keep&& keep)
+	{
+		PacketReader  reader(bytes);
+		std::uint64_t previous = 0;
+		std::uint64_t previousDelta = 0;
+
+		for (std::size_t row = 0; row < rowCount; ++row)
+		{
+			std::uint64_t encoded = 0;
+			if (!reader.readVarint(encoded))
+			{
+				return false;
+			}
+
+			previousDelta += static_cast<std::uint64_t>(unzigzag(encoded));
+			previous += previousDelta;
+			keep(row, static_cast<std::int64_t>(previous));
+		}
+
+		return reader.isAtEnd();
+	}
+
+	template<typename Keep>
+	bool decodeIntegers(std::span<const std::byte> bytes, std::size_t rowCount, Keep&& keep)
+	{
+		PacketReader  reader(bytes);
+		std::uint64_t previous = 0;
+
+		for (std::size_t row = 0; row < rowCount; ++row)
+		{
+			std::uint64_t encoded = 0;
+			if (!reader.readVarint(encoded))
+			{
+				return false;
+			}
+
+			previous += static_cast<std::uint64_t>(unzigzag(encoded));
+			keep(row, static_cast<std::int64_t>(previous));
+		}
+
+		return reader.isAtEnd();
+	}
+
+	template<typename Keep>
+	bool decodeFloats(std::span<const std::byte> bytes, std::size_t rowCount, Keep&& keep)
+	{
+		BitReader     reader(bytes);
+		std::uint64_t previous = 0;
+		std::uint64_t leading = 0;
+		std::uint64_t trailing = 0;
+
+		for (std::size_t row = 0; row < rowCount; ++row)
+		{
+			if (row == 0)
+			{
+				if (!reader.read(64, previous))
+				{
+					return false;
+				}
+
+				keep(row, std::bit_cast<double>(previous));
+				continue;
+			}
+
+			std::uint64_t control = 0;
+			if (!reader.read(1, control))
+			{
+				return false;
+			}
+
+			if (control != 0)
+			{
+				if (!reader.read(1, control))
+				{
+					return false;
+				}
+
+				if (control != 0)
+				{
+					std::uint64_t meaningful = 0;
+					if (!reader.read(6, leading) || !reader.read(6, meaningful))
+					{
+						return false;
+					}
+
+					if (leading + meaningful + 1 > 64)
+					{
+						return false;
+					}
+
+					trailing = 64 - leading - (meaningful + 1);
+				}
+
+				const int     width = static_cast<int>(64 - leading - trailing);
+				std::uint64_t difference = 0;
+				if (width <= 0 || !reader.read(width, difference))
+				{
+					return false;
+				}
+
+				previous ^= difference << trailing;
+			}
+
+			keep(row, std::bit_cast<double>(previous));
+		}
+
+		return true;
+	}
+
+	template<typename Keep>
+	bool decodeStrings(std::span<const std::byte> bytes, std::size_t rowCount, Keep&& keep)
+	{
+		PacketReader reader(bytes);
+		std::size_t  remaining = bytes.size();
+		std::string  value;
+
+		for (std::size_t row = 0; row < rowCount; ++row)
+		{
+			std::uint64_t size = 0;
+			if (!reader.readVarint(size) || size > remaining)
+			{
+				return false;
+			}
+
+			value.resize(size);
+			if (!reader.read(value.data(), size))
+			{
+				return false;
+			}
+
+			remaining -= size;
+			keep(row, value);
+		}
+
+		return reader.isAtEnd();
+	}
+
+	template<typename T>
+	void pushInteger(Integers& values, PacketReader& reader, bool& isValid)
+	{
+		T value{};
+		isValid = isValid && PacketEncoding::readLittleEndian(reader, value);
+
+		if constexpr (std::is_same_v<T, std::uint64_t>)
+		{
+			values.push_back(std::bit_cast<std::int64_t>(value));
+		}
+		else
+		{
+			values.push_back(static_cast<std::int64_t>(value));
+		}
+	}
+
+	template<typename T>
+	void writeInteger(std::vector<std::byte>& out, std::int64_t value)
+	{
+		PacketEncoding::writeLittleEndian(out, static_cast<T>(value));
+	}
+}
+
+namespace TimeSeriesCodec
+{
+	Compression getDefaultCompression()
+	{
+#ifdef VECTORIUM_TIMESERIES_ZSTD
+		return Compression::Zstd;
+#else
+		return Compression::None;
+#endif
+	}
+
+	TimeSeriesColumn makeColumn(std::string_view name, PacketFieldKind kind)
+	{
+		TimeSeriesColumn column{ .name = std::string(name), .kind = kind, .values = Integers{} };
+
+		if (kind == PacketFieldKind::Float32 || kind == PacketFieldKind::Float64)
+		{
+			column.values = Floats{};
+		}
+		else if (kind == PacketFieldKind::String)
+		{
+			column.values = Strings{};
+		}
+
+		return column;
+	}
+
+	void clearRows(TimeSeriesRange& rows)
+	{
+		rows.timestampsNs.clear();
+		for (auto& column : rows.columns)
+		{
+			std::visit([](auto& values) { values.clear(); }, column.values);
+		}
+	}
+
+	bool appendEncodedRow(std::span<const std::byte> encoded, std::int64_t timestampNs, TimeSeriesRange& rows)
+	{
+		PacketReader reader(encoded);
+		bool         isValid = true;
+
+		for (auto& column : rows.columns)
+		{
+			switch (column.kind)
+			{
+			case PacketFieldKind::Bool:
+			case PacketFieldKind::UInt8: pushInteger<std::uint8_t>(std::get<Integers>(column.values), reader, isValid); break;
+			case PacketFieldKind::Int8: pushInteger<std::int8_t>(std::get<Integers>(column.values), reader, isValid); break;
+			case PacketFieldKind::Int16: pushInteger<std::int16_t>(std::get<Integers>(column.values), reader, isValid); break;
+			case PacketFieldKind::UInt16: pushInteger<std::uint16_t>(std::get<Integers>(column.values), reader, isValid); break;
+			case PacketFieldKind::Int32: pushInteger<std::int32_t>(std::get<Integers>(column.values), reader, isValid); break;
+			case PacketFieldKind::UInt32: pushInteger<std::uint32_t>(std::get<Integers>(column.values), reader, isValid); break;
+			case PacketFieldKind::Int64:
+			case PacketFieldKind::Timestamp: pushInteger<std::int64_t>(std::get<Integers>(column.values), reader, isValid); break;
+			case PacketFieldKind::UInt64: pushInteger<std::uint64_t>(std::get<Integers>(column.values), reader, isValid); break;
+			case PacketFieldKind::Float32:
+			{
+				float value = 0;
+				isValid = isValid && PacketEncoding::readLittleEndian(reader, value);
+				std::get<Floats>(column.values).push_back(value);
+				break;
+			}
+			case PacketFieldKind::Float64:
+			{
+				double value = 0;
+				isValid = isValid && PacketEncoding::readLittleEndian(reader, value);
+				std::get<Floats>(column.values).push_back(value);
+				break;
+			}
+			case PacketFieldKind::String:
+			{
+				std::uint64_t size = 0;
+				std::string   value;
+				isValid = isValid && reader.readVarint(size) && size <= encoded.size();
+				if (isValid)
+				{
+					value.resize(size);
+					isValid = reader.read(value.data(), size);
+				}
+
+				std::get<Strings>(column.values).push_back(std::move(value));
+				break;
+			}
+			}
+		}
+
+		if (!isValid || !reader.isAtEnd())
+		{
+			// Every column got a value, so each drops its last
+			for (auto& column : rows.columns)
+			{
+				std::visit([](auto& values) { values.pop_back(); }, column.values);
+			}
+
+			return false;
+		}
+
+		rows.timestampsNs.push_back(timestampNs);
+		return true;
+	}
+
+	void encodeRow(const TimeSeriesRange& rows, std::size_t row, std::vector<std::byte>& out)
+	{
+		for (const auto& column : rows.columns)
+		{
+			switch (column.kind)
+			{
+			case PacketFieldKind::Bool:
+			case PacketFieldKind::UInt8: writeInteger<std::uint8_t>(out, std::get<Integers>(column.values)[row]); break;
+			case PacketFieldKind::Int8: writeInteger<std::int8_t>(out, std::get<Integers>(column.values)[row]); break;
+			case PacketFieldKind::Int16: writeInteger<std::int16_t>(out, std::get<Integers>(column.values)[row]); break;
+			case PacketFieldKind::UInt16: writeInteger<std::uint16_t>(out, std::get<Integers>(column.values)[row]); break;
+			case PacketFieldKind::Int32: writeInteger<std::int32_t>(out, std::get<Integers>(column.values)[row]); break;
+			case PacketFieldKind::UInt32: writeInteger<std::uint32_t>(out, std::get<Integers>(column.values)[row]); break;
+			case PacketFieldKind::Int64:
+			case PacketFieldKind::Timestamp:
+			case PacketFieldKind::UInt64: writeInteger<std::int64_t>(out, std::get<Integers>(column.values)[row]); break;
+			case PacketFieldKind::Float32: PacketEncoding::writeLittleEndian(out, static_cast<float>(std::get<Floats>(column.values)[row])); break;
+			case PacketFieldKind::Float64: PacketEncoding::writeLittleEndian(out, std::get<Floats>(column.values)[row]); break;
+			case PacketFieldKind::String:
+			{
+				const std::string& value = std::get<Strings>(column.values)[row];
+				PacketEncoding::writeVarint(out, value.size());
+				const auto* bytes = reinterpret_cast<const std::byte*>(value.data());
+				out.insert(out.end(), bytes, bytes + value.size());
+				break;
+			}
+			}
+		}
+	}
+
+	void appendRowsInRange(const TimeSeriesRange& from, std::int64_t fromNs, std::int64_t toNs, TimeSeriesRange& to)
+	{
+		for (std::size_t row = 0; row < from.timestampsNs.size(); ++row)
+		{
+			const std::int64_t timestampNs = from.timestampsNs[row];
+			if (timestampNs < fromNs || timestampNs >= toNs)
+			{
+				continue;
+			}
+
+			to.timestampsNs.push_back(timestampNs);
+			for (std::size_t i = 0; i < from.columns.size(); ++i)
+			{
+				std::visit([&](const auto& values)
+				{
+					std::get<std::remove_cvref_t<decltype(values)>>(to.columns[i].values).push_back(values[row]);
+				}, from.columns[i].values);
+			}
+		}
+	}
+
+	void encodeColumns(const TimeSeriesRange& rows, std::vector<std::byte>& out)
+	{
+		std::vector<std::byte> scratch;
+
+		writeColumn(out, scratch, [&](std::vector<std::byte>& column) { encodeTimestamps(rows.timestampsNs, column); });
+
+		for (const auto& field : rows.columns)
+		{
+			writeColumn(out, scratch, [&](std::vector<std::byte>& column)
+			{
+				std::visit([&]<typename Values>(const Values& values)
+				{
+					if constexpr (std::is_same_v<Values, Floats>)
+					{
+						encodeFloats(values, column);
+					}
+					else if constexpr (std::is_same_v<Values, Strings>)
+					{
+						encodeStrings(values, column);
+					}
+					else
+					{
+						encodeIntegers(values, column);
+					}
+				}, field.values);
+			});
+		}
+	}
+
+	std::expected<void, std::string> decodeColumns(std::span<const std::byte> bytes, std::size_t rowCount, std::int64_t fromNs, std::int64_t toNs,
+	                                               TimeSeriesRange& rows)
+	{
+		std::size_t offset = 0;
+
+		auto timestampColumn = readColumn(bytes, offset);
+		if (!timestampColumn)
+		{
+			return std::unexpected(timestampColumn.error());
+		}
+
+		// Which rows are in range - the other columns keep the same ones
+		std::vector<bool> isKept(rowCount);
+		const std::size_t rowsBefore = rows.timestampsNs.size();
+
+		const bool isTimestampValid = decodeTimestamps(*timestampColumn, rowCount, [&](std::size_t row, std::int64_t timestampNs)
+		{
+			isKept[row] = timestampNs >= fromNs && timestampNs < toNs;
+			if (isKept[row])
+			{
+				rows.timestampsNs.push_back(timestampNs);
+			}
+		});
+
+		if (!isTimestampValid)
+		{
+			rows.timestampsNs.resize(rowsBefore);
+			return std::unexpected("Timestamps don't decode");
+		}
+
+		for (auto& field : rows.columns)
+		{
+			auto column = readColumn(bytes, offset);
+			bool isValid = column.has_value();
+
+			if (isValid)
+			{
+				std::visit([&]<typename Values>(Values& values)
+				{
+					const auto keep = [&](std::size_t row, const auto& value)
+					{
+						if (isKept[row])
+						{
+							values.push_back(value);
+						}
+					};
+
+					if constexpr (std::is_same_v<Values, Floats>)
+					{
+						isValid = decodeFloats(*column, rowCount, keep);
+					}
+					else if constexpr (std::is_same_v<Values, Strings>)
+					{
+						isValid = decodeStrings(*column, rowCount, keep);
+					}
+					else
+					{
+						isValid = decodeIntegers(*column, rowCount, keep);
+					}
+				}, field.values);
+			}
+
+			if (!isValid)
+			{
+				// Back to the rows there were, so the columns stay the same length
+				rows.timestampsNs.resize(rowsBefore);
+				for (auto& other : rows.columns)
+				{
+					std::visit([&](auto& values) { values.resize(std::min(values.size(), rowsBefore)); }, other.values);
+				}
+
+				return std::unexpected(std::format("Column '{}' doesn't decode", field.name));
+			}
+		}
+
+		return {};
+	}
+
+	bool compress(Compression compression, std::span<const std::byte> data, std::vector<std::byte>& out)
+	{
+#ifdef VECTORIUM_TIMESERIES_ZSTD
+		if (compression == Compression::Zstd)
+		{
+			out.resize(ZSTD_compressBound(data.size()));
+			const std::size_t size = ZSTD_compress(out.data(), out.size(), data.data(), data.size(), ZSTD_CLEVEL_DEFAULT);
+			if (!ZSTD_isError(size) && size < data.size())
+			{
+				out.resize(size);
+				return true;
+			}
+		}
+#else
+		(void)compression;
+#endif
+
+		out.assign(data.begin(), data.end());
+		return false;
+	}
+
+	std::expected<void, std::string> decompress(Compression compression, std::span<const std::byte> data, std::size_t rawSize, std::vector<std::byte>& out)
+	{
+		switch (compression)
+		{
+		case Compression::None:
+			if (data.size() != rawSize)
+			{
+				return std::unexpected(std::format("Block is {} bytes, not {}", data.size(), rawSize));
+			}
+
+			out.assign(data.begin(), data.end());
+			return {};
+
+		case Compression::Zstd:
+		{
+#ifdef VECTORIUM_TIMESERIES_ZSTD
+			out.resize(rawSize);
+			const std::size_t size = ZSTD_decompress(out.data(), out.size(), data.data(), data.size());
+			if (ZSTD_isError(size) || size != rawSize)
+			{
+				return std::unexpected(std::format("Block doesn't decompress: {}", ZSTD_isError(size) ? ZSTD_getErrorName(size) : "wrong size"));
+			}
+
+			return {};
+#else
+			return std::unexpected("Block is zstd compressed, and this build is without zstd");
+#endif
+		}
+		}
+
+		return std::unexpected(std::format("Unknown compression {}", static_cast<int>(compression)));
+	}
+}
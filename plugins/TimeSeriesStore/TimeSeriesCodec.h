@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "DataPacket/PacketSchema.h"
+#include "Services/TimeSeries/ITimeSeriesStore.h"
+
+/// <summary>
+/// How a block of rows is laid out on disk. Columns follow each other, each a varint byte length then its values:
+/// timestamps as delta-of-delta zigzag varints, integers as delta zigzag varints, floats XOR'd with the value before
+/// (as in Facebook's Gorilla) and strings as a varint length then their bytes. The whole block may then be compressed.
+/// </summary>
+namespace TimeSeriesCodec
+{
+	enum class Compression : std::uint8_t
+	{
+		None,
+		Zstd
+	};
+
+	/// <summary>
+	/// Zstd if the plugin was built with it
+	/// </summary>
+	Compression getDefaultCompression();
+
+	/// <summary>
+	/// An empty column for the field, holding the values the kind is kept as
+	/// </summary>
+	TimeSeriesColumn makeColumn(std::string_view name, PacketFieldKind kind);
+
+	void clearRows(TimeSeriesRange& rows);
+
+	/// <summary>
+	/// Appends a row from a packet's PacketSerializer encoding, which has to match the columns
+	/// </summary>
+	/// <returns>False, with the rows as they were, if the encoding doesn't match</returns>
+	bool appendEncodedRow(std::span<const std::byte> encoded, std::int64_t timestampNs, TimeSeriesRange& rows);
+
+	/// <summary>
+	/// The row as its PacketSerializer encoding, for decoding it back into a packet
+	/// </summary>
+	void encodeRow(const TimeSeriesRange& rows, std::size_t row, std::vector<std::byte>& out);
+
+	/// <summary>
+	/// Appends the rows that are timestamped in [fromNs, toNs) from another range with the same columns
+	/// </summary>
+	void appendRowsInRange(const TimeSeriesRange& from, std::int64_t fromNs, std::int64_t toNs, TimeSeriesRange& to);
+
+	void                            encodeColumns(const TimeSeriesRange& rows, std::vector<std::byte>& out);
+	std::expected<void, std::string> decodeColumns(std::span<const std::byte> bytes, std::size_t rowCount, std::int64_t fromNs, std::int64_t toNs,
+	                                               TimeSeriesRange& rows); // appends, the columns have to match
+
+	/// <returns>False if it doesn't compress, out is then the data as it was</returns>
+	bool                             compress(Compression compression, std::span<const std::byte> data, std::vector<std::byte>& out);
+	std::expected<void, std::string> decompress(Compression compression, std::span<const std::byte> data, std::size_t rawSize, std::vector<std::byte>& out);
+}
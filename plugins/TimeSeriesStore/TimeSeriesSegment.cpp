@@ -0,0 +1,289 @@
+#include "TimeSeriesSegment.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace TimeSeriesSegmentFormat;
+
+SeriesLayout SeriesLayout::fromSerializer(const PacketSerializer& serializer)
+{
+	SeriesLayout layout{ .schemaHash = serializer.schemaHash, .fields = {} };
+	for (const PacketFieldInfo& field : serializer.fields)
+	{
+		layout.fields.push_back(Field{ .name = std::string(field.name), .kind = field.kind });
+	}
+
+	return layout;
+}
+
+TimeSeriesRange SeriesLayout::makeRows(std::string_view schemaName) const
+{
+	TimeSeriesRange rows{ .schemaName = std::string(schemaName), .timestampsNs = {}, .columns = {} };
+	for (const Field& field : fields)
+	{
+		rows.columns.push_back(TimeSeriesCodec::makeColumn(field.name, field.kind));
+	}
+
+	return rows;
+}
+
+std::expected<std::unique_ptr<SegmentWriter>, std::string> SegmentWriter::create(const std::filesystem::path& path, const SeriesLayout& layout)
+{
+	std::vector<std::byte> fieldTable;
+	for (const auto& field : layout.fields)
+	{
+		fieldTable.push_back(static_cast<std::byte>(field.kind));
+		PacketEncoding::writeVarint(fieldTable, field.name.size());
+		const auto* name = reinterpret_cast<const std::byte*>(field.name.data());
+		fieldTable.insert(fieldTable.end(), name, name + field.name.size());
+	}
+
+	FileHeader header{};
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.fieldTableSize = static_cast<std::uint32_t>(fieldTable.size());
+	header.schemaHash = layout.schemaHash;
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(fieldTable.data()), static_cast<std::streamsize>(fieldTable.size()));
+	file.flush();
+
+	if (!file)
+	{
+		return std::unexpected(std::format("Could not create segment '{}'", path.string()));
+	}
+
+	return std::unique_ptr<SegmentWriter>(new SegmentWriter(path, std::move(file), sizeof(header) + fieldTable.size()));
+}
+
+SegmentWriter::SegmentWriter(std::filesystem::path path, std::ofstream file, std::uint64_t size)
+	: m_path(std::move(path))
+	, m_file(std::move(file))
+	, m_size(size)
+{
+}
+
+std::expected<void, std::string> SegmentWriter::appendBlock(const TimeSeriesRange& rows, TimeSeriesCodec::Compression compression)
+{
+	if (rows.timestampsNs.empty())
+	{
+		return {};
+	}
+
+	m_raw.clear();
+	TimeSeriesCodec::encodeColumns(rows, m_raw);
+
+	const bool isCompressed = TimeSeriesCodec::compress(compression, m_raw, m_compressed);
+	const auto [minTimestamp, maxTimestamp] = std::ranges::minmax(rows.timestampsNs);
+
+	BlockHeader header{};
+	header.magic = blockMagic;
+	header.compression = isCompressed ? compression : TimeSeriesCodec::Compression::None;
+	header.rowCount = static_cast<std::uint32_t>(rows.timestampsNs.size());
+	header.rawSize = static_cast<std::uint32_t>(m_raw.size());
+	header.storedSize = static_cast<std::uint32_t>(m_compressed.size());
+	header.minTimestampNs = minTimestamp;
+	header.maxTimestampNs = maxTimestamp;
+
+	m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	m_file.write(reinterpret_cast<const char*>(m_compressed.data()), static_cast<std::streamsize>(m_compressed.size()));
+	m_file.flush();
+
+	if (!m_file)
+	{
+		// Whatever part of it got written is past getSize(), so readers never see it
+		m_file.clear();
+		m_file.seekp(static_cast<std::streamoff>(m_size));
+		return std::unexpected(std::format("Could not write to segment '{}'", m_path.string()));
+	}
+
+	m_size += sizeof(header) + m_compressed.size();
+	m_firstTimestampNs = std::min(m_firstTimestampNs, minTimestamp);
+	return {};
+}
+
+std::expected<std::shared_ptr<const SegmentReader>, std::string> SegmentReader::open(const std::filesystem::path& path, std::uint64_t size)
+{
+	std::error_code ec;
+	const std::uint64_t fileSize = std::min<std::uint64_t>(std::filesystem::file_size(path, ec), size);
+	if (ec)
+	{
+		return std::unexpected(std::format("Could not open segment '{}': {}", path.string(), ec.message()));
+	}
+
+	if (fileSize < sizeof(FileHeader))
+	{
+		return std::unexpected(std::format("'{}' is too small to be a segment", path.string()));
+	}
+
+#ifdef _WIN32
+	// Read into memory instead of mapping it
+	std::shared_ptr<SegmentReader> reader(new SegmentReader(path, nullptr, 0));
+	reader->m_contents.resize(fileSize);
+
+	std::ifstream file(path, std::ios::binary);
+	file.read(reinterpret_cast<char*>(reader->m_contents.data()), static_cast<std::streamsize>(fileSize));
+	if (!file)
+	{
+		return std::unexpected(std::format("Could not read segment '{}'", path.string()));
+	}
+
+	reader->m_mapping = reader->m_contents.data();
+	reader->m_mappedBytes = reader->m_contents.size();
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		return std::unexpected(std::format("Could not open segment '{}': {}", path.string(), std::strerror(errno)));
+	}
+
+	// The mapping outlives the descriptor
+	void* mapping = ::mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+	const int error = errno;
+	::close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		return std::unexpected(std::format("Could not map segment '{}': {}", path.string(), std::strerror(error)));
+	}
+
+	std::shared_ptr<SegmentReader> reader(new SegmentReader(path, static_cast<const std::byte*>(mapping), fileSize));
+#endif
+
+	if (auto layout = reader->readLayout(); !layout)
+	{
+		return std::unexpected(layout.error());
+	}
+
+	reader->readBlocks();
+	return reader;
+}
+
+SegmentReader::SegmentReader(std::filesystem::path path, const std::byte* mapping, std::size_t mappedBytes)
+	: m_path(std::move(path))
+	, m_mapping(mapping)
+	, m_mappedBytes(mappedBytes)
+{
+}
+
+SegmentReader::~SegmentReader()
+{
+#ifndef _WIN32
+	if (m_mapping)
+	{
+		::munmap(const_cast<std::byte*>(m_mapping), m_mappedBytes);
+	}
+#endif
+}
+
+std::expected<void, std::string> SegmentReader::readLayout()
+{
+	FileHeader header;
+	std::memcpy(&header, m_mapping, sizeof(header));
+
+	if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+	{
+		return std::unexpected(std::format("'{}' is not a segment", m_path.string()));
+	}
+
+	if (header.version != version)
+	{
+		return std::unexpected(std::format("Segment '{}' is version {}, this build reads version {}", m_path.string(), header.version, version));
+	}
+
+	if (header.fieldTableSize > m_mappedBytes - sizeof(header))
+	{
+		return std::unexpected(std::format("Segment '{}' is damaged", m_path.string()));
+	}
+
+	m_layout.schemaHash = header.schemaHash;
+	m_dataOffset = sizeof(header) + header.fieldTableSize;
+
+	const std::span<const std::byte> fieldTable(m_mapping + sizeof(header), header.fieldTableSize);
+	PacketReader                     reader(fieldTable);
+
+	while (!reader.isAtEnd())
+	{
+		std::uint8_t  kind = 0;
+		std::uint64_t nameSize = 0;
+		if (!reader.read(&kind, 1) || kind > static_cast<std::uint8_t>(PacketFieldKind::String) || !reader.readVarint(nameSize) || nameSize > fieldTable.size())
+		{
+			return std::unexpected(std::format("Segment '{}' has a damaged field table", m_path.string()));
+		}
+
+		SeriesLayout::Field field{ .name = std::string(nameSize, '\0'), .kind = static_cast<PacketFieldKind>(kind) };
+		if (!reader.read(field.name.data(), nameSize))
+		{
+			return std::unexpected(std::format("Segment '{}' has a damaged field table", m_path.string()));
+		}
+
+		m_layout.fields.push_back(std::move(field));
+	}
+
+	return {};
+}
+
+void SegmentReader::readBlocks()
+{
+	// Up to the first block that isn't whole - a segment being written, or cut short, ends there
+	std::uint64_t offset = m_dataOffset;
+	while (m_mappedBytes - offset >= sizeof(BlockHeader))
+	{
+		BlockHeader header;
+		std::memcpy(&header, m_mapping + offset, sizeof(header));
+
+		// Every row takes at least a byte of the timestamp column
+		if (header.magic != blockMagic || header.storedSize > m_mappedBytes - offset - sizeof(header) || header.rowCount > header.rawSize)
+		{
+			break;
+		}
+
+		m_blocks.push_back(Block{ .offset = offset + sizeof(header), .header = header });
+		m_rowCount += header.rowCount;
+		m_minTimestampNs = std::min(m_minTimestampNs, header.minTimestampNs);
+		m_maxTimestampNs = std::max(m_maxTimestampNs, header.maxTimestampNs);
+
+		offset += sizeof(header) + header.storedSize;
+	}
+}
+
+std::expected<void, std::string> SegmentReader::read(std::int64_t fromNs, std::int64_t toNs, TimeSeriesRange& rows) const
+{
+	std::vector<std::byte> decompressed;
+
+	for (const Block& block : m_blocks)
+	{
+		if (block.header.minTimestampNs >= toNs || block.header.maxTimestampNs < fromNs)
+		{
+			continue;
+		}
+
+		std::span<const std::byte> columns(m_mapping + block.offset, block.header.storedSize);
+		if (block.header.compression != TimeSeriesCodec::Compression::None)
+		{
+			if (auto result = TimeSeriesCodec::decompress(block.header.compression, columns, block.header.rawSize, decompressed); !result)
+			{
+				return std::unexpected(std::format("Segment '{}': {}", m_path.string(), result.error()));
+			}
+
+			columns = decompressed;
+		}
+
+		if (auto result = TimeSeriesCodec::decodeColumns(columns, block.header.rowCount, fromNs, toNs, rows); !result)
+		{
+			return std::unexpected(std::format("Segment '{}': {}", m_path.string(), result.error()));
+		}
+	}
+
+	return {};
+}
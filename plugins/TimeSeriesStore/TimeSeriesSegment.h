@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "DataPacket/PacketSchema.h"
+#include "Services/TimeSeries/ITimeSeriesStore.h"
+#include "TimeSeriesCodec.h"
+
+/// <summary>
+/// A segment file holds one series' rows for a stretch of time: a FileHeader and the fields, then blocks of rows one
+/// after the other, each a BlockHeader and its TimeSeriesCodec columns. A block is only ever appended whole, so a
+/// segment cut short by a crash is readable up to its last whole block.
+/// </summary>
+namespace TimeSeriesSegmentFormat
+{
+	inline constexpr char          magic[8] = {'V', 'E', 'C', 'T', 'S', 'E', 'G', '\0'};
+	inline constexpr std::uint32_t version = 1;
+	inline constexpr std::uint32_t blockMagic = 0x4b4c4254; // "TBLK"
+
+	struct FileHeader
+	{
+		char          magic[8];
+		std::uint32_t version;
+		std::uint32_t fieldTableSize; // bytes after the header - per field its kind, then a varint length and its name
+		std::uint64_t schemaHash;
+	};
+
+	struct BlockHeader
+	{
+		std::uint32_t                magic;
+		TimeSeriesCodec::Compression compression;
+		std::uint8_t                 reserved[3];
+		std::uint32_t                rowCount;
+		std::uint32_t                rawSize;    // of the columns, uncompressed
+		std::uint32_t                storedSize; // bytes after the header
+		std::uint32_t                reserved2;
+		std::int64_t                 minTimestampNs;
+		std::int64_t                 maxTimestampNs;
+	};
+
+	static_assert(sizeof(FileHeader) == 24 && sizeof(BlockHeader) == 40);
+}
+
+/// <summary>
+/// The fields a series is stored with, from its packet schema
+/// </summary>
+struct SeriesLayout
+{
+	struct Field
+	{
+		std::string     name;
+		PacketFieldKind kind;
+	};
+
+	std::uint64_t      schemaHash = 0;
+	std::vector<Field> fields;
+
+	static SeriesLayout fromSerializer(const PacketSerializer& serializer);
+
+	/// <summary>
+	/// Empty rows with a column per field
+	/// </summary>
+	[[nodiscard]] TimeSeriesRange makeRows(std::string_view schemaName) const;
+	[[nodiscard]] bool            isEmpty() const { return schemaHash == 0; }
+};
+
+/// <summary>
+/// Appends blocks to a new segment file. Not thread-safe.
+/// </summary>
+class SegmentWriter
+{
+public:
+	static std::expected<std::unique_ptr<SegmentWriter>, std::string> create(const std::filesystem::path& path, const SeriesLayout& layout);
+
+	/// <summary>
+	/// Writes the rows as one block, flushed so a reader mapping the file sees all of it
+	/// </summary>
+	std::expected<void, std::string> appendBlock(const TimeSeriesRange& rows, TimeSeriesCodec::Compression compression);
+
+	[[nodiscard]] const std::filesystem::path& getPath() const { return m_path; }
+	[[nodiscard]] std::uint64_t                getSize() const { return m_size; } // every byte of it in whole blocks
+	[[nodiscard]] std::int64_t                 getFirstTimestampNs() const { return m_firstTimestampNs; } // of the first block's oldest row
+
+private:
+	SegmentWriter(std::filesystem::path path, std::ofstream file, std::uint64_t size);
+
+	const std::filesystem::path m_path;
+	std::ofstream               m_file;
+	std::uint64_t               m_size = 0;
+	std::int64_t                m_firstTimestampNs = std::numeric_limits<std::int64_t>::max();
+
+	std::vector<std::byte> m_raw;
+	std::vector<std::byte> m_compressed;
+};
+
+/// <summary>
+/// A segment file mapped for reading. Its blocks' time ranges are read when it's opened, so a query only decodes the
+/// blocks that overlap it. Thread-safe - it doesn't change once opened.
+/// </summary>
+class SegmentReader
+{
+public:
+	/// <param name="size">Map only this much, eg. the part of a segment still being written that is whole blocks</param>
+	static std::expected<std::shared_ptr<const SegmentReader>, std::string> open(const std::filesystem::path& path,
+	                                                                             std::uint64_t size = std::numeric_limits<std::uint64_t>::max());
+
+	~SegmentReader();
+
+	SegmentReader(const SegmentReader&) = delete;
+	SegmentReader& operator=(const SegmentReader&) = delete;
+
+	/// <summary>
+	/// Appends the rows timestamped in [fromNs, toNs) - rows has to have this segment's columns
+	/// </summary>
+	std::expected<void, std::string> read(std::int64_t fromNs, std::int64_t toNs, TimeSeriesRange& rows) const;
+
+	[[nodiscard]] const std::filesystem::path& getPath() const { return m_path; }
+	[[nodiscard]] const SeriesLayout&          getLayout() const { return m_layout; }
+	[[nodiscard]] std::int64_t                 getMinTimestampNs() const { return m_minTimestampNs; }
+	[[nodiscard]] std::int64_t                 getMaxTimestampNs() const { return m_maxTimestampNs; }
+	[[nodiscard]] std::uint64_t                getRowCount() const { return m_rowCount; }
+	[[nodiscard]] bool                         overlaps(std::int64_t fromNs, std::int64_t toNs) const
+	{
+		return m_rowCount != 0 && m_minTimestampNs < toNs && m_maxTimestampNs >= fromNs;
+	}
+
+private:
+	struct Block
+	{
+		std::uint64_t                        offset; // of the columns
+		TimeSeriesSegmentFormat::BlockHeader header;
+	};
+
+	SegmentReader(std::filesystem::path path, const std::byte* mapping, std::size_t mappedBytes);
+
+	std::expected<void, std::string> readLayout();
+	void                             readBlocks();
+
+	const std::filesystem::path m_path;
+	const std::byte*            m_mapping = nullptr;
+	std::size_t                 m_mappedBytes = 0;
+	std::vector<std::byte>      m_contents; // what's mapped, where files can't be
+
+	SeriesLayout       m_layout;
+	std::vector<Block> m_blocks;
+	std::uint64_t      m_dataOffset = 0;
+	std::uint64_t      m_rowCount = 0;
+	std::int64_t       m_minTimestampNs = std::numeric_limits<std::int64_t>::max();
+	std::int64_t       m_maxTimestampNs = std::numeric_limits<std::int64_t>::min();
+};
@@ -0,0 +1,508 @@
+#include "TimeSeriesStore.h"
+
+#include <algorithm>
+#include <format>
+#include <limits>
+#include <ranges>
+#include <utility>
+
+#include "DataPacket/SchemaSubscription.h"
+#include "Plugin/IPluginContext.h"
+#include "Services/Logging/ILogger.h"
+
+namespace
+{
+	std::int64_t toNanoseconds(std::chrono::system_clock::time_point time)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+	}
+
+	std::chrono::system_clock::time_point fromNanoseconds(std::int64_t nanoseconds)
+	{
+		return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanoseconds)));
+	}
+}
+
+struct TimeSeriesStore::Series
+{
+	Series(std::string name, std::filesystem::path directory)
+		: name(std::move(name))
+		, directory(std::move(directory))
+		, subscription(this->name)
+	{
+	}
+
+	const std::string           name;
+	const std::filesystem::path directory;
+
+	// Only touched by tick() and close()
+	SchemaSubscription                    subscription;
+	std::vector<std::byte>                encoded;
+	std::chrono::steady_clock::time_point blockStarted;
+	std::uint64_t                         failedPackets = 0;
+
+	// Guards the rest - queries only hold it to copy what they need
+	mutable std::mutex                                mutex;
+	SeriesLayout                                      layout;   // of the newest segment, then of the type's schema once it's registered
+	TimeSeriesRange                                   openRows; // not in a segment yet
+	std::vector<std::shared_ptr<const SegmentReader>> segments; // finished, oldest first
+	std::unique_ptr<SegmentWriter>                    writer;   // the segment being written
+	std::uint64_t                                     writerRows = 0;
+	std::int64_t                                      writerMinTimestampNs = std::numeric_limits<std::int64_t>::max();
+	std::int64_t                                      writerMaxTimestampNs = std::numeric_limits<std::int64_t>::min();
+};
+
+TimeSeriesStore::TimeSeriesStore(IPluginContext& context, TimeSeriesStoreConfig config)
+	: m_config(std::move(config))
+	, m_compression(TimeSeriesCodec::getDefaultCompression())
+	, m_logger(context.getLoggerShared())
+	, m_context(&context)
+{
+	for (const auto& schemaName : m_config.series)
+	{
+		track(schemaName);
+	}
+}
+
+TimeSeriesStore::~TimeSeriesStore() = default;
+
+bool TimeSeriesStore::track(std::string_view schemaName)
+{
+	if (!SchemaSubscription::isUsableAsFileName(schemaName))
+	{
+		log(LogLevel::Warning, std::format("Can't store '{}', it isn't usable as a directory name", schemaName));
+		return false;
+	}
+
+	std::lock_guard lock(m_seriesMutex);
+
+	if (findSeries(schemaName))
+	{
+		return true;
+	}
+
+	auto series = std::make_shared<Series>(std::string(schemaName), m_config.directory / schemaName);
+
+	// What earlier runs stored
+	std::vector<std::filesystem::path> paths;
+	std::error_code                    ec;
+	for (const auto& entry : std::filesystem::directory_iterator(series->directory, ec))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".seg")
+		{
+			paths.push_back(entry.path());
+		}
+	}
+
+	// Named after their first timestamp
+	std::ranges::sort(paths);
+	for (const auto& path : paths)
+	{
+		if (auto segment = SegmentReader::open(path))
+		{
+			series->segments.push_back(std::move(*segment));
+		}
+		else
+		{
+			log(LogLevel::Warning, std::format("Skipping segment: {}", segment.error()));
+		}
+	}
+
+	if (!series->segments.empty())
+	{
+		series->layout = series->segments.back()->getLayout();
+	}
+
+	series->openRows = series->layout.makeRows(series->name);
+	applyRetention(*series);
+
+	log(LogLevel::Info, std::format("Storing '{}' in '{}', {} segment(s) there already", series->name, series->directory.string(), series->segments.size()));
+	m_series.push_back(std::move(series));
+	return true;
+}
+
+std::vector<std::string> TimeSeriesStore::getTrackedSchemas() const
+{
+	std::lock_guard lock(m_seriesMutex);
+
+	std::vector<std::string> names;
+	for (const auto& series : m_series)
+	{
+		names.push_back(series->name);
+	}
+
+	return names;
+}
+
+std::expected<TimeSeriesRange, std::string> TimeSeriesStore::query(std::string_view schemaName, TimePoint from, TimePoint to)
+{
+	std::shared_ptr<Series> series;
+	{
+		std::lock_guard lock(m_seriesMutex);
+		series = findSeries(schemaName);
+	}
+
+	if (!series)
+	{
+		return std::unexpected(std::format("'{}' isn't stored", schemaName));
+	}
+
+	return read(*series, toNanoseconds(from), toNanoseconds(to));
+}
+
+std::expected<std::vector<DataPacket>, std::string> TimeSeriesStore::queryPackets(std::type_index packetType, TimePoint from, TimePoint to)
+{
+	std::shared_lock contextLock(m_contextMutex);
+	if (!m_context)
+	{
+		return std::unexpected("The time series store is closed");
+	}
+
+	const auto serializer = m_context->findPacketSerializer(packetType);
+	if (!serializer)
+	{
+		return std::unexpected(std::format("{} has no packet schema registered", packetType.name()));
+	}
+
+	std::shared_ptr<Series> series;
+	{
+		std::lock_guard lock(m_seriesMutex);
+		series = findSeries(serializer->name);
+	}
+
+	if (!series)
+	{
+		return std::unexpected(std::format("'{}' isn't stored", serializer->name));
+	}
+
+	auto rows = read(*series, toNanoseconds(from), toNanoseconds(to), serializer->schemaHash);
+	if (!rows)
+	{
+		return std::unexpected(rows.error());
+	}
+
+	std::vector<DataPacket> packets;
+	packets.reserve(rows->getRowCount());
+
+	std::vector<std::byte> encoded;
+	for (std::size_t row = 0; row < rows->getRowCount(); ++row)
+	{
+		encoded.clear();
+		TimeSeriesCodec::encodeRow(*rows, row, encoded);
+
+		auto packet = serializer->decode(encoded);
+		if (!packet)
+		{
+			return std::unexpected(std::format("'{}' row {} doesn't decode: {}", serializer->name, row, packet.error()));
+		}
+
+		packet->timestamp = fromNanoseconds(rows->timestampsNs[row]);
+		packets.push_back(std::move(*packet));
+	}
+
+	return packets;
+}
+
+void TimeSeriesStore::tick()
+{
+	std::shared_lock lock(m_contextMutex);
+	if (!m_context)
+	{
+		return;
+	}
+
+	for (const auto& series : getSeries())
+	{
+		if (auto subscribed = series->subscription.subscribe(*m_context); !subscribed)
+		{
+			log(LogLevel::Warning, subscribed.error());
+		}
+
+		store(*series, false);
+	}
+}
+
+void TimeSeriesStore::close()
+{
+	std::unique_lock lock(m_contextMutex);
+	if (!m_context)
+	{
+		return;
+	}
+
+	for (const auto& series : getSeries())
+	{
+		series->subscription.close();
+		store(*series, true);
+	}
+
+	m_context = nullptr;
+}
+
+std::shared_ptr<TimeSeriesStore::Series> TimeSeriesStore::findSeries(std::string_view schemaName) const
+{
+	const auto series = std::ranges::find(m_series, schemaName, &Series::name);
+	return series != m_series.end() ? *series : nullptr;
+}
+
+std::vector<std::shared_ptr<TimeSeriesStore::Series>> TimeSeriesStore::getSeries() const
+{
+	std::lock_guard lock(m_seriesMutex);
+	return m_series;
+}
+
+void TimeSeriesStore::store(Series& series, bool isClosing)
+{
+	if (!series.subscription.isSubscribed())
+	{
+		return;
+	}
+
+	// The layout is only changed from here, so it can be read without the series' mutex
+	const auto [packets, serializer, isSchemaChanged] = series.subscription.take(*m_context, series.layout.schemaHash);
+	const std::uint64_t failedBefore = series.failedPackets;
+
+	std::lock_guard lock(series.mutex);
+
+	if (isSchemaChanged)
+	{
+		// A new version of the schema starts a segment of its own
+		writeBlock(series);
+		sealSegment(series);
+
+		if (!series.layout.isEmpty())
+		{
+			log(LogLevel::Info, std::format("The schema of '{}' changed, segments stored before aren't queried", series.name));
+		}
+
+		series.layout = SeriesLayout::fromSerializer(*serializer);
+		series.openRows = series.layout.makeRows(series.name);
+	}
+
+	for (const DataPacket& packet : packets)
+	{
+		if (!serializer)
+		{
+			++series.failedPackets;
+			continue;
+		}
+
+		series.encoded.clear();
+		serializer->encode(packet, series.encoded);
+
+		if (!TimeSeriesCodec::appendEncodedRow(series.encoded, toNanoseconds(packet.timestamp), series.openRows))
+		{
+			++series.failedPackets;
+			continue;
+		}
+
+		if (series.openRows.getRowCount() == 1)
+		{
+			series.blockStarted = std::chrono::steady_clock::now();
+		}
+
+		if (series.openRows.getRowCount() >= m_config.blockRows)
+		{
+			writeBlock(series);
+		}
+	}
+
+	if (isClosing || (series.openRows.getRowCount() != 0 && std::chrono::steady_clock::now() - series.blockStarted >= m_config.blockInterval))
+	{
+		writeBlock(series);
+	}
+
+	if (isClosing)
+	{
+		sealSegment(series);
+	}
+
+	if (series.failedPackets != failedBefore)
+	{
+		log(LogLevel::Warning, std::format("{} '{}' packet(s) couldn't be stored, {} so far", series.failedPackets - failedBefore, series.name, series.failedPackets));
+	}
+}
+
+void TimeSeriesStore::writeBlock(Series& series)
+{
+	const std::size_t rowCount = series.openRows.getRowCount();
+	if (rowCount == 0)
+	{
+		return;
+	}
+
+	const auto [minTimestampNs, maxTimestampNs] = std::ranges::minmax(series.openRows.timestampsNs);
+
+	const auto segmentDurationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(m_config.segmentDuration).count();
+	if (series.writer && maxTimestampNs - series.writer->getFirstTimestampNs() >= segmentDurationNs)
+	{
+		sealSegment(series);
+	}
+
+	if (!series.writer)
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(series.directory, ec);
+
+		// Named after its first timestamp, sorting as they were written
+		auto path = series.directory / std::format("{:020}.seg", minTimestampNs);
+		for (int suffix = 1; std::filesystem::exists(path, ec); ++suffix)
+		{
+			path = series.directory / std::format("{:020}-{}.seg", minTimestampNs, suffix);
+		}
+
+		auto writer = SegmentWriter::create(path, series.layout);
+		if (!writer)
+		{
+			log(LogLevel::Error, std::format("Dropping {} '{}' row(s): {}", rowCount, series.name, writer.error()));
+			series.failedPackets += rowCount;
+			TimeSeriesCodec::clearRows(series.openRows);
+			return;
+		}
+
+		series.writer = std::move(*writer);
+		series.writerRows = 0;
+		series.writerMinTimestampNs = std::numeric_limits<std::int64_t>::max();
+		series.writerMaxTimestampNs = std::numeric_limits<std::int64_t>::min();
+	}
+
+	if (auto written = series.writer->appendBlock(series.openRows, m_compression); !written)
+	{
+		log(LogLevel::Error, std::format("Dropping {} '{}' row(s): {}", rowCount, series.name, written.error()));
+		series.failedPackets += rowCount;
+	}
+	else
+	{
+		series.writerRows += rowCount;
+		series.writerMinTimestampNs = std::min(series.writerMinTimestampNs, minTimestampNs);
+		series.writerMaxTimestampNs = std::max(series.writerMaxTimestampNs, maxTimestampNs);
+	}
+
+	TimeSeriesCodec::clearRows(series.openRows);
+}
+
+void TimeSeriesStore::sealSegment(Series& series)
+{
+	if (!series.writer)
+	{
+		return;
+	}
+
+	const std::filesystem::path path = series.writer->getPath();
+	series.writer.reset();
+
+	if (series.writerRows == 0)
+	{
+		std::error_code ec;
+		std::filesystem::remove(path, ec);
+		return;
+	}
+
+	if (auto segment = SegmentReader::open(path))
+	{
+		series.segments.push_back(std::move(*segment));
+	}
+	else
+	{
+		log(LogLevel::Error, std::format("Could not reopen a finished segment: {}", segment.error()));
+	}
+
+	applyRetention(series);
+}
+
+void TimeSeriesStore::applyRetention(Series& series)
+{
+	if (m_config.retention.count() == 0 || series.segments.empty())
+	{
+		return;
+	}
+
+	const std::int64_t newestNs = std::ranges::max(series.segments | std::views::transform(&SegmentReader::getMaxTimestampNs));
+	const std::int64_t cutoffNs = newestNs - std::chrono::duration_cast<std::chrono::nanoseconds>(m_config.retention).count();
+
+	// A query still reading one keeps its mapping
+	std::erase_if(series.segments, [&](const std::shared_ptr<const SegmentReader>& segment)
+	{
+		if (segment->getMaxTimestampNs() >= cutoffNs)
+		{
+			return false;
+		}
+
+		std::error_code ec;
+		std::filesystem::remove(segment->getPath(), ec);
+		log(LogLevel::Info, std::format("Deleted segment '{}', past retention", segment->getPath().string()));
+		return true;
+	});
+}
+
+void TimeSeriesStore::log(LogLevel level, const std::string& message) const
+{
+	if (m_logger)
+	{
+		m_logger->log(level, std::format("[TimeSeriesStore] - {}", message));
+	}
+}
+
+std::expected<TimeSeriesRange, std::string> TimeSeriesStore::read(Series& series, std::int64_t fromNs, std::int64_t toNs,
+                                                                  std::optional<std::uint64_t> schemaHash) const
+{
+	TimeSeriesRange                                   rows;
+	TimeSeriesRange                                   recentRows;
+	std::vector<std::shared_ptr<const SegmentReader>> segments;
+	std::filesystem::path                             writerPath;
+	std::uint64_t                                     writerSize = 0;
+
+	{
+		std::lock_guard lock(series.mutex);
+
+		if (schemaHash && *schemaHash != series.layout.schemaHash)
+		{
+			return std::unexpected(std::format("'{}' is stored with another version of its schema", series.name));
+		}
+
+		rows = series.layout.makeRows(series.name);
+		recentRows = series.layout.makeRows(series.name);
+
+		for (const auto& segment : series.segments)
+		{
+			if (segment->getLayout().schemaHash == series.layout.schemaHash && segment->overlaps(fromNs, toNs))
+			{
+				segments.push_back(segment);
+			}
+		}
+
+		// Whole blocks of the segment being written can be mapped as they are, later ones aren't looked at
+		if (series.writer && series.writerRows != 0 && series.writerMinTimestampNs < toNs && series.writerMaxTimestampNs >= fromNs)
+		{
+			writerPath = series.writer->getPath();
+			writerSize = series.writer->getSize();
+		}
+
+		TimeSeriesCodec::appendRowsInRange(series.openRows, fromNs, toNs, recentRows);
+	}
+
+	for (const auto& segment : segments)
+	{
+		if (auto result = segment->read(fromNs, toNs, rows); !result)
+		{
+			return std::unexpected(result.error());
+		}
+	}
+
+	if (writerSize != 0)
+	{
+		auto segment = SegmentReader::open(writerPath, writerSize);
+		if (!segment)
+		{
+			return std::unexpected(segment.error());
+		}
+
+		if (auto result = (*segment)->read(fromNs, toNs, rows); !result)
+		{
+			return std::unexpected(result.error());
+		}
+	}
+
+	TimeSeriesCodec::appendRowsInRange(recentRows, fromNs, toNs, rows);
+	return rows;
+}
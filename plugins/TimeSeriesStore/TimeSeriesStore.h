@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+#include "DataPacket/DataPacket.h"
+#include "Services/Logging/LogLevel.h"
+#include "Services/TimeSeries/ITimeSeriesStore.h"
+#include "TimeSeriesCodec.h"
+#include "TimeSeriesSegment.h"
+
+class ILogger;
+class IPluginContext;
+
+struct TimeSeriesStoreConfig
+{
+	std::filesystem::path    directory = "data/timeseries"; // a directory per series below it
+	std::vector<std::string> series;                        // schema names tracked from the start
+	std::size_t              blockRows = 4096;              // rows per block, at most
+	std::chrono::seconds     blockInterval{10};             // a block is written at least this often, full or not
+	std::chrono::minutes     segmentDuration{60};           // of packet time per segment file
+	std::chrono::hours       retention{0};                  // older segments are deleted, 0 = never
+};
+
+/// <summary>
+/// The ITimeSeriesStore the plugin provides. Each tracked type is a series: a directory of segment files, and the rows
+/// not yet written to one. Thread-safe.
+/// </summary>
+/// <remarks>
+/// Each series is a SchemaSubscription, its packets are encoded and written from tick(). Segments written before the
+/// schema of a type changed are kept but not queried.
+/// </remarks>
+class TimeSeriesStore final : public ITimeSeriesStore
+{
+public:
+	TimeSeriesStore(IPluginContext& context, TimeSeriesStoreConfig config);
+	~TimeSeriesStore() override;
+
+	TimeSeriesStore(const TimeSeriesStore&) = delete;
+	TimeSeriesStore& operator=(const TimeSeriesStore&) = delete;
+
+	bool                     track(std::string_view schemaName) override;
+	std::vector<std::string> getTrackedSchemas() const override;
+
+	using ITimeSeriesStore::query;
+	using ITimeSeriesStore::queryPackets;
+
+	std::expected<TimeSeriesRange, std::string>         query(std::string_view schemaName, TimePoint from, TimePoint to) override;
+	std::expected<std::vector<DataPacket>, std::string> queryPackets(std::type_index packetType, TimePoint from, TimePoint to) override;
+
+	/// <summary>
+	/// Subscribes to the tracked types whose schema has been registered since, and stores what arrived - from the
+	/// plugin's tick
+	/// </summary>
+	void tick();
+
+	/// <summary>
+	/// Writes out everything still held and stops storing - from the plugin's onPluginUnload. What is on disk can still
+	/// be queried.
+	/// </summary>
+	void close();
+
+private:
+	struct Series;
+
+	[[nodiscard]] std::shared_ptr<Series> findSeries(std::string_view schemaName) const;
+	[[nodiscard]] std::vector<std::shared_ptr<Series>> getSeries() const;
+
+	// Called from tick() and close(), with m_contextMutex held
+	void store(Series& series, bool isClosing);
+	void writeBlock(Series& series);     // and the series' mutex
+	void sealSegment(Series& series);    // and the series' mutex
+	void applyRetention(Series& series); // and the series' mutex
+	void log(LogLevel level, const std::string& message) const;
+
+	std::expected<TimeSeriesRange, std::string> read(Series& series, std::int64_t fromNs, std::int64_t toNs,
+	                                                 std::optional<std::uint64_t> schemaHash = std::nullopt) const;
+
+	const TimeSeriesStoreConfig        m_config;
+	const TimeSeriesCodec::Compression m_compression;
+	const std::shared_ptr<ILogger>     m_logger;
+
+	mutable std::shared_mutex m_contextMutex; // close() takes it exclusively, so nothing uses the context after
+	IPluginContext*           m_context;
+
+	mutable std::mutex                   m_seriesMutex;
+	std::vector<std::shared_ptr<Series>> m_series;
+};
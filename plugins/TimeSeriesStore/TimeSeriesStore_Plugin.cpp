@@ -0,0 +1,116 @@
+#include "TimeSeriesStore_Plugin.h"
+#include "Services/IServiceSpecialisations.h"
+
+#include <format>
+#include <fstream>
+
+#include <nlohmann/json.hpp>
+
+#include "Services/Logging/ILogger.h"
+#include "Services/Logging/LogLevel.h"
+
+std::expected<void, std::string> TimeSeriesStorePlugin::onPluginLoad(IPluginContext& context)
+{
+	m_logger = ServiceProxy(context.getService<ILogger>());
+
+	auto config = loadConfig();
+	if (!config)
+	{
+		return std::unexpected(config.error());
+	}
+
+	m_store = std::make_shared<TimeSeriesStore>(context, std::move(*config));
+
+	if (!context.provideService<ITimeSeriesStore>(m_store))
+	{
+		return std::unexpected("Could not provide the time series store");
+	}
+
+	m_logger->log(LogLevel::Info, "loaded");
+	return {};
+}
+
+void TimeSeriesStorePlugin::onPluginUnload()
+{
+	if (m_store)
+	{
+		m_store->close();
+	}
+
+	m_logger->log(LogLevel::Info, "unloading");
+}
+
+std::type_index TimeSeriesStorePlugin::getType() const
+{
+	return typeid(TimeSeriesRange);
+}
+
+void TimeSeriesStorePlugin::tick()
+{
+	if (m_store)
+	{
+		m_store->tick();
+	}
+}
+
+std::expected<TimeSeriesStoreConfig, std::string> TimeSeriesStorePlugin::loadConfig() const
+{
+	TimeSeriesStoreConfig config;
+
+	std::ifstream file(m_configPath);
+	if (!file)
+	{
+		m_logger->log(LogLevel::Info, std::format("No config at '{}', storing nothing until asked to", m_configPath.string()));
+		return config;
+	}
+
+	try
+	{
+		nlohmann::json j;
+		file >> j;
+
+		if (j.contains("directory")) config.directory = j["directory"].get<std::string>();
+		if (j.contains("series")) config.series = j["series"].get<std::vector<std::string>>();
+		if (j.contains("blockRows")) config.blockRows = std::max<std::size_t>(j["blockRows"].get<std::size_t>(), 1);
+		if (j.contains("blockInterval_seconds")) config.blockInterval = std::chrono::seconds(j["blockInterval_seconds"].get<int>());
+		if (j.contains("segmentDuration_minutes")) config.segmentDuration = std::chrono::minutes(j["segmentDuration_minutes"].get<int>());
+		if (j.contains("retention_hours")) config.retention = std::chrono::hours(j["retention_hours"].get<int>());
+	}
+	catch (const nlohmann::json::exception& e)
+	{
+		return std::unexpected(std::format("Could not read '{}': {}", m_configPath.string(), e.what()));
+	}
+
+	return config;
+}
+
+EXPORT PluginDescriptor* getPluginDescriptor()
+{
+	static PluginDescriptor descriptor
+	{
+		.name = "TimeSeriesStore",
+		.version = "1.0.0",
+		.services = {
+			{
+				.type = typeid(ILogger),
+				.name = "logger",
+				.minVersion = ">=1.0.0",
+				.required = false
+			}
+		},
+		.provides = {
+			{
+				.type = typeid(ITimeSeriesStore),
+				.name = "timeSeriesStore",
+				.version = "1.0.0"
+			}
+		}
+	};
+
+	return &descriptor;
+}
+
+EXPORT IPlugin* loadPlugin()
+{
+	return new TimeSeriesStorePlugin();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "Plugin/IPlugin.h"
+#include "Services/IService.h"
+#include "TimeSeriesStore.h"
+
+class ILogger;
+
+/// <summary>
+/// Stores the packet types listed in config/timeseries_store.json, and any other plugin asks it to, and provides
+/// ITimeSeriesStore to query them
+/// </summary>
+struct TimeSeriesStorePlugin final : public IPlugin
+{
+	std::expected<void, std::string> onPluginLoad(IPluginContext& context) override;
+	void                             onPluginUnload() override;
+
+	[[nodiscard]] std::type_index getType() const override;
+	void                          tick() override;
+
+	private:
+		std::expected<TimeSeriesStoreConfig, std::string> loadConfig() const;
+
+		ServiceProxy<ILogger>            m_logger{nullptr};
+		std::shared_ptr<TimeSeriesStore> m_store;
+		std::filesystem::path            m_configPath = std::filesystem::path("config") / "timeseries_store.json";
+};
@@ -0,0 +1,915 @@
+#include "DataPacket/PacketJournal.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <unordered_set>
+#include <utility>
+
+#include "DataPacket/DataPacketRegistry.h"
+#include "DataPacket/PacketSchema.h"
+#include "DataPacket/PacketTypeHash.h"
+#include "Profiling/TraceRecorder.h"
+#include "Services/Logging/ILogger.h"
+#include "Services/Logging/LogLevel.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace PacketJournalFormat;
+
+namespace
+{
+	constexpr std::uint64_t recordAlignment = 8;
+
+	constexpr std::uint64_t alignRecord(std::uint64_t bytes)
+	{
+		return (bytes + recordAlignment - 1) & ~(recordAlignment - 1);
+	}
+
+	// The same type with another schema is another type as far as its packets go
+	std::uint64_t journalTypeHash(std::string_view typeName, std::uint64_t schemaHash)
+	{
+		const std::uint64_t typeHash = hashPacketTypeName(typeName);
+		return schemaHash == 0 ? typeHash : typeHash ^ (schemaHash + 0x9e3779b97f4a7c15ull + (typeHash << 6) + (typeHash >> 2));
+	}
+
+	std::int64_t toNanoseconds(std::chrono::system_clock::time_point time)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+	}
+
+	std::chrono::system_clock::time_point fromNanoseconds(std::int64_t nanoseconds)
+	{
+		return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanoseconds)));
+	}
+
+	// The few file calls a journal needs - stubbed on Windows, where create() and open() refuse before reaching them
+#ifdef _WIN32
+	int openFile(const std::filesystem::path&, bool) { errno = ENOSYS; return -1; }
+	void closeFile(int) {}
+	std::optional<std::uint64_t> getFileSize(int) { return std::nullopt; }
+	bool resizeFile(int, std::uint64_t) { return false; }
+	void* mapFile(int, std::size_t, bool) { return nullptr; }
+	void unmapFile(const void*, std::size_t) {}
+#else
+	int openFile(const std::filesystem::path& path, bool isForWriting)
+	{
+		return isForWriting ? ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	}
+
+	void closeFile(int fd)
+	{
+		::close(fd);
+	}
+
+	std::optional<std::uint64_t> getFileSize(int fd)
+	{
+		struct stat info{};
+		if (fstat(fd, &info) != 0)
+		{
+			return std::nullopt;
+		}
+
+		return static_cast<std::uint64_t>(info.st_size);
+	}
+
+	bool resizeFile(int fd, std::uint64_t bytes)
+	{
+		return ftruncate(fd, static_cast<off_t>(bytes)) == 0;
+	}
+
+	void* mapFile(int fd, std::size_t bytes, bool isWritable)
+	{
+		void* mapping = mmap(nullptr, bytes, isWritable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+		return mapping == MAP_FAILED ? nullptr : mapping;
+	}
+
+	void unmapFile(const void* mapping, std::size_t bytes)
+	{
+		munmap(const_cast<void*>(mapping), bytes);
+	}
+#endif
+}
+
+std::expected<std::shared_ptr<PacketJournalWriter>, std::string> PacketJournalWriter::create(const std::filesystem::path& path, PacketJournalOptions options)
+{
+#ifdef _WIN32
+	return std::unexpected("Packet journals are memory-mapped with POSIX calls, not supported on Windows yet");
+#endif
+
+	options.indexInterval = std::max<std::uint32_t>(options.indexInterval, 1);
+	options.growBytes = std::max<std::size_t>(alignRecord(options.growBytes), 64 * 1024);
+	options.maxBytes = std::max<std::size_t>(alignRecord(options.maxBytes), options.growBytes);
+
+	const int fd = openFile(path, true);
+	if (fd < 0)
+	{
+		return std::unexpected(std::format("Could not create journal '{}': {}", path.string(), std::strerror(errno)));
+	}
+
+	std::shared_ptr<PacketJournalWriter> writer(new PacketJournalWriter(fd, path, options));
+
+	if (!resizeFile(fd, options.growBytes))
+	{
+		return std::unexpected(std::format("Could not grow journal '{}' to {} bytes: {}", path.string(), options.growBytes, std::strerror(errno)));
+	}
+
+	// All of maxBytes is mapped now, so growing the file never moves the mapping under an append
+	void* mapping = mapFile(fd, options.maxBytes, true);
+	if (!mapping)
+	{
+		return std::unexpected(std::format("Could not map journal '{}': {}", path.string(), std::strerror(errno)));
+	}
+
+	writer->m_mapping = static_cast<std::byte*>(mapping);
+	writer->m_fileBytes.store(options.growBytes, std::memory_order_relaxed);
+
+	auto& header = writer->header();
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.headerSize = static_cast<std::uint32_t>(alignRecord(sizeof(FileHeader)));
+	header.dataEnd = header.headerSize;
+
+	writer->m_reservedEnd.store(header.headerSize, std::memory_order_relaxed);
+	writer->m_committedEnd.store(header.headerSize, std::memory_order_release);
+
+	return writer;
+}
+
+PacketJournalWriter::PacketJournalWriter(int fd, std::filesystem::path path, PacketJournalOptions options)
+	: m_path(std::move(path))
+	, m_options(options)
+	, m_fd(fd)
+{
+}
+
+PacketJournalWriter::~PacketJournalWriter()
+{
+	close();
+}
+
+bool PacketJournalWriter::append(const DataPacket& packet, const PacketSerializer* serializer)
+{
+	// Counted in before the closed check, so close() either sees this append and waits for it, or it sees the journal closed
+	m_activeAppends.fetch_add(1, std::memory_order_seq_cst);
+	const bool isRecorded = !m_isClosed.load(std::memory_order_seq_cst) && appendPacket(packet, serializer);
+	m_activeAppends.fetch_sub(1, std::memory_order_release);
+
+	return isRecorded;
+}
+
+bool PacketJournalWriter::appendPacket(const DataPacket& packet, const PacketSerializer* serializer)
+{
+	const bool isEncoded = packet.payloadSize == 0;
+	if (!packet.payload || (isEncoded && !serializer))
+	{
+		m_skippedPackets.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	const std::int64_t timestampNs = toNanoseconds(packet.timestamp);
+
+	const auto typeHash = findTypeHash(packet.payloadType, serializer ? serializer->schemaHash : 0, timestampNs);
+	if (!typeHash)
+	{
+		m_skippedPackets.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	std::span<const std::byte> payload(static_cast<const std::byte*>(packet.payload.get()), packet.payloadSize);
+	if (isEncoded)
+	{
+		// Per thread, so producers encode side by side
+		thread_local std::vector<std::byte> encodeBuffer;
+		encodeBuffer.clear();
+		serializer->encode(packet, encodeBuffer);
+		payload = encodeBuffer;
+	}
+
+	const auto placement = place(isEncoded ? RecordKind::EncodedPacket : RecordKind::Packet, *typeHash, timestampNs, payload);
+	if (!placement)
+	{
+		m_skippedPackets.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	// This thread's turn - the records before it are committed and the ones after wait, so nothing else touches these
+	auto& fileHeader = header();
+	if (fileHeader.packetCount++ == 0)
+	{
+		fileHeader.firstTimestampNs = timestampNs;
+	}
+	fileHeader.lastTimestampNs = timestampNs;
+
+	// Packets from several threads can be a little out of order, so a block covers the whole range it saw
+	if (m_indexPacketCount++ == 0)
+	{
+		m_indexFirstOffset = placement->offset;
+		m_indexFirstTimestampNs = timestampNs;
+		m_indexLastTimestampNs = timestampNs;
+	}
+	m_indexFirstTimestampNs = std::min(m_indexFirstTimestampNs, timestampNs);
+	m_indexLastTimestampNs = std::max(m_indexLastTimestampNs, timestampNs);
+
+	std::optional<IndexBlock> fullBlock;
+	if (m_indexPacketCount >= m_options.indexInterval)
+	{
+		fullBlock = takeIndexBlock();
+	}
+
+	m_recordedPackets.fetch_add(1, std::memory_order_relaxed);
+	commit(*placement);
+
+	// Placed after the turn is given up, it has to wait for one of its own
+	if (fullBlock)
+	{
+		writeIndexBlock(*fullBlock);
+	}
+
+	return true;
+}
+
+void PacketJournalWriter::close()
+{
+	{
+		std::lock_guard lock(m_typesMutex);
+
+		if (m_isClosed.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+		m_isClosed.store(true, std::memory_order_seq_cst);
+	}
+
+	// Appends that got in before the journal closed finish first
+	while (m_activeAppends.load(std::memory_order_seq_cst) != 0)
+	{
+		std::this_thread::yield();
+	}
+
+	if (m_mapping)
+	{
+		if (m_indexPacketCount > 0)
+		{
+			writeIndexBlock(takeIndexBlock());
+		}
+		writeTypeTable();
+
+		// Trimmed to the records, the file was grown ahead of them
+		const std::uint64_t dataEnd = header().dataEnd;
+		unmapFile(m_mapping, m_options.maxBytes);
+		m_mapping = nullptr;
+		resizeFile(m_fd, dataEnd);
+	}
+
+	closeFile(m_fd);
+	m_fd = -1;
+}
+
+PacketJournalWriter::Stats PacketJournalWriter::getStats() const
+{
+	return Stats{
+		.recordedPackets = m_recordedPackets.load(std::memory_order_relaxed),
+		.skippedPackets = m_skippedPackets.load(std::memory_order_relaxed),
+		.bytes = m_committedEnd.load(std::memory_order_relaxed)
+	};
+}
+
+const std::filesystem::path& PacketJournalWriter::getPath() const
+{
+	return m_path;
+}
+
+std::optional<std::uint64_t> PacketJournalWriter::findTypeHash(std::type_index type, std::uint64_t schemaHash, std::int64_t timestampNs)
+{
+	{
+		std::shared_lock lock(m_typesMutex);
+		if (const auto it = m_typeHashes.find(type); it != m_typeHashes.end() && it->second.schemaHash == schemaHash)
+		{
+			return it->second.typeHash;
+		}
+	}
+
+	std::unique_lock lock(m_typesMutex);
+	if (const auto it = m_typeHashes.find(type); it != m_typeHashes.end() && it->second.schemaHash == schemaHash)
+	{
+		return it->second.typeHash;
+	}
+
+	// Each type's name is written once per schema, before its first packet - packets only carry the hash. It's committed
+	// before the type is known to other threads, so none of them can place a packet of it ahead of the name.
+	const WrittenType written{
+		.type = type,
+		.typeHash = journalTypeHash(type.name(), schemaHash),
+		.schemaHash = schemaHash
+	};
+
+	if (!writeTypeName(written, timestampNs))
+	{
+		return std::nullopt;
+	}
+
+	m_typeHashes.insert_or_assign(type, written);
+	m_writtenTypes.push_back(written);
+	return written.typeHash;
+}
+
+bool PacketJournalWriter::writeTypeName(const WrittenType& type, std::int64_t timestampNs)
+{
+	const std::string_view typeName = type.type.name();
+	const TypeNameRecord   record{ .schemaHash = type.schemaHash };
+
+	std::vector<std::byte> payload(sizeof(record) + typeName.size());
+	std::memcpy(payload.data(), &record, sizeof(record));
+	std::memcpy(payload.data() + sizeof(record), typeName.data(), typeName.size());
+
+	const auto placement = place(RecordKind::TypeName, type.typeHash, timestampNs, payload);
+	if (!placement)
+	{
+		return false;
+	}
+
+	commit(*placement);
+	return true;
+}
+
+bool PacketJournalWriter::grow(std::uint64_t end)
+{
+	std::lock_guard lock(m_growMutex);
+
+	const std::uint64_t fileBytes = m_fileBytes.load(std::memory_order_relaxed);
+	if (end <= fileBytes)
+	{
+		return true;
+	}
+
+	if (end > m_options.maxBytes)
+	{
+		return false;
+	}
+
+	const std::uint64_t newFileBytes = std::min<std::uint64_t>(std::max<std::uint64_t>(end, fileBytes + m_options.growBytes), m_options.maxBytes);
+	if (!resizeFile(m_fd, newFileBytes))
+	{
+		return false;
+	}
+
+	m_fileBytes.store(newFileBytes, std::memory_order_release);
+	return true;
+}
+
+std::optional<PacketJournalWriter::Placement> PacketJournalWriter::place(RecordKind kind, std::uint64_t typeHash, std::int64_t timestampNs, std::span<const std::byte> payload)
+{
+	const std::uint64_t recordBytes = alignRecord(sizeof(RecordHeader) + payload.size());
+	if (payload.size() > UINT32_MAX || m_isFailed.load(std::memory_order_relaxed))
+	{
+		return std::nullopt;
+	}
+
+	// The only step producers share - copying in and waiting happen side by side
+	const std::uint64_t offset = m_reservedEnd.fetch_add(recordBytes, std::memory_order_relaxed);
+
+	// Space that can't be had leaves a hole nothing after it can be committed past, so recording stops here
+	if (offset + recordBytes > m_fileBytes.load(std::memory_order_acquire) && !grow(offset + recordBytes))
+	{
+		m_isFailed.store(true, std::memory_order_release);
+
+		// Wakes everything parked behind the hole, they'll find the journal failed
+		m_commits.fetch_add(1, std::memory_order_release);
+		m_commits.notify_all();
+		return std::nullopt;
+	}
+
+	const RecordHeader recordHeader{
+		.kind = kind,
+		.size = static_cast<std::uint32_t>(payload.size()),
+		.typeHash = typeHash,
+		.timestampNs = timestampNs
+	};
+
+	std::byte* record = m_mapping + offset;
+	std::memcpy(record, &recordHeader, sizeof(recordHeader));
+	std::memcpy(record + sizeof(recordHeader), payload.data(), payload.size());
+	std::memset(record + sizeof(recordHeader) + payload.size(), 0, recordBytes - sizeof(recordHeader) - payload.size());
+
+	// Records join the journal in the order they were placed, so wait for the ones before this - spinning and yielding
+	// briefly, then parked until the next commit, so a producer preempted before committing doesn't leave the rest
+	// yielding in a loop
+	for (unsigned spins = 0;; ++spins)
+	{
+		const std::uint32_t commits = m_commits.load(std::memory_order_acquire);
+		if (m_committedEnd.load(std::memory_order_acquire) == offset)
+		{
+			break;
+		}
+
+		if (m_isFailed.load(std::memory_order_acquire))
+		{
+			return std::nullopt;
+		}
+
+		if (spins >= 80)
+		{
+			m_commits.wait(commits, std::memory_order_acquire);
+		}
+		else if (spins >= 64)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	return Placement{ .offset = offset, .bytes = recordBytes };
+}
+
+void PacketJournalWriter::commit(const Placement& placement)
+{
+	// Only now part of the journal, so a reader never sees half a record
+	header().dataEnd = placement.offset + placement.bytes;
+	m_committedEnd.store(placement.offset + placement.bytes, std::memory_order_release);
+
+	m_commits.fetch_add(1, std::memory_order_release);
+	m_commits.notify_all();
+}
+
+IndexBlock PacketJournalWriter::takeIndexBlock()
+{
+	const IndexBlock block{
+		.previousIndexOffset = 0, // linked when it's committed
+		.firstPacketOffset = m_indexFirstOffset,
+		.packetCount = m_indexPacketCount,
+		.firstTimestampNs = m_indexFirstTimestampNs,
+		.lastTimestampNs = m_indexLastTimestampNs
+	};
+
+	m_indexPacketCount = 0;
+	return block;
+}
+
+void PacketJournalWriter::writeIndexBlock(const IndexBlock& block)
+{
+	// If it can't be written these packets are just found by reading, from the block before
+	const auto placement = place(RecordKind::Index, 0, block.lastTimestampNs, std::as_bytes(std::span(&block, 1)));
+	if (!placement)
+	{
+		return;
+	}
+
+	// Blocks chain in the order they're committed, which is only known now
+	const std::uint64_t previousIndexOffset = header().lastIndexOffset;
+	std::memcpy(m_mapping + placement->offset + sizeof(RecordHeader) + offsetof(IndexBlock, previousIndexOffset), &previousIndexOffset, sizeof(previousIndexOffset));
+
+	header().lastIndexOffset = placement->offset;
+	commit(*placement);
+}
+
+void PacketJournalWriter::writeTypeTable()
+{
+	const std::uint64_t offset = header().dataEnd;
+	for (const WrittenType& type : m_writtenTypes)
+	{
+		if (!writeTypeName(type, 0))
+		{
+			return;
+		}
+	}
+
+	header().typeTableOffset = offset;
+}
+
+FileHeader& PacketJournalWriter::header()
+{
+	return *reinterpret_cast<FileHeader*>(m_mapping);
+}
+
+std::expected<PacketJournalReader, std::string> PacketJournalReader::open(const std::filesystem::path& path)
+{
+#ifdef _WIN32
+	return std::unexpected("Packet journals are memory-mapped with POSIX calls, not supported on Windows yet");
+#endif
+
+	const int fd = openFile(path, false);
+	if (fd < 0)
+	{
+		return std::unexpected(std::format("Could not open journal '{}': {}", path.string(), std::strerror(errno)));
+	}
+
+	const auto fileSize = getFileSize(fd);
+	if (!fileSize || *fileSize < sizeof(FileHeader))
+	{
+		closeFile(fd);
+		return std::unexpected(std::format("'{}' is too small to be a packet journal", path.string()));
+	}
+
+	// The mapping outlives the descriptor
+	const void* mapping = mapFile(fd, *fileSize, false);
+	const int error = errno;
+	closeFile(fd);
+	if (!mapping)
+	{
+		return std::unexpected(std::format("Could not map journal '{}': {}", path.string(), std::strerror(error)));
+	}
+
+	PacketJournalReader reader(static_cast<const std::byte*>(mapping), *fileSize);
+
+	const FileHeader& header = reader.header();
+	if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+	{
+		return std::unexpected(std::format("'{}' is not a packet journal", path.string()));
+	}
+
+	if (header.version != version)
+	{
+		return std::unexpected(std::format("Journal '{}' is version {}, this build reads version {}", path.string(), header.version, version));
+	}
+
+	if (header.headerSize < sizeof(FileHeader) || header.headerSize % recordAlignment != 0 || header.dataEnd < header.headerSize || header.dataEnd > *fileSize)
+	{
+		return std::unexpected(std::format("Journal '{}' is damaged", path.string()));
+	}
+
+	reader.m_dataEnd = header.dataEnd;
+	reader.m_readOffset = header.headerSize;
+
+	// Without the table a close writes, the names are spread through the records before the packets that need them
+	const bool hasTypeTable = header.typeTableOffset >= header.headerSize && header.typeTableOffset < header.dataEnd && header.typeTableOffset % recordAlignment == 0;
+	reader.readTypeNames(hasTypeTable ? header.typeTableOffset : header.headerSize);
+
+	return reader;
+}
+
+PacketJournalReader::PacketJournalReader(const std::byte* mapping, std::size_t mappedBytes)
+	: m_mapping(mapping)
+	, m_mappedBytes(mappedBytes)
+{
+}
+
+PacketJournalReader::PacketJournalReader(PacketJournalReader&& other) noexcept
+	: m_mapping(std::exchange(other.m_mapping, nullptr))
+	, m_mappedBytes(std::exchange(other.m_mappedBytes, 0))
+	, m_dataEnd(std::exchange(other.m_dataEnd, 0))
+	, m_readOffset(std::exchange(other.m_readOffset, 0))
+	, m_types(std::move(other.m_types))
+{
+}
+
+PacketJournalReader& PacketJournalReader::operator=(PacketJournalReader&& other) noexcept
+{
+	if (this != &other)
+	{
+		if (m_mapping)
+		{
+			unmapFile(m_mapping, m_mappedBytes);
+		}
+
+		m_mapping = std::exchange(other.m_mapping, nullptr);
+		m_mappedBytes = std::exchange(other.m_mappedBytes, 0);
+		m_dataEnd = std::exchange(other.m_dataEnd, 0);
+		m_readOffset = std::exchange(other.m_readOffset, 0);
+		m_types = std::move(other.m_types);
+	}
+
+	return *this;
+}
+
+PacketJournalReader::~PacketJournalReader()
+{
+	if (m_mapping)
+	{
+		unmapFile(m_mapping, m_mappedBytes);
+	}
+}
+
+std::optional<JournalRecord> PacketJournalReader::next()
+{
+	while (const RecordHeader* record = recordAt(m_readOffset))
+	{
+		const std::uint64_t offset = m_readOffset;
+		const std::byte*    payload = m_mapping + offset + sizeof(RecordHeader);
+		m_readOffset = nextRecordOffset(offset);
+
+		if (record->kind == RecordKind::TypeName)
+		{
+			readTypeName(offset, *record);
+		}
+		else if (record->kind == RecordKind::Packet || record->kind == RecordKind::EncodedPacket)
+		{
+			const auto type = m_types.find(record->typeHash);
+			return JournalRecord{
+				.typeHash = record->typeHash,
+				.typeName = type != m_types.end() ? type->second.name : std::string_view(),
+				.schemaHash = type != m_types.end() ? type->second.schemaHash : 0,
+				.timestamp = fromNanoseconds(record->timestampNs),
+				.payload = std::span(payload, record->size),
+				.isEncoded = record->kind == RecordKind::EncodedPacket
+			};
+		}
+	}
+
+	return std::nullopt;
+}
+
+void PacketJournalReader::seek(std::chrono::system_clock::time_point time)
+{
+	const std::int64_t timeNs = toNanoseconds(time);
+
+	// Newest block first - the first one wholly before the time is where reading starts, everything after it is later
+	m_readOffset = header().headerSize;
+	for (std::uint64_t indexOffset = header().lastIndexOffset; const RecordHeader* record = recordAt(indexOffset); )
+	{
+		if (record->kind != RecordKind::Index || record->size < sizeof(IndexBlock))
+		{
+			break;
+		}
+
+		IndexBlock block;
+		std::memcpy(&block, m_mapping + indexOffset + sizeof(RecordHeader), sizeof(block));
+		if (block.lastTimestampNs < timeNs)
+		{
+			m_readOffset = nextRecordOffset(indexOffset);
+			break;
+		}
+
+		// Each block points back to an earlier one, anything else means the chain is damaged
+		if (block.previousIndexOffset >= indexOffset)
+		{
+			break;
+		}
+		indexOffset = block.previousIndexOffset;
+	}
+
+	for (const RecordHeader* record = recordAt(m_readOffset); record; record = recordAt(m_readOffset))
+	{
+		if ((record->kind == RecordKind::Packet || record->kind == RecordKind::EncodedPacket) && record->timestampNs >= timeNs)
+		{
+			return;
+		}
+
+		if (record->kind == RecordKind::TypeName)
+		{
+			readTypeName(m_readOffset, *record);
+		}
+
+		m_readOffset = nextRecordOffset(m_readOffset);
+	}
+}
+
+void PacketJournalReader::rewind()
+{
+	m_readOffset = header().headerSize;
+}
+
+std::uint64_t PacketJournalReader::getPacketCount() const
+{
+	return header().packetCount;
+}
+
+std::chrono::system_clock::time_point PacketJournalReader::getFirstTimestamp() const
+{
+	return fromNanoseconds(header().firstTimestampNs);
+}
+
+std::chrono::system_clock::time_point PacketJournalReader::getLastTimestamp() const
+{
+	return fromNanoseconds(header().lastTimestampNs);
+}
+
+const RecordHeader* PacketJournalReader::recordAt(std::uint64_t offset) const
+{
+	if (offset == 0 || offset % recordAlignment != 0 || offset > m_dataEnd || m_dataEnd - offset < sizeof(RecordHeader))
+	{
+		return nullptr;
+	}
+
+	const auto* record = reinterpret_cast<const RecordHeader*>(m_mapping + offset);
+	if (m_dataEnd - offset - sizeof(RecordHeader) < record->size)
+	{
+		return nullptr;
+	}
+
+	return record;
+}
+
+std::uint64_t PacketJournalReader::nextRecordOffset(std::uint64_t offset) const
+{
+	return offset + alignRecord(sizeof(RecordHeader) + recordAt(offset)->size);
+}
+
+const FileHeader& PacketJournalReader::header() const
+{
+	return *reinterpret_cast<const FileHeader*>(m_mapping);
+}
+
+void PacketJournalReader::readTypeName(std::uint64_t offset, const RecordHeader& record)
+{
+	if (record.size < sizeof(TypeNameRecord))
+	{
+		return;
+	}
+
+	TypeNameRecord typeName;
+	std::memcpy(&typeName, m_mapping + offset + sizeof(RecordHeader), sizeof(typeName));
+
+	m_types.try_emplace(record.typeHash, JournalType{
+		.name = std::string_view(reinterpret_cast<const char*>(m_mapping + offset + sizeof(RecordHeader) + sizeof(TypeNameRecord)), record.size - sizeof(TypeNameRecord)),
+		.schemaHash = typeName.schemaHash
+	});
+}
+
+void PacketJournalReader::readTypeNames(std::uint64_t offset)
+{
+	for (const RecordHeader* record = recordAt(offset); record; record = recordAt(offset))
+	{
+		if (record->kind == RecordKind::TypeName)
+		{
+			readTypeName(offset, *record);
+		}
+
+		offset = nextRecordOffset(offset);
+	}
+}
+
+PacketJournalReplayer::PacketJournalReplayer(DataPacketRegistry& registry, ILogger& logger)
+	: m_registry(registry)
+	, m_logger(logger)
+{
+}
+
+PacketJournalReplayer::~PacketJournalReplayer()
+{
+	stop();
+}
+
+std::expected<void, std::string> PacketJournalReplayer::start(const std::filesystem::path& path, double speed,
+                                                              std::optional<std::chrono::system_clock::time_point> from)
+{
+	auto reader = PacketJournalReader::open(path);
+	if (!reader)
+	{
+		return std::unexpected(reader.error());
+	}
+
+	if (from)
+	{
+		reader->seek(*from);
+	}
+
+	stop();
+
+	m_logger.log(LogLevel::Info, std::format("[PacketJournalReplayer] - Replaying {} packet(s) from '{}' at {}", reader->getPacketCount(), path.string(),
+		speed > 0.0 ? std::format("{}x", speed) : std::string("full speed")));
+
+	m_replayedPackets.store(0, std::memory_order_relaxed);
+	m_isReplaying.store(true, std::memory_order_release);
+	m_thread = std::jthread([this, reader = std::move(*reader), speed = std::max(speed, 0.0), path](const std::stop_token& stopToken) mutable
+	{
+		replay(stopToken, std::move(reader), speed, std::move(path));
+	});
+
+	return {};
+}
+
+void PacketJournalReplayer::stop()
+{
+	if (m_thread.joinable())
+	{
+		m_thread.request_stop();
+		m_thread.join();
+	}
+}
+
+bool PacketJournalReplayer::isReplaying() const
+{
+	return m_isReplaying.load(std::memory_order_acquire);
+}
+
+std::uint64_t PacketJournalReplayer::getReplayedPacketCount() const
+{
+	return m_replayedPackets.load(std::memory_order_relaxed);
+}
+
+void PacketJournalReplayer::replay(const std::stop_token& stopToken, PacketJournalReader reader, double speed, std::filesystem::path path)
+{
+	if (TraceRecorder::instance().isEnabled())
+	{
+		TraceRecorder::instance().setCurrentThreadName("JournalReplay");
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	std::optional<std::chrono::system_clock::time_point> firstTimestamp;
+
+	// Resolved once per type, as soon as some handler takes it
+	std::unordered_map<std::uint64_t, std::type_index> types;
+	std::unordered_set<std::uint64_t>                  mismatchedTypes; // reported already
+	std::uint64_t skippedPackets = 0;
+	std::uint64_t mismatchedPackets = 0;
+
+	std::mutex                  paceMutex;
+	std::condition_variable_any pace; // only ever woken by a stop request
+
+	while (!stopToken.stop_requested())
+	{
+		const auto record = reader.next();
+		if (!record)
+		{
+			break;
+		}
+
+		// A type nobody handles yet is looked up again on its next packet - a plugin may start handling it mid-replay
+		auto type = types.find(record->typeHash);
+		if (type == types.end())
+		{
+			const auto found = m_registry.findDataPacketType(record->typeName);
+			if (!found)
+			{
+				++skippedPackets;
+				continue;
+			}
+
+			type = types.emplace(record->typeHash, *found).first;
+		}
+
+		// Spaced as they were recorded
+		if (speed > 0.0)
+		{
+			if (!firstTimestamp)
+			{
+				firstTimestamp = record->timestamp;
+			}
+
+			const auto offset = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+				std::chrono::duration<double, std::chrono::system_clock::period>(record->timestamp - *firstTimestamp) / speed);
+
+			std::unique_lock lock(paceMutex);
+			pace.wait_until(lock, stopToken, start + offset, [] { return false; });
+
+			if (stopToken.stop_requested())
+			{
+				break;
+			}
+		}
+
+		// Looked up each time rather than kept, a kept serializer would hold back unloading its plugin. Only needed to decode,
+		// or to check a schema the packet was recorded with.
+		const auto serializer = record->isEncoded || record->schemaHash != 0 ? m_registry.findPacketSerializer(type->second) : nullptr;
+		if (serializer && record->schemaHash != 0 && serializer->schemaHash != record->schemaHash)
+		{
+			if (mismatchedTypes.insert(record->typeHash).second)
+			{
+				m_logger.log(LogLevel::Warning, std::format("[PacketJournalReplayer] - Skipping '{}' packets in '{}', they were recorded with schema {:016x} and this build's is {:016x}",
+					record->typeName, path.string(), record->schemaHash, serializer->schemaHash));
+			}
+
+			++mismatchedPackets;
+			continue;
+		}
+
+		if (record->isEncoded)
+		{
+			if (!serializer)
+			{
+				++skippedPackets;
+				continue;
+			}
+
+			auto packet = serializer->decode(record->payload);
+			if (!packet)
+			{
+				++skippedPackets;
+				continue;
+			}
+
+			packet->timestamp = record->timestamp;
+			m_registry.dispatch(*packet);
+		}
+		else
+		{
+			// Copied out into suitably aligned storage, as RemotePlugin does with packets from a host
+			const std::size_t words = (record->payload.size() + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+			auto payload = std::make_shared_for_overwrite<std::max_align_t[]>(words);
+			std::memcpy(payload.get(), record->payload.data(), record->payload.size());
+
+			m_registry.dispatch(DataPacket{
+				.payload = std::move(payload),
+				.payloadType = type->second,
+				.timestamp = record->timestamp,
+				.payloadSize = static_cast<std::uint32_t>(record->payload.size())
+			});
+		}
+		m_replayedPackets.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	m_isReplaying.store(false, std::memory_order_release);
+
+	m_logger.log(skippedPackets == 0 && mismatchedPackets == 0 ? LogLevel::Info : LogLevel::Warning,
+		std::format("[PacketJournalReplayer] - {} '{}' after {} packet(s) in {:.2f}s, {} skipped - nothing handles or can decode them, {} recorded with another schema",
+			stopToken.stop_requested() ? "Stopped replaying" : "Finished replaying", path.string(), getReplayedPacketCount(),
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), skippedPackets, mismatchedPackets));
+}
@@ -0,0 +1,246 @@
+#include "DataPacket/PacketSpillBuffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <utility>
+
+PacketSpillBuffer::PacketSpillBuffer(PacketRetentionLimits limits)
+	: m_limits(std::move(limits))
+{
+}
+
+PacketSpillBuffer::~PacketSpillBuffer()
+{
+	if (m_spillFile.is_open())
+	{
+		m_spillFile.close();
+	}
+
+	if (!m_spillPath.empty())
+	{
+		std::error_code ec;
+		std::filesystem::remove(m_spillPath, ec);
+	}
+}
+
+PacketSpillBuffer::PushResult PacketSpillBuffer::push(const DataPacket& packet)
+{
+	std::lock_guard lock(m_mutex);
+
+	if (m_isClosed)
+	{
+		return PushResult::Closed;
+	}
+
+	// Once anything is on disk the rest follows it there, or they'd be popped ahead of it
+	if (!isSpilling() && m_memoryPackets.size() < m_limits.memoryPackets)
+	{
+		m_memoryPackets.push_back(packet);
+		++m_stats.heldPackets;
+		return PushResult::Held;
+	}
+
+	if (!spill(packet))
+	{
+		++m_stats.droppedPackets;
+		return PushResult::Dropped;
+	}
+
+	++m_stats.heldPackets;
+	return PushResult::Held;
+}
+
+std::optional<DataPacket> PacketSpillBuffer::popOrClose()
+{
+	std::lock_guard lock(m_mutex);
+
+	if (!m_memoryPackets.empty())
+	{
+		DataPacket packet = std::move(m_memoryPackets.front());
+		m_memoryPackets.pop_front();
+		return packet;
+	}
+
+	if (m_spilledPending != 0)
+	{
+		if (auto packet = readSpilled())
+		{
+			return packet;
+		}
+
+		// The file can't be read back, so nothing left in it can be replayed
+		m_stats.droppedPackets += m_spilledPending;
+		m_spilledPending = 0;
+		m_asidePackets.clear();
+		m_isSpillFailed = true;
+	}
+
+	m_isClosed = true;
+	return std::nullopt;
+}
+
+void PacketSpillBuffer::putBack(DataPacket packet)
+{
+	std::lock_guard lock(m_mutex);
+	m_memoryPackets.push_front(std::move(packet));
+}
+
+void PacketSpillBuffer::reopen()
+{
+	std::lock_guard lock(m_mutex);
+	m_isClosed = false;
+}
+
+PacketSpillBuffer::Stats PacketSpillBuffer::getStats() const
+{
+	std::lock_guard lock(m_mutex);
+
+	Stats stats = m_stats;
+	stats.pendingPackets = m_memoryPackets.size() + m_spilledPending;
+	return stats;
+}
+
+bool PacketSpillBuffer::isSpilling() const
+{
+	return m_spilledPending != 0;
+}
+
+std::expected<void, std::string> PacketSpillBuffer::openSpillFile()
+{
+	std::error_code ec;
+	const auto directory = m_limits.spillDirectory.empty() ? std::filesystem::temp_directory_path(ec) : m_limits.spillDirectory;
+	if (ec)
+	{
+		return std::unexpected(std::format("No temp directory: {}", ec.message()));
+	}
+
+	std::filesystem::create_directories(directory, ec);
+
+	// Unique per process and buffer
+	m_spillPath = directory / std::format("vectorium_spill-{:x}-{:x}.bin",
+		std::chrono::steady_clock::now().time_since_epoch().count(), reinterpret_cast<std::uintptr_t>(this));
+
+	m_spillFile.open(m_spillPath, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+	if (!m_spillFile)
+	{
+		return std::unexpected(std::format("Could not create spill file '{}'", m_spillPath.string()));
+	}
+
+	return {};
+}
+
+bool PacketSpillBuffer::spill(const DataPacket& packet)
+{
+	if (m_limits.maxSpillBytes == 0 || m_isSpillFailed)
+	{
+		return false;
+	}
+
+	if (!m_spillFile.is_open() && !openSpillFile())
+	{
+		m_isSpillFailed = true;
+		return false;
+	}
+
+	const bool isWritable = packet.payloadSize != 0 && packet.payload;
+	if (!isWritable && m_asidePackets.size() >= m_limits.memoryPackets)
+	{
+		return false;
+	}
+
+	const std::uint32_t payloadSize = isWritable ? packet.payloadSize : 0;
+	if (m_spillWriteOffset + sizeof(SpillRecordHeader) + payloadSize > m_limits.maxSpillBytes)
+	{
+		return false;
+	}
+
+	auto type = std::ranges::find(m_spilledTypes, packet.payloadType);
+	if (type == m_spilledTypes.end())
+	{
+		type = m_spilledTypes.insert(m_spilledTypes.end(), packet.payloadType);
+	}
+
+	const SpillRecordHeader header{
+		.typeIndex = static_cast<std::uint32_t>(type - m_spilledTypes.begin()),
+		.payloadSize = payloadSize,
+		.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(packet.timestamp.time_since_epoch()).count()
+	};
+
+	m_spillFile.seekp(static_cast<std::streamoff>(m_spillWriteOffset));
+	m_spillFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (isWritable)
+	{
+		m_spillFile.write(static_cast<const char*>(packet.payload.get()), payloadSize);
+	}
+
+	if (!m_spillFile)
+	{
+		// Disk full or gone - what is in the file so far can still be read back
+		m_spillFile.clear();
+		m_isSpillFailed = true;
+		return false;
+	}
+
+	if (isWritable)
+	{
+		++m_stats.spilledPackets;
+	}
+	else
+	{
+		m_asidePackets.push_back(packet);
+	}
+
+	m_spillWriteOffset += sizeof(header) + payloadSize;
+	++m_spilledPending;
+	return true;
+}
+
+std::optional<DataPacket> PacketSpillBuffer::readSpilled()
+{
+	SpillRecordHeader header;
+	m_spillFile.seekg(static_cast<std::streamoff>(m_spillReadOffset));
+	m_spillFile.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!m_spillFile || header.typeIndex >= m_spilledTypes.size())
+	{
+		m_spillFile.clear();
+		return std::nullopt;
+	}
+
+	DataPacket packet{ .payload = nullptr, .payloadType = m_spilledTypes[header.typeIndex] };
+
+	if (header.payloadSize == 0)
+	{
+		packet = std::move(m_asidePackets.front());
+		m_asidePackets.pop_front();
+	}
+	else
+	{
+		// Read back into suitably aligned storage, as RemotePlugin does with packets from a host
+		const std::size_t words = (header.payloadSize + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+		auto payload = std::make_shared_for_overwrite<std::max_align_t[]>(words);
+		m_spillFile.read(reinterpret_cast<char*>(payload.get()), header.payloadSize);
+		if (!m_spillFile)
+		{
+			m_spillFile.clear();
+			return std::nullopt;
+		}
+
+		packet.payload = std::move(payload);
+		packet.timestamp = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(header.timestampNs)));
+		packet.payloadSize = header.payloadSize;
+	}
+
+	m_spillReadOffset += sizeof(header) + header.payloadSize;
+
+	// Drained, so the file is written from the start again
+	if (--m_spilledPending == 0)
+	{
+		m_spillReadOffset = 0;
+		m_spillWriteOffset = 0;
+		m_isSpillFailed = false;
+	}
+
+	return packet;
+}
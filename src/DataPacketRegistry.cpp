@@ -1,31 +1,135 @@
 #include "DataPacket/DataPacketRegistry.h"
 
+#include <algorithm>
 #include <cassert>
+#include <condition_variable>
 #include <format>
+#include <iterator>
 #include <ranges>
 #include <string>
 #include <utility>
 #include "DataPacket/DataPacket.h"
 #include "DataPacket/IDataPacketHandler.h"
+#include "DataPacket/PacketJournal.h"
+#include "DataPacket/PacketSchema.h"
+#include "Plugin/PluginWatchdog.h"
+#include "Profiling/AllocationTracker.h"
+#include "Profiling/TraceRecorder.h"
+#include "Services/Logging/ILogger.h"
 #include "Services/Logging/LogLevel.h"
+#include "Threading/ThreadPlacement.h"
 
-DataPacketRegistry::DataPacketRegistry(ILogger& log) : m_logger(log)
+/// <summary>
+/// Stands in for a reloading plugin's handlers: buffers its packets, then replays them in arrival order into whichever
+/// handlers take over, and forwards anything still dispatched through an older table.
+/// </summary>
+class DataPacketRegistry::PacketHandoffBuffer final : public IDataPacketHandler
 {
+public:
+	bool handle(const DataPacket& packet) override
+	{
+		std::lock_guard lock(m_mutex);
+		if (!m_isReleased)
+		{
+			m_buffered.push_back(packet);
+			return true;
+		}
+
+		return forward(packet);
+	}
+
+	std::size_t release(std::vector<StagedHandler> targets)
+	{
+		// Recursive, as a replayed handler may dispatch a packet that comes back through this buffer
+		std::lock_guard lock(m_mutex);
+		m_targets = std::move(targets);
+
+		// Indexed, a nested dispatch can still append while replaying
+		for (std::size_t i = 0; i < m_buffered.size(); ++i)
+		{
+			const DataPacket packet = m_buffered[i];
+			forward(packet);
+		}
+
+		const std::size_t replayed = m_buffered.size();
+		m_buffered = {};
+		m_isReleased = true;
+
+		return replayed;
+	}
+
+private:
+	bool forward(const DataPacket& packet) const
+	{
+		bool isHandled = false;
+		for (const auto& [type, entry] : m_targets)
+		{
+			if (type == packet.payloadType && entry.handler)
+			{
+				ScopedPluginActivity activity(entry.activity.get(), PluginActivityKind::Handler);
+				isHandled |= entry.handler->handle(packet);
+			}
+		}
+
+		return isHandled;
+	}
 
+	std::recursive_mutex       m_mutex;
+	std::vector<DataPacket>    m_buffered;
+	std::vector<StagedHandler> m_targets;
+	bool                       m_isReleased = false;
+};
+
+DataPacketRegistry::DataPacketRegistry(ILogger& log)
+	: m_table(std::make_shared<const HandlerTable>())
+	, m_isNuma(CpuTopology::get().isNuma())
+	, m_logger(log)
+{
+
+}
+
+template<typename Fn>
+DataPacketRegistry::DispatchFence DataPacketRegistry::modifyHandlers(Fn&& edit)
+{
+	std::lock_guard lock(m_writeMutex);
+
+	const auto current = m_table.load(std::memory_order_acquire);
+	auto table = std::make_shared<HandlerTable>(*current);
+	edit(*table);
+
+	table->generation = std::make_shared<TableGeneration>();
+	current->generation->next = table->generation;
+
+	// Dispatches already in flight keep the old table alive until they finish
+	m_table.store(std::move(table), std::memory_order_release);
+	return current->generation;
 }
 
 bool DataPacketRegistry::registerDataPacketHandler(std::type_index packetType, std::shared_ptr<IDataPacketHandler> handler, const std::string& pluginName)
 {
-	m_handlers[packetType].emplace_back(std::move(handler), pluginName);
+	HandlerEntry entry{
+		.handler = std::move(handler),
+		.pluginName = pluginName,
+		.traceLabel = TraceRecorder::instance().internName(pluginName),
+		.activity = nullptr
+	};
+
+	modifyHandlers([&](HandlerTable& table)
+	{
+		entry.activity = findActivity(table, pluginName);
+		table.handlers[packetType].push_back(std::move(entry));
+	});
 	return true;
 }
 
 std::vector<std::type_index> DataPacketRegistry::getDataPacketTypes() const
 {
+	const auto table = m_table.load(std::memory_order_acquire);
+
 	std::vector<std::type_index> types;
-	types.reserve(m_handlers.size());
+	types.reserve(table->handlers.size());
 
-	for(const auto& key : m_handlers | std::views::keys)
+	for(const auto& key : table->handlers | std::views::keys)
 	{
 		types.push_back(key);
 	}
@@ -35,54 +139,641 @@ std::vector<std::type_index> DataPacketRegistry::getDataPacketTypes() const
 
 bool DataPacketRegistry::registerWildcardHandler(std::shared_ptr<IDataPacketHandler> handler, const std::string& pluginName)
 {
-	m_wildcardHandlers.emplace_back(std::move(handler), pluginName);
+	HandlerEntry entry{
+		.handler = std::move(handler),
+		.pluginName = pluginName,
+		.traceLabel = TraceRecorder::instance().internName(pluginName),
+		.activity = nullptr
+	};
+
+	modifyHandlers([&](HandlerTable& table)
+	{
+		entry.activity = findActivity(table, pluginName);
+		table.wildcardHandlers.push_back(std::move(entry));
+	});
     return true;
 }
 
-void DataPacketRegistry::unregisterDataPacketHandlerForPlugin(std::string_view pluginName)
+bool DataPacketRegistry::registerDataPacketHandlerByTypeName(std::string typeName, std::shared_ptr<IDataPacketHandler> handler, const std::string& pluginName)
+{
+	NamedHandler named{
+		.typeName = std::move(typeName),
+		.entry = HandlerEntry{
+			.handler = std::move(handler),
+			.pluginName = pluginName,
+			.traceLabel = TraceRecorder::instance().internName(pluginName),
+			.activity = nullptr
+		}
+	};
+
+	modifyHandlers([&](HandlerTable& table)
+	{
+		named.entry.activity = findActivity(table, pluginName);
+		table.namedHandlers.push_back(std::move(named));
+	});
+	return true;
+}
+
+std::optional<std::type_index> DataPacketRegistry::findDataPacketType(std::string_view typeName) const
+{
+	const auto table = m_table.load(std::memory_order_acquire);
+
+	for (const auto& type : table->handlers | std::views::keys)
+	{
+		if (type.name() == typeName)
+		{
+			return type;
+		}
+	}
+
+	return std::nullopt;
+}
+
+DataPacketRegistry::DispatchFence DataPacketRegistry::unregisterDataPacketHandlerForPlugin(std::string_view pluginName)
+{
+	const auto isOwnedByPlugin = [&](const HandlerEntry& entry)
+	{
+		return entry.pluginName == pluginName;
+	};
+
+	return modifyHandlers([&](HandlerTable& table)
+	{
+		for (auto it = table.handlers.begin(); it != table.handlers.end(); )
+		{
+			auto& handlerList = it->second;
+
+			// Remove all handlers matching pluginName
+			std::erase_if(handlerList, isOwnedByPlugin);
+
+			// Clean up empty type entries
+			if (handlerList.empty())
+			{
+				it = table.handlers.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		std::erase_if(table.wildcardHandlers, isOwnedByPlugin);
+		std::erase_if(table.namedHandlers, [&](const NamedHandler& named) { return isOwnedByPlugin(named.entry); });
+
+		table.activities.erase(std::string(pluginName));
+		eraseSerializers(table, std::string(pluginName), false);
+	});
+}
+
+void DataPacketRegistry::setPluginActivity(const std::string& pluginName, std::shared_ptr<PluginActivity> activity)
+{
+	modifyHandlers([&](HandlerTable& table)
+	{
+		const auto stamp = [&](HandlerEntry& entry)
+		{
+			if (entry.pluginName == pluginName)
+			{
+				entry.activity = activity;
+			}
+		};
+
+		for (auto& handlerList : table.handlers | std::views::values)
+		{
+			std::ranges::for_each(handlerList, stamp);
+		}
+
+		std::ranges::for_each(table.wildcardHandlers, stamp);
+		std::ranges::for_each(table.namedHandlers, [&](NamedHandler& named) { stamp(named.entry); });
+
+		if (const auto staged = table.stagedHandlers.find(pluginName); staged != table.stagedHandlers.end())
+		{
+			std::ranges::for_each(staged->second, [&](StagedHandler& handler) { stamp(handler.entry); });
+		}
+
+		table.activities[pluginName] = std::move(activity);
+	});
+}
+
+DataPacketRegistry::DispatchFence DataPacketRegistry::wrapHandlersForPlugin(const std::string& pluginName,
+	const std::function<std::shared_ptr<IDataPacketHandler>(std::shared_ptr<IDataPacketHandler>)>& wrap)
+{
+	return modifyHandlers([&](HandlerTable& table)
+	{
+		const auto wrapEntry = [&](HandlerEntry& entry)
+		{
+			if (entry.pluginName == pluginName && entry.handler)
+			{
+				entry.handler = wrap(std::move(entry.handler));
+			}
+		};
+
+		for (auto& handlerList : table.handlers | std::views::values)
+		{
+			std::ranges::for_each(handlerList, wrapEntry);
+		}
+
+		std::ranges::for_each(table.wildcardHandlers, wrapEntry);
+		std::ranges::for_each(table.namedHandlers, [&](NamedHandler& named) { wrapEntry(named.entry); });
+	});
+}
+
+std::shared_ptr<PluginActivity> DataPacketRegistry::findActivity(const HandlerTable& table, const std::string& pluginName)
+{
+	const auto activity = table.activities.find(pluginName);
+	return activity != table.activities.end() ? activity->second : nullptr;
+}
+
+bool DataPacketRegistry::stageDataPacketHandler(std::type_index packetType, std::shared_ptr<IDataPacketHandler> handler, const std::string& pluginName)
+{
+	StagedHandler staged{
+		.type = packetType,
+		.entry = HandlerEntry{
+			.handler = std::move(handler),
+			.pluginName = pluginName,
+			.traceLabel = TraceRecorder::instance().internName(pluginName),
+			.activity = nullptr
+		}
+	};
+
+	modifyHandlers([&](HandlerTable& table)
+	{
+		staged.entry.activity = findActivity(table, pluginName);
+		table.stagedHandlers[pluginName].push_back(std::move(staged));
+	});
+	return true;
+}
+
+void DataPacketRegistry::discardStagedHandlers(const std::string& pluginName)
+{
+	modifyHandlers([&](HandlerTable& table)
+	{
+		table.stagedHandlers.erase(pluginName);
+		eraseSerializers(table, pluginName, true);
+	});
+}
+
+DataPacketRegistry::DispatchFence DataPacketRegistry::beginHandoff(const std::string& pluginName)
+{
+	return modifyHandlers([&](HandlerTable& table)
+	{
+		if (table.handoffs.contains(pluginName))
+		{
+			return;
+		}
+
+		auto buffer = std::make_shared<PacketHandoffBuffer>();
+		std::vector<StagedHandler>   held;
+		std::vector<std::type_index> bufferedTypes;
+
+		for (auto it = table.handlers.begin(); it != table.handlers.end();)
+		{
+			auto& handlerList = it->second;
+			for (const auto& entry : handlerList)
+			{
+				if (entry.pluginName == pluginName)
+				{
+					held.push_back(StagedHandler{ .type = it->first, .entry = entry });
+				}
+			}
+
+			if (std::erase_if(handlerList, [&](const HandlerEntry& entry) { return entry.pluginName == pluginName; }) > 0)
+			{
+				bufferedTypes.push_back(it->first);
+			}
+
+			it = handlerList.empty() ? table.handlers.erase(it) : std::next(it);
+		}
+
+		// Types only the new instance handles are buffered too, so it sees them from the moment of the swap
+		if (const auto staged = table.stagedHandlers.find(pluginName); staged != table.stagedHandlers.end())
+		{
+			for (const auto& handler : staged->second)
+			{
+				if (std::ranges::find(bufferedTypes, handler.type) == bufferedTypes.end())
+				{
+					bufferedTypes.push_back(handler.type);
+				}
+			}
+		}
+
+		const char* traceLabel = TraceRecorder::instance().internName(pluginName);
+		for (const auto& type : bufferedTypes)
+		{
+			table.handlers[type].push_back(HandlerEntry{ .handler = buffer, .pluginName = pluginName, .traceLabel = traceLabel, .activity = nullptr });
+		}
+
+		table.heldHandlers[pluginName] = std::move(held);
+		table.handoffs[pluginName] = std::move(buffer);
+	});
+}
+
+DataPacketRegistry::DispatchFence DataPacketRegistry::commitHandoff(const std::string& pluginName)
+{
+	return finishHandoff(pluginName, true);
+}
+
+DataPacketRegistry::DispatchFence DataPacketRegistry::abortHandoff(const std::string& pluginName)
+{
+	return finishHandoff(pluginName, false);
+}
+
+DataPacketRegistry::DispatchFence DataPacketRegistry::finishHandoff(const std::string& pluginName, bool useStagedHandlers)
+{
+	std::shared_ptr<PacketHandoffBuffer> buffer;
+	std::vector<StagedHandler>           takeOver;
+
+	{
+		const auto table = m_table.load(std::memory_order_acquire);
+
+		const auto handoff = table->handoffs.find(pluginName);
+		if (handoff == table->handoffs.end())
+		{
+			m_logger.log(LogLevel::Warning, std::format("[DataPacketRegistry] - No handoff in progress for '{}'", pluginName));
+			return {};
+		}
+
+		buffer = handoff->second;
+
+		const auto& source = useStagedHandlers ? table->stagedHandlers : table->heldHandlers;
+		if (const auto handlers = source.find(pluginName); handlers != source.end())
+		{
+			takeOver = handlers->second;
+		}
+	}
+
+	// Replay before the swap - packets arriving meanwhile wait on the buffer, so nothing overtakes what was buffered
+	const std::size_t replayed = buffer->release(takeOver);
+	m_logger.log(LogLevel::Debug, std::format("[DataPacketRegistry] - Replayed {} buffered packet(s) for '{}'", replayed, pluginName));
+
+	return modifyHandlers([&](HandlerTable& table)
+	{
+		const auto isOwnedByPlugin = [&](const HandlerEntry& entry)
+		{
+			return entry.pluginName == pluginName;
+		};
+
+		for (auto it = table.handlers.begin(); it != table.handlers.end();)
+		{
+			std::erase_if(it->second, isOwnedByPlugin);
+			it = it->second.empty() ? table.handlers.erase(it) : std::next(it);
+		}
+
+		// Wildcard handlers aren't handed off, the old instance's go with it
+		if (useStagedHandlers)
+		{
+			std::erase_if(table.wildcardHandlers, isOwnedByPlugin);
+		}
+
+		for (auto& handler : takeOver)
+		{
+			table.handlers[handler.type].push_back(std::move(handler.entry));
+		}
+
+		// The new instance's serializers replace the old one's, or go with it
+		eraseSerializers(table, pluginName, !useStagedHandlers);
+		for (auto& entries : table.serializers | std::views::values)
+		{
+			for (auto& entry : entries)
+			{
+				if (entry.pluginName == pluginName)
+				{
+					entry.isStaged = false;
+				}
+			}
+		}
+
+		table.stagedHandlers.erase(pluginName);
+		table.heldHandlers.erase(pluginName);
+		table.handoffs.erase(pluginName);
+	});
+}
+
+void DataPacketRegistry::setPacketWatches(std::vector<std::type_index> types, bool watchAllTypes, PacketWatchCallback callback)
 {
-	for (auto it = m_handlers.begin(); it != m_handlers.end(); )
+	modifyHandlers([&](HandlerTable& table)
 	{
-		auto& handlerList = it->second;
+		table.watchedTypes = std::move(types);
+		table.watchAllTypes = watchAllTypes;
+		table.watchCallback = std::move(callback);
+	});
+}
 
-		// Remove all handlers matching pluginName
-		std::erase_if(handlerList,
-		              [&](const auto& pair)
-		              {
-			              return pair.second == pluginName;
-		              });
+void DataPacketRegistry::clearPacketWatches()
+{
+	setPacketWatches({}, false, nullptr);
+}
 
-		// Clean up empty type entries
-		if (handlerList.empty())
+void DataPacketRegistry::setPacketRecorder(std::shared_ptr<PacketJournalWriter> recorder)
+{
+	modifyHandlers([&](HandlerTable& table)
+	{
+		table.recorder = std::move(recorder);
+	});
+}
+
+std::shared_ptr<PacketJournalWriter> DataPacketRegistry::getPacketRecorder() const
+{
+	return m_table.load(std::memory_order_acquire)->recorder;
+}
+
+bool DataPacketRegistry::registerPacketSerializer(std::type_index packetType, const PacketSerializer& serializer, const std::string& pluginName)
+{
+	modifyHandlers([&](HandlerTable& table)
+	{
+		table.serializers[packetType].push_back(SerializerEntry{ .serializer = &serializer, .pluginName = pluginName, .isStaged = false });
+	});
+	return true;
+}
+
+bool DataPacketRegistry::stagePacketSerializer(std::type_index packetType, const PacketSerializer& serializer, const std::string& pluginName)
+{
+	modifyHandlers([&](HandlerTable& table)
+	{
+		table.serializers[packetType].push_back(SerializerEntry{ .serializer = &serializer, .pluginName = pluginName, .isStaged = true });
+	});
+	return true;
+}
+
+std::shared_ptr<const PacketSerializer> DataPacketRegistry::findPacketSerializer(std::type_index packetType) const
+{
+	auto table = m_table.load(std::memory_order_acquire);
+	const PacketSerializer* serializer = findSerializer(*table, packetType);
+
+	// Shares the table's lifetime, which is what keeps the plugin's library loaded
+	return serializer ? std::shared_ptr<const PacketSerializer>(std::move(table), serializer) : nullptr;
+}
+
+std::optional<std::type_index> DataPacketRegistry::findPacketTypeBySchema(std::string_view schemaName) const
+{
+	const auto table = m_table.load(std::memory_order_acquire);
+
+	for (const auto& type : table->serializers | std::views::keys)
+	{
+		if (const PacketSerializer* serializer = findSerializer(*table, type); serializer && serializer->name == schemaName)
 		{
-			it = m_handlers.erase(it);
+			return type;
 		}
-		else
+	}
+
+	return std::nullopt;
+}
+
+std::optional<std::string> DataPacketRegistry::describePacket(const DataPacket& packet) const
+{
+	if (!packet.payload)
+	{
+		return std::nullopt;
+	}
+
+	const auto serializer = findPacketSerializer(packet.payloadType);
+	if (!serializer)
+	{
+		return std::nullopt;
+	}
+
+	return serializer->format(packet);
+}
+
+const PacketSerializer* DataPacketRegistry::findSerializer(const HandlerTable& table, std::type_index packetType)
+{
+	const auto entries = table.serializers.find(packetType);
+	if (entries == table.serializers.end())
+	{
+		return nullptr;
+	}
+
+	for (const auto& entry : entries->second | std::views::reverse)
+	{
+		if (!entry.isStaged)
 		{
-			++it;
+			return entry.serializer;
 		}
 	}
+
+	return nullptr;
+}
+
+void DataPacketRegistry::eraseSerializers(HandlerTable& table, const std::string& pluginName, bool isStaged)
+{
+	for (auto it = table.serializers.begin(); it != table.serializers.end();)
+	{
+		std::erase_if(it->second, [&](const SerializerEntry& entry) { return entry.pluginName == pluginName && entry.isStaged == isStaged; });
+		it = it->second.empty() ? table.serializers.erase(it) : std::next(it);
+	}
+}
+
+void DataPacketRegistry::notifyPacketWatch(const HandlerTable& table, std::type_index packetType)
+{
+	if (table.watchAllTypes || std::ranges::find(table.watchedTypes, packetType) != table.watchedTypes.end())
+	{
+		table.watchCallback(packetType);
+	}
 }
 
 void DataPacketRegistry::dispatch(const DataPacket &packet)
 {
 	assert(packet.payloadType != std::type_index(typeid(void)) && "Invalid payloadType!");
 
-	const auto& it = m_handlers.find(packet.payloadType);
-	if(it != m_handlers.end())
+	// Paused, or replaying what was held while paused
+	if (m_isHoldingPackets.load(std::memory_order_acquire)) [[unlikely]]
 	{
-		for(const auto& key : it->second | std::views::keys)
+		if (holdPacket(packet))
 		{
-			if(!key) continue;
+			return;
+		}
+	}
+
+	deliver(packet);
+}
+
+void DataPacketRegistry::deliver(const DataPacket& packet)
+{
+	VECTORIUM_TRACE_ZONE("DataPacketRegistry::dispatch");
+
+	// Hold the snapshot for the whole dispatch - a handler may (un)register without invalidating this loop
+	const auto table = m_table.load(std::memory_order_acquire);
+
+	if (table->watchCallback) [[unlikely]]
+	{
+		notifyPacketWatch(*table, packet.payloadType);
+	}
 
-			key->handle(packet);
+	if (table->recorder) [[unlikely]]
+	{
+		// Raw packets too, so the journal has the schema of every type that has one
+		table->recorder->append(packet, findSerializer(*table, packet.payloadType));
+	}
+
+	const int dispatchNode = m_isNuma ? CpuTopology::get().getCurrentNode() : -1;
+
+	const auto& it = table->handlers.find(packet.payloadType);
+	if(it != table->handlers.end())
+	{
+		for(const auto& entry : it->second)
+		{
+			if(!entry.handler) continue;
+
+			VECTORIUM_TRACE_ZONE_DETAIL("IDataPacketHandler::handle", entry.traceLabel);
+			VECTORIUM_ALLOCATION_ZONE(AllocationZoneKind::Handler, entry.traceLabel);
+			ScopedPluginActivity activity(entry.activity.get(), PluginActivityKind::Handler);
+			if (entry.activity) entry.activity->noteDispatchNode(dispatchNode);
+			entry.handler->handle(packet);
+		}
+	}
+
+	if (!table->namedHandlers.empty()) [[unlikely]]
+	{
+		const std::string_view typeName = packet.payloadType.name();
+		for (const auto& [handledTypeName, entry] : table->namedHandlers)
+		{
+			if (handledTypeName != typeName || !entry.handler) continue;
+
+			VECTORIUM_TRACE_ZONE_DETAIL("IDataPacketHandler::handle", entry.traceLabel);
+			VECTORIUM_ALLOCATION_ZONE(AllocationZoneKind::Handler, entry.traceLabel);
+			ScopedPluginActivity activity(entry.activity.get(), PluginActivityKind::Handler);
+			if (entry.activity) entry.activity->noteDispatchNode(dispatchNode);
+			entry.handler->handle(packet);
 		}
 	}
 
-	for(const auto& key : m_wildcardHandlers | std::views::keys)
+	for(const auto& entry : table->wildcardHandlers)
+	{
+		if(!entry.handler) continue;
+
+		VECTORIUM_TRACE_ZONE_DETAIL("IDataPacketHandler::handle", entry.traceLabel);
+		VECTORIUM_ALLOCATION_ZONE(AllocationZoneKind::Handler, entry.traceLabel);
+		ScopedPluginActivity activity(entry.activity.get(), PluginActivityKind::Handler);
+		if (entry.activity) entry.activity->noteDispatchNode(dispatchNode);
+		entry.handler->handle(packet);
+	}
+}
+
+void DataPacketRegistry::holdPackets(const PacketRetentionLimits& limits)
+{
+	std::lock_guard lock(m_holdMutex);
+
+	// Whatever a replay hasn't delivered yet stays held, ahead of what comes next
+	if (m_replayThread.joinable())
+	{
+		m_replayThread.request_stop();
+		m_replayThread.join();
+	}
+
+	if (const auto held = m_heldPackets.load(std::memory_order_acquire))
+	{
+		held->reopen();
+		m_isHoldingPackets.store(true, std::memory_order_release);
+		m_logger.log(LogLevel::Info, std::format("[DataPacketRegistry] - Holding packets again, {} not replayed yet", held->getStats().pendingPackets));
+		return;
+	}
+
+	m_heldPackets.store(std::make_shared<PacketSpillBuffer>(limits), std::memory_order_release);
+	m_isHoldingPackets.store(true, std::memory_order_release);
+
+	m_logger.log(LogLevel::Info, std::format("[DataPacketRegistry] - Holding packets, {} in memory before spilling to {}",
+		limits.memoryPackets, limits.maxSpillBytes == 0 ? std::string("nowhere") : std::format("disk, up to {}MB", limits.maxSpillBytes / (1024 * 1024))));
+}
+
+void DataPacketRegistry::releasePackets(double speed)
+{
+	std::lock_guard lock(m_holdMutex);
+
+	auto held = m_heldPackets.load(std::memory_order_acquire);
+	if (!held)
+	{
+		return;
+	}
+
+	// Already replaying - carries on at the new speed
+	if (m_replayThread.joinable())
+	{
+		m_replayThread.request_stop();
+		m_replayThread.join();
+	}
+
+	if (speed > 0.0 && speed < minReplaySpeed)
+	{
+		m_logger.log(LogLevel::Warning, std::format("[DataPacketRegistry] - A replay at {}x couldn't catch up with the packets still arriving, replaying at {}x",
+			speed, minReplaySpeed));
+		speed = minReplaySpeed;
+	}
+
+	m_replayThread = std::jthread([this, held = std::move(held), speed = std::max(speed, 0.0)](const std::stop_token& stopToken)
+	{
+		replayHeldPackets(stopToken, held, speed);
+	});
+}
+
+bool DataPacketRegistry::isHoldingPackets() const
+{
+	return m_isHoldingPackets.load(std::memory_order_acquire);
+}
+
+std::optional<PacketSpillBuffer::Stats> DataPacketRegistry::getHeldPacketStats() const
+{
+	if (const auto held = m_heldPackets.load(std::memory_order_acquire))
+	{
+		return held->getStats();
+	}
+
+	return std::nullopt;
+}
+
+bool DataPacketRegistry::holdPacket(const DataPacket& packet)
+{
+	const auto held = m_heldPackets.load(std::memory_order_acquire);
+	return held && held->push(packet) != PacketSpillBuffer::PushResult::Closed;
+}
+
+void DataPacketRegistry::replayHeldPackets(const std::stop_token& stopToken, const std::shared_ptr<PacketSpillBuffer>& held, double speed)
+{
+	if (TraceRecorder::instance().isEnabled())
+	{
+		TraceRecorder::instance().setCurrentThreadName("PacketReplay");
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	std::optional<std::chrono::system_clock::time_point> firstTimestamp;
+
+	std::mutex                  paceMutex;
+	std::condition_variable_any pace; // only ever woken by a stop request
+
+	while (!stopToken.stop_requested())
 	{
-		if(!key) continue;
+		auto packet = held->popOrClose();
+		if (!packet)
+		{
+			// Caught up - the buffer refuses packets now, so they go straight to the handlers
+			m_isHoldingPackets.store(false, std::memory_order_release);
+			m_heldPackets.store(nullptr, std::memory_order_release);
+
+			const auto stats = held->getStats();
+			m_logger.log(stats.droppedPackets == 0 ? LogLevel::Info : LogLevel::Warning,
+				std::format("[DataPacketRegistry] - Caught up on {} held packet(s) in {:.2f}s, {} spilled to disk, {} dropped",
+					stats.heldPackets, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), stats.spilledPackets, stats.droppedPackets));
+			return;
+		}
+
+		// Spaced as they arrived, so consumers aren't hit with the whole backlog at once
+		if (speed > 0.0)
+		{
+			if (!firstTimestamp)
+			{
+				firstTimestamp = packet->timestamp;
+			}
+
+			const auto offset = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+				std::chrono::duration<double, std::chrono::system_clock::period>(packet->timestamp - *firstTimestamp) / speed);
+
+			std::unique_lock lock(paceMutex);
+			pace.wait_until(lock, stopToken, start + offset, [] { return false; });
+		}
+
+		if (stopToken.stop_requested())
+		{
+			held->putBack(std::move(*packet));
+			return;
+		}
 
-		key->handle(packet);
+		deliver(*packet);
 	}
 }
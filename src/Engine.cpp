@@ -1,17 +1,65 @@
 #include "Engine.h"
 
+#include <algorithm>
 #include <iostream>
+#include <optional>
+#include <thread>
 #include <utility>
 
-#include "../UI/include/Services/UI/PluginUIService_ImGui.h"
+#include "../UI/include/Services/UI/IPluginUIService.h"
 #include "DataPacket/DataPacketRegistry.h"
+#include "DataPacket/PacketJournal.h"
+#include "EngineEventBus.h"
 #include "Services/Logging/SpdLogger.h"
 #include "Plugin/PluginManager.h"
+#include "Profiling/AllocationTracker.h"
+#include "Profiling/TraceRecorder.h"
 #include "Services/Logging/UILogSink.h"
 #include "Services/REST/PluginRESTService_Cpr.h"
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+namespace
+{
+	/// <summary>
+	/// The value EngineSettings passed along, as the event carries it - none for a type it doesn't know
+	/// </summary>
+	std::optional<SettingValue> toSettingValue(const std::any& value)
+	{
+		if (const auto* boolValue = std::any_cast<bool>(&value))
+		{
+			return *boolValue;
+		}
+
+		if (const auto* intValue = std::any_cast<int>(&value))
+		{
+			return std::int64_t{*intValue};
+		}
+
+		if (const auto* int64Value = std::any_cast<std::int64_t>(&value))
+		{
+			return *int64Value;
+		}
+
+		if (const auto* doubleValue = std::any_cast<double>(&value))
+		{
+			return *doubleValue;
+		}
+
+		if (const auto* stringValue = std::any_cast<std::string>(&value))
+		{
+			return *stringValue;
+		}
+
+		if (const auto* seconds = std::any_cast<std::chrono::seconds>(&value))
+		{
+			return std::int64_t{seconds->count()};
+		}
+
+		return std::nullopt;
+	}
+}
+
 Engine::Engine()
 {
 	auto consoleSink   = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
@@ -30,10 +78,13 @@ Engine::Engine()
 	m_serviceContainer.registerService(m_loggingService);
 	m_serviceContainer.registerService(m_pRestClient);
 
+	m_pEventBus = std::make_unique<EngineEventBus>();
+
 	m_pPluginManager = std::make_unique<PluginManager>(*m_loggingService
 		, *m_pDataPacketRegistry
 		, m_pUiLogSink
-		, m_serviceContainer);
+		, m_serviceContainer
+		, *m_pEventBus);
 
 	spdlog::set_level(spdlog::level::info);
 
@@ -46,7 +97,9 @@ Engine::Engine()
 Engine::~Engine()
 {
 	// This order so nothing crashes
+	m_pJournalReplayer.reset();
 	m_pPluginManager.reset();
+	m_pEventBus.reset();
 	m_pDataPacketRegistry.reset();
 	m_pRestClient.reset();
 	m_loggingService.reset();
@@ -56,6 +109,8 @@ void Engine::init() const
 {
 	m_loggingService->log(LogLevel::Info, "[Engine::init] - Engine starting");
 
+	TraceRecorder::instance().setCurrentThreadName("Main");
+
 	m_pPluginManager->init();
 
 	m_loggingService->log(LogLevel::Info, "[Engine::init] - complete");
@@ -79,6 +134,40 @@ bool EngineSettings::isDebugLoggingEnabled() const
 	return m_debugLoggingEnabled;
 }
 
+void EngineSettings::setTraceCapture(bool enabled)
+{
+	if(m_traceCaptureEnabled != enabled)
+	{
+		m_traceCaptureEnabled = enabled;
+		if(onSettingChanged)
+		{
+			onSettingChanged("traceCapture", enabled);
+		}
+	}
+}
+
+bool EngineSettings::isTraceCaptureEnabled() const
+{
+	return m_traceCaptureEnabled;
+}
+
+void EngineSettings::setAllocationAudit(bool enabled)
+{
+	if(m_allocationAuditEnabled != enabled)
+	{
+		m_allocationAuditEnabled = enabled;
+		if(onSettingChanged)
+		{
+			onSettingChanged("allocationAudit", enabled);
+		}
+	}
+}
+
+bool EngineSettings::isAllocationAuditEnabled() const
+{
+	return m_allocationAuditEnabled;
+}
+
 bool Engine::shouldTick() const
 {
 	if((std::chrono::high_resolution_clock::now() - m_lastUpdateTime >= m_engineSetting.getPluginUpdateInterval()))
@@ -91,20 +180,142 @@ bool Engine::shouldTick() const
 
 void Engine::tick()
 {
+	VECTORIUM_TRACE_ZONE("Engine::tick");
+
 	//If we haven't polling for over a second
 	if(shouldTick())
 	{
+		// Plugins aren't ticked while paused, but still hear about it
+		if (m_engineSetting.isPaused())
+		{
+			m_pPluginManager->deliverEngineEvents();
+			m_lastUpdateTime = std::chrono::high_resolution_clock::now();
+			return;
+		}
+
 		m_loggingService->log(LogLevel::Debug, "Engine Tick");
+
+		const auto now = std::chrono::high_resolution_clock::now();
+		if (m_pEventBus->hasSubscribers(EngineEventType::Clock))
+		{
+			m_pEventBus->publish(EngineEventType::Clock, ClockEvent{
+				.tick = m_tickCount,
+				.wallTime = std::chrono::system_clock::now(),
+				.sinceLastTick = m_tickCount == 0 ? std::chrono::nanoseconds{0} : std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_lastUpdateTime)
+			});
+		}
+		++m_tickCount;
+
 		m_pPluginManager->tick();
-		m_lastUpdateTime = std::chrono::high_resolution_clock::now();
+		m_lastUpdateTime = now;
+	}
+}
+
+void Engine::run()
+{
+	// How long run() can take to notice a shutdown request while waiting for the next plugin tick
+	constexpr auto shutdownPollInterval = std::chrono::milliseconds(50);
+
+	m_loggingService->log(LogLevel::Info, "[Engine::run] - running until shutdown is requested");
+
+	while (!isShutdownRequested())
+	{
+		tick();
+
+		const auto nextTick = m_lastUpdateTime + m_engineSetting.getPluginUpdateInterval();
+		std::this_thread::sleep_until(std::min<std::chrono::high_resolution_clock::time_point>(nextTick, std::chrono::high_resolution_clock::now() + shutdownPollInterval));
 	}
+
+	m_loggingService->log(LogLevel::Info, "[Engine::run] - shutdown requested");
+}
+
+void Engine::requestShutdown() noexcept
+{
+	static_assert(std::atomic_bool::is_always_lock_free, "requestShutdown() must stay async-signal-safe");
+	m_shutdownRequested.store(true, std::memory_order_relaxed);
+}
+
+bool Engine::isShutdownRequested() const noexcept
+{
+	return m_shutdownRequested.load(std::memory_order_relaxed);
 }
 
 void Engine::shutdown() const
 {
+	// No more packets from a journal, and the one being recorded is closed whole
+	if (m_pJournalReplayer)
+	{
+		m_pJournalReplayer->stop();
+	}
+	stopRecording();
+
+	// Handed over straight away - there is no next tick
+	m_pEventBus->publish(EngineEventType::Shutdown);
+	m_pPluginManager->deliverEngineEvents();
+
+	if (const auto held = m_pDataPacketRegistry->getHeldPacketStats(); held && held->pendingPackets != 0)
+	{
+		m_loggingService->log(LogLevel::Warning, std::format("[Engine::shutdown] - {} held packet(s) were never replayed", held->pendingPackets));
+	}
+
+	if (m_engineSetting.isAllocationAuditEnabled())
+	{
+		m_loggingService->log(LogLevel::Info, std::format("[Engine::shutdown] - allocation audit:\n{}", AllocationTracker::instance().formatReport()));
+	}
+
 	m_loggingService->log(LogLevel::Info, "[Engine::shutdown] - complete");
 }
 
+std::expected<void, std::string> Engine::startRecording(const std::filesystem::path& path) const
+{
+	auto recorder = PacketJournalWriter::create(path);
+	if (!recorder)
+	{
+		m_loggingService->log(LogLevel::Error, std::format("[Engine::startRecording] - {}", recorder.error()));
+		return std::unexpected(recorder.error());
+	}
+
+	stopRecording();
+	m_pDataPacketRegistry->setPacketRecorder(std::move(*recorder));
+
+	m_loggingService->log(LogLevel::Info, std::format("[Engine::startRecording] - Recording packets to '{}'", path.string()));
+	return {};
+}
+
+void Engine::stopRecording() const
+{
+	const auto recorder = m_pDataPacketRegistry->getPacketRecorder();
+	if (!recorder)
+	{
+		return;
+	}
+
+	// A dispatch still on the old table may append until close() - after it, its packets are just left out
+	m_pDataPacketRegistry->setPacketRecorder(nullptr);
+	recorder->close();
+
+	const auto stats = recorder->getStats();
+	m_loggingService->log(stats.skippedPackets == 0 ? LogLevel::Info : LogLevel::Warning,
+		std::format("[Engine::stopRecording] - Recorded {} packet(s), {}KB to '{}', {} skipped (no serializer for their type, or the journal couldn't grow)",
+			stats.recordedPackets, stats.bytes / 1024, recorder->getPath().string(), stats.skippedPackets));
+}
+
+std::expected<void, std::string> Engine::replayJournal(const std::filesystem::path& path, double speed)
+{
+	if (!m_pJournalReplayer)
+	{
+		m_pJournalReplayer = std::make_unique<PacketJournalReplayer>(*m_pDataPacketRegistry, *m_loggingService);
+	}
+
+	auto started = m_pJournalReplayer->start(path, speed);
+	if (!started)
+	{
+		m_loggingService->log(LogLevel::Error, std::format("[Engine::replayJournal] - {}", started.error()));
+	}
+
+	return started;
+}
+
 DataPacketRegistry* Engine::getDataPacketRegistry() const
 {
 	return m_pDataPacketRegistry.get();
@@ -160,7 +371,33 @@ EngineSettings& Engine::getEngineSettings()
 
 void Engine::handleSettingChanged(const std::string& setting, const std::any& value)
 {
-	if (setting == "debugLogging")
+	if (const auto settingValue = toSettingValue(value))
+	{
+		m_pEventBus->publish(EngineEventType::SettingChanged, SettingChangedEvent{ .setting = setting, .value = *settingValue });
+	}
+
+	if (setting == "paused")
+	{
+		bool bIsPaused = std::any_cast<bool>(value);
+		const auto& config = m_pPluginManager->getConfig();
+
+		// Producers keep dispatching while paused - their packets are held, then replayed without flooding consumers
+		if (bIsPaused)
+		{
+			m_pDataPacketRegistry->holdPackets(config.pauseRetention);
+			m_loggingService->log(LogLevel::Info, "Engine paused");
+		}
+		else
+		{
+			m_pDataPacketRegistry->releasePackets(config.pauseReplaySpeed);
+			m_loggingService->log(LogLevel::Info, config.pauseReplaySpeed == 0.0
+				? std::string("Engine resumed, replaying held packets as fast as possible")
+				: std::format("Engine resumed, replaying held packets at {}x", config.pauseReplaySpeed));
+		}
+
+		m_pEventBus->publish(bIsPaused ? EngineEventType::Paused : EngineEventType::Resumed);
+	}
+	else if (setting == "debugLogging")
 	{
 		bool bShouldEnabledDebugLogging = std::any_cast<bool>(value);
 		m_loggingService->log(LogLevel::Info, std::format("Engine debug logging {}", bShouldEnabledDebugLogging ? "enabled" : "disabled"));
@@ -169,6 +406,26 @@ void Engine::handleSettingChanged(const std::string& setting, const std::any& va
 		? m_loggingService->enableDebugLogging()
 		: m_loggingService->disableDebugLogging();
 	}
+	else if (setting == "traceCapture")
+	{
+		bool bShouldCapture = std::any_cast<bool>(value);
+		TraceRecorder::instance().setEnabled(bShouldCapture);
+		m_loggingService->log(LogLevel::Info, std::format("Trace capture {}", bShouldCapture ? "enabled" : "disabled"));
+	}
+	else if (setting == "allocationAudit")
+	{
+		bool bShouldAudit = std::any_cast<bool>(value);
+		AllocationTracker::instance().setEnabled(bShouldAudit);
+
+		if (bShouldAudit && !AllocationTracker::areHooksInstalled())
+		{
+			m_loggingService->log(LogLevel::Warning, "Allocation audit enabled, but this build has no counting operator new - configure with VECTORIUM_ALLOCATION_AUDIT=ON");
+		}
+		else
+		{
+			m_loggingService->log(LogLevel::Info, std::format("Allocation audit {}", bShouldAudit ? "enabled" : "disabled"));
+		}
+	}
 }
 
 void Engine::updateLoggerFromSettings()
@@ -196,7 +453,27 @@ void Engine::setUIService(std::shared_ptr<IPluginUIService> uiService)
 	{
 		m_serviceContainer.registerService<IPluginUIService>(m_uiService);
 		m_loggingService->log(LogLevel::Info, "UI service registered with engine");
+
+		// Plugins that require the UI were deferred at startup
+		m_pPluginManager->retryDeferredPlugins();
+	}
+}
+
+void Engine::setRESTService(std::shared_ptr<IPluginRESTService> restService)
+{
+	if (!restService)
+	{
+		return;
 	}
+
+	m_pRestClient = std::move(restService);
+	m_serviceContainer.replaceService<IPluginRESTService>(m_pRestClient);
+	m_loggingService->log(LogLevel::Info, "REST service replaced");
+}
+
+EngineEventBus& Engine::getEventBus() const
+{
+	return *m_pEventBus;
 }
 
 std::shared_ptr<IPluginUIService> Engine::getUIService() const
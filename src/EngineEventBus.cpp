@@ -0,0 +1,113 @@
+#include "EngineEventBus.h"
+
+#include <algorithm>
+#include <utility>
+
+EngineEventQueue::EngineEventQueue(EngineEventMask types, std::size_t capacity)
+	: m_types(types)
+	, m_capacity(capacity)
+{
+}
+
+EngineEventMask EngineEventQueue::getTypes() const
+{
+	return m_types.load(std::memory_order_relaxed);
+}
+
+bool EngineEventQueue::isSubscribed(EngineEventType type) const
+{
+	return (getTypes() & engineEventBit(type)) != 0;
+}
+
+bool EngineEventQueue::push(const EngineEvent& event)
+{
+	std::lock_guard lock(m_mutex);
+	if (m_events.size() >= m_capacity)
+	{
+		m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	m_events.push_back(event);
+	m_hasEvents.store(true, std::memory_order_release);
+	return true;
+}
+
+void EngineEventQueue::takeAll(std::vector<EngineEvent>& batch)
+{
+	batch.clear();
+
+	std::lock_guard lock(m_mutex);
+	std::swap(batch, m_events);
+	m_hasEvents.store(false, std::memory_order_relaxed);
+}
+
+bool EngineEventQueue::isEmpty() const
+{
+	return !m_hasEvents.load(std::memory_order_acquire);
+}
+
+std::uint64_t EngineEventQueue::takeNewDrops()
+{
+	const std::uint64_t dropped = m_droppedEvents.load(std::memory_order_relaxed);
+	return dropped - std::exchange(m_seenDrops, dropped);
+}
+
+std::shared_ptr<EngineEventQueue> EngineEventBus::subscribe(EngineEventMask types, std::size_t capacity)
+{
+	auto queue = std::make_shared<EngineEventQueue>(types, capacity);
+
+	std::unique_lock lock(m_mutex);
+	m_queues.push_back(queue);
+	updateSubscribedTypes();
+	return queue;
+}
+
+void EngineEventBus::setSubscribedTypes(EngineEventQueue& queue, EngineEventMask types)
+{
+	std::unique_lock lock(m_mutex);
+	queue.m_types.store(types, std::memory_order_relaxed);
+	updateSubscribedTypes();
+}
+
+void EngineEventBus::unsubscribe(const std::shared_ptr<EngineEventQueue>& queue)
+{
+	std::unique_lock lock(m_mutex);
+	std::erase(m_queues, queue);
+	updateSubscribedTypes();
+}
+
+void EngineEventBus::publish(EngineEventType type, EngineEvent::Payload payload)
+{
+	if (!hasSubscribers(type))
+	{
+		return;
+	}
+
+	const EngineEvent event{ .type = type, .timestamp = std::chrono::steady_clock::now(), .payload = std::move(payload) };
+
+	std::shared_lock lock(m_mutex);
+	for (const auto& queue : m_queues)
+	{
+		if (queue->isSubscribed(type))
+		{
+			queue->push(event);
+		}
+	}
+}
+
+bool EngineEventBus::hasSubscribers(EngineEventType type) const
+{
+	return (m_subscribedTypes.load(std::memory_order_relaxed) & engineEventBit(type)) != 0;
+}
+
+void EngineEventBus::updateSubscribedTypes()
+{
+	EngineEventMask types = 0;
+	for (const auto& queue : m_queues)
+	{
+		types |= queue->getTypes();
+	}
+
+	m_subscribedTypes.store(types, std::memory_order_relaxed);
+}
@@ -0,0 +1,119 @@
+#include "Plugin/PluginDescriptorCache.h"
+
+#include <format>
+#include <nlohmann/json.hpp>
+
+CachedPluginDescriptor CachedPluginDescriptor::fromDescriptor(const PluginDescriptor& descriptor)
+{
+	CachedPluginDescriptor cached{
+		.name = descriptor.name,
+		.version = descriptor.version,
+		.services = {},
+		.securityLevel = descriptor.requestedSecurityLevel,
+		.packetTypeNames = {},
+		.provides = {}
+	};
+
+	for (const auto& service : descriptor.services)
+	{
+		cached.services.push_back(Service{
+			.typeName = service.type.name(),
+			.name = service.name,
+			.minVersion = service.minVersion,
+			.required = service.required
+		});
+	}
+
+	for (const auto& packetType : descriptor.packetTypes)
+	{
+		cached.packetTypeNames.emplace_back(packetType.name());
+	}
+
+	for (const auto& provided : descriptor.provides)
+	{
+		cached.provides.push_back(ProvidedService{
+			.typeName = provided.type.name(),
+			.name = provided.name,
+			.version = provided.version
+		});
+	}
+
+	return cached;
+}
+
+std::string CachedPluginDescriptor::toJson() const
+{
+	nlohmann::json json =
+	{
+		{"name", name},
+		{"version", version},
+		{"securityLevel", static_cast<int>(securityLevel)},
+		{"packetTypes", packetTypeNames},
+		{"services", nlohmann::json::array()},
+		{"provides", nlohmann::json::array()}
+	};
+
+	for (const auto& service : services)
+	{
+		json["services"].push_back({
+			{"type", service.typeName},
+			{"name", service.name},
+			{"minVersion", service.minVersion},
+			{"required", service.required}
+		});
+	}
+
+	for (const auto& provided : provides)
+	{
+		json["provides"].push_back({
+			{"type", provided.typeName},
+			{"name", provided.name},
+			{"version", provided.version}
+		});
+	}
+
+	return json.dump();
+}
+
+std::expected<CachedPluginDescriptor, std::string> CachedPluginDescriptor::fromJson(std::string_view json)
+{
+	try
+	{
+		const auto parsed = nlohmann::json::parse(json);
+
+		CachedPluginDescriptor cached{
+			.name = parsed.at("name").get<std::string>(),
+			.version = parsed.at("version").get<std::string>(),
+			.services = {},
+			.securityLevel = static_cast<PluginDescriptor::SecurityLevel>(parsed.value("securityLevel", static_cast<int>(PluginDescriptor::SecurityLevel::Standard))),
+			.packetTypeNames = parsed.value("packetTypes", std::vector<std::string>{}),
+			.provides = {}
+		};
+
+		for (const auto& service : parsed.at("services"))
+		{
+			cached.services.push_back(Service{
+				.typeName = service.at("type").get<std::string>(),
+				.name = service.at("name").get<std::string>(),
+				.minVersion = service.value("minVersion", ""),
+				.required = service.value("required", true)
+			});
+		}
+
+		// Not in entries cached before plugins could provide services
+		for (const auto& provided : parsed.value("provides", nlohmann::json::array()))
+		{
+			cached.provides.push_back(ProvidedService{
+				.typeName = provided.at("type").get<std::string>(),
+				.name = provided.at("name").get<std::string>(),
+				.version = provided.value("version", "")
+			});
+		}
+
+		return cached;
+	}
+	catch (const nlohmann::json::exception& ex)
+	{
+		return std::unexpected(std::format("Malformed plugin descriptor: {}", ex.what()));
+	}
+}
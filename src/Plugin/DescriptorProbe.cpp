@@ -0,0 +1,112 @@
+// vectorium_descriptor_probe <plugin>
+// Loads a plugin in a throwaway process and prints its descriptor as one line of JSON, or {"error": "..."}.
+// PluginDescriptorCache runs this so that a plugin which crashes, hangs or prints while loading can't take the engine's
+// folder scan down with it.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include "Plugin/PluginDescriptorCache.h"
+#include "Plugin/PluginInstance.h"
+
+#ifdef _WIN32
+	#include <io.h>
+	#define DuplicateFd(fd)          _dup(fd)
+	#define WriteFd(fd, data, size)  _write(fd, data, static_cast<unsigned>(size))
+	constexpr auto nullDevice = "NUL";
+#else
+	#include <sys/resource.h>
+	#include <unistd.h>
+	#define DuplicateFd(fd)          dup(fd)
+	#define WriteFd(fd, data, size)  write(fd, data, size)
+	constexpr auto nullDevice = "/dev/null";
+#endif
+
+namespace
+{
+	constexpr unsigned probeTimeLimitSeconds = 10;
+
+	/// <summary>
+	/// A plugin whose static initialisers spin or block is killed rather than stalling the scan
+	/// </summary>
+	void limitProcess()
+	{
+#ifndef _WIN32
+		const rlimit cpuLimit{probeTimeLimitSeconds, probeTimeLimitSeconds};
+		setrlimit(RLIMIT_CPU, &cpuLimit);
+		alarm(probeTimeLimitSeconds);
+#endif
+	}
+
+	/// <summary>
+	/// Keeps stdout for the result - anything the plugin prints while loading goes to the null device
+	/// </summary>
+	int reserveResultChannel()
+	{
+		std::fflush(stdout);
+		std::fflush(stderr);
+
+		const int resultFd = DuplicateFd(fileno(stdout));
+
+		if (!std::freopen(nullDevice, "w", stdout) || !std::freopen(nullDevice, "w", stderr))
+		{
+			return -1;
+		}
+
+		return resultFd;
+	}
+
+	[[noreturn]] void finish(int resultFd, const std::string& json, int exitCode)
+	{
+		const std::string line = json + "\n";
+		[[maybe_unused]] const auto written = WriteFd(resultFd, line.data(), line.size());
+
+		// Skip the plugin's static destructors, there's nothing left to learn from it
+		std::_Exit(exitCode);
+	}
+
+	[[noreturn]] void fail(int resultFd, const std::string& error)
+	{
+		finish(resultFd, nlohmann::json{{"error", error}}.dump(), 1);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc != 2)
+	{
+		std::fputs("usage: vectorium_descriptor_probe <plugin>\n", stderr);
+		return 2;
+	}
+
+	limitProcess();
+
+	const int resultFd = reserveResultChannel();
+	if (resultFd < 0)
+	{
+		return 1;
+	}
+
+	// Only the descriptor is needed, so let everything else stay unbound
+	LibraryHandle handle = LoadSharedLibraryLazy(argv[1]);
+	if (!handle)
+	{
+		fail(resultFd, std::string("Failed to load plugin: ") + getError());
+	}
+
+	const auto pluginDescriptorFunc = reinterpret_cast<PluginDescriptor*(*)()>(GetSymbol(handle, "getPluginDescriptor"));
+	if (!pluginDescriptorFunc)
+	{
+		fail(resultFd, "Missing 'getPluginDescriptor' export");
+	}
+
+	const PluginDescriptor* descriptor = pluginDescriptorFunc();
+	if (!descriptor)
+	{
+		fail(resultFd, "'getPluginDescriptor' returned nullptr");
+	}
+
+	finish(resultFd, CachedPluginDescriptor::fromDescriptor(*descriptor).toJson(), 0);
+}
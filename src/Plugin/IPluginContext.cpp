@@ -1 +1,7 @@
 #include "Plugin/IPluginContext.h"
+
+std::shared_ptr<std::pmr::memory_resource> IPluginContext::getMemoryResourceShared()
+{
+	// A context with no memory account (eg. in a plugin host process) charges nobody - not owned, it's never destroyed
+	return std::shared_ptr<std::pmr::memory_resource>(std::shared_ptr<void>(), std::pmr::new_delete_resource());
+}
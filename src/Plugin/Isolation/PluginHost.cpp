@@ -0,0 +1,395 @@
+// vectorium_plugin_host <plugin> <name>
+// Runs one plugin in its own process for RemotePlugin, so that a crash, hang or leak in it stays out of the engine.
+// The engine hands over fd 3 (control socket), fd 4 (engine -> host packet ring) and fd 5 (host -> engine packet ring).
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "DataPacket/DataPacket.h"
+#include "Plugin/IPlugin.h"
+#include "Plugin/Isolation/PluginHostChannel.h"
+#include "Plugin/Isolation/SharedPacketRing.h"
+#include "Plugin/PluginDescriptorCache.h"
+#include "Plugin/PluginInstance.h"
+#include "Services/Logging/ILogger.h"
+#include "Services/Logging/LogLevel.h"
+
+#include <unistd.h>
+
+namespace
+{
+	constexpr auto packetPollInterval = std::chrono::milliseconds(100);
+	constexpr auto fullRingTimeout = std::chrono::milliseconds(10);
+
+	void sendLog(const PluginHostChannel& channel, LogLevel level, const std::string& message)
+	{
+		channel.send(nlohmann::json{{"op", "log"}, {"level", static_cast<int>(level)}, {"message", message}}.dump());
+	}
+
+	/// <summary>
+	/// Hands everything to the plugin's logger in the engine, which applies its debug setting
+	/// </summary>
+	class HostLogger final : public ILogger
+	{
+	public:
+		explicit HostLogger(const PluginHostChannel& channel) : m_channel(channel) {}
+
+		void log(LogLevel level, const std::string& message) override { sendLog(m_channel, level, message); }
+
+		void enableDebugLogging() override { m_isDebugLoggingEnabled = true; }
+		void disableDebugLogging() override { m_isDebugLoggingEnabled = false; }
+		bool isDebugLoggingEnabled() const override { return m_isDebugLoggingEnabled; }
+		void setPluginName([[maybe_unused]] const std::string& name) override {}
+
+	private:
+		const PluginHostChannel& m_channel;
+		std::atomic_bool         m_isDebugLoggingEnabled{false};
+	};
+
+	/// <summary>
+	/// The plugin's view of the engine from inside the host. Handlers are told to the engine by type name, packets go out
+	/// through the ring, and only the logger is available as a service.
+	/// </summary>
+	class HostContext final : public IPluginContext
+	{
+	public:
+		HostContext(const PluginHostChannel& channel, SharedPacketRing& toEngine, std::string pluginName)
+			: m_channel(channel)
+			, m_toEngine(toEngine)
+			, m_pluginName(std::move(pluginName))
+			, m_logger(std::make_shared<HostLogger>(channel))
+		{
+			m_loggerSlot.store(m_logger);
+			m_fixedServiceSlots[serviceSlotIndex<ILogger>] = &m_loggerSlot;
+		}
+
+		void dispatch(const DataPacket& packet) override
+		{
+			if (!packet.payload)
+			{
+				return;
+			}
+
+			if (packet.payloadSize == 0)
+			{
+				if (!m_hasWarnedNotCopyable.exchange(true))
+				{
+					log(LogLevel::Warning, std::format("[PluginHost] - '{}' packets aren't trivially copyable, so they can't leave the plugin host", packet.payloadType.name()));
+				}
+				return;
+			}
+
+			const std::string_view typeName = packet.payloadType.name();
+			const std::uint64_t    typeHash = hashPacketTypeName(typeName);
+			const auto             timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(packet.timestamp.time_since_epoch()).count();
+
+			std::lock_guard lock(m_dispatchMutex);
+
+			// The engine learns each type name once, in the ring, so it always arrives before the packets that use it
+			if (!m_announcedTypes.contains(typeHash))
+			{
+				if (!m_toEngine.write(RingRecord::Kind::TypeName, typeHash, 0, std::as_bytes(std::span(typeName)), fullRingTimeout))
+				{
+					++m_droppedPackets;
+					return;
+				}
+				m_announcedTypes.insert(typeHash);
+			}
+
+			const std::span payload(static_cast<const std::byte*>(packet.payload.get()), packet.payloadSize);
+			if (!m_toEngine.write(RingRecord::Kind::Packet, typeHash, timestampNs, payload, fullRingTimeout))
+			{
+				++m_droppedPackets;
+			}
+		}
+
+		void log(LogLevel level, const std::string& message) const override { m_logger->log(level, message); }
+
+		std::shared_ptr<ILogger> getLoggerShared() override { return m_logger; }
+		std::string              getPluginName() const override { return m_pluginName; }
+
+		// No ImGui context crosses a process boundary
+		void* getMainAppImGuiContext() override { return nullptr; }
+		bool  setImGuiContext([[maybe_unused]] void* ctx) override { return false; }
+
+		/// <summary>
+		/// Hands a packet from the engine to the handlers registered for its type
+		/// </summary>
+		void deliver(const RingRecord& record)
+		{
+			std::vector<std::shared_ptr<IDataPacketHandler>> handlers;
+			std::optional<std::type_index>                   type;
+			{
+				std::lock_guard lock(m_handlersMutex);
+				const auto subscription = m_subscriptions.find(record.typeHash);
+				if (subscription == m_subscriptions.end())
+				{
+					return;
+				}
+
+				type = subscription->second.type;
+				handlers = subscription->second.handlers;
+			}
+
+			const std::size_t words = (record.payload.size() + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+			auto payload = std::make_shared_for_overwrite<std::max_align_t[]>(words);
+			std::memcpy(payload.get(), record.payload.data(), record.payload.size());
+
+			const DataPacket packet{
+				.payload = std::move(payload),
+				.payloadType = *type,
+				.timestamp = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(record.timestampNs))),
+				.payloadSize = static_cast<std::uint32_t>(record.payload.size())
+			};
+
+			for (const auto& handler : handlers)
+			{
+				handler->handle(packet);
+			}
+		}
+
+		[[nodiscard]] std::uint64_t getDroppedPacketCount() const
+		{
+			std::lock_guard lock(m_dispatchMutex);
+			return m_droppedPackets;
+		}
+
+	protected:
+		bool registerDataPacketHandler(std::type_index type, std::shared_ptr<IDataPacketHandler> handler) override
+		{
+			bool isNewType = false;
+			{
+				std::lock_guard lock(m_handlersMutex);
+				auto [subscription, inserted] = m_subscriptions.try_emplace(hashPacketTypeName(type.name()), Subscription{ .type = type, .handlers = {} });
+				subscription->second.handlers.push_back(std::move(handler));
+				isNewType = inserted;
+			}
+
+			if (isNewType)
+			{
+				m_channel.send(nlohmann::json{{"op", "register"}, {"type", type.name()}}.dump());
+			}
+
+			return true;
+		}
+
+	private:
+		// Nothing but the logger is available to a plugin running in its own process
+		const ServiceSlot* getServiceSlot(std::type_index tIdx, std::size_t slotIndex) override
+		{
+			return tIdx == typeid(ILogger) && slotIndex == serviceSlotIndex<ILogger> ? &m_loggerSlot : nullptr;
+		}
+
+		bool hasServiceByTypeIndex(std::type_index tIdx) const override
+		{
+			return tIdx == typeid(ILogger);
+		}
+
+		struct Subscription
+		{
+			std::type_index                                  type;
+			std::vector<std::shared_ptr<IDataPacketHandler>> handlers;
+		};
+
+		const PluginHostChannel&    m_channel;
+		SharedPacketRing&           m_toEngine;
+		std::string                 m_pluginName;
+		std::shared_ptr<ILogger>    m_logger;
+		ServiceSlot                 m_loggerSlot;
+
+		std::mutex                                      m_handlersMutex;
+		std::unordered_map<std::uint64_t, Subscription> m_subscriptions;
+
+		mutable std::mutex                m_dispatchMutex; // the ring has one producer
+		std::unordered_set<std::uint64_t> m_announcedTypes;
+		std::uint64_t                     m_droppedPackets = 0;
+		std::atomic_bool                  m_hasWarnedNotCopyable{false};
+	};
+
+	int failLoad(const PluginHostChannel& channel, const std::string& error)
+	{
+		channel.send(nlohmann::json{{"op", "loaded"}, {"ok", false}, {"error", error}}.dump());
+		return 1;
+	}
+
+	/// <summary>
+	/// Waits for the engine's "load" - false if the engine went away first
+	/// </summary>
+	bool waitForLoadRequest(const PluginHostChannel& channel)
+	{
+		while (true)
+		{
+			const auto message = channel.receive(std::chrono::seconds(1));
+			if (!message)
+			{
+				if (message.error() == PluginHostChannel::Error::Closed)
+				{
+					return false;
+				}
+				continue;
+			}
+
+			const auto json = nlohmann::json::parse(*message, nullptr, false);
+			if (!json.is_discarded() && json.value("op", "") == "load")
+			{
+				return true;
+			}
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc != 3)
+	{
+		std::fputs("usage: vectorium_plugin_host <plugin> <name> - started by the engine for isolated plugins\n", stderr);
+		return 2;
+	}
+
+	const pid_t enginePid = getppid();
+
+	const PluginHostChannel channel(PluginHostChannel::hostControlFd);
+	auto toHost = SharedPacketRing::attach(PluginHostChannel::hostToHostRingFd);
+	auto fromHost = SharedPacketRing::attach(PluginHostChannel::hostFromHostRingFd);
+	if (!toHost || !fromHost)
+	{
+		return failLoad(channel, !toHost ? toHost.error() : fromHost.error());
+	}
+
+	LibraryHandle handle = LoadSharedLibrary(argv[1]);
+	if (!handle)
+	{
+		return failLoad(channel, std::string("Failed to load plugin: ") + getError());
+	}
+
+	if (const auto pluginDescriptorFunc = reinterpret_cast<PluginDescriptor*(*)()>(GetSymbol(handle, "getPluginDescriptor")))
+	{
+		if (const PluginDescriptor* descriptor = pluginDescriptorFunc())
+		{
+			const auto descriptorJson = nlohmann::json::parse(CachedPluginDescriptor::fromDescriptor(*descriptor).toJson());
+			channel.send(nlohmann::json{{"op", "hello"}, {"descriptor", descriptorJson}}.dump());
+		}
+	}
+
+	const auto createPlugin = reinterpret_cast<IPlugin*(*)()>(GetSymbol(handle, "loadPlugin"));
+	if (!createPlugin)
+	{
+		return failLoad(channel, "Missing 'loadPlugin' export");
+	}
+
+	if (!waitForLoadRequest(channel))
+	{
+		return 0;
+	}
+
+	HostContext context(channel, *fromHost, argv[2]);
+
+	std::unique_ptr<IPlugin> plugin;
+	try
+	{
+		plugin.reset(createPlugin());
+		if (!plugin)
+		{
+			return failLoad(channel, "'loadPlugin' returned nullptr");
+		}
+
+		if (auto loadResult = plugin->onPluginLoad(context); !loadResult)
+		{
+			plugin->onPluginUnload();
+			return failLoad(channel, loadResult.error());
+		}
+	}
+	catch (const std::exception& ex)
+	{
+		return failLoad(channel, std::format("Exception while loading: {}", ex.what()));
+	}
+
+	channel.send(R"({"op":"loaded","ok":true})");
+
+	std::jthread packetReader([&](const std::stop_token& stopToken)
+	{
+		while (!stopToken.stop_requested())
+		{
+			// Nothing else notices the engine dying while the plugin is busy, so don't outlive it
+			if (getppid() != enginePid)
+			{
+				std::_Exit(0);
+			}
+
+			if (toHost->waitForData(packetPollInterval))
+			{
+				toHost->read([&](const RingRecord& record) { context.deliver(record); });
+			}
+
+			if (toHost->isCorrupted())
+			{
+				sendLog(channel, LogLevel::Error, "[PluginHost] - Packet ring from the engine is corrupt, stopping");
+				std::_Exit(3);
+			}
+		}
+	});
+
+	std::uint64_t reportedDrops = 0;
+
+	while (true)
+	{
+		const auto message = channel.receive(std::chrono::seconds(1));
+		if (!message)
+		{
+			if (message.error() == PluginHostChannel::Error::Closed)
+			{
+				break;
+			}
+			continue;
+		}
+
+		const auto json = nlohmann::json::parse(*message, nullptr, false);
+		const std::string op = json.is_discarded() ? "" : json.value("op", "");
+
+		if (op == "unload")
+		{
+			break;
+		}
+
+		if (op == "tick")
+		{
+			try
+			{
+				plugin->tick();
+			}
+			catch (const std::exception& ex)
+			{
+				sendLog(channel, LogLevel::Error, std::format("[PluginHost] - Exception in tick: {}", ex.what()));
+			}
+
+			if (const std::uint64_t dropped = context.getDroppedPacketCount(); dropped != reportedDrops)
+			{
+				sendLog(channel, LogLevel::Warning, std::format("[PluginHost] - Dropped {} packet(s) - the engine isn't keeping up", dropped - reportedDrops));
+				reportedDrops = dropped;
+			}
+		}
+	}
+
+	packetReader.request_stop();
+	toHost->wakeConsumer();
+	packetReader.join();
+
+	plugin->onPluginUnload();
+	plugin.reset();
+
+	return 0;
+}
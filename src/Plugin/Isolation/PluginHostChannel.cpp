@@ -0,0 +1,80 @@
+#include "Plugin/Isolation/PluginHostChannel.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <string>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+PluginHostChannel::PluginHostChannel(int fd)
+	: m_fd(fd)
+{
+}
+
+PluginHostChannel::~PluginHostChannel()
+{
+	if (m_fd >= 0)
+	{
+		close(m_fd);
+	}
+}
+
+bool PluginHostChannel::send(std::string_view message) const
+{
+	return sendWithFlags(message, 0);
+}
+
+bool PluginHostChannel::trySend(std::string_view message) const
+{
+	return sendWithFlags(message, MSG_DONTWAIT);
+}
+
+bool PluginHostChannel::sendWithFlags(std::string_view message, int flags) const
+{
+	const std::size_t size = std::min(message.size(), maxMessageSize);
+
+	ssize_t sent = -1;
+	do
+	{
+		// MSG_NOSIGNAL - a host that died must not take the engine down with SIGPIPE
+		sent = ::send(m_fd, message.data(), size, MSG_NOSIGNAL | flags);
+	}
+	while (sent < 0 && errno == EINTR);
+
+	return sent == static_cast<ssize_t>(size);
+}
+
+std::expected<std::string, PluginHostChannel::Error> PluginHostChannel::receive(std::chrono::milliseconds timeout) const
+{
+	pollfd fd{ .fd = m_fd, .events = POLLIN, .revents = 0 };
+
+	const int ready = poll(&fd, 1, static_cast<int>(timeout.count()));
+	if (ready == 0 || (ready < 0 && errno == EINTR))
+	{
+		return std::unexpected(Error::Timeout);
+	}
+
+	if (ready < 0)
+	{
+		return std::unexpected(Error::Closed);
+	}
+
+	std::string message(maxMessageSize, '\0');
+	const ssize_t received = recv(m_fd, message.data(), message.size(), 0);
+
+	// A zero-length datagram is never sent, so zero is the other end going away
+	if (received <= 0)
+	{
+		return std::unexpected(received < 0 && (errno == EAGAIN || errno == EINTR) ? Error::Timeout : Error::Closed);
+	}
+
+	message.resize(static_cast<std::size_t>(received));
+	return message;
+}
+
+void PluginHostChannel::shutdown() const
+{
+	::shutdown(m_fd, SHUT_RDWR);
+}
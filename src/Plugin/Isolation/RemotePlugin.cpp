@@ -0,0 +1,551 @@
+#include "Plugin/Isolation/RemotePlugin.h"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <utility>
+#include <nlohmann/json.hpp>
+
+#include "DataPacket/DataPacket.h"
+#include "DataPacket/DataPacketRegistry.h"
+#include "Plugin/PluginDescriptorCache.h"
+#include "Services/Logging/ILogger.h"
+#include "Services/Logging/LogLevel.h"
+
+#include <csignal>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+	constexpr auto controlPollInterval = std::chrono::milliseconds(200);
+	constexpr auto packetPollInterval = std::chrono::milliseconds(100);
+	constexpr auto typeLookupRetryInterval = std::chrono::seconds(1);
+
+	/// <summary>
+	/// Types with no handler in the engine can still be dispatched if they are built in
+	/// </summary>
+	std::optional<std::type_index> findFundamentalType(std::string_view typeName)
+	{
+		static const std::array<std::type_index, 15> fundamentalTypes{
+			typeid(bool), typeid(char), typeid(signed char), typeid(unsigned char),
+			typeid(short), typeid(unsigned short), typeid(int), typeid(unsigned int),
+			typeid(long), typeid(unsigned long), typeid(long long), typeid(unsigned long long),
+			typeid(float), typeid(double), typeid(long double)
+		};
+
+		for (const auto& type : fundamentalTypes)
+		{
+			if (type.name() == typeName)
+			{
+				return type;
+			}
+		}
+
+		return std::nullopt;
+	}
+
+	std::string describeExitStatus(int status)
+	{
+		if (WIFSIGNALED(status))
+		{
+			return std::format("killed by signal {} ({})", WTERMSIG(status), strsignal(WTERMSIG(status)));
+		}
+
+		return std::format("exit code {}", WEXITSTATUS(status));
+	}
+
+	std::int64_t toTimestampNs(std::chrono::system_clock::time_point timestamp)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+	}
+}
+
+/// <summary>
+/// Registered for each packet type the host's plugin handles - copies the packet into the host's ring
+/// </summary>
+class RemotePlugin::Forwarder final : public IDataPacketHandler
+{
+public:
+	Forwarder(std::shared_ptr<HostLink> link, std::string typeName, std::shared_ptr<ILogger> logger)
+		: m_link(std::move(link))
+		, m_typeHash(hashPacketTypeName(typeName))
+		, m_typeName(std::move(typeName))
+		, m_logger(std::move(logger))
+	{
+	}
+
+	bool handle(const DataPacket& packet) override
+	{
+		if (!m_link->isRunning.load(std::memory_order_relaxed) || !packet.payload)
+		{
+			return false;
+		}
+
+		if (packet.payloadSize == 0)
+		{
+			if (!m_hasWarned.exchange(true) && m_logger)
+			{
+				m_logger->log(LogLevel::Warning, std::format("[RemotePlugin] - '{}' packets aren't trivially copyable, so they can't be sent to the plugin host", m_typeName));
+			}
+			return false;
+		}
+
+		const std::span payload(static_cast<const std::byte*>(packet.payload.get()), packet.payloadSize);
+
+		// A host that stopped reading costs a dispatch one wait, not one per packet
+		if (m_link->isHostStalled.load(std::memory_order_acquire))
+		{
+			if (m_link->toHost.getReadBytes() == m_link->stalledAtReadBytes.load(std::memory_order_relaxed))
+			{
+				m_link->droppedPackets.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			m_link->isHostStalled.store(false, std::memory_order_relaxed);
+		}
+
+		bool isWritten = tryWrite(packet, payload);
+		if (!isWritten)
+		{
+			// Waited for without the write lock, so the other dispatching threads aren't queued up behind this one
+			const std::uint64_t readBytes = m_link->toHost.getReadBytes();
+			isWritten = m_link->toHost.waitForRoom(payload.size(), m_link->fullRingTimeout) && tryWrite(packet, payload);
+
+			if (!isWritten)
+			{
+				m_link->stalledAtReadBytes.store(readBytes, std::memory_order_relaxed);
+				m_link->isHostStalled.store(true, std::memory_order_release);
+			}
+		}
+
+		if (!isWritten)
+		{
+			m_link->droppedPackets.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		return isWritten;
+	}
+
+private:
+	bool tryWrite(const DataPacket& packet, std::span<const std::byte> payload)
+	{
+		std::lock_guard lock(m_link->writeMutex);
+		return m_link->toHost.write(RingRecord::Kind::Packet, m_typeHash, toTimestampNs(packet.timestamp), payload, std::chrono::milliseconds(0));
+	}
+
+	std::shared_ptr<HostLink> m_link;
+	std::uint64_t             m_typeHash;
+	std::string               m_typeName;
+	std::shared_ptr<ILogger>  m_logger;
+	std::atomic_bool          m_hasWarned{false};
+};
+
+RemotePlugin::RemotePlugin(std::string name, std::filesystem::path pluginPath, DataPacketRegistry& registry, RemotePluginOptions options)
+	: m_name(std::move(name))
+	, m_pluginPath(std::move(pluginPath))
+	, m_registry(registry)
+	, m_options(std::move(options))
+{
+	m_plugin_descriptor.name = m_name;
+}
+
+RemotePlugin::~RemotePlugin()
+{
+	stopHost();
+}
+
+std::expected<void, std::string> RemotePlugin::onPluginLoad(IPluginContext& context)
+{
+	m_context = &context;
+
+	if (auto started = startHost(); !started)
+	{
+		return started;
+	}
+
+	m_controlReader = std::jthread([this](const std::stop_token& stopToken) { readControl(stopToken); });
+	m_packetReader = std::jthread([this](const std::stop_token& stopToken) { readPackets(stopToken); });
+
+	m_channel->send(nlohmann::json{{"op", "load"}}.dump());
+
+	std::unique_lock lock(m_stateMutex);
+	const bool hasFinished = m_stateChanged.wait_for(lock, m_options.startTimeout, [&]
+	{
+		return m_loadResult.has_value() || m_hasHostExited;
+	});
+
+	if (!hasFinished)
+	{
+		return std::unexpected(std::format("Plugin host didn't load '{}' within {}ms", m_name, m_options.startTimeout.count()));
+	}
+
+	if (!m_loadResult)
+	{
+		return std::unexpected(std::format("Plugin host exited while loading '{}' - {}", m_name, m_exitDescription));
+	}
+
+	return *m_loadResult;
+}
+
+void RemotePlugin::onPluginUnload()
+{
+	stopHost();
+}
+
+void RemotePlugin::tick()
+{
+	if (!isHostRunning())
+	{
+		return;
+	}
+
+	// A host still busy with earlier ticks just misses this one
+	m_channel->trySend(R"({"op":"tick"})");
+
+	if (const std::uint64_t dropped = getDroppedPacketCount(); dropped != m_reportedDrops)
+	{
+		log(LogLevel::Warning, std::format("Dropped {} packet(s) for '{}' - its host isn't keeping up", dropped - m_reportedDrops, m_name));
+		m_reportedDrops = dropped;
+	}
+}
+
+std::type_index RemotePlugin::getType() const
+{
+	return typeid(RemotePlugin);
+}
+
+bool RemotePlugin::isHostRunning() const
+{
+	return m_link && m_link->isRunning.load(std::memory_order_relaxed);
+}
+
+std::uint64_t RemotePlugin::getDroppedPacketCount() const
+{
+	return m_link ? m_link->droppedPackets.load(std::memory_order_relaxed) : 0;
+}
+
+std::expected<void, std::string> RemotePlugin::startHost()
+{
+	if (!std::filesystem::exists(m_options.hostExecutable))
+	{
+		return std::unexpected(std::format("Plugin host not found at '{}'", m_options.hostExecutable.string()));
+	}
+
+	auto toHost = SharedPacketRing::create(m_options.ringBytes);
+	auto fromHost = SharedPacketRing::create(m_options.ringBytes);
+	if (!toHost || !fromHost)
+	{
+		return std::unexpected(!toHost ? toHost.error() : fromHost.error());
+	}
+
+	int sockets[2];
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sockets) != 0)
+	{
+		return std::unexpected(std::format("Could not create plugin host socket: {}", std::strerror(errno)));
+	}
+
+	// Built before forking - the child may only make async-signal-safe calls until it execs
+	const std::string executable = m_options.hostExecutable.string();
+	const std::string pluginPath = m_pluginPath.string();
+	std::array<char*, 4> argv{
+		const_cast<char*>(executable.c_str()),
+		const_cast<char*>(pluginPath.c_str()),
+		const_cast<char*>(m_name.c_str()),
+		nullptr
+	};
+
+	const int sourceFds[] = { sockets[1], toHost->getFd(), fromHost->getFd() };
+	const int targetFds[] = { PluginHostChannel::hostControlFd, PluginHostChannel::hostToHostRingFd, PluginHostChannel::hostFromHostRingFd };
+
+	const pid_t pid = fork();
+	if (pid == 0)
+	{
+		// Move everything clear of the target numbers first, so no dup2 overwrites a source still to be moved
+		int movedFds[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			movedFds[i] = fcntl(sourceFds[i], F_DUPFD, 10);
+			if (movedFds[i] < 0)
+			{
+				_exit(127);
+			}
+		}
+
+		for (int i = 0; i < 3; ++i)
+		{
+			if (dup2(movedFds[i], targetFds[i]) < 0)
+			{
+				_exit(127);
+			}
+			close(movedFds[i]);
+		}
+
+		execv(argv[0], argv.data());
+		_exit(127);
+	}
+
+	close(sockets[1]);
+
+	if (pid < 0)
+	{
+		close(sockets[0]);
+		return std::unexpected(std::format("Could not start plugin host: {}", std::strerror(errno)));
+	}
+
+	m_hostPid = pid;
+	m_channel = std::make_unique<PluginHostChannel>(sockets[0]);
+	m_fromHost = std::make_unique<SharedPacketRing>(std::move(*fromHost));
+
+	m_link = std::make_shared<HostLink>(std::move(*toHost));
+	m_link->fullRingTimeout = m_options.fullRingTimeout;
+	m_link->isRunning = true;
+
+	log(LogLevel::Info, std::format("Started plugin host {} for '{}'", pid, m_name));
+	return {};
+}
+
+void RemotePlugin::readControl(const std::stop_token& stopToken)
+{
+	while (!stopToken.stop_requested())
+	{
+		const auto message = m_channel->receive(controlPollInterval);
+		if (message)
+		{
+			handleControlMessage(*message);
+		}
+		else if (message.error() == PluginHostChannel::Error::Closed)
+		{
+			onHostExited();
+			return;
+		}
+	}
+}
+
+void RemotePlugin::handleControlMessage(const std::string& message)
+{
+	try
+	{
+		const auto json = nlohmann::json::parse(message);
+		const auto op = json.at("op").get<std::string>();
+
+		if (op == "log")
+		{
+			m_context->log(static_cast<LogLevel>(json.at("level").get<int>()), json.at("message").get<std::string>());
+		}
+		else if (op == "register")
+		{
+			auto typeName = json.at("type").get<std::string>();
+			log(LogLevel::Info, std::format("'{}' handles '{}' in its host", m_name, typeName));
+
+			auto forwarder = std::make_shared<Forwarder>(m_link, typeName, m_context->getLoggerShared());
+			m_registry.registerDataPacketHandlerByTypeName(std::move(typeName), std::move(forwarder), m_name);
+		}
+		else if (op == "hello")
+		{
+			if (const auto descriptor = CachedPluginDescriptor::fromJson(json.at("descriptor").dump()))
+			{
+				m_plugin_descriptor.name = descriptor->name;
+				m_plugin_descriptor.version = descriptor->version;
+				m_plugin_descriptor.requestedSecurityLevel = descriptor->securityLevel;
+			}
+		}
+		else if (op == "loaded")
+		{
+			std::lock_guard lock(m_stateMutex);
+			if (json.at("ok").get<bool>())
+			{
+				m_loadResult.emplace();
+			}
+			else
+			{
+				m_loadResult.emplace(std::unexpected(json.value("error", std::string("unknown error"))));
+			}
+			m_stateChanged.notify_all();
+		}
+		else
+		{
+			log(LogLevel::Warning, std::format("Unknown message '{}' from the host of '{}'", op, m_name));
+		}
+	}
+	catch (const nlohmann::json::exception& ex)
+	{
+		log(LogLevel::Warning, std::format("Unreadable message from the host of '{}': {}", m_name, ex.what()));
+	}
+}
+
+void RemotePlugin::readPackets(const std::stop_token& stopToken)
+{
+	while (!stopToken.stop_requested())
+	{
+		if (!m_fromHost->waitForData(packetPollInterval))
+		{
+			continue;
+		}
+
+		m_fromHost->read([this](const RingRecord& record) { dispatchFromHost(record); });
+
+		if (m_fromHost->isCorrupted())
+		{
+			log(LogLevel::Error, std::format("The host of '{}' wrote a corrupt packet, stopping it", m_name));
+			kill(m_hostPid, SIGKILL);
+			return;
+		}
+	}
+}
+
+void RemotePlugin::dispatchFromHost(const RingRecord& record)
+{
+	if (record.kind == RingRecord::Kind::TypeName)
+	{
+		HostType& hostType = m_hostTypes[record.typeHash];
+		hostType.name.assign(reinterpret_cast<const char*>(record.payload.data()), record.payload.size());
+		hostType.type.reset();
+		hostType.nextLookup = {};
+		return;
+	}
+
+	const auto type = resolveHostType(record.typeHash);
+	if (!type)
+	{
+		return;
+	}
+
+	// Copied out, the ring space is reused as soon as this returns
+	const std::size_t words = (record.payload.size() + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+	auto payload = std::make_shared_for_overwrite<std::max_align_t[]>(words);
+	std::memcpy(payload.get(), record.payload.data(), record.payload.size());
+
+	m_context->dispatch(DataPacket{
+		.payload = std::move(payload),
+		.payloadType = *type,
+		.timestamp = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(record.timestampNs))),
+		.payloadSize = static_cast<std::uint32_t>(record.payload.size())
+	});
+}
+
+std::optional<std::type_index> RemotePlugin::resolveHostType(std::uint64_t typeHash)
+{
+	const auto it = m_hostTypes.find(typeHash);
+	if (it == m_hostTypes.end())
+	{
+		return std::nullopt;
+	}
+
+	HostType& hostType = it->second;
+	if (hostType.type)
+	{
+		return hostType.type;
+	}
+
+	// Handlers register over time, so an unknown name is tried again now and then rather than on every packet
+	const auto now = std::chrono::steady_clock::now();
+	if (now < hostType.nextLookup)
+	{
+		return std::nullopt;
+	}
+
+	hostType.type = m_registry.findDataPacketType(hostType.name);
+	if (!hostType.type)
+	{
+		hostType.type = findFundamentalType(hostType.name);
+	}
+
+	if (!hostType.type)
+	{
+		if (hostType.nextLookup == std::chrono::steady_clock::time_point{})
+		{
+			log(LogLevel::Warning, std::format("'{}' sent '{}' packets, which nothing in the engine handles - dropping them", m_name, hostType.name));
+		}
+		hostType.nextLookup = now + typeLookupRetryInterval;
+	}
+
+	return hostType.type;
+}
+
+void RemotePlugin::onHostExited()
+{
+	m_link->isRunning = false;
+
+	// The socket closes as the process dies, so it is normally already reapable - give it a moment before forcing it
+	int   status = 0;
+	pid_t reaped = 0;
+	for (int attempt = 0; attempt < 50 && (reaped = waitpid(m_hostPid, &status, WNOHANG)) == 0; ++attempt)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+
+	if (reaped == 0)
+	{
+		kill(m_hostPid, SIGKILL);
+		reaped = waitpid(m_hostPid, &status, 0);
+	}
+
+	const std::string description = reaped > 0 ? describeExitStatus(status) : "already reaped";
+
+	if (m_isUnloading)
+	{
+		log(LogLevel::Debug, std::format("Plugin host for '{}' finished - {}", m_name, description));
+	}
+	else
+	{
+		log(LogLevel::Error, std::format("Plugin host for '{}' exited unexpectedly - {}. The plugin is no longer running, the engine carries on", m_name, description));
+	}
+
+	{
+		std::lock_guard lock(m_stateMutex);
+		m_hasHostExited = true;
+		m_exitDescription = description;
+	}
+	m_stateChanged.notify_all();
+
+	m_fromHost->wakeConsumer();
+}
+
+void RemotePlugin::stopHost()
+{
+	if (m_hostPid < 0)
+	{
+		return;
+	}
+
+	m_isUnloading = true;
+
+	{
+		std::unique_lock lock(m_stateMutex);
+		if (!m_hasHostExited)
+		{
+			lock.unlock();
+			m_channel->send(nlohmann::json{{"op", "unload"}}.dump());
+			lock.lock();
+
+			if (!m_stateChanged.wait_for(lock, m_options.unloadTimeout, [&] { return m_hasHostExited; }))
+			{
+				log(LogLevel::Warning, std::format("Plugin host for '{}' didn't unload within {}ms, killing it", m_name, m_options.unloadTimeout.count()));
+				kill(m_hostPid, SIGKILL);
+
+				// The control reader sees the socket close and reaps it
+				m_stateChanged.wait(lock, [&] { return m_hasHostExited; });
+			}
+		}
+	}
+
+	m_controlReader = {};
+
+	m_packetReader.request_stop();
+	m_fromHost->wakeConsumer();
+	m_packetReader = {};
+
+	m_hostPid = -1;
+}
+
+void RemotePlugin::log(LogLevel level, const std::string& message) const
+{
+	if (m_context)
+	{
+		m_context->log(level, std::format("[{}] - {}", "RemotePlugin", message));
+	}
+}
@@ -0,0 +1,309 @@
+#include "Plugin/Isolation/SharedPacketRing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <format>
+#include <new>
+#include <utility>
+
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+	std::uint32_t* futexWord(std::atomic<std::uint32_t>& word)
+	{
+		static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t) && std::atomic<std::uint32_t>::is_always_lock_free);
+		return reinterpret_cast<std::uint32_t*>(&word);
+	}
+
+	/// <summary>
+	/// Not FUTEX_PRIVATE - the word is shared with another process
+	/// </summary>
+	void futexWait(std::atomic<std::uint32_t>& word, std::uint32_t expected, std::chrono::nanoseconds timeout)
+	{
+		const timespec relative{
+			.tv_sec = static_cast<time_t>(timeout.count() / 1'000'000'000),
+			.tv_nsec = static_cast<long>(timeout.count() % 1'000'000'000)
+		};
+
+		syscall(SYS_futex, futexWord(word), FUTEX_WAIT, expected, &relative, nullptr, 0);
+	}
+
+	void futexWakeAll(std::atomic<std::uint32_t>& word)
+	{
+		syscall(SYS_futex, futexWord(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+	}
+
+	std::size_t roundToPages(std::size_t bytes)
+	{
+		const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+		return (bytes + pageSize - 1) / pageSize * pageSize;
+	}
+
+	/// <summary>
+	/// Waits on a futex word until ready() holds or the deadline passes. The waiting flag is raised before ready() is
+	/// checked again, so the other side either sees it and wakes us, or we see its update - never neither.
+	/// </summary>
+	template<typename Ready>
+	bool waitUntil(std::atomic<std::uint32_t>& signal, std::atomic<std::uint32_t>& isWaiting,
+		std::chrono::steady_clock::time_point deadline, Ready&& ready)
+	{
+		while (!ready())
+		{
+			const auto remaining = deadline - std::chrono::steady_clock::now();
+			if (remaining <= std::chrono::steady_clock::duration::zero())
+			{
+				return false;
+			}
+
+			const std::uint32_t observed = signal.load(std::memory_order_acquire);
+			isWaiting.store(1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if (!ready())
+			{
+				futexWait(signal, observed, remaining);
+			}
+
+			isWaiting.store(0, std::memory_order_relaxed);
+		}
+
+		return true;
+	}
+
+	void signalIfWaiting(std::atomic<std::uint32_t>& signal, std::atomic<std::uint32_t>& isWaiting)
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (isWaiting.load(std::memory_order_relaxed))
+		{
+			signal.fetch_add(1, std::memory_order_release);
+			futexWakeAll(signal);
+		}
+	}
+}
+
+std::expected<SharedPacketRing, std::string> SharedPacketRing::create(std::size_t capacity)
+{
+	capacity = std::max<std::size_t>(alignRecord(capacity), 64 * 1024);
+
+	const int fd = memfd_create("vectorium-packet-ring", MFD_CLOEXEC);
+	if (fd < 0)
+	{
+		return std::unexpected(std::format("memfd_create failed: {}", std::strerror(errno)));
+	}
+
+	const std::size_t headerSize = roundToPages(sizeof(Header));
+	const std::size_t mappingSize = headerSize + roundToPages(capacity);
+
+	if (ftruncate(fd, static_cast<off_t>(mappingSize)) != 0)
+	{
+		const int error = errno;
+		close(fd);
+		return std::unexpected(std::format("Could not size packet ring: {}", std::strerror(error)));
+	}
+
+	void* mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mapping == MAP_FAILED)
+	{
+		const int error = errno;
+		close(fd);
+		return std::unexpected(std::format("Could not map packet ring: {}", std::strerror(error)));
+	}
+
+	auto* header = new (mapping) Header{};
+	header->capacity = mappingSize - headerSize;
+	header->version = layoutVersion;
+	header->magic = magicValue;
+
+	return SharedPacketRing(fd, mapping, mappingSize);
+}
+
+std::expected<SharedPacketRing, std::string> SharedPacketRing::attach(int fd)
+{
+	struct stat info{};
+	if (fstat(fd, &info) != 0)
+	{
+		return std::unexpected(std::format("Packet ring fd {} is not open: {}", fd, std::strerror(errno)));
+	}
+
+	const auto mappingSize = static_cast<std::size_t>(info.st_size);
+	const std::size_t headerSize = roundToPages(sizeof(Header));
+	if (mappingSize <= headerSize)
+	{
+		return std::unexpected(std::format("Packet ring fd {} is too small", fd));
+	}
+
+	void* mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mapping == MAP_FAILED)
+	{
+		return std::unexpected(std::format("Could not map packet ring: {}", std::strerror(errno)));
+	}
+
+	const auto* header = static_cast<const Header*>(mapping);
+	if (header->magic != magicValue || header->version != layoutVersion || header->capacity != mappingSize - headerSize)
+	{
+		munmap(mapping, mappingSize);
+		return std::unexpected("Packet ring layout doesn't match - host and engine are from different builds");
+	}
+
+	return SharedPacketRing(fd, mapping, mappingSize);
+}
+
+SharedPacketRing::SharedPacketRing(int fd, void* mapping, std::size_t mappingSize)
+	: m_fd(fd)
+	, m_mapping(mapping)
+	, m_mappingSize(mappingSize)
+	, m_header(static_cast<Header*>(mapping))
+{
+	const std::size_t headerSize = roundToPages(sizeof(Header));
+	m_data = static_cast<std::byte*>(mapping) + headerSize;
+	m_capacity = mappingSize - headerSize;
+}
+
+SharedPacketRing::SharedPacketRing(SharedPacketRing&& other) noexcept
+	: m_fd(std::exchange(other.m_fd, -1))
+	, m_mapping(std::exchange(other.m_mapping, nullptr))
+	, m_mappingSize(std::exchange(other.m_mappingSize, 0))
+	, m_header(std::exchange(other.m_header, nullptr))
+	, m_data(std::exchange(other.m_data, nullptr))
+	, m_capacity(std::exchange(other.m_capacity, 0))
+	, m_isCorrupted(other.m_isCorrupted)
+{
+}
+
+SharedPacketRing& SharedPacketRing::operator=(SharedPacketRing&& other) noexcept
+{
+	if (this != &other)
+	{
+		std::swap(m_fd, other.m_fd);
+		std::swap(m_mapping, other.m_mapping);
+		std::swap(m_mappingSize, other.m_mappingSize);
+		std::swap(m_header, other.m_header);
+		std::swap(m_data, other.m_data);
+		std::swap(m_capacity, other.m_capacity);
+		std::swap(m_isCorrupted, other.m_isCorrupted);
+	}
+
+	return *this;
+}
+
+SharedPacketRing::~SharedPacketRing()
+{
+	if (m_mapping)
+	{
+		munmap(m_mapping, m_mappingSize);
+	}
+
+	if (m_fd >= 0)
+	{
+		close(m_fd);
+	}
+}
+
+bool SharedPacketRing::write(RingRecord::Kind kind, std::uint64_t typeHash, std::int64_t timestampNs,
+	std::span<const std::byte> payload, std::chrono::milliseconds timeout)
+{
+	const std::uint64_t recordBytes = alignRecord(sizeof(RecordHeader) + payload.size());
+
+	// Anything over half the ring could wait forever for a gap at the right offset
+	if (recordBytes > m_capacity / 2)
+	{
+		return false;
+	}
+
+	std::uint64_t       head = m_header->head.load(std::memory_order_relaxed);
+	const std::uint64_t untilEnd = m_capacity - head % m_capacity;
+	const bool          isWrapping = untilEnd < recordBytes;
+	const std::uint64_t needed = recordBytes + (isWrapping ? untilEnd : 0);
+
+	const auto hasRoom = [&]
+	{
+		return m_capacity - (head - m_header->tail.load(std::memory_order_acquire)) >= needed;
+	};
+
+	if (!waitUntil(m_header->spaceSignal, m_header->isProducerWaiting, std::chrono::steady_clock::now() + timeout, hasRoom))
+	{
+		return false;
+	}
+
+	if (isWrapping)
+	{
+		if (untilEnd >= sizeof(RecordHeader))
+		{
+			const RecordHeader marker{ .size = 0, .kind = wrapMarker, .typeHash = 0, .timestampNs = 0 };
+			std::memcpy(m_data + head % m_capacity, &marker, sizeof(marker));
+		}
+
+		head += untilEnd;
+	}
+
+	const RecordHeader record{
+		.size = static_cast<std::uint32_t>(payload.size()),
+		.kind = static_cast<std::uint32_t>(kind),
+		.typeHash = typeHash,
+		.timestampNs = timestampNs
+	};
+
+	std::byte* destination = m_data + head % m_capacity;
+	std::memcpy(destination, &record, sizeof(record));
+	if (!payload.empty())
+	{
+		std::memcpy(destination + sizeof(record), payload.data(), payload.size());
+	}
+
+	m_header->head.store(head + recordBytes, std::memory_order_release);
+	signalIfWaiting(m_header->dataSignal, m_header->isConsumerWaiting);
+
+	return true;
+}
+
+bool SharedPacketRing::waitForRoom(std::size_t payloadSize, std::chrono::milliseconds timeout)
+{
+	const std::uint64_t recordBytes = alignRecord(sizeof(RecordHeader) + payloadSize);
+	if (recordBytes > m_capacity / 2)
+	{
+		return false;
+	}
+
+	return waitUntil(m_header->spaceSignal, m_header->isProducerWaiting, std::chrono::steady_clock::now() + timeout, [&]
+	{
+		// The same test as write(), against wherever the head is now
+		const std::uint64_t head = m_header->head.load(std::memory_order_acquire);
+		const std::uint64_t untilEnd = m_capacity - head % m_capacity;
+		const std::uint64_t needed = recordBytes + (untilEnd < recordBytes ? untilEnd : 0);
+
+		return m_capacity - (head - m_header->tail.load(std::memory_order_acquire)) >= needed;
+	});
+}
+
+std::uint64_t SharedPacketRing::getReadBytes() const
+{
+	return m_header->tail.load(std::memory_order_acquire);
+}
+
+bool SharedPacketRing::waitForData(std::chrono::milliseconds timeout)
+{
+	const std::uint32_t wakeCount = m_header->dataSignal.load(std::memory_order_acquire);
+
+	return waitUntil(m_header->dataSignal, m_header->isConsumerWaiting, std::chrono::steady_clock::now() + timeout, [&]
+	{
+		return m_header->head.load(std::memory_order_acquire) != m_header->tail.load(std::memory_order_relaxed)
+			|| m_header->dataSignal.load(std::memory_order_acquire) != wakeCount;
+	});
+}
+
+void SharedPacketRing::wakeConsumer()
+{
+	m_header->dataSignal.fetch_add(1, std::memory_order_release);
+	futexWakeAll(m_header->dataSignal);
+}
+
+void SharedPacketRing::notifyProducer()
+{
+	signalIfWaiting(m_header->spaceSignal, m_header->isProducerWaiting);
+}
@@ -0,0 +1,30 @@
+#include "Plugin/PluginActivation.h"
+
+const char* toString(PluginActivationPolicy policy)
+{
+	switch (policy)
+	{
+		case PluginActivationPolicy::Eager:         return "eager";
+		case PluginActivationPolicy::OnFirstPacket: return "firstPacket";
+		case PluginActivationPolicy::OnFirstUIOpen: return "firstUIOpen";
+		case PluginActivationPolicy::Scheduled:     return "scheduled";
+	}
+
+	return "unknown";
+}
+
+std::optional<PluginActivationPolicy> parseActivationPolicy(std::string_view policy)
+{
+	for (const auto candidate : {PluginActivationPolicy::Eager,
+	                             PluginActivationPolicy::OnFirstPacket,
+	                             PluginActivationPolicy::OnFirstUIOpen,
+	                             PluginActivationPolicy::Scheduled})
+	{
+		if (policy == toString(candidate))
+		{
+			return candidate;
+		}
+	}
+
+	return std::nullopt;
+}
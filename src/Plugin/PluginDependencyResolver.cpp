@@ -0,0 +1,227 @@
+#include "Plugin/PluginDependencyResolver.h"
+
+#include <algorithm>
+#include <format>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+	// A plugin of the batch has to be set up before the one that needs its service
+	struct Dependency
+	{
+		std::size_t        provider = 0;
+		const std::string* serviceName = nullptr;
+	};
+
+	struct Provider
+	{
+		std::size_t     plugin = 0;
+		SemanticVersion version;
+	};
+}
+
+PluginDependencyResolver::PluginDependencyResolver(ServiceLookup findRegisteredService)
+	: m_findRegisteredService(std::move(findRegisteredService))
+{
+}
+
+std::size_t PluginDependencyResolver::addPlugin(std::string name, std::shared_ptr<const CachedPluginDescriptor> descriptor)
+{
+	m_plugins.push_back(Plugin{.name = std::move(name), .descriptor = std::move(descriptor)});
+	return m_plugins.size() - 1;
+}
+
+PluginLoadPlan PluginDependencyResolver::resolve() const
+{
+	const std::size_t pluginCount = m_plugins.size();
+
+	std::vector<std::optional<BlockedPlugin>> blocked(pluginCount);
+	const auto block = [&](std::size_t index, std::string reason, bool isDeferred)
+	{
+		blocked[index] = BlockedPlugin{.index = index, .reason = std::move(reason), .isDeferred = isDeferred};
+	};
+
+	// What the batch provides, by typeid name
+	std::unordered_map<std::string_view, std::vector<Provider>> providers;
+	for (std::size_t i = 0; i < pluginCount; ++i)
+	{
+		if (!m_plugins[i].descriptor)
+		{
+			continue;
+		}
+
+		for (const auto& provided : m_plugins[i].descriptor->provides)
+		{
+			const auto version = SemanticVersion::parse(provided.version);
+			if (!version)
+			{
+				block(i, std::format("Provides service '{}' at an invalid version: {}", provided.name, version.error()), false);
+				break;
+			}
+
+			providers[provided.typeName].push_back(Provider{.plugin = i, .version = *version});
+		}
+	}
+
+	std::vector<std::vector<Dependency>> required(pluginCount);
+	std::vector<std::vector<Dependency>> optional(pluginCount);
+
+	for (std::size_t i = 0; i < pluginCount; ++i)
+	{
+		if (!m_plugins[i].descriptor || blocked[i])
+		{
+			continue;
+		}
+
+		for (const auto& service : m_plugins[i].descriptor->services)
+		{
+			const auto range = VersionRange::parse(service.minVersion);
+			if (!range)
+			{
+				if (service.required)
+				{
+					block(i, std::format("Service '{}': {}", service.name, range.error()), false);
+					break;
+				}
+
+				continue;
+			}
+
+			const auto registeredVersion = m_findRegisteredService(service.typeName);
+			if (registeredVersion && range->contains(*registeredVersion))
+			{
+				continue;
+			}
+
+			const auto matching = providers.find(service.typeName);
+			if (matching != providers.end())
+			{
+				const auto provider = std::ranges::find_if(matching->second, [&](const Provider& candidate)
+				{
+					return candidate.plugin != i && range->contains(candidate.version);
+				});
+
+				if (provider != matching->second.end())
+				{
+					(service.required ? required : optional)[i].push_back(Dependency{.provider = provider->plugin, .serviceName = &service.name});
+					continue;
+				}
+			}
+
+			if (!service.required)
+			{
+				continue;
+			}
+
+			// A version that doesn't fit won't change by waiting, but a service nobody has registered yet might turn up
+			if (registeredVersion)
+			{
+				block(i, std::format("Needs service '{}' {}, the engine has {}", service.name, service.minVersion, registeredVersion->toString()), false);
+			}
+			else if (matching != providers.end())
+			{
+				const Provider& provider = matching->second.front();
+				block(i, std::format("Needs service '{}' {}, '{}' provides {}", service.name, service.minVersion, m_plugins[provider.plugin].name, provider.version.toString()), false);
+			}
+			else
+			{
+				block(i, std::format("Waiting for required service '{}'", service.name), true);
+			}
+			break;
+		}
+	}
+
+	// A plugin waits for the providers it requires
+	for (bool isChanged = true; isChanged;)
+	{
+		isChanged = false;
+
+		for (std::size_t i = 0; i < pluginCount; ++i)
+		{
+			if (blocked[i])
+			{
+				continue;
+			}
+
+			const auto blockedProvider = std::ranges::find_if(required[i], [&](const Dependency& dependency) { return blocked[dependency.provider].has_value(); });
+			if (blockedProvider != required[i].end())
+			{
+				block(i, std::format("Waiting for required service '{}' from '{}'", *blockedProvider->serviceName, m_plugins[blockedProvider->provider].name), true);
+				isChanged = true;
+			}
+		}
+	}
+
+	// Stages, in the order the plugins were added. Optional dependencies are dropped if they are all that's left in the way.
+	PluginLoadPlan plan;
+
+	std::vector<std::size_t> remaining;
+	for (std::size_t i = 0; i < pluginCount; ++i)
+	{
+		if (!blocked[i])
+		{
+			remaining.push_back(i);
+		}
+	}
+
+	std::vector<bool> isPlaced(pluginCount, false);
+	bool isOrderingOptional = true;
+
+	while (!remaining.empty())
+	{
+		const auto isReady = [&](std::size_t i)
+		{
+			const auto isWaiting = [&](const Dependency& dependency)
+			{
+				return !blocked[dependency.provider] && !isPlaced[dependency.provider];
+			};
+
+			return std::ranges::none_of(required[i], isWaiting) && (!isOrderingOptional || std::ranges::none_of(optional[i], isWaiting));
+		};
+
+		std::vector<std::size_t> stage;
+		std::ranges::copy_if(remaining, std::back_inserter(stage), isReady);
+
+		if (stage.empty())
+		{
+			if (!std::exchange(isOrderingOptional, false))
+			{
+				break;
+			}
+			continue;
+		}
+
+		for (const std::size_t i : stage)
+		{
+			isPlaced[i] = true;
+		}
+
+		std::erase_if(remaining, [&](std::size_t i) { return isPlaced[i]; });
+		plan.stages.push_back(std::move(stage));
+		isOrderingOptional = true;
+	}
+
+	// Whatever couldn't be placed requires itself through the others
+	std::string cycle;
+	for (const std::size_t i : remaining)
+	{
+		cycle += std::format("{}'{}'", cycle.empty() ? "" : ", ", m_plugins[i].name);
+	}
+
+	for (const std::size_t i : remaining)
+	{
+		block(i, std::format("Required services form a cycle between {}", cycle), false);
+	}
+
+	for (auto& plugin : blocked)
+	{
+		if (plugin)
+		{
+			plan.blocked.push_back(std::move(*plugin));
+		}
+	}
+
+	return plan;
+}
@@ -0,0 +1,468 @@
+#include "Plugin/PluginDescriptorCache.h"
+
+#include <array>
+#include <format>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <utility>
+#include <nlohmann/json.hpp>
+
+#include "Services/Logging/ILogger.h"
+#include "Services/Logging/LogLevel.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <cerrno>
+	#include <cstring>
+	#include <fcntl.h>
+	#include <spawn.h>
+	#include <sys/wait.h>
+	#include <unistd.h>
+
+	extern char** environ;
+#endif
+
+namespace
+{
+	constexpr int cacheFormatVersion = 2; // 1 also cached probes that never ran or were killed
+
+	std::optional<std::uint64_t> hashFileContents(const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			return std::nullopt;
+		}
+
+		std::uint64_t hash = 14695981039346656037ull; // FNV-1a offset basis
+		std::array<char, 64 * 1024> buffer{};
+
+		while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0)
+		{
+			for (std::streamsize i = 0; i < file.gcount(); ++i)
+			{
+				hash ^= static_cast<unsigned char>(buffer[static_cast<std::size_t>(i)]);
+				hash *= 1099511628211ull; // FNV prime
+			}
+		}
+
+		return hash;
+	}
+
+	struct ProcessResult
+	{
+		std::string output;       // what it wrote to stdout
+		int         exitCode = 0;
+		int         signal = 0;   // the one that killed it, or 0
+	};
+
+#ifdef _WIN32
+	/// <summary>
+	/// Quotes an argument so CommandLineToArgvW hands it back unchanged - backslashes only need doubling before a quote
+	/// </summary>
+	std::wstring quoteArgument(const std::wstring& argument)
+	{
+		std::wstring quoted = L"\"";
+		std::size_t  backslashes = 0;
+
+		for (const wchar_t c : argument)
+		{
+			if (c == L'\\')
+			{
+				++backslashes;
+				continue;
+			}
+
+			quoted.append(c == L'"' ? backslashes * 2 + 1 : backslashes, L'\\');
+			quoted += c;
+			backslashes = 0;
+		}
+
+		quoted.append(backslashes * 2, L'\\');
+		quoted += L'"';
+		return quoted;
+	}
+
+	std::expected<ProcessResult, std::string> runProcess(const std::filesystem::path& executable, const std::filesystem::path& argument)
+	{
+		SECURITY_ATTRIBUTES inheritable{ .nLength = sizeof(SECURITY_ATTRIBUTES), .lpSecurityDescriptor = nullptr, .bInheritHandle = TRUE };
+
+		HANDLE readPipe = nullptr;
+		HANDLE writePipe = nullptr;
+		if (!CreatePipe(&readPipe, &writePipe, &inheritable, 0) || !SetHandleInformation(readPipe, HANDLE_FLAG_INHERIT, 0))
+		{
+			return std::unexpected(std::format("Could not create pipe: error {}", GetLastError()));
+		}
+
+		STARTUPINFOW startup{};
+		startup.cb = sizeof(startup);
+		startup.dwFlags = STARTF_USESTDHANDLES;
+		startup.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+		startup.hStdOutput = writePipe;
+		startup.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+		// No shell in between - the command line is only split back into arguments by the probe
+		std::wstring commandLine = std::format(L"{} {}", quoteArgument(executable.wstring()), quoteArgument(argument.wstring()));
+
+		PROCESS_INFORMATION process{};
+		const BOOL isStarted = CreateProcessW(executable.c_str(), commandLine.data(), nullptr, nullptr, TRUE, CREATE_NO_WINDOW,
+			nullptr, nullptr, &startup, &process);
+		const DWORD startError = GetLastError();
+		CloseHandle(writePipe);
+
+		if (!isStarted)
+		{
+			CloseHandle(readPipe);
+			return std::unexpected(std::format("Could not start '{}': error {}", executable.string(), startError));
+		}
+
+		ProcessResult result;
+		std::array<char, 4096> buffer{};
+		DWORD bytesRead = 0;
+		while (ReadFile(readPipe, buffer.data(), static_cast<DWORD>(buffer.size()), &bytesRead, nullptr) && bytesRead > 0)
+		{
+			result.output.append(buffer.data(), bytesRead);
+		}
+		CloseHandle(readPipe);
+
+		WaitForSingleObject(process.hProcess, INFINITE);
+		DWORD exitCode = 0;
+		GetExitCodeProcess(process.hProcess, &exitCode);
+		CloseHandle(process.hThread);
+		CloseHandle(process.hProcess);
+
+		result.exitCode = static_cast<int>(exitCode);
+		return result;
+	}
+#else
+	std::expected<ProcessResult, std::string> runProcess(const std::filesystem::path& executable, const std::filesystem::path& argument)
+	{
+		// Close-on-exec, so probes started concurrently don't inherit each other's pipes and keep them open
+		int pipeFds[2];
+		if (pipe2(pipeFds, O_CLOEXEC) != 0)
+		{
+			return std::unexpected(std::format("Could not create pipe: {}", std::strerror(errno)));
+		}
+
+		posix_spawn_file_actions_t actions;
+		posix_spawn_file_actions_init(&actions);
+		posix_spawn_file_actions_adddup2(&actions, pipeFds[1], STDOUT_FILENO);
+
+		// Passed as they are - no shell parses them
+		const std::string executableString = executable.string();
+		const std::string argumentString = argument.string();
+		std::array<char*, 3> argv{
+			const_cast<char*>(executableString.c_str()),
+			const_cast<char*>(argumentString.c_str()),
+			nullptr
+		};
+
+		pid_t pid = 0;
+		const int spawnError = posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+		posix_spawn_file_actions_destroy(&actions);
+		close(pipeFds[1]);
+
+		if (spawnError != 0)
+		{
+			close(pipeFds[0]);
+			return std::unexpected(std::format("Could not start '{}': {}", executableString, std::strerror(spawnError)));
+		}
+
+		ProcessResult result;
+		std::array<char, 4096> buffer{};
+		for (;;)
+		{
+			const ssize_t bytesRead = read(pipeFds[0], buffer.data(), buffer.size());
+			if (bytesRead > 0)
+			{
+				result.output.append(buffer.data(), static_cast<std::size_t>(bytesRead));
+			}
+			else if (bytesRead == 0 || errno != EINTR)
+			{
+				break;
+			}
+		}
+		close(pipeFds[0]);
+
+		int status = 0;
+		while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+		{
+		}
+
+		result.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+		result.signal = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+		return result;
+	}
+#endif
+}
+
+PluginDescriptorCache::PluginDescriptorCache(ILogger& logger, std::filesystem::path cacheFile, std::filesystem::path probeExecutable)
+	: m_logger(logger)
+	, m_cacheFile(std::move(cacheFile))
+	, m_probeExecutable(std::move(probeExecutable))
+{
+}
+
+bool PluginDescriptorCache::load()
+{
+	std::ifstream file(m_cacheFile);
+	if (!file)
+	{
+		return false;
+	}
+
+	try
+	{
+		nlohmann::json json;
+		file >> json;
+
+		if (json.value("version", 0) != cacheFormatVersion)
+		{
+			log(LogLevel::Info, "Descriptor cache is from another version, starting afresh");
+			return false;
+		}
+
+		std::lock_guard lock(m_mutex);
+		m_entries.clear();
+
+		for (const auto& [path, cached] : json.at("plugins").items())
+		{
+			Entry entry{
+				.fingerprint = PluginFileFingerprint{
+					.size = cached.at("size").get<std::uintmax_t>(),
+					.modifiedTime = cached.at("modified").get<std::int64_t>(),
+					.contentHash = cached.at("hash").get<std::uint64_t>()
+				},
+				.descriptor = nullptr,
+				.error = cached.value("error", "")
+			};
+
+			if (cached.contains("descriptor"))
+			{
+				auto descriptor = CachedPluginDescriptor::fromJson(cached["descriptor"].dump());
+				if (!descriptor)
+				{
+					continue; // probed again on the next lookup
+				}
+
+				entry.descriptor = std::make_shared<const CachedPluginDescriptor>(std::move(*descriptor));
+			}
+
+			m_entries.emplace(path, std::move(entry));
+		}
+
+		log(LogLevel::Info, std::format("Loaded {} cached plugin descriptor(s)", m_entries.size()));
+		return true;
+	}
+	catch (const nlohmann::json::exception& ex)
+	{
+		log(LogLevel::Warning, std::format("Ignoring unreadable descriptor cache '{}': {}", m_cacheFile.string(), ex.what()));
+		return false;
+	}
+}
+
+bool PluginDescriptorCache::save()
+{
+	nlohmann::json plugins = nlohmann::json::object();
+
+	{
+		std::lock_guard lock(m_mutex);
+		if (!m_isDirty)
+		{
+			return true;
+		}
+
+		for (const auto& [path, entry] : m_entries)
+		{
+			nlohmann::json cached =
+			{
+				{"size", entry.fingerprint.size},
+				{"modified", entry.fingerprint.modifiedTime},
+				{"hash", entry.fingerprint.contentHash}
+			};
+
+			if (entry.descriptor)
+			{
+				cached["descriptor"] = nlohmann::json::parse(entry.descriptor->toJson());
+			}
+			else
+			{
+				cached["error"] = entry.error;
+			}
+
+			plugins[path] = std::move(cached);
+		}
+
+		m_isDirty = false;
+	}
+
+	std::ofstream file(m_cacheFile);
+	if (!file)
+	{
+		log(LogLevel::Error, std::format("Could not write descriptor cache '{}'", m_cacheFile.string()));
+		return false;
+	}
+
+	file << std::setw(4) << nlohmann::json{{"version", cacheFormatVersion}, {"plugins", plugins}} << "\n";
+	return true;
+}
+
+std::expected<std::shared_ptr<const CachedPluginDescriptor>, std::string> PluginDescriptorCache::getDescriptor(const std::filesystem::path& pluginPath)
+{
+	std::error_code ec;
+	const auto absolutePath = std::filesystem::absolute(pluginPath, ec);
+	const std::string key = (ec ? pluginPath : absolutePath).lexically_normal().string();
+
+	const auto size = std::filesystem::file_size(pluginPath, ec);
+	if (ec)
+	{
+		return std::unexpected(ec.message());
+	}
+
+	const auto modifiedTime = std::filesystem::last_write_time(pluginPath, ec);
+	if (ec)
+	{
+		return std::unexpected(ec.message());
+	}
+
+	PluginFileFingerprint fingerprint{
+		.size = size,
+		.modifiedTime = static_cast<std::int64_t>(modifiedTime.time_since_epoch().count()),
+		.contentHash = 0
+	};
+
+	const auto toResult = [](const Entry& entry) -> std::expected<std::shared_ptr<const CachedPluginDescriptor>, std::string>
+	{
+		if (entry.descriptor)
+		{
+			return entry.descriptor;
+		}
+
+		return std::unexpected(entry.error);
+	};
+
+	// Unchanged since last time - the common case on every scan
+	{
+		std::lock_guard lock(m_mutex);
+		const auto it = m_entries.find(key);
+		if (it != m_entries.end() && it->second.fingerprint.size == fingerprint.size && it->second.fingerprint.modifiedTime == fingerprint.modifiedTime)
+		{
+			return toResult(it->second);
+		}
+	}
+
+	const auto contentHash = hashFileContents(pluginPath);
+	if (!contentHash)
+	{
+		return std::unexpected(std::format("Could not read '{}'", pluginPath.string()));
+	}
+
+	fingerprint.contentHash = *contentHash;
+
+	// Touched but identical (eg. a no-op rebuild)
+	{
+		std::lock_guard lock(m_mutex);
+		const auto it = m_entries.find(key);
+		if (it != m_entries.end() && it->second.fingerprint.size == fingerprint.size && it->second.fingerprint.contentHash == fingerprint.contentHash)
+		{
+			it->second.fingerprint.modifiedTime = fingerprint.modifiedTime;
+			m_isDirty = true;
+			return toResult(it->second);
+		}
+	}
+
+	// The probe runs without the lock held, a concurrent lookup of the same file just probes it twice
+	auto probed = runProbe(pluginPath);
+
+	if (!probed && !probed.error().isReportedByProbe)
+	{
+		// Nothing learnt about this build of the plugin - the probe is missing, or was killed before it could tell
+		log(LogLevel::Warning, std::format("Could not probe '{}': {}", pluginPath.string(), probed.error().message));
+		return std::unexpected(probed.error().message);
+	}
+
+	Entry entry{
+		.fingerprint = fingerprint,
+		.descriptor = probed ? std::make_shared<const CachedPluginDescriptor>(std::move(*probed)) : nullptr,
+		.error = probed ? "" : probed.error().message
+	};
+
+	if (!probed)
+	{
+		log(LogLevel::Warning, std::format("Could not read descriptor of '{}': {}", pluginPath.string(), entry.error));
+	}
+
+	auto result = toResult(entry);
+
+	std::lock_guard lock(m_mutex);
+	m_entries.insert_or_assign(key, std::move(entry));
+	m_isDirty = true;
+
+	return result;
+}
+
+void PluginDescriptorCache::forget(const std::filesystem::path& pluginPath)
+{
+	std::error_code ec;
+	const auto absolutePath = std::filesystem::absolute(pluginPath, ec);
+
+	std::lock_guard lock(m_mutex);
+	if (m_entries.erase((ec ? pluginPath : absolutePath).lexically_normal().string()) > 0)
+	{
+		m_isDirty = true;
+	}
+}
+
+std::expected<CachedPluginDescriptor, PluginDescriptorCache::ProbeError> PluginDescriptorCache::runProbe(const std::filesystem::path& pluginPath) const
+{
+	if (!std::filesystem::exists(m_probeExecutable))
+	{
+		return std::unexpected(ProbeError{ .message = std::format("Descriptor probe not found at '{}'", m_probeExecutable.string()) });
+	}
+
+	const auto process = runProcess(m_probeExecutable, pluginPath);
+	if (!process)
+	{
+		return std::unexpected(ProbeError{ .message = std::format("Could not start descriptor probe for '{}': {}", pluginPath.string(), process.error()) });
+	}
+
+	// Which is how its time limit ends it too (SIGXCPU, SIGALRM, SIGKILL), so this says nothing lasting about the plugin
+	if (process->signal != 0)
+	{
+		return std::unexpected(ProbeError{ .message = std::format("Descriptor probe was killed by signal {}", process->signal) });
+	}
+
+	if (process->output.empty())
+	{
+		return std::unexpected(ProbeError{ .message = std::format("Descriptor probe exited with status {} and no output", process->exitCode) });
+	}
+
+	// The probe reports failures as {"error": "..."} on the same channel
+	try
+	{
+		const auto json = nlohmann::json::parse(process->output);
+		if (json.contains("error"))
+		{
+			return std::unexpected(ProbeError{ .message = json["error"].get<std::string>(), .isReportedByProbe = true });
+		}
+	}
+	catch (const nlohmann::json::exception& ex)
+	{
+		return std::unexpected(ProbeError{ .message = std::format("Unreadable descriptor probe output: {}", ex.what()) });
+	}
+
+	auto descriptor = CachedPluginDescriptor::fromJson(process->output);
+	if (!descriptor)
+	{
+		return std::unexpected(ProbeError{ .message = std::move(descriptor.error()) });
+	}
+
+	return std::move(*descriptor);
+}
+
+void PluginDescriptorCache::log(LogLevel level, const std::string& message) const
+{
+	m_logger.log(level, std::format("[{}] - {}", "PluginDescriptorCache", message));
+}
@@ -0,0 +1,343 @@
+#include "Plugin/PluginFolderWatcher.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <format>
+#include <map>
+#include <mutex>
+#include <ranges>
+#include <utility>
+
+#include "Services/Logging/ILogger.h"
+#include "Services/Logging/LogLevel.h"
+
+#ifdef __linux__
+	#include <cerrno>
+	#include <cstdint>
+	#include <cstring>
+	#include <poll.h>
+	#include <sys/eventfd.h>
+	#include <sys/inotify.h>
+	#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef __linux__
+	class ScopedFd
+	{
+	public:
+		explicit ScopedFd(int fd) : m_fd(fd) {}
+
+		~ScopedFd()
+		{
+			if (m_fd >= 0)
+			{
+				close(m_fd);
+			}
+		}
+
+		ScopedFd(const ScopedFd&) = delete;
+		ScopedFd& operator=(const ScopedFd&) = delete;
+
+		[[nodiscard]] int get() const { return m_fd; }
+
+	private:
+		int m_fd;
+	};
+#endif
+}
+
+PluginFolderWatcher::PluginFolderWatcher(ILogger& logger,
+	std::filesystem::path directory,
+	std::string extension,
+	std::chrono::milliseconds debounce,
+	std::chrono::milliseconds pollInterval,
+	ChangeCallback onChanges,
+	ThreadPlacement placement)
+	: m_logger(logger)
+	, m_directory(std::move(directory))
+	, m_extension(std::move(extension))
+	, m_debounce(debounce)
+	, m_pollInterval(pollInterval)
+	, m_onChanges(std::move(onChanges))
+	, m_placement(std::move(placement))
+{
+	m_thread = std::jthread([this](const std::stop_token& stopToken)
+	{
+		run(stopToken);
+	});
+}
+
+const std::filesystem::path& PluginFolderWatcher::getDirectory() const
+{
+	return m_directory;
+}
+
+void PluginFolderWatcher::run(const std::stop_token& stopToken)
+{
+	if (const auto placed = placeCurrentThread(m_placement); !placed)
+	{
+		log(LogLevel::Warning, std::format("Could not place the folder watcher thread: {}", placed.error()));
+	}
+
+	if (!watchWithInotify(stopToken) && !stopToken.stop_requested())
+	{
+		watchByPolling(stopToken);
+	}
+}
+
+bool PluginFolderWatcher::watchWithInotify(const std::stop_token& stopToken)
+{
+#ifdef __linux__
+	const ScopedFd inotifyFd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC));
+	const ScopedFd wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+	if (inotifyFd.get() < 0 || wakeFd.get() < 0)
+	{
+		log(LogLevel::Warning, std::format("Could not set up inotify: {}", std::strerror(errno)));
+		return false;
+	}
+
+	constexpr std::uint32_t watchMask = IN_CREATE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM
+		| IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+	if (inotify_add_watch(inotifyFd.get(), m_directory.c_str(), watchMask) < 0)
+	{
+		log(LogLevel::Warning, std::format("Could not watch '{}': {}", m_directory.string(), std::strerror(errno)));
+		return false;
+	}
+
+	const std::stop_callback wakeOnStop(stopToken, [&wakeFd]
+	{
+		const std::uint64_t one = 1;
+		[[maybe_unused]] const auto written = write(wakeFd.get(), &one, sizeof(one));
+	});
+
+	log(LogLevel::Info, std::format("Watching '{}' for plugin changes", m_directory.string()));
+
+	// Watching starts before the listing, so a file written in between is reported rather than missed
+	report(listPluginFiles());
+
+	// Last event per file - it's reported once it has been quiet for m_debounce
+	std::map<std::filesystem::path, std::chrono::steady_clock::time_point> pending;
+	alignas(inotify_event) char buffer[16 * 1024];
+
+	while (!stopToken.stop_requested())
+	{
+		int timeoutMs = -1;
+		if (!pending.empty())
+		{
+			const auto firstDue = std::ranges::min(pending | std::views::values) + m_debounce;
+			const auto untilDue = std::chrono::ceil<std::chrono::milliseconds>(firstDue - std::chrono::steady_clock::now());
+			timeoutMs = static_cast<int>(std::max<std::chrono::milliseconds::rep>(untilDue.count(), 0));
+		}
+
+		pollfd fds[] = {
+			{ .fd = inotifyFd.get(), .events = POLLIN, .revents = 0 },
+			{ .fd = wakeFd.get(), .events = POLLIN, .revents = 0 }
+		};
+
+		if (poll(fds, 2, timeoutMs) < 0 && errno != EINTR)
+		{
+			log(LogLevel::Warning, std::format("Waiting for inotify events failed: {}", std::strerror(errno)));
+			return false;
+		}
+
+		if (stopToken.stop_requested())
+		{
+			break;
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+
+		ssize_t length = 0;
+		while ((fds[0].revents & POLLIN) && (length = read(inotifyFd.get(), buffer, sizeof(buffer))) > 0)
+		{
+			for (const char* cursor = buffer; cursor < buffer + length;)
+			{
+				const auto* event = reinterpret_cast<const inotify_event*>(cursor);
+				cursor += sizeof(inotify_event) + event->len;
+
+				if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+				{
+					log(LogLevel::Warning, std::format("'{}' was moved or deleted, falling back to polling", m_directory.string()));
+					return false;
+				}
+
+				if (event->mask & IN_Q_OVERFLOW)
+				{
+					// Events were dropped, so recheck everything that is there now
+					log(LogLevel::Warning, "inotify queue overflowed, rescanning plugin folder");
+					for (const auto& path : listPluginFiles())
+					{
+						pending[path] = now;
+					}
+					continue;
+				}
+
+				if (event->len == 0)
+				{
+					continue;
+				}
+
+				std::filesystem::path path = m_directory / event->name;
+				if (isPluginFile(path))
+				{
+					pending[std::move(path)] = now;
+				}
+			}
+		}
+
+		std::vector<std::filesystem::path> settled;
+		for (auto it = pending.begin(); it != pending.end();)
+		{
+			if (now - it->second >= m_debounce)
+			{
+				settled.push_back(it->first);
+				it = pending.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		report(settled);
+	}
+
+	return true;
+#else
+	(void)stopToken;
+	return false;
+#endif
+}
+
+void PluginFolderWatcher::watchByPolling(const std::stop_token& stopToken)
+{
+	using FileState = std::pair<std::uintmax_t, std::filesystem::file_time_type>;
+	using Snapshot = std::map<std::filesystem::path, FileState>;
+
+	const auto takeSnapshot = [this]
+	{
+		Snapshot snapshot;
+		for (const auto& path : listPluginFiles())
+		{
+			std::error_code ec;
+			const auto size = std::filesystem::file_size(path, ec);
+			const auto modified = std::filesystem::last_write_time(path, ec);
+			snapshot.emplace(path, FileState{size, modified});
+		}
+
+		return snapshot;
+	};
+
+	log(LogLevel::Info, std::format("Polling '{}' for plugin changes every {}ms", m_directory.string(), m_pollInterval.count()));
+
+	Snapshot reported = takeSnapshot();
+	Snapshot previous = reported;
+	std::vector<std::filesystem::path> existing;
+	for (const auto& path : reported | std::views::keys)
+	{
+		existing.push_back(path);
+	}
+	report(existing);
+
+	std::mutex                  waitMutex;
+	std::condition_variable_any waitForStop;
+
+	while (true)
+	{
+		{
+			std::unique_lock lock(waitMutex);
+			waitForStop.wait_for(lock, stopToken, m_pollInterval, [] { return false; });
+		}
+
+		if (stopToken.stop_requested())
+		{
+			return;
+		}
+
+		const Snapshot current = takeSnapshot();
+		std::vector<std::filesystem::path> changes;
+
+		// The poll interval is the debounce here - a file is reported once it looks the same on two polls in a row
+		for (const auto& [path, state] : current)
+		{
+			const auto known = reported.find(path);
+			const auto last = previous.find(path);
+			const bool isSettled = last != previous.end() && last->second == state;
+
+			if (isSettled && (known == reported.end() || known->second != state))
+			{
+				reported[path] = state;
+				changes.push_back(path);
+			}
+		}
+
+		for (auto it = reported.begin(); it != reported.end();)
+		{
+			if (!current.contains(it->first))
+			{
+				changes.push_back(it->first);
+				it = reported.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		previous = current;
+		report(changes);
+	}
+}
+
+bool PluginFolderWatcher::isPluginFile(const std::filesystem::path& path) const
+{
+	return path.extension() == m_extension;
+}
+
+std::vector<std::filesystem::path> PluginFolderWatcher::listPluginFiles() const
+{
+	std::vector<std::filesystem::path> files;
+
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::directory_iterator(m_directory, ec))
+	{
+		if (entry.is_regular_file(ec) && isPluginFile(entry.path()))
+		{
+			files.push_back(entry.path());
+		}
+	}
+
+	return files;
+}
+
+void PluginFolderWatcher::report(const std::vector<std::filesystem::path>& paths) const
+{
+	if (paths.empty())
+	{
+		return;
+	}
+
+	std::vector<PluginFolderChange> changes;
+	changes.reserve(paths.size());
+
+	for (const auto& path : paths)
+	{
+		std::error_code ec;
+		const bool exists = std::filesystem::is_regular_file(path, ec);
+
+		changes.push_back(PluginFolderChange{
+			.kind = exists ? PluginFolderChange::Kind::Changed : PluginFolderChange::Kind::Removed,
+			.path = path
+		});
+	}
+
+	m_onChanges(std::move(changes));
+}
+
+void PluginFolderWatcher::log(LogLevel level, const std::string& msg) const
+{
+	m_logger.log(level, std::format("[{}] - {}", "PluginFolderWatcher", msg));
+}
@@ -0,0 +1,68 @@
+#include "Plugin/PluginLoadReport.h"
+
+#include <algorithm>
+#include <format>
+
+namespace
+{
+	double toMilliseconds(std::chrono::microseconds duration)
+	{
+		return static_cast<double>(duration.count()) / 1000.0;
+	}
+}
+
+const char* toString(PluginLoadStatus status)
+{
+	switch (status)
+	{
+		case PluginLoadStatus::Loaded:        return "loaded";
+		case PluginLoadStatus::AlreadyLoaded: return "already loaded";
+		case PluginLoadStatus::Dormant:       return "dormant";
+		case PluginLoadStatus::Deferred:      return "deferred";
+		case PluginLoadStatus::Failed:        return "failed";
+	}
+
+	return "unknown";
+}
+
+std::chrono::microseconds PluginLoadReport::getSerialTime() const
+{
+	std::chrono::microseconds total{0};
+
+	for (const auto& plugin : plugins)
+	{
+		total += plugin.getTotalTime();
+	}
+
+	return total;
+}
+
+std::string PluginLoadReport::format() const
+{
+	const auto serialTime = getSerialTime();
+	const double speedup = wallTime.count() > 0
+		? static_cast<double>(serialTime.count()) / static_cast<double>(wallTime.count())
+		: 1.0;
+
+	std::string report = std::format("{} plugin(s) took {:.2f}ms on {} thread(s) - {:.2f}ms serial, {:.1f}x\n",
+		plugins.size(), toMilliseconds(wallTime), threadCount, toMilliseconds(serialTime), speedup);
+
+	report += std::format("{:<24} {:<15} {:>10} {:>10} {:>10}  {}\n", "Plugin", "Status", "Open ms", "Setup ms", "Total ms", "Error");
+
+	// Slowest first, that's what needs looking at
+	auto sorted = plugins;
+	std::ranges::sort(sorted, std::greater{}, &PluginLoadTiming::getTotalTime);
+
+	for (const auto& plugin : sorted)
+	{
+		report += std::format("{:<24} {:<15} {:>10.2f} {:>10.2f} {:>10.2f}  {}\n",
+			plugin.name,
+			toString(plugin.status),
+			toMilliseconds(plugin.openTime),
+			toMilliseconds(plugin.setupTime),
+			toMilliseconds(plugin.getTotalTime()),
+			plugin.error);
+	}
+
+	return report;
+}
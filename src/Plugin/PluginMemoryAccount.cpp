@@ -0,0 +1,94 @@
+#include "Plugin/PluginMemoryAccount.h"
+
+#include <new>
+#include <utility>
+
+PluginMemoryAccount::PluginMemoryAccount(std::string pluginName, PluginMemoryBudget budget, std::pmr::memory_resource* upstream)
+	: m_pluginName(std::move(pluginName))
+	, m_budget(budget)
+	, m_upstream(upstream)
+{
+}
+
+const std::string& PluginMemoryAccount::getPluginName() const
+{
+	return m_pluginName;
+}
+
+PluginMemoryBudget PluginMemoryAccount::getBudget() const
+{
+	return m_budget;
+}
+
+PluginMemoryStats PluginMemoryAccount::getStats() const
+{
+	return PluginMemoryStats{
+		.currentBytes = m_currentBytes.load(std::memory_order_relaxed),
+		.peakBytes = m_peakBytes.load(std::memory_order_relaxed),
+		.allocations = m_allocations.load(std::memory_order_relaxed),
+		.rejectedAllocations = m_rejectedAllocations.load(std::memory_order_relaxed)
+	};
+}
+
+bool PluginMemoryAccount::isOverWarning() const
+{
+	return m_budget.warnBytes != 0 && m_currentBytes.load(std::memory_order_relaxed) > m_budget.warnBytes;
+}
+
+std::uint64_t PluginMemoryAccount::takeNewRejections()
+{
+	const std::uint64_t rejected = m_rejectedAllocations.load(std::memory_order_relaxed);
+	return rejected - std::exchange(m_reportedRejections, rejected);
+}
+
+bool PluginMemoryAccount::setWarningReported(const bool isReported)
+{
+	return std::exchange(m_isWarningReported, isReported) != isReported;
+}
+
+void* PluginMemoryAccount::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	// Charged before allocating, so threads racing for the last of the budget can't both get it
+	const std::size_t previous = m_currentBytes.fetch_add(bytes, std::memory_order_relaxed);
+	const std::size_t current = previous + bytes;
+
+	if (m_budget.limitBytes != 0 && current > m_budget.limitBytes)
+	{
+		m_currentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+		m_rejectedAllocations.fetch_add(1, std::memory_order_relaxed);
+		throw std::bad_alloc();
+	}
+
+	void* pointer = nullptr;
+	try
+	{
+		pointer = m_upstream->allocate(bytes, alignment);
+	}
+	catch (...)
+	{
+		m_currentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+		throw;
+	}
+
+	m_allocations.fetch_add(1, std::memory_order_relaxed);
+
+	std::size_t peak = m_peakBytes.load(std::memory_order_relaxed);
+	while (current > peak && !m_peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+	{
+	}
+
+	return pointer;
+}
+
+void PluginMemoryAccount::do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment)
+{
+	m_upstream->deallocate(pointer, bytes, alignment);
+
+	m_currentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+	m_allocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool PluginMemoryAccount::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	return this == &other;
+}
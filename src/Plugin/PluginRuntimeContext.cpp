@@ -1,13 +1,38 @@
 #include "Plugin/PluginRuntimeContext.h"
 
+#include <algorithm>
 #include <cassert>
 #include <format>
 #include <utility>
 #include "Services/Logging/ILogger.h"
 #include "Services/Logging/SpdLogger.h"
 #include "DataPacket/DataPacketRegistry.h"
+#include "EngineEventBus.h"
+#include "Plugin/PluginMemoryAccount.h"
 #include "Services/REST/IPluginRESTService.h"
 
+namespace
+{
+	std::size_t getServiceSlotIndex(const std::type_index typeIdx)
+	{
+		if (typeIdx == typeid(ILogger))
+		{
+			return serviceSlotIndex<ILogger>;
+		}
+
+		if (typeIdx == typeid(IPluginRESTService))
+		{
+			return serviceSlotIndex<IPluginRESTService>;
+		}
+
+		if (typeIdx == typeid(IPluginUIService))
+		{
+			return serviceSlotIndex<IPluginUIService>;
+		}
+
+		return dynamicServiceSlot;
+	}
+}
 
 
 PluginRuntimeContext::PluginRuntimeContext(
@@ -20,19 +45,75 @@ m_dataPacketRegistry(registry)
 , m_pluginName(std::move(pluginName))
 , m_services(services)
 {
+	for (std::size_t slotIndex = 0; slotIndex < fixedServiceSlotCount; ++slotIndex)
+	{
+		m_fixedServiceSlots[slotIndex] = &m_serviceSlots.getFixedSlot(slotIndex);
+	}
+
+	// Subscribed first, so a change made while populating isn't missed
+	m_serviceSubscription = m_services.subscribe([this](const std::type_index typeIdx, const std::shared_ptr<void>& service, std::uint64_t)
+	{
+		onServiceChanged(typeIdx, service);
+	});
+
 	populateServices();
 }
 
-void PluginRuntimeContext::registerServiceByType(std::type_index typeIdx, std::shared_ptr<void> service)
+PluginRuntimeContext::~PluginRuntimeContext()
 {
-	std::unique_lock lk(m_mutex);
-	m_localServices[typeIdx] = std::move(service);
+	withdrawProvidedServices();
+	m_services.unsubscribe(m_serviceSubscription);
+
+	if (m_engineEventBus)
+	{
+		m_engineEventBus->unsubscribe(m_engineEvents);
+	}
 }
 
-void PluginRuntimeContext::unregisterServiceByType(std::type_index typeIdx)
+void PluginRuntimeContext::registerServiceByType(std::type_index typeIdx, std::size_t slotIndex, std::shared_ptr<void> service)
 {
-	std::unique_lock lock(m_mutex);
+	std::lock_guard lock(m_serviceMutex);
+
+	m_localServices.insert(typeIdx);
+	m_serviceSlots.store(typeIdx, slotIndex, std::move(service));
+}
+
+void PluginRuntimeContext::unregisterServiceByType(std::type_index typeIdx, std::size_t slotIndex)
+{
+	std::lock_guard lock(m_serviceMutex);
+
+	// Back to following the engine's, if it has one
 	m_localServices.erase(typeIdx);
+	m_serviceSlots.store(typeIdx, slotIndex, m_services.getServiceByType(typeIdx));
+}
+
+void PluginRuntimeContext::onServiceChanged(const std::type_index typeIdx, const std::shared_ptr<void>& service)
+{
+	std::lock_guard lock(m_serviceMutex);
+
+	if (m_localServices.contains(typeIdx))
+	{
+		return;
+	}
+
+	// A type the plugin never asked for gets its slot when it does
+	const std::size_t slotIndex = getServiceSlotIndex(typeIdx);
+	if (slotIndex == dynamicServiceSlot && !m_serviceSlots.findSlot(typeIdx, slotIndex))
+	{
+		return;
+	}
+
+	m_serviceSlots.store(typeIdx, slotIndex, service);
+}
+
+void PluginRuntimeContext::collectRetiredServices()
+{
+	m_serviceSlots.collectRetired();
+}
+
+bool PluginRuntimeContext::hasRetiredServices() const
+{
+	return m_serviceSlots.hasRetired();
 }
 
 std::shared_ptr<ILogger> PluginRuntimeContext::getLoggerShared()
@@ -40,12 +121,152 @@ std::shared_ptr<ILogger> PluginRuntimeContext::getLoggerShared()
 	return m_pluginLogger;
 }
 
+void PluginRuntimeContext::setMemoryAccount(std::shared_ptr<PluginMemoryAccount> account)
+{
+	m_memoryAccount = std::move(account);
+}
+
+const std::shared_ptr<PluginMemoryAccount>& PluginRuntimeContext::getMemoryAccount() const
+{
+	return m_memoryAccount;
+}
+
+std::shared_ptr<std::pmr::memory_resource> PluginRuntimeContext::getMemoryResourceShared()
+{
+	if (!m_memoryAccount)
+	{
+		return IPluginContext::getMemoryResourceShared();
+	}
+
+	return m_memoryAccount;
+}
+
+void PluginRuntimeContext::setThreadPlacement(ThreadPlacement placement)
+{
+	m_threadPlacement = std::move(placement);
+}
+
+const ThreadPlacement& PluginRuntimeContext::getThreadPlacement() const
+{
+	return m_threadPlacement;
+}
+
+void PluginRuntimeContext::placeCurrentThread()
+{
+	if (m_threadPlacement.isEmpty())
+	{
+		return;
+	}
+
+	if (const auto placed = ::placeCurrentThread(m_threadPlacement); !placed)
+	{
+		log(LogLevel::Warning, std::format("Could not place thread: {}", placed.error()));
+	}
+}
+
+void PluginRuntimeContext::setProvidedServices(std::vector<ProvidedService> providedServices)
+{
+	std::lock_guard lock(m_providedMutex);
+	m_providedServices = std::move(providedServices);
+}
+
+void PluginRuntimeContext::withdrawProvidedServices()
+{
+	std::vector<std::pair<std::type_index, const void*>> providedInstances;
+	{
+		std::lock_guard lock(m_providedMutex);
+		providedInstances = std::exchange(m_providedInstances, {});
+	}
+
+	for (const auto& [typeIdx, instance] : providedInstances)
+	{
+		if (m_services.withdrawServiceByType(typeIdx, instance))
+		{
+			log(LogLevel::Info, std::format("Withdrew service {}", typeIdx.name()));
+		}
+	}
+}
+
+bool PluginRuntimeContext::provideServiceByType(const std::type_index tIdx, std::shared_ptr<void> service)
+{
+	if (!service)
+	{
+		return false;
+	}
+
+	std::optional<SemanticVersion> version;
+	{
+		std::lock_guard lock(m_providedMutex);
+
+		const auto provided = std::ranges::find(m_providedServices, tIdx, &ProvidedService::type);
+		if (provided == m_providedServices.end())
+		{
+			log(LogLevel::Warning, std::format("Can't provide service {} - it isn't in the plugin descriptor's provides", tIdx.name()));
+			return false;
+		}
+
+		const auto parsed = SemanticVersion::parse(provided->version);
+		if (!parsed)
+		{
+			log(LogLevel::Warning, std::format("Can't provide service '{}': {}", provided->name, parsed.error()));
+			return false;
+		}
+
+		version = *parsed;
+		m_providedInstances.emplace_back(tIdx, service.get());
+	}
+
+	// Not under the lock - the container calls back into every context, this one included
+	m_services.replaceServiceByType(tIdx, std::move(service), *version);
+	log(LogLevel::Info, std::format("Provided service {} at {}", tIdx.name(), version->toString()));
+	return true;
+}
+
+void PluginRuntimeContext::setEngineEventBus(EngineEventBus& eventBus)
+{
+	// Subscribed to nothing until the plugin asks, so the queue is in place before any thread can look for it
+	m_engineEventBus = &eventBus;
+	m_engineEvents = eventBus.subscribe(0);
+}
+
+bool PluginRuntimeContext::subscribeToEngineEvents(const EngineEventMask types)
+{
+	if (!m_engineEventBus)
+	{
+		return false;
+	}
+
+	m_engineEventBus->setSubscribedTypes(*m_engineEvents, types & allEngineEvents);
+	return true;
+}
+
+EngineEventQueue* PluginRuntimeContext::getEngineEventQueue() const
+{
+	return m_engineEvents.get();
+}
+
 bool PluginRuntimeContext::registerDataPacketHandler(const std::type_index type, std::shared_ptr<IDataPacketHandler> handler)
 {
 	log(LogLevel::Info, std::format("Registered handle for {}", type.name()));
+
+	if (m_isStagingHandlers)
+	{
+		return m_dataPacketRegistry.stageDataPacketHandler(type, std::move(handler), m_pluginName);
+	}
+
 	return m_dataPacketRegistry.registerDataPacketHandler(type, std::move(handler), m_pluginName);
 }
 
+bool PluginRuntimeContext::registerPacketSerializer(const std::type_index type, const PacketSerializer& serializer)
+{
+	if (m_isStagingHandlers)
+	{
+		return m_dataPacketRegistry.stagePacketSerializer(type, serializer, m_pluginName);
+	}
+
+	return m_dataPacketRegistry.registerPacketSerializer(type, serializer, m_pluginName);
+}
+
 void PluginRuntimeContext::dispatch(const DataPacket& packet)
 {
 	if (!packet.payload) return;
@@ -53,27 +274,37 @@ void PluginRuntimeContext::dispatch(const DataPacket& packet)
 	m_dataPacketRegistry.dispatch(packet);
 }
 
-std::expected<std::shared_ptr<void>, std::string> PluginRuntimeContext::getServiceByTypeIndex(std::type_index tIdx)
+std::optional<std::type_index> PluginRuntimeContext::findPacketTypeBySchema(std::string_view schemaName) const
 {
-	// First check local services (plugin-specific)
-	auto it = m_localServices.find(tIdx);
-	if (it != m_localServices.end())
-	{
-		return it->second;
-	}
+	return m_dataPacketRegistry.findPacketTypeBySchema(schemaName);
+}
 
-	// Fallback to global service container
-	if (auto service = m_services.getServiceByType(tIdx))
+std::shared_ptr<const PacketSerializer> PluginRuntimeContext::findPacketSerializer(std::type_index type) const
+{
+	return m_dataPacketRegistry.findPacketSerializer(type);
+}
+
+const ServiceSlot* PluginRuntimeContext::getServiceSlot(std::type_index tIdx, std::size_t slotIndex)
+{
+	// Local services (plugin-specific) first, then the global service container. Resolved once - the slot then
+	// follows whatever is registered with this context, or swapped in the container.
+	std::lock_guard lock(m_serviceMutex);
+
+	if (const ServiceSlot* slot = m_serviceSlots.findSlot(tIdx, slotIndex); slot && slot->isOccupied())
 	{
-		return service;
+		return slot;
 	}
 
-	return std::unexpected("Service not found");
+	return &m_serviceSlots.storeIfEmpty(tIdx, slotIndex, m_services.getServiceByType(tIdx));
 }
 
 bool PluginRuntimeContext::hasServiceByTypeIndex(std::type_index tIdx) const
 {
-	std::shared_lock lock(m_mutex);
+	if (const ServiceSlot* slot = m_serviceSlots.findSlot(tIdx, dynamicServiceSlot); slot && slot->isOccupied())
+	{
+		return true;
+	}
+
 	return m_services.hasServiceByType(tIdx);
 }
 
@@ -108,10 +339,23 @@ void PluginRuntimeContext::setImGuiContextFunctions(std::function<void*()> getFu
 //Needed? Move to base class?
 void PluginRuntimeContext::unregisterDataPacketHandler()
 {
+	// A staging context never went live, so the handlers under its name belong to the instance being replaced
+	if (m_isStagingHandlers)
+	{
+		m_dataPacketRegistry.discardStagedHandlers(m_pluginName);
+		log(LogLevel::Info, std::format("Discarded staged handles for {}", m_pluginName));
+		return;
+	}
+
 	m_dataPacketRegistry.unregisterDataPacketHandlerForPlugin(m_pluginName);
 	log(LogLevel::Info, std::format("Unregistered handles for {}", m_pluginName));
 }
 
+void PluginRuntimeContext::setStagingHandlers(bool isStaging)
+{
+	m_isStagingHandlers = isStaging;
+}
+
 std::string PluginRuntimeContext::getPluginName() const
 {
 	return m_pluginName;
@@ -124,20 +368,15 @@ void PluginRuntimeContext::log(const LogLevel level, const std::string& message)
 
 void PluginRuntimeContext::populateServices()
 {
-		// Store references to services that plugins commonly need
-		if (auto logger = m_services.getService<ILogger>())
-		{
-			registerService<ILogger>(logger);
-		}
-
-		if (auto restClient = m_services.getService<IPluginRESTService>())
-		{
-			registerService<IPluginRESTService>(restClient);
-		}
+	std::lock_guard lock(m_serviceMutex);
 
-		if(auto uiService = m_services.getService<IPluginUIService>())
+		// Resolve the services that plugins commonly need up front - followed from the container, not registered here
+		for (const std::type_index typeIdx : {std::type_index(typeid(ILogger)), std::type_index(typeid(IPluginRESTService)), std::type_index(typeid(IPluginUIService))})
 		{
-			registerService<IPluginUIService>(uiService);
+			if (auto service = m_services.getServiceByType(typeIdx))
+			{
+				m_serviceSlots.store(typeIdx, getServiceSlotIndex(typeIdx), std::move(service));
+			}
 		}
 		// Add other services as needed
 }
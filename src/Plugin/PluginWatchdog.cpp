@@ -0,0 +1,366 @@
+#include "Plugin/PluginWatchdog.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <format>
+#include <unordered_map>
+#include <utility>
+
+#include "Profiling/TraceRecorder.h"
+#include "Services/Logging/ILogger.h"
+#include "Services/Logging/LogLevel.h"
+
+namespace
+{
+	/// <summary>
+	/// What a thread is running right now, as seen by the watchdog. Written only by its own thread.
+	/// </summary>
+	/// <remarks>
+	/// episode changes on every scope, is 0 when the thread runs no plugin code and has its low bit set once the watchdog
+	/// flagged it as stalled - the watchdog sets that bit with a CAS, so a scope ending at the same time never misses it.
+	/// </remarks>
+	struct ThreadSlot
+	{
+		std::atomic<PluginActivity*> activity{nullptr};
+		std::atomic<std::uint64_t>   startTicks{0};
+		std::atomic<std::uint8_t>    kind{0};
+		std::atomic<std::uint64_t>   episode{0};
+		std::atomic_bool             isAlive{true};
+		std::uint64_t                lastEpisode = 0; // owning thread only
+	};
+
+	constexpr std::uint64_t stalledBit = 1;
+
+	struct SlotRegistry
+	{
+		std::mutex                               mutex;
+		std::vector<std::shared_ptr<ThreadSlot>> slots;
+	};
+
+	SlotRegistry& slotRegistry()
+	{
+		static SlotRegistry registry;
+		return registry;
+	}
+
+	struct SlotOwner
+	{
+		SlotOwner()
+			: slot(std::make_shared<ThreadSlot>())
+		{
+			auto& registry = slotRegistry();
+			std::scoped_lock lock(registry.mutex);
+			registry.slots.push_back(slot);
+		}
+
+		~SlotOwner()
+		{
+			slot->isAlive.store(false, std::memory_order_release);
+		}
+
+		std::shared_ptr<ThreadSlot> slot;
+	};
+
+	ThreadSlot& currentSlot()
+	{
+		thread_local SlotOwner owner;
+		return *owner.slot;
+	}
+
+	const char* toString(PluginActivityKind kind)
+	{
+		return kind == PluginActivityKind::Tick ? "tick" : "packet handler";
+	}
+
+	void storeMax(std::atomic<std::uint64_t>& target, std::uint64_t value) noexcept
+	{
+		std::uint64_t current = target.load(std::memory_order_relaxed);
+		while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+		{
+		}
+	}
+}
+
+const char* toString(PluginOverrunAction action)
+{
+	switch (action)
+	{
+		case PluginOverrunAction::Flag:     return "flag";
+		case PluginOverrunAction::Throttle: return "throttle";
+		case PluginOverrunAction::Isolate:  return "isolate";
+	}
+
+	return "unknown";
+}
+
+std::optional<PluginOverrunAction> parseOverrunAction(std::string_view text)
+{
+	for (const auto candidate : {PluginOverrunAction::Flag, PluginOverrunAction::Throttle, PluginOverrunAction::Isolate})
+	{
+		if (text == toString(candidate))
+		{
+			return candidate;
+		}
+	}
+
+	return std::nullopt;
+}
+
+PluginActivity::PluginActivity(std::string pluginName)
+	: m_pluginName(std::move(pluginName))
+{
+}
+
+const std::string& PluginActivity::getPluginName() const
+{
+	return m_pluginName;
+}
+
+PluginActivityStats PluginActivity::getStats() const
+{
+	return PluginActivityStats{
+		.tickOverruns = m_tickOverruns.load(std::memory_order_relaxed),
+		.handlerOverruns = m_handlerOverruns.load(std::memory_order_relaxed),
+		.worstTick = PluginWatchdog::ticksToDuration(m_worstTickTicks.load(std::memory_order_relaxed)),
+		.worstHandler = PluginWatchdog::ticksToDuration(m_worstHandlerTicks.load(std::memory_order_relaxed)),
+		.isStalled = m_stalledCalls.load(std::memory_order_relaxed) > 0,
+		.crossNodeDispatches = m_crossNodeDispatches.load(std::memory_order_relaxed)
+	};
+}
+
+std::uint64_t PluginActivity::getOverrunCount() const
+{
+	return m_tickOverruns.load(std::memory_order_relaxed) + m_handlerOverruns.load(std::memory_order_relaxed);
+}
+
+void PluginActivity::setHomeNode(int node)
+{
+	m_homeNode.store(node, std::memory_order_relaxed);
+}
+
+int PluginActivity::getHomeNode() const
+{
+	return m_homeNode.load(std::memory_order_relaxed);
+}
+
+void PluginActivity::recordOverrun(PluginActivityKind kind, std::uint64_t elapsedTicks) noexcept
+{
+	if (kind == PluginActivityKind::Tick)
+	{
+		m_tickOverruns.fetch_add(1, std::memory_order_relaxed);
+		storeMax(m_worstTickTicks, elapsedTicks);
+	}
+	else
+	{
+		m_handlerOverruns.fetch_add(1, std::memory_order_relaxed);
+		storeMax(m_worstHandlerTicks, elapsedTicks);
+	}
+}
+
+void ScopedPluginActivity::begin() noexcept
+{
+	ThreadSlot& slot = currentSlot();
+
+	// Hide the slot while it changes, the watchdog skips episode 0. Exchanged, so a stall flagged on the outer
+	// scope at this very moment is still carried back to it.
+	m_outerEpisode = slot.episode.exchange(0, std::memory_order_acq_rel);
+	m_outerActivity = slot.activity.load(std::memory_order_relaxed);
+	m_outerKind = static_cast<PluginActivityKind>(slot.kind.load(std::memory_order_relaxed));
+	m_outerStartTicks = slot.startTicks.load(std::memory_order_relaxed);
+
+	slot.lastEpisode += 2;
+	m_episode = slot.lastEpisode;
+	m_startTicks = TraceRecorder::nowTicks();
+
+	slot.activity.store(m_activity, std::memory_order_relaxed);
+	slot.kind.store(static_cast<std::uint8_t>(m_kind), std::memory_order_relaxed);
+	slot.startTicks.store(m_startTicks, std::memory_order_relaxed);
+	slot.episode.store(m_episode, std::memory_order_release);
+}
+
+void ScopedPluginActivity::end() noexcept
+{
+	const std::uint64_t elapsedTicks = TraceRecorder::nowTicks() - m_startTicks;
+	ThreadSlot&         slot = currentSlot();
+
+	const std::uint64_t episode = slot.episode.exchange(0, std::memory_order_acq_rel);
+	if (episode & stalledBit)
+	{
+		m_activity->m_stalledCalls.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	if (elapsedTicks > PluginWatchdog::s_deadlineTicks[static_cast<std::size_t>(m_kind)].load(std::memory_order_relaxed))
+	{
+		m_activity->recordOverrun(m_kind, elapsedTicks);
+	}
+
+	slot.activity.store(m_outerActivity, std::memory_order_relaxed);
+	slot.kind.store(static_cast<std::uint8_t>(m_outerKind), std::memory_order_relaxed);
+	slot.startTicks.store(m_outerStartTicks, std::memory_order_relaxed);
+	slot.episode.store(m_outerEpisode, std::memory_order_release);
+}
+
+std::atomic_bool           PluginWatchdog::s_isWatching{false};
+std::atomic<std::uint64_t> PluginWatchdog::s_deadlineTicks[2]{};
+std::atomic<double>        PluginWatchdog::s_nsPerTick{1.0};
+
+PluginWatchdog::PluginWatchdog(ILogger& logger, std::chrono::milliseconds tickDeadline, std::chrono::milliseconds handlerDeadline, ThreadPlacement placement)
+	: m_logger(logger)
+	, m_deadlines{tickDeadline, handlerDeadline}
+	, m_placement(std::move(placement))
+{
+	m_thread = std::jthread([this](const std::stop_token& stopToken)
+	{
+		run(stopToken);
+	});
+}
+
+PluginWatchdog::~PluginWatchdog()
+{
+	// Joined first - the thread only starts watching once calibrated, which may not have happened yet
+	m_thread.request_stop();
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+
+	s_isWatching.store(false, std::memory_order_relaxed);
+}
+
+void PluginWatchdog::track(const std::shared_ptr<PluginActivity>& activity)
+{
+	std::scoped_lock lock(m_trackedMutex);
+	std::erase_if(m_tracked, [](const auto& tracked) { return tracked.expired(); });
+	m_tracked.push_back(activity);
+}
+
+std::chrono::milliseconds PluginWatchdog::getDeadline(PluginActivityKind kind) const
+{
+	return m_deadlines[static_cast<std::size_t>(kind)];
+}
+
+std::chrono::nanoseconds PluginWatchdog::ticksToDuration(std::uint64_t ticks) noexcept
+{
+	return std::chrono::nanoseconds(static_cast<std::int64_t>(static_cast<double>(ticks) * s_nsPerTick.load(std::memory_order_relaxed)));
+}
+
+void PluginWatchdog::run(const std::stop_token& stopToken)
+{
+	if (const auto placed = placeCurrentThread(m_placement); !placed)
+	{
+		log(LogLevel::Warning, std::format("Could not place the watchdog thread: {}", placed.error()));
+	}
+
+	calibrate();
+	s_isWatching.store(true, std::memory_order_relaxed);
+
+	// Often enough that a stall is reported within half a deadline of it happening
+	const auto period = std::max(std::min(m_deadlines[0], m_deadlines[1]) / 2, std::chrono::milliseconds(5));
+
+	std::mutex                  waitMutex;
+	std::condition_variable_any waitForStop;
+	while (!stopToken.stop_requested())
+	{
+		{
+			std::unique_lock lock(waitMutex);
+			waitForStop.wait_for(lock, stopToken, period, [] { return false; });
+		}
+
+		if (!stopToken.stop_requested())
+		{
+			checkThreads();
+		}
+	}
+}
+
+void PluginWatchdog::calibrate()
+{
+#ifdef VECTORIUM_TRACE_HAS_TSC
+	const std::uint64_t startTicks = TraceRecorder::nowTicks();
+	const std::int64_t  startNs = TraceRecorder::nowNs();
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	const std::uint64_t endTicks = TraceRecorder::nowTicks();
+	const std::int64_t  endNs = TraceRecorder::nowNs();
+
+	if (endTicks > startTicks)
+	{
+		s_nsPerTick.store(static_cast<double>(endNs - startNs) / static_cast<double>(endTicks - startTicks), std::memory_order_relaxed);
+	}
+#endif
+
+	for (const auto kind : {PluginActivityKind::Tick, PluginActivityKind::Handler})
+	{
+		const auto deadlineNs = std::chrono::duration<double, std::nano>(getDeadline(kind)).count();
+		s_deadlineTicks[static_cast<std::size_t>(kind)].store(static_cast<std::uint64_t>(deadlineNs / s_nsPerTick.load(std::memory_order_relaxed)),
+		                                                      std::memory_order_relaxed);
+	}
+}
+
+void PluginWatchdog::checkThreads()
+{
+	// Holding these keeps every tracked activity alive while slots that point at them are inspected
+	std::unordered_map<PluginActivity*, std::shared_ptr<PluginActivity>> tracked;
+	{
+		std::scoped_lock lock(m_trackedMutex);
+		for (const auto& weak : m_tracked)
+		{
+			if (auto activity = weak.lock())
+			{
+				tracked.emplace(activity.get(), std::move(activity));
+			}
+		}
+	}
+
+	std::vector<std::shared_ptr<ThreadSlot>> slots;
+	{
+		auto& registry = slotRegistry();
+		std::scoped_lock lock(registry.mutex);
+		std::erase_if(registry.slots, [](const auto& slot) { return !slot->isAlive.load(std::memory_order_acquire); });
+		slots = registry.slots;
+	}
+
+	const std::uint64_t now = TraceRecorder::nowTicks();
+	for (const auto& slot : slots)
+	{
+		std::uint64_t episode = slot->episode.load(std::memory_order_acquire);
+		if (episode == 0 || (episode & stalledBit))
+		{
+			continue;
+		}
+
+		PluginActivity*          activity = slot->activity.load(std::memory_order_relaxed);
+		const std::uint64_t      startTicks = slot->startTicks.load(std::memory_order_relaxed);
+		const PluginActivityKind kind = static_cast<PluginActivityKind>(slot->kind.load(std::memory_order_relaxed));
+
+		const auto found = tracked.find(activity);
+		if (found == tracked.end() || slot->episode.load(std::memory_order_acquire) != episode)
+		{
+			continue;
+		}
+
+		const std::uint64_t elapsedTicks = now > startTicks ? now - startTicks : 0;
+		if (elapsedTicks <= s_deadlineTicks[static_cast<std::size_t>(kind)].load(std::memory_order_relaxed))
+		{
+			continue;
+		}
+
+		// Counted before the flag is set, so the scope can never see the flag and uncount it first
+		activity->m_stalledCalls.fetch_add(1, std::memory_order_relaxed);
+		if (!slot->episode.compare_exchange_strong(episode, episode | stalledBit, std::memory_order_acq_rel))
+		{
+			activity->m_stalledCalls.fetch_sub(1, std::memory_order_relaxed);
+			continue;
+		}
+
+		log(std::exchange(activity->m_isStallReported, true) ? LogLevel::Debug : LogLevel::Warning, std::format("Plugin '{}' has been in its {} for {} ms, past its {} ms deadline",
+		                                   activity->getPluginName(),
+		                                   toString(kind),
+		                                   std::chrono::duration_cast<std::chrono::milliseconds>(ticksToDuration(elapsedTicks)).count(),
+		                                   getDeadline(kind).count()));
+	}
+}
+
+void PluginWatchdog::log(LogLevel level, const std::string& msg) const
+{
+	m_logger.log(level, std::format("[{}] - {}", "PluginWatchdog", msg));
+}
@@ -0,0 +1,208 @@
+#include "Plugin/PluginWorker.h"
+
+#include <algorithm>
+#include <format>
+#include <iterator>
+#include <utility>
+
+#include "DataPacket/IDataPacketHandler.h"
+#include "Plugin/IPlugin.h"
+#include "Plugin/IPluginContext.h"
+#include "Plugin/PluginWatchdog.h"
+#include "Profiling/AllocationTracker.h"
+#include "Profiling/TraceRecorder.h"
+
+namespace
+{
+	/// <summary>
+	/// Stands in for a demoted plugin's handler in the registry
+	/// </summary>
+	class QueuedPacketHandler final : public IDataPacketHandler
+	{
+	public:
+		QueuedPacketHandler(std::shared_ptr<PluginWorker> worker, std::shared_ptr<IDataPacketHandler> handler)
+			: m_worker(std::move(worker))
+			, m_handler(std::move(handler))
+		{
+		}
+
+		bool handle(const DataPacket& packet) override
+		{
+			return m_worker->postPacket(m_handler, packet);
+		}
+
+	private:
+		std::shared_ptr<PluginWorker>       m_worker;
+		std::shared_ptr<IDataPacketHandler> m_handler;
+	};
+}
+
+PluginWorker::PluginWorker(IPlugin& plugin, IPluginContext& context, std::string pluginName, std::shared_ptr<PluginActivity> activity, std::size_t packetCapacity)
+	: m_plugin(plugin)
+	, m_context(context)
+	, m_pluginName(std::move(pluginName))
+	, m_traceLabel(TraceRecorder::instance().internName(m_pluginName))
+	, m_activity(std::move(activity))
+	, m_packetCapacity(packetCapacity)
+{
+	m_thread = std::jthread([this](const std::stop_token& stopToken)
+	{
+		run(stopToken);
+	});
+}
+
+PluginWorker::~PluginWorker()
+{
+	stop();
+}
+
+void PluginWorker::postTick()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		if (m_isStopped || m_isTickPending)
+		{
+			return;
+		}
+
+		m_isTickPending = true;
+	}
+
+	m_wake.notify_one();
+}
+
+void PluginWorker::postEngineEvents(std::vector<EngineEvent>& events)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		if (m_isStopped)
+		{
+			events.clear();
+			return;
+		}
+
+		if (m_engineEvents.empty())
+		{
+			std::swap(m_engineEvents, events);
+		}
+		else
+		{
+			std::ranges::move(events, std::back_inserter(m_engineEvents));
+		}
+	}
+
+	events.clear();
+	m_wake.notify_one();
+}
+
+bool PluginWorker::postPacket(const std::shared_ptr<IDataPacketHandler>& handler, const DataPacket& packet)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		if (m_isStopped || m_packets.size() >= m_packetCapacity)
+		{
+			m_droppedPackets.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		m_packets.push_back(QueuedPacket{ .handler = handler, .packet = packet });
+	}
+
+	m_wake.notify_one();
+	return true;
+}
+
+std::shared_ptr<IDataPacketHandler> PluginWorker::makeQueuedHandler(std::shared_ptr<IDataPacketHandler> handler)
+{
+	return std::make_shared<QueuedPacketHandler>(shared_from_this(), std::move(handler));
+}
+
+void PluginWorker::stop()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_isStopped = true;
+	}
+
+	m_thread.request_stop();
+	if (m_thread.joinable() && m_thread.get_id() != std::this_thread::get_id())
+	{
+		m_thread.join();
+	}
+
+	// The handlers may come from a library that is about to be closed
+	std::lock_guard lock(m_mutex);
+	m_packets.clear();
+	m_engineEvents.clear();
+	m_isTickPending = false;
+}
+
+std::uint64_t PluginWorker::getDroppedPacketCount() const
+{
+	return m_droppedPackets.load(std::memory_order_relaxed);
+}
+
+std::size_t PluginWorker::getQueuedPacketCount() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_packets.size();
+}
+
+void PluginWorker::run(const std::stop_token& stopToken)
+{
+	if (TraceRecorder::instance().isEnabled())
+	{
+		TraceRecorder::instance().setCurrentThreadName(std::format("PluginWorker {}", m_pluginName));
+	}
+
+	m_context.placeCurrentThread();
+
+	std::deque<QueuedPacket> packets;
+	std::vector<EngineEvent> engineEvents;
+	while (true)
+	{
+		bool isTickDue = false;
+		{
+			std::unique_lock lock(m_mutex);
+			if (!m_wake.wait(lock, stopToken, [&] { return m_isTickPending || !m_packets.empty() || !m_engineEvents.empty(); }))
+			{
+				return; // stopped
+			}
+
+			std::swap(packets, m_packets);
+			std::swap(engineEvents, m_engineEvents);
+			isTickDue = std::exchange(m_isTickPending, false);
+		}
+
+		if (!engineEvents.empty() && !stopToken.stop_requested())
+		{
+			VECTORIUM_TRACE_ZONE_DETAIL("IPlugin::onEngineEvents", m_traceLabel);
+			ScopedPluginActivity activity(m_activity.get(), PluginActivityKind::Tick);
+			m_plugin.onEngineEvents(engineEvents);
+		}
+		engineEvents.clear();
+
+		// Packets first, so a tick sees everything that arrived before it was posted
+		for (const auto& [handler, packet] : packets)
+		{
+			if (stopToken.stop_requested())
+			{
+				break;
+			}
+
+			VECTORIUM_TRACE_ZONE_DETAIL("IDataPacketHandler::handle", m_traceLabel);
+			VECTORIUM_ALLOCATION_ZONE(AllocationZoneKind::Handler, m_traceLabel);
+			ScopedPluginActivity activity(m_activity.get(), PluginActivityKind::Handler);
+			handler->handle(packet);
+		}
+		packets.clear();
+
+		if (isTickDue && !stopToken.stop_requested())
+		{
+			VECTORIUM_TRACE_ZONE_DETAIL("PluginInstance::tick", m_traceLabel);
+			VECTORIUM_ALLOCATION_ZONE(AllocationZoneKind::PluginTick, m_traceLabel);
+			ScopedPluginActivity activity(m_activity.get(), PluginActivityKind::Tick);
+			m_plugin.tick();
+		}
+	}
+}
@@ -1,22 +1,26 @@
 #include "Plugin/PluginInstance.h"
+#include <algorithm>
 #include <utility>
+#include "EngineEventBus.h"
 #include "Plugin/IPlugin.h"
 #include "Plugin/PluginRuntimeContext.h"
+#include "Plugin/PluginWatchdog.h"
+#include "Plugin/PluginWorker.h"
+#include "Profiling/AllocationTracker.h"
+#include "Profiling/TraceRecorder.h"
 
 #include "Services/Logging/ILogger.h"
 #include "Services/Logging/LogLevel.h"
 
-PluginInstance::PluginInstance(LibraryHandle h, std::unique_ptr<IPlugin> p, std::unique_ptr<PluginRuntimeContext> ctx, std::string name)
+PluginInstance::PluginInstance(LibraryHandle h, std::unique_ptr<IPlugin> p, std::unique_ptr<PluginRuntimeContext> ctx, std::string name,
+                               std::shared_ptr<PluginActivity> activity)
 : m_handle(h)
 , m_plugin(std::move(p))
 , m_context(std::move(ctx))
 , m_pluginName(std::move(name))
+, m_activity(std::move(activity))
 {
-	if (!m_handle)
-	{
-		throw std::invalid_argument("Nullptr handle passed to PluginInstance constructor");
-	}
-
+	// A null handle is fine - an isolated plugin's library is open in its host process, not here
 	if (!m_plugin)
 	{
 		throw std::invalid_argument("Nullptr plugin passed to PluginInstance constructor");
@@ -26,10 +30,24 @@ PluginInstance::PluginInstance(LibraryHandle h, std::unique_ptr<IPlugin> p, std:
 	{
 		throw std::invalid_argument("Nullptr context passed to PluginInstance constructor");
 	}
+
+	m_traceLabel = TraceRecorder::instance().internName(m_pluginName);
 }
 
 PluginInstance::~PluginInstance()
 {
+	// Nothing may still be running on the worker once the plugin goes
+	if (m_worker)
+	{
+		m_worker->stop();
+	}
+
+	// Other plugins stop reaching what it provided while it can still serve them
+	if (m_context)
+	{
+		m_context->withdrawProvidedServices();
+	}
+
 	if (m_plugin)
 	{
 		m_plugin->onPluginUnload();
@@ -72,6 +90,11 @@ const std::string& PluginInstance::getPluginName()
 	return m_pluginName;
 }
 
+bool PluginInstance::isInProcess() const
+{
+	return m_handle != nullptr;
+}
+
 void PluginInstance::enablePluginDebugLogging()
 {
 	m_context->getLoggerShared()->enableDebugLogging();
@@ -87,11 +110,102 @@ bool PluginInstance::isPluginDebugLoggingEnabled() const
 	return m_context->getLoggerShared()->isDebugLoggingEnabled();
 }
 
-void PluginInstance::tick() const
+void PluginInstance::tick()
+{
+	if(!m_plugin)
+	{
+		return;
+	}
+
+	if (m_tickStride > 1 && ++m_ticksSkipped < m_tickStride)
+	{
+		return;
+	}
+	m_ticksSkipped = 0;
+
+	if (m_worker)
+	{
+		m_worker->postTick();
+		return;
+	}
+
+	VECTORIUM_TRACE_ZONE_DETAIL("PluginInstance::tick", m_traceLabel);
+	VECTORIUM_ALLOCATION_ZONE(AllocationZoneKind::PluginTick, m_traceLabel);
+	ScopedPluginActivity activity(m_activity.get(), PluginActivityKind::Tick);
+	m_plugin->tick();
+}
+
+void PluginInstance::deliverEngineEvents()
+{
+	EngineEventQueue* queue = m_context ? m_context->getEngineEventQueue() : nullptr;
+	if (!m_plugin || !queue || queue->isEmpty())
+	{
+		return;
+	}
+
+	queue->takeAll(m_engineEvents);
+
+	if (m_worker)
+	{
+		m_worker->postEngineEvents(m_engineEvents);
+		return;
+	}
+
+	VECTORIUM_TRACE_ZONE_DETAIL("IPlugin::onEngineEvents", m_traceLabel);
+	ScopedPluginActivity activity(m_activity.get(), PluginActivityKind::Tick);
+	m_plugin->onEngineEvents(m_engineEvents);
+	m_engineEvents.clear();
+}
+
+const std::shared_ptr<PluginActivity>& PluginInstance::getActivity() const
+{
+	return m_activity;
+}
+
+PluginWorker* PluginInstance::moveToWorker()
+{
+	if (!m_worker && m_plugin && m_context)
+	{
+		m_worker = std::make_shared<PluginWorker>(*m_plugin, *m_context, m_pluginName, m_activity);
+	}
+
+	return m_worker.get();
+}
+
+PluginWorker* PluginInstance::getWorker() const
 {
-	if(m_plugin)
+	return m_worker.get();
+}
+
+void PluginInstance::setTickStride(std::uint32_t stride)
+{
+	m_tickStride = std::max(stride, 1u);
+	m_ticksSkipped = 0;
+}
+
+std::uint32_t PluginInstance::getTickStride() const
+{
+	return m_tickStride;
+}
+
+std::uint64_t PluginInstance::takeNewOverruns()
+{
+	if (!m_activity)
 	{
-		m_plugin->tick();
+		return 0;
 	}
+
+	const std::uint64_t overruns = m_activity->getOverrunCount();
+	return overruns - std::exchange(m_seenOverruns, overruns);
 }
 
+std::uint64_t PluginInstance::takeNewDroppedPackets()
+{
+	if (!m_worker)
+	{
+		return 0;
+	}
+
+	const std::uint64_t dropped = m_worker->getDroppedPacketCount();
+	return dropped - std::exchange(m_seenDroppedPackets, dropped);
+}
@@ -1,23 +1,36 @@
 #include "Plugin/PluginManager.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <expected>
 #include <format>
 #include <fstream>
 #include <memory>
 #include <ranges>
+#include <thread>
 #include <utility>
 #include <nlohmann/json.hpp>
 #include <Services/REST/IPluginRESTService.h>
 #include "Services/IServiceSpecialisations.h"
 #include "DataPacket/DataPacketRegistry.h"
+#include "EngineEventBus.h"
+#include "Plugin/PluginDependencyResolver.h"
 #include "Plugin/PluginInstance.h"
+#include "Plugin/PluginMemoryAccount.h"
 #include "Plugin/PluginRuntimeContext.h"
+#include "Plugin/PluginWorker.h"
+#ifdef VECTORIUM_PLUGIN_ISOLATION
+#include "Plugin/Isolation/RemotePlugin.h"
+#endif
+#include "Profiling/TraceRecorder.h"
+#include "Services/SemanticVersion.h"
 #include "Services/ServiceId.h"
 #include "Services/Logging/ILogger.h"
 #include "Services/Logging/LogLevel.h"
 #include "Services/Logging/PluginLogger.h"
 #include "Services/Logging/SpdLogger.h"
+#include "Services/Logging/UILogSink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "Utils/range_utils.h"
 
@@ -30,7 +43,7 @@
 
 namespace
 {
-	std::expected<std::string, std::string> formatPluginDescriptor(PluginDescriptor* pPluginDescriptor)
+	std::expected<std::string, std::string> formatPluginDescriptor(const PluginDescriptor* pPluginDescriptor)
 	{
 		if (!pPluginDescriptor)
 		{
@@ -44,11 +57,21 @@ namespace
 			stringOfServices += std::format("{}({}) - optional: {}\n", service.name, service.minVersion, service.required ? "false" : "true"); // negate as we are showing optional rather than required
 		}
 
+		for (const auto& provided : pPluginDescriptor->provides)
+		{
+			stringOfServices += std::format("provides {}({})\n", provided.name, provided.version);
+		}
+
 		return stringOfServices;
 	}
 
 	bool needsNetworkAccess(const PluginDescriptor* desc)
 	{
+		if (!desc)
+		{
+			return false;
+		}
+
 		// Check if plugin requests IPluginRESTService in its services list
 		return std::ranges::any_of(desc->services,
 			[](const auto& service)
@@ -57,11 +80,14 @@ namespace
 			});
 	}
 
-	bool isTrustedPlugin(const std::string& name)
-	{
-		static const std::set<std::string> trusted = {"GPS", "WeatherService"};
-		return trusted.contains(name);
-	}
+#ifdef _WIN32
+	constexpr auto descriptorProbeName = "vectorium_descriptor_probe.exe";
+#else
+	constexpr auto descriptorProbeName = "vectorium_descriptor_probe";
+	constexpr auto pluginHostName = "vectorium_plugin_host";
+#endif
+
+	constexpr std::uint32_t maxThrottledTickStride = 64; // a throttled plugin is still ticked at least once every this many frames
 
 	std::filesystem::path getExecutableDir()
 	{
@@ -77,18 +103,158 @@ namespace
 		return std::filesystem::path(exePath).parent_path();
 #endif
 	}
+
+	/// <summary>
+	/// Accepts "firstPacket" or {"policy": "scheduled", "delay_seconds": 30}
+	/// </summary>
+	std::optional<PluginActivation> parsePluginActivation(const nlohmann::json& json)
+	{
+		if (json.is_string())
+		{
+			if (const auto policy = parseActivationPolicy(json.get<std::string>()))
+			{
+				return PluginActivation{.policy = *policy, .delay = std::chrono::seconds(0)};
+			}
+
+			return std::nullopt;
+		}
+
+		if (!json.is_object() || !json.contains("policy"))
+		{
+			return std::nullopt;
+		}
+
+		const auto policy = parseActivationPolicy(json["policy"].get<std::string>());
+		if (!policy)
+		{
+			return std::nullopt;
+		}
+
+		return PluginActivation{
+			.policy = *policy,
+			.delay = std::chrono::seconds(json.value("delay_seconds", 0))
+		};
+	}
+
+	/// <summary>
+	/// Accepts 0 or "asFastAsPossible", or a multiple of real time of at least DataPacketRegistry::minReplaySpeed - not
+	/// "realTime", nor anything slower than the minimum
+	/// </summary>
+	std::optional<double> parseReplaySpeed(const nlohmann::json& json)
+	{
+		// A paced replay has to outrun the packets arriving behind it, so real time or slower isn't accepted
+		if (json.is_number())
+		{
+			const double speed = json.get<double>();
+			return speed == 0.0 || speed >= DataPacketRegistry::minReplaySpeed ? std::optional(speed) : std::nullopt;
+		}
+
+		if (json.is_string() && json.get<std::string>() == "asFastAsPossible")
+		{
+			return 0.0;
+		}
+
+		return std::nullopt;
+	}
+
+	std::optional<ThreadPlacement> parseThreadPlacement(const nlohmann::json& json)
+	{
+		if (!json.is_object())
+		{
+			return std::nullopt;
+		}
+
+		return ThreadPlacement{
+			.numaNode = json.value("node", -1),
+			.cpus = json.value("cpus", std::vector<unsigned>{}),
+			.nearPlugin = json.value("near", std::string{})
+		};
+	}
+
+	nlohmann::json toJson(const ThreadPlacement& placement)
+	{
+		nlohmann::json json = nlohmann::json::object();
+		if (placement.numaNode >= 0) json["node"] = placement.numaNode;
+		if (!placement.cpus.empty()) json["cpus"] = placement.cpus;
+		if (!placement.nearPlugin.empty()) json["near"] = placement.nearPlugin;
+		return json;
+	}
+
+	std::chrono::microseconds elapsedSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	}
+
+	/// <summary>
+	/// Calls work(i) for every i in [0, count), spread over threadCount threads - the calling thread is one of them. The
+	/// others are placed as given.
+	/// </summary>
+	template<typename Fn>
+	void runInParallel(std::size_t count, unsigned threadCount, const ThreadPlacement& placement, Fn&& work)
+	{
+		std::atomic_size_t next{0};
+
+		const auto drain = [&]
+		{
+			for (std::size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed))
+			{
+				work(i);
+			}
+		};
+
+		const std::size_t helperCount = std::min<std::size_t>(threadCount, count);
+
+		std::vector<std::jthread> helpers;
+		for (std::size_t t = 1; t < helperCount; ++t)
+		{
+			helpers.emplace_back([&drain, &placement, t]
+			{
+				// Only name the thread when tracing, naming allocates its trace ring buffer
+				if (TraceRecorder::instance().isEnabled())
+				{
+					TraceRecorder::instance().setCurrentThreadName(std::format("PluginLoader {}", t));
+				}
+
+				// A placement that can't be applied was already reported by PluginManager::init
+				[[maybe_unused]] const auto placed = placeCurrentThread(placement);
+
+				drain();
+			});
+		}
+
+		drain();
+	} // helpers join here
 }
 
 
 PluginManager::PluginManager(ILogger& logger,
 	DataPacketRegistry& ptrDataPacketReg,
 	spdlog::sink_ptr uiLogSink,
-	ServiceContainer& services)
-	: m_uiLogSink(std::move(uiLogSink))
+	ServiceContainer& services,
+	EngineEventBus& events)
+	: m_loadedSnapshot(std::make_shared<const LoadedPluginSnapshot::State>())
+	, m_uiLogSink(std::move(uiLogSink))
 	, m_dataPacketRegistry(ptrDataPacketReg)
 	, m_baseLogger(logger)
 	, m_services(services)
+	, m_events(events)
+{
+}
+
+PluginManager::~PluginManager()
 {
+	m_folderWatcher.reset();
+	m_retiredPlugins.clear();
+
+	if (m_packetWatchesActive)
+	{
+		m_dataPacketRegistry.clearPacketWatches();
+	}
+
+	for (auto& job : m_dormantPlugins | std::views::values)
+	{
+		UnloadLibrary(job.handle);
+	}
 }
 
 bool PluginManager::loadConfig()
@@ -113,7 +279,138 @@ bool PluginManager::loadConfig()
 	if (j.contains("autoScan")) m_config.autoScan = j["autoScan"].get<bool>();
 	if (j.contains("pluginDirectory")) m_config.pluginDirectory = j["pluginDirectory"].get<std::string>();
 	if (j.contains("pluginScanInterval_seconds")) m_config.pluginScanInterval = std::chrono::seconds(j["pluginScanInterval_seconds"].get<int>());
+	if (j.contains("pluginChangeDebounce_ms")) m_config.pluginChangeDebounce = std::chrono::milliseconds(j["pluginChangeDebounce_ms"].get<int>());
 	if (j.contains("enabledPlugins")) m_config.enabledPluginsOnStartup = j["enabledPlugins"].get<std::vector<std::string>>();
+	if (j.contains("parallelLoading")) m_config.parallelLoading = j["parallelLoading"].get<bool>();
+	if (j.contains("loadThreads")) m_config.loadThreads = j["loadThreads"].get<unsigned>();
+	if (j.contains("lazyBinding")) m_config.lazyBinding = j["lazyBinding"].get<bool>();
+	if (j.contains("descriptorCache")) m_config.descriptorCache = j["descriptorCache"].get<bool>();
+	if (j.contains("autoReload")) m_config.autoReload = j["autoReload"].get<bool>();
+	if (j.contains("reloadDrainTimeout_ms")) m_config.reloadDrainTimeout = std::chrono::milliseconds(j["reloadDrainTimeout_ms"].get<int>());
+	if (j.contains("isolatedPlugins")) m_config.isolatedPlugins = j["isolatedPlugins"].get<std::vector<std::string>>();
+	if (j.contains("watchdog")) m_config.watchdog = j["watchdog"].get<bool>();
+	if (j.contains("tickDeadline_ms")) m_config.tickDeadline = std::chrono::milliseconds(j["tickDeadline_ms"].get<int>());
+	if (j.contains("handlerDeadline_ms")) m_config.handlerDeadline = std::chrono::milliseconds(j["handlerDeadline_ms"].get<int>());
+	if (j.contains("watchdogStrikes")) m_config.watchdogStrikes = j["watchdogStrikes"].get<unsigned>();
+
+	if (j.contains("overrunAction"))
+	{
+		const auto action = j["overrunAction"].get<std::string>();
+		const auto parsed = parseOverrunAction(action);
+		if (parsed == PluginOverrunAction::Isolate)
+		{
+			log(LogLevel::Warning, "Ignoring overrunAction 'isolate' - a plugin has to opt in to it through overrunActions");
+		}
+		else if (parsed)
+		{
+			m_config.overrunAction = *parsed;
+		}
+		else
+		{
+			log(LogLevel::Warning, std::format("Ignoring unknown overrunAction '{}'", action));
+		}
+	}
+
+	if (j.contains("overrunActions"))
+	{
+		for (const auto& [pluginName, value] : j["overrunActions"].items())
+		{
+			const auto action = value.get<std::string>();
+			if (const auto parsed = parseOverrunAction(action))
+			{
+				m_config.overrunActions[pluginName] = *parsed;
+			}
+			else
+			{
+				log(LogLevel::Warning, std::format("Ignoring unknown overrunAction '{}' for '{}'", action, pluginName));
+			}
+		}
+	}
+
+	if (j.contains("memoryBudgets"))
+	{
+		constexpr std::size_t bytesPerMB = 1024 * 1024;
+		for (const auto& [pluginName, value] : j["memoryBudgets"].items())
+		{
+			m_config.memoryBudgets[pluginName] = PluginMemoryBudget{
+				.warnBytes = value.value("warn_mb", std::size_t{0}) * bytesPerMB,
+				.limitBytes = value.value("limit_mb", std::size_t{0}) * bytesPerMB
+			};
+		}
+	}
+
+	if (j.contains("threadPlacement"))
+	{
+		const auto& placement = j["threadPlacement"];
+		if (placement.contains("engine"))
+		{
+			if (const auto parsed = parseThreadPlacement(placement["engine"]))
+			{
+				m_config.engineThreadPlacement = *parsed;
+			}
+		}
+
+		if (placement.contains("plugins"))
+		{
+			for (const auto& [pluginName, value] : placement["plugins"].items())
+			{
+				if (const auto parsed = parseThreadPlacement(value))
+				{
+					m_config.pluginThreadPlacement[pluginName] = *parsed;
+				}
+				else
+				{
+					log(LogLevel::Warning, std::format("Ignoring thread placement for '{}': {}", pluginName, value.dump()));
+				}
+			}
+		}
+	}
+
+	if (j.contains("pauseRetention"))
+	{
+		constexpr std::uint64_t bytesPerMB = 1024 * 1024;
+		const auto& retention = j["pauseRetention"];
+
+		m_config.pauseRetention.memoryPackets = retention.value("memoryPackets", m_config.pauseRetention.memoryPackets);
+		m_config.pauseRetention.maxSpillBytes = retention.value("maxSpill_mb", m_config.pauseRetention.maxSpillBytes / bytesPerMB) * bytesPerMB;
+		m_config.pauseRetention.spillDirectory = retention.value("spillDirectory", std::string{});
+
+		if (retention.contains("replaySpeed"))
+		{
+			if (const auto speed = parseReplaySpeed(retention["replaySpeed"]))
+			{
+				m_config.pauseReplaySpeed = *speed;
+			}
+			else if (const auto& speed = retention["replaySpeed"];
+			         (speed.is_string() && speed.get<std::string>() == "realTime") || (speed.is_number() && speed.get<double>() > 0.0))
+			{
+				// Real time used to be accepted, so say why it isn't rather than only that it didn't parse
+				log(LogLevel::Error, std::format("Ignoring pause replaySpeed {} - a replay at real time or slower never catches up with "
+					"the packets arriving behind it, so the backlog would only grow, and the slowest accepted is {}x. Use "
+					"\"asFastAsPossible\" or a multiple of at least {}", speed.dump(), DataPacketRegistry::minReplaySpeed, DataPacketRegistry::minReplaySpeed));
+			}
+			else
+			{
+				log(LogLevel::Warning, std::format("Ignoring pause replaySpeed {} - use \"asFastAsPossible\" or a multiple of at least {}",
+					retention["replaySpeed"].dump(), DataPacketRegistry::minReplaySpeed));
+			}
+		}
+	}
+
+	if (j.contains("activation"))
+	{
+		for (const auto& [pluginName, value] : j["activation"].items())
+		{
+			if (const auto activation = parsePluginActivation(value))
+			{
+				m_config.activation[pluginName] = *activation;
+			}
+			else
+			{
+				log(LogLevel::Warning, std::format("Ignoring unknown activation policy for '{}': {}", pluginName, value.dump()));
+			}
+		}
+	}
 
 	return true;
 }
@@ -138,10 +435,67 @@ bool PluginManager::saveConfig() const
 	{
 		{"autoScan", m_config.autoScan},
 		{"pluginDirectory", m_config.pluginDirectory},
-		{"pluginScanInterval_seconds", m_config.pluginScanInterval.count()}
+		{"pluginScanInterval_seconds", m_config.pluginScanInterval.count()},
+		{"pluginChangeDebounce_ms", m_config.pluginChangeDebounce.count()},
+		{"parallelLoading", m_config.parallelLoading},
+		{"loadThreads", m_config.loadThreads},
+		{"lazyBinding", m_config.lazyBinding},
+		{"descriptorCache", m_config.descriptorCache},
+		{"autoReload", m_config.autoReload},
+		{"reloadDrainTimeout_ms", m_config.reloadDrainTimeout.count()},
+		{"isolatedPlugins", m_config.isolatedPlugins},
+		{"watchdog", m_config.watchdog},
+		{"tickDeadline_ms", m_config.tickDeadline.count()},
+		{"handlerDeadline_ms", m_config.handlerDeadline.count()},
+		{"watchdogStrikes", m_config.watchdogStrikes},
+		{"overrunAction", toString(m_config.overrunAction)}
 		// add enabled plugins
 	};
 
+	nlohmann::json activation = nlohmann::json::object();
+	for (const auto& [pluginName, pluginActivation] : m_config.activation)
+	{
+		activation[pluginName] = {
+			{"policy", toString(pluginActivation.policy)},
+			{"delay_seconds", pluginActivation.delay.count()}
+		};
+	}
+	json["activation"] = activation;
+
+	nlohmann::json memoryBudgets = nlohmann::json::object();
+	for (const auto& [pluginName, budget] : m_config.memoryBudgets)
+	{
+		memoryBudgets[pluginName] = {
+			{"warn_mb", budget.warnBytes / (1024 * 1024)},
+			{"limit_mb", budget.limitBytes / (1024 * 1024)}
+		};
+	}
+	json["memoryBudgets"] = memoryBudgets;
+
+	nlohmann::json overrunActions = nlohmann::json::object();
+	for (const auto& [pluginName, action] : m_config.overrunActions)
+	{
+		overrunActions[pluginName] = toString(action);
+	}
+	json["overrunActions"] = overrunActions;
+
+	nlohmann::json pluginThreadPlacement = nlohmann::json::object();
+	for (const auto& [pluginName, placement] : m_config.pluginThreadPlacement)
+	{
+		pluginThreadPlacement[pluginName] = toJson(placement);
+	}
+	json["threadPlacement"] = {
+		{"engine", toJson(m_config.engineThreadPlacement)},
+		{"plugins", pluginThreadPlacement}
+	};
+
+	json["pauseRetention"] = {
+		{"memoryPackets", m_config.pauseRetention.memoryPackets},
+		{"maxSpill_mb", m_config.pauseRetention.maxSpillBytes / (1024 * 1024)},
+		{"spillDirectory", m_config.pauseRetention.spillDirectory.string()},
+		{"replaySpeed", m_config.pauseReplaySpeed}
+	};
+
 	file << std::setw(4) << json << "\n";
 	return true;
 }
@@ -154,21 +508,47 @@ void PluginManager::init()
 {
 	if(loadConfig())
 	{
+		validateThreadPlacement();
+
+		// Before any plugin loads, so none of them run unwatched
+		if(m_config.watchdog)
+		{
+			m_watchdog = std::make_unique<PluginWatchdog>(m_baseLogger, m_config.tickDeadline, m_config.handlerDeadline, m_config.engineThreadPlacement);
+		}
+
+		if(m_config.descriptorCache)
+		{
+			m_descriptorCache = std::make_unique<PluginDescriptorCache>(m_baseLogger,
+				getPortableConfigPath().parent_path() / "plugin_descriptor_cache.json",
+				getExecutableDir() / descriptorProbeName);
+			m_descriptorCache->load();
+		}
+
 		const auto pluginFolderLoc = getExecutableDir() / m_config.pluginDirectory;
 		m_baseLogger.log(LogLevel::Info, std::format("Checking plugin folder: {}", pluginFolderLoc.string()));
 		scanPluginsFolder(std::format("{}", pluginFolderLoc.string()));
 
 		log(LogLevel::Info, std::format("Loading previously enabled Plugin [{}]", join_range(m_config.enabledPluginsOnStartup)));
 
-		for(const std::string& pluginName : m_config.enabledPluginsOnStartup)
+		std::vector<PluginInfo> startupPlugins;
 		{
-			auto knownPlugin = m_discoveredPlugins.find(pluginName);
-			if(knownPlugin != m_discoveredPlugins.end())
+			std::lock_guard lock(m_discoveredMutex);
+			for(const std::string& pluginName : m_config.enabledPluginsOnStartup)
 			{
-				loadPlugin(knownPlugin->second.path, knownPlugin->second.name);
+				auto knownPlugin = m_discoveredPlugins.find(pluginName);
+				if(knownPlugin != m_discoveredPlugins.end())
+				{
+					startupPlugins.push_back(knownPlugin->second);
+				}
 			}
 		}
 
+		if(!startupPlugins.empty())
+		{
+			m_startupLoadReport = loadPlugins(startupPlugins, true);
+			log(LogLevel::Info, std::format("Startup plugin load report\n{}", m_startupLoadReport.format()));
+		}
+
 		if(m_config.autoScan)
 		{
 			startPluginAutoScan();
@@ -183,10 +563,10 @@ void PluginManager::init()
 
 bool PluginManager::isPluginFolderWatcherEnabled() const
 {
-	return m_scanningThread.joinable();
+	return m_folderWatcher != nullptr;
 }
 
-PluginInfo& PluginManager::getOrAddPluginInfo(const std::string& pluginName, const std::filesystem::path& pluginPath)
+PluginInfo PluginManager::getOrAddPluginInfo(const std::string& pluginName, const std::filesystem::path& pluginPath)
 {
 	std::string name = pluginPath.stem().string();
 
@@ -195,13 +575,15 @@ PluginInfo& PluginManager::getOrAddPluginInfo(const std::string& pluginName, con
 		name = pluginName;
 	}
 
-	// Insert if not exists; get reference either way
+	// Insert if not exists; copied under the lock either way
+	std::lock_guard lock(m_discoveredMutex);
 	auto [iter, inserted] = m_discoveredPlugins.try_emplace(name, PluginInfo
 		{
 			.name = name,
 			.path = pluginPath,
 			.loaded = false,
-			.errorMessage = ""
+			.errorMessage = "",
+			.descriptor = nullptr
 		});
 
 	return iter->second;
@@ -210,6 +592,8 @@ PluginInfo& PluginManager::getOrAddPluginInfo(const std::string& pluginName, con
 void PluginManager::removeKnownPlugin(const std::string& name)
 {
 	log(LogLevel::Info, std::format("'{}' removed from known plugins", name));
+
+	std::lock_guard lock(m_discoveredMutex);
 	m_discoveredPlugins.erase(name);
 }
 
@@ -222,178 +606,965 @@ void PluginManager::scanPluginsFolder(const std::string& pluginDirectory)
 		return;
 	}
 
+	std::vector<std::filesystem::path> pluginFiles;
 	for (const auto& entry : std::filesystem::directory_iterator(pluginDirectory))
 	{
 		if (!entry.is_regular_file()) continue;
 		if (entry.path().extension() != PLUGIN_EXT) continue;
 
-		//Add this plugin to the list
-		const std::string discoveredPluginName = entry.path().stem().string();
-
-		const auto it = m_discoveredPlugins.find(discoveredPluginName);
-		if(it == m_discoveredPlugins.end())
-		{
-			log(LogLevel::Info, std::format("Found plugin '{}'", discoveredPluginName));
-			m_discoveredPlugins.emplace(entry.path().stem().string(),
-				PluginInfo
-				{
-					.name = discoveredPluginName,
-					.path = entry.path(),
-					.loaded = false,
-					.errorMessage = ""
-				}
-			);
-		}
+		pluginFiles.push_back(entry.path());
 	}
-}
 
-
-std::unordered_map<std::string, PluginInfo> PluginManager::getDiscoveredPlugins() const
-{
-	return m_discoveredPlugins;
+	addDiscoveredPlugins(describePluginFiles(pluginFiles));
 }
 
-bool PluginManager::loadPlugin(const std::filesystem::path& path, const std::string& name)
+std::vector<PluginInfo> PluginManager::describePluginFiles(const std::vector<std::filesystem::path>& pluginFiles) const
 {
-	std::string pluginName = name.empty() ? path.stem().string() : name;
+	std::vector<PluginInfo> plugins;
+	plugins.reserve(pluginFiles.size());
 
-	if (!std::filesystem::exists(path))
+	for (const auto& path : pluginFiles)
 	{
-		log(LogLevel::Error, std::format("Could not find plugin '{}' at {}.", pluginName, path.string()));
-		removeKnownPlugin(pluginName);
-		return false;
+		plugins.push_back(PluginInfo{
+			.name = path.stem().string(),
+			.path = path,
+			.loaded = false,
+			.errorMessage = "",
+			.descriptor = nullptr
+		});
 	}
 
-	// Already loaded
-	if (m_loadedPlugins.contains(pluginName))
+	// Only new or changed files are probed, the rest is a stat against the cache
+	if (m_descriptorCache)
 	{
-		log(LogLevel::Warning, std::format("Plugin '{}' is already loaded.", pluginName));
-		return true;
+		runInParallel(plugins.size(), getLoadThreadCount(plugins.size()), m_config.engineThreadPlacement, [&](std::size_t i)
+		{
+			if (auto descriptor = m_descriptorCache->getDescriptor(plugins[i].path))
+			{
+				plugins[i].descriptor = std::move(*descriptor);
+			}
+		});
+
+		m_descriptorCache->save();
 	}
 
-	// Get or create plugin metadata
-	PluginInfo& info = getOrAddPluginInfo(pluginName, path);
+	return plugins;
+}
+
+void PluginManager::addDiscoveredPlugins(std::vector<PluginInfo> plugins)
+{
+	std::vector<std::string> rebuiltPlugins;
 
-	try
 	{
-		// Load shared library
-		LibraryHandle handle = LoadSharedLibrary(path.string().c_str());
-		if (!handle)
+		std::lock_guard lock(m_discoveredMutex);
+		for (auto& plugin : plugins)
 		{
-			info.errorMessage = getError();
-			log(LogLevel::Error, std::format("Failed to load plugin '{}': {}", pluginName, info.errorMessage));
+			const auto it = m_discoveredPlugins.find(plugin.name);
+			if (it == m_discoveredPlugins.end())
+			{
+				log(LogLevel::Info, std::format("Found plugin '{}'", plugin.name));
+				m_discoveredPlugins.emplace(plugin.name, std::move(plugin));
+				continue;
+			}
 
-			removeKnownPlugin(pluginName);
-			return false;
-		}
+			// The cache hands back the same descriptor until the file's content changes
+			if (it->second.loaded && it->second.descriptor && plugin.descriptor && it->second.descriptor != plugin.descriptor)
+			{
+				rebuiltPlugins.push_back(plugin.name);
+			}
 
-		//Add descriptor check
-		const auto pluginDescriptorFunc = reinterpret_cast<PluginDescriptor*(*)()>(GetSymbol(handle, "getPluginDescriptor"));
+			if (plugin.descriptor)
+			{
+				it->second.descriptor = std::move(plugin.descriptor); // picks up a rebuilt plugin
+			}
+		}
+	}
 
-		if(!pluginDescriptorFunc)
+	for (const auto& name : rebuiltPlugins)
+	{
+		if (!m_config.autoReload)
 		{
-			info.errorMessage = getError();
-			UnloadLibrary(handle);
-			log(LogLevel::Error, std::format("Missing 'getPluginDescriptor' function for '{}':{} - Did you add it the dll EXPORT section?", pluginName, info.errorMessage));
-			removeKnownPlugin(pluginName);
-			return false;
+			log(LogLevel::Info, std::format("Plugin '{}' changed on disk, the loaded copy is unaffected", name));
+			continue;
 		}
 
-		auto formattedDescriptor = formatPluginDescriptor(pluginDescriptorFunc());
-		if(formattedDescriptor.has_value())
+		if (const auto reloaded = reloadPlugin(name); !reloaded)
 		{
-			log(LogLevel::Info, formattedDescriptor.value());
+			log(LogLevel::Error, std::format("Could not reload '{}': {}", name, reloaded.error()));
 		}
-		else
+	}
+}
+
+void PluginManager::removeDiscoveredPlugins(const std::vector<std::filesystem::path>& pluginFiles)
+{
+	std::lock_guard lock(m_discoveredMutex);
+	for (const auto& path : pluginFiles)
+	{
+		if (m_descriptorCache)
 		{
-			log(LogLevel::Error, formattedDescriptor.error());
+			m_descriptorCache->forget(path);
 		}
 
+		const std::string name = path.stem().string();
+		const auto it = m_discoveredPlugins.find(name);
+		if (it == m_discoveredPlugins.end() || it->second.path != path)
+		{
+			continue;
+		}
 
-		//Check that the context provides the REQUIRED services; otherwise stop trying to load the plugin.
-		// We will however, still load plugins if OPTIONAL services are not available
+		if (it->second.loaded || m_dormantPlugins.contains(name))
+		{
+			log(LogLevel::Warning, std::format("Plugin '{}' was removed from disk while loaded", name));
+			continue;
+		}
 
+		log(LogLevel::Info, std::format("Plugin '{}' was removed", name));
+		m_discoveredPlugins.erase(it);
+	}
 
+	if (m_descriptorCache)
+	{
+		m_descriptorCache->save();
+	}
+}
 
-		// Load init symbol
-		auto pluginEntryFunction = reinterpret_cast<IPlugin*(*)()>(GetSymbol(handle, "loadPlugin"));
-		if (!pluginEntryFunction)
-		{
-			info.errorMessage = getError();
-			UnloadLibrary(handle);
-			log(LogLevel::Error, std::format("Missing 'initPlugin' in '{}':{}", pluginName, info.errorMessage));
-			return false;
-		}
+void PluginManager::onPluginFolderChanges(std::vector<PluginFolderChange> changes)
+{
+	std::vector<std::filesystem::path> changedFiles;
+	std::vector<std::filesystem::path> removedFiles;
 
+	for (auto& change : changes)
+	{
+		(change.kind == PluginFolderChange::Kind::Removed ? removedFiles : changedFiles).push_back(std::move(change.path));
+	}
 
-		auto pluginLogger = createPluginLogger(pluginName);
+	// Probing stays on the watcher thread, only the bookkeeping is handed to the main thread
+	m_discoveryUpdates.push([this, discovered = describePluginFiles(changedFiles), removed = std::move(removedFiles)]() mutable
+	{
+		addDiscoveredPlugins(std::move(discovered));
+		removeDiscoveredPlugins(removed);
+	});
+}
 
-		// Construct plugin and context(currently just one type of Context)
-		auto assignedPluginContext = std::make_unique<PluginRuntimeContext>(pluginLogger, m_dataPacketRegistry, pluginName, m_services);
 
-		assignedPluginContext->registerService<ILogger>(pluginLogger);
+std::unordered_map<std::string, PluginInfo> PluginManager::getDiscoveredPlugins() const
+{
+	std::lock_guard lock(m_discoveredMutex);
+	return m_discoveredPlugins;
+}
 
-		if(const auto restClient = m_services.getService<IPluginRESTService>())
-		{
-			assignedPluginContext->registerService<IPluginRESTService>(restClient); // This might be wrong
-		}
+bool PluginManager::loadPlugin(const std::filesystem::path& path, const std::string& name)
+{
+	const std::string pluginName = name.empty() ? path.stem().string() : name;
 
-		if(const auto uiService = m_services.getService<IPluginUIService>())
-		{
-			assignedPluginContext->registerService<IPluginUIService>(uiService);
-		}
+	// Asking for a dormant plugin by hand activates it
+	if (m_dormantPlugins.contains(pluginName))
+	{
+		return activatePlugin(pluginName);
+	}
 
-		std::unique_ptr<IPlugin> plugin(pluginEntryFunction());
+	const auto report = loadPlugins({PluginInfo{
+		.name = pluginName,
+		.path = path,
+		.loaded = false,
+		.errorMessage = "",
+		.descriptor = nullptr
+	}});
 
-		/*assignedPluginContext->setImGuiContextFunctions(
-			[]() -> void*
-				{
-					return static_cast<void*>(ImGui::GetCurrentContext());
-				},
-			[](void* ctx) -> bool
-				{
-					ImGui::SetCurrentContext(static_cast<ImGuiContext*>(ctx));
-					return ImGui::GetCurrentContext() == static_cast<ImGuiContext*>(ctx);
-				}
-			);*/
+	const PluginLoadStatus status = report.plugins.front().status;
+	return status == PluginLoadStatus::Loaded || status == PluginLoadStatus::AlreadyLoaded;
+}
 
-		log(LogLevel::Debug, std::format("ImGui context functions set for plugin '{}'", pluginName));
+PluginLoadReport PluginManager::loadPlugins(const std::vector<PluginInfo>& plugins, bool applyActivationPolicy)
+{
+	VECTORIUM_TRACE_ZONE("PluginManager::loadPlugins");
 
-		auto loadResult = plugin->onPluginLoad(*assignedPluginContext);
+	const auto start = std::chrono::steady_clock::now();
 
+	std::vector<PluginLoadJob> jobs(plugins.size());
+	for (std::size_t i = 0; i < plugins.size(); ++i)
+	{
+		jobs[i].name = plugins[i].name.empty() ? plugins[i].path.stem().string() : plugins[i].name;
+		jobs[i].path = plugins[i].path;
+		jobs[i].timing.name = jobs[i].name;
 
-		// Handle issue loading plugin
-		if(!loadResult.has_value())
+		if (applyActivationPolicy)
 		{
-			info.errorMessage = loadResult.error();
-			log(LogLevel::Error, std::format("Plugin '{}' failed to load: {}", pluginName, loadResult.error()));
-
+			if (const auto activation = m_config.activation.find(jobs[i].name); activation != m_config.activation.end())
+			{
+				jobs[i].activation = activation->second;
+			}
+		}
+	}
+
+	PluginLoadReport report;
+	report.threadCount = getLoadThreadCount(jobs.size());
+
+	// A plugin whose cached descriptor shows its required services can't be met isn't even opened
+	std::vector<std::size_t> toOpen;
+	for (std::size_t i = 0; i < jobs.size(); ++i)
+	{
+		jobs[i].cachedDescriptor = findCachedDescriptor(jobs[i].name, jobs[i].path);
+		toOpen.push_back(i);
+	}
+
+	planLoadOrder(jobs, toOpen);
+	std::erase_if(toOpen, [&](std::size_t i) { return jobs[i].isBlocked; });
+
+	// Open every library and read its descriptor. The loader lock serialises part of dlopen/LoadLibrary, but file I/O,
+	// relocation and static initialisers of independent libraries still overlap
+	runInParallel(toOpen.size(), report.threadCount, m_config.engineThreadPlacement, [&](std::size_t i)
+	{
+		PluginLoadJob& job = jobs[toOpen[i]];
+
+		const auto openStart = std::chrono::steady_clock::now();
+		openPluginLibrary(job);
+		job.timing.openTime = elapsedSince(openStart);
+	});
+
+	// With every descriptor read, order the plugins so the ones providing a service are set up before those requiring it
+	std::vector<std::size_t> ready;
+	for (std::size_t i = 0; i < jobs.size(); ++i)
+	{
+		if ((jobs[i].handle || jobs[i].isIsolated) && jobs[i].timing.status != PluginLoadStatus::Dormant)
+		{
+			ready.push_back(i);
+		}
+	}
+
+	bool hasNewProviders = false;
+
+	for (std::vector<std::size_t>& stage : planLoadOrder(jobs, ready))
+	{
+		// A provider of an earlier stage that failed leaves the plugins requiring it waiting
+		std::erase_if(stage, [&](std::size_t i) { return !checkRequiredServices(jobs[i]) || !reservePluginName(jobs[i]); });
+
+		// Network plugins go first - their onPluginLoad tends to block on I/O, so starting them early hides the most time
+		// behind the others
+		std::ranges::stable_partition(stage, [&](std::size_t i) { return needsNetworkAccess(jobs[i].descriptor); });
+
+		runInParallel(stage.size(), report.threadCount, m_config.engineThreadPlacement, [&](std::size_t i)
+		{
+			PluginLoadJob& job = jobs[stage[i]];
+
+			const auto setupStart = std::chrono::steady_clock::now();
+			setupPlugin(job);
+			job.timing.setupTime = elapsedSince(setupStart);
+		});
+
+		for (const std::size_t i : stage)
+		{
+			hasNewProviders |= jobs[i].timing.status == PluginLoadStatus::Loaded && jobs[i].descriptor && !jobs[i].descriptor->provides.empty();
+		}
+	}
+
+	// Publish on this thread, in the order asked for, so the loaded set and the log read the same on every run
+	report.plugins.reserve(jobs.size());
+	bool hasNewDormantPlugins = false;
+
+	for (PluginLoadJob& job : jobs)
+	{
+		PluginLoadTiming timing = job.timing; // a dormant job is moved away on commit
+		timing.status = commitPlugin(job);
+
+		hasNewDormantPlugins |= (timing.status == PluginLoadStatus::Dormant);
+		report.plugins.push_back(std::move(timing));
+	}
+
+	if (hasNewDormantPlugins)
+	{
+		updatePacketWatches();
+	}
+
+	report.wallTime = elapsedSince(start);
+
+	// Plugins deferred by an earlier batch may have been waiting for what these provide
+	if (hasNewProviders && !m_deferredPlugins.empty())
+	{
+		retryDeferredPlugins();
+	}
+
+	return report;
+}
+
+bool PluginManager::checkRequiredServices(PluginLoadJob& job) const
+{
+	const auto missingService = job.cachedDescriptor ? findMissingRequiredService(*job.cachedDescriptor) : std::nullopt;
+	if (!missingService)
+	{
+		return true;
+	}
+
+	if (job.handle)
+	{
+		UnloadLibrary(job.handle);
+		job.handle = nullptr;
+	}
+
+	job.timing.status = PluginLoadStatus::Deferred;
+	job.timing.error = std::format("Waiting for required service '{}'", *missingService);
+	return false;
+}
+
+std::vector<std::vector<std::size_t>> PluginManager::planLoadOrder(std::vector<PluginLoadJob>& jobs, const std::vector<std::size_t>& candidates) const
+{
+	PluginDependencyResolver resolver([this](std::string_view typeName) { return findRegisteredServiceVersion(typeName); });
+
+	std::vector<std::size_t> jobOfPlugin;
+	for (const std::size_t i : candidates)
+	{
+		// Already loaded - left for openPluginLibrary to report
+		if (!jobs[i].isReload && getLoadedPlugins().contains(jobs[i].name))
+		{
+			continue;
+		}
+
+		resolver.addPlugin(jobs[i].name, jobs[i].cachedDescriptor);
+		jobOfPlugin.push_back(i);
+	}
+
+	PluginLoadPlan plan = resolver.resolve();
+
+	for (const BlockedPlugin& blocked : plan.blocked)
+	{
+		PluginLoadJob& job = jobs[jobOfPlugin[blocked.index]];
+
+		if (job.handle)
+		{
+			UnloadLibrary(job.handle);
+			job.handle = nullptr;
+		}
+
+		job.isBlocked = true;
+		job.timing.status = blocked.isDeferred ? PluginLoadStatus::Deferred : PluginLoadStatus::Failed;
+		job.timing.error = blocked.reason;
+
+		if (!blocked.isDeferred)
+		{
+			log(LogLevel::Error, std::format("Can't load plugin '{}': {}", job.name, blocked.reason));
+		}
+	}
+
+	for (auto& stage : plan.stages)
+	{
+		for (std::size_t& plugin : stage)
+		{
+			plugin = jobOfPlugin[plugin];
+		}
+	}
+
+	return std::move(plan.stages);
+}
+
+PluginLoadReport PluginManager::retryDeferredPlugins()
+{
+	if (m_deferredPlugins.empty())
+	{
+		return {};
+	}
+
+	const auto deferred = std::exchange(m_deferredPlugins, {});
+	log(LogLevel::Info, std::format("Retrying {} deferred plugin(s)", deferred.size()));
+
+	auto report = loadPlugins(deferred, true);
+	log(LogLevel::Info, std::format("Deferred plugin load report\n{}", report.format()));
+
+	return report;
+}
+
+const PluginLoadReport& PluginManager::getStartupLoadReport() const
+{
+	return m_startupLoadReport;
+}
+
+std::vector<std::string> PluginManager::getDeferredPlugins() const
+{
+	std::vector<std::string> names;
+	names.reserve(m_deferredPlugins.size());
+
+	for (const auto& plugin : m_deferredPlugins)
+	{
+		names.push_back(plugin.name);
+	}
+
+	return names;
+}
+
+bool PluginManager::activatePlugin(const std::string& name)
+{
+	auto dormant = m_dormantPlugins.extract(name);
+	if (dormant.empty())
+	{
+		return getLoadedPlugins().contains(name);
+	}
+
+	PluginLoadJob& job = dormant.mapped();
+	log(LogLevel::Info, std::format("Activating plugin '{}' ({})", name, toString(job.activation.policy)));
+
+	// What it requires may have gone since it was opened
+	if (checkRequiredServices(job) && reservePluginName(job))
+	{
+		const auto start = std::chrono::steady_clock::now();
+		setupPlugin(job);
+		job.timing.setupTime = elapsedSince(start);
+	}
+
+	const PluginLoadStatus status = commitPlugin(job);
+	updatePacketWatches();
+
+	if (status == PluginLoadStatus::Loaded)
+	{
+		log(LogLevel::Info, std::format("Activated plugin '{}' in {:.2f}ms", name, static_cast<double>(job.timing.setupTime.count()) / 1000.0));
+	}
+
+	return status == PluginLoadStatus::Loaded || status == PluginLoadStatus::AlreadyLoaded;
+}
+
+std::vector<std::string> PluginManager::getDormantPlugins(PluginActivationPolicy policy) const
+{
+	std::vector<std::string> names;
+
+	for (const auto& [name, job] : m_dormantPlugins)
+	{
+		if (job.activation.policy == policy)
+		{
+			names.push_back(name);
+		}
+	}
+
+	std::ranges::sort(names);
+	return names;
+}
+
+void PluginManager::activateDuePlugins()
+{
+	std::vector<std::type_index> triggeredTypes;
+	if (m_packetActivationPending.exchange(false, std::memory_order_acq_rel))
+	{
+		std::lock_guard lock(m_triggeredPacketsMutex);
+		triggeredTypes.swap(m_triggeredPacketTypes);
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	std::vector<std::string> due;
+
+	for (const auto& [name, job] : m_dormantPlugins)
+	{
+		switch (job.activation.policy)
+		{
+			case PluginActivationPolicy::Scheduled:
+				if (now >= job.activateAt)
+				{
+					due.push_back(name);
+				}
+				break;
+
+			case PluginActivationPolicy::OnFirstPacket:
+			{
+				const bool acceptsAnyPacket = !job.descriptor || job.descriptor->packetTypes.empty();
+				const bool isTriggered = std::ranges::any_of(triggeredTypes, [&](std::type_index type)
+				{
+					return acceptsAnyPacket || std::ranges::find(job.descriptor->packetTypes, type) != job.descriptor->packetTypes.end();
+				});
+
+				if (isTriggered)
+				{
+					due.push_back(name);
+				}
+				break;
+			}
+
+			case PluginActivationPolicy::Eager:
+			case PluginActivationPolicy::OnFirstUIOpen:
+				break;
+		}
+	}
+
+	for (const auto& name : due)
+	{
+		activatePlugin(name);
+	}
+}
+
+void PluginManager::updatePacketWatches()
+{
+	std::vector<std::type_index> watchedTypes;
+	bool watchAllTypes = false;
+
+	for (const auto& job : m_dormantPlugins | std::views::values)
+	{
+		if (job.activation.policy != PluginActivationPolicy::OnFirstPacket)
+		{
+			continue;
+		}
+
+		if (!job.descriptor || job.descriptor->packetTypes.empty())
+		{
+			watchAllTypes = true;
+		}
+		else
+		{
+			watchedTypes.insert(watchedTypes.end(), job.descriptor->packetTypes.begin(), job.descriptor->packetTypes.end());
+		}
+	}
+
+	if (watchedTypes.empty() && !watchAllTypes)
+	{
+		if (m_packetWatchesActive)
+		{
+			m_dataPacketRegistry.clearPacketWatches();
+			m_packetWatchesActive = false;
+		}
+		return;
+	}
+
+	m_dataPacketRegistry.setPacketWatches(std::move(watchedTypes), watchAllTypes, [this](std::type_index packetType)
+	{
+		onWatchedPacket(packetType);
+	});
+	m_packetWatchesActive = true;
+}
+
+void PluginManager::onWatchedPacket(std::type_index packetType)
+{
+	// Runs once per watched packet until the next tick activates the plugin, so keep it short
+	std::lock_guard lock(m_triggeredPacketsMutex);
+	if (std::ranges::find(m_triggeredPacketTypes, packetType) == m_triggeredPacketTypes.end())
+	{
+		m_triggeredPacketTypes.push_back(packetType);
+	}
+
+	m_packetActivationPending.store(true, std::memory_order_release);
+}
+
+void PluginManager::openPluginLibrary(PluginLoadJob& job) const
+{
+	VECTORIUM_TRACE_ZONE_DETAIL("PluginManager::openPluginLibrary", TraceRecorder::instance().internName(job.name));
+
+	const auto fail = [&](std::string error, bool forgetPlugin)
+	{
+		if (job.handle)
+		{
+			UnloadLibrary(job.handle);
+			job.handle = nullptr;
+		}
+
+		job.timing.status = PluginLoadStatus::Failed;
+		job.timing.error = std::move(error);
+		job.forgetPlugin = forgetPlugin;
+	};
+
+	// Already loaded - a reload opens its copy alongside on purpose
+	if (!job.isReload && getLoadedPlugins().contains(job.name))
+	{
+		job.timing.status = PluginLoadStatus::AlreadyLoaded;
+		return;
+	}
+
+	if (!std::filesystem::exists(job.path))
+	{
+		log(LogLevel::Error, std::format("Could not find plugin '{}' at {}.", job.name, job.path.string()));
+		fail("File not found", true);
+		return;
+	}
+
+	if (isIsolatedPlugin(job.name))
+	{
+#ifdef VECTORIUM_PLUGIN_ISOLATION
+		// Its host process opens it in setupPlugin, so a plugin that crashes while loading only takes the host down
+		job.isIsolated = true;
+		return;
+#else
+		log(LogLevel::Warning, std::format("Plugins can't be isolated on this platform, loading '{}' in-process", job.name));
+#endif
+	}
+
+	try
+	{
+		// Only the descriptor of a dormant plugin is read now, so let its functions bind when they are first called
+		const bool isDormant = job.activation.policy != PluginActivationPolicy::Eager;
+
+		// Load shared library
+		job.handle = (isDormant && m_config.lazyBinding)
+			? LoadSharedLibraryLazy(job.path.string().c_str())
+			: LoadSharedLibrary(job.path.string().c_str());
+		if (!job.handle)
+		{
+			std::string error = getError();
+			log(LogLevel::Error, std::format("Failed to load plugin '{}': {}", job.name, error));
+			fail(std::move(error), true);
+			return;
+		}
+
+		//Add descriptor check
+		const auto pluginDescriptorFunc = reinterpret_cast<PluginDescriptor*(*)()>(GetSymbol(job.handle, "getPluginDescriptor"));
+
+		if(!pluginDescriptorFunc)
+		{
+			std::string error = getError();
+			log(LogLevel::Error, std::format("Missing 'getPluginDescriptor' function for '{}':{} - Did you add it the dll EXPORT section?", job.name, error));
+			fail(std::move(error), true);
+			return;
+		}
+
+		job.descriptor = pluginDescriptorFunc();
+		if (job.descriptor)
+		{
+			job.cachedDescriptor = std::make_shared<const CachedPluginDescriptor>(CachedPluginDescriptor::fromDescriptor(*job.descriptor));
+		}
+
+		auto formattedDescriptor = formatPluginDescriptor(job.descriptor);
+		if(formattedDescriptor.has_value())
+		{
+			log(LogLevel::Info, formattedDescriptor.value());
+		}
+		else
+		{
+			log(LogLevel::Error, formattedDescriptor.error());
+		}
+
+		// Load init symbol
+		job.createPlugin = reinterpret_cast<IPlugin*(*)()>(GetSymbol(job.handle, "loadPlugin"));
+		if (!job.createPlugin)
+		{
+			std::string error = getError();
+			log(LogLevel::Error, std::format("Missing 'initPlugin' in '{}':{}", job.name, error));
+			fail(std::move(error), false);
+			return;
+		}
+
+		if (isDormant)
+		{
+			job.timing.status = PluginLoadStatus::Dormant;
+		}
+	}
+	catch (const std::exception& ex)
+	{
+		log(LogLevel::Error, std::format("Exception while loading plugin '{}': {}", job.name, ex.what()));
+		fail(ex.what(), false);
+	}
+}
+
+void PluginManager::setupPlugin(PluginLoadJob& job) const
+{
+	VECTORIUM_TRACE_ZONE_DETAIL("PluginManager::setupPlugin", TraceRecorder::instance().internName(job.name));
+
+	try
+	{
+		auto pluginLogger = createPluginLogger(job.name);
+
+		// Construct plugin and context(currently just one type of Context)
+		auto assignedPluginContext = std::make_unique<PluginRuntimeContext>(pluginLogger, m_dataPacketRegistry, job.name, m_services);
+		assignedPluginContext->setStagingHandlers(job.isReload);
+		assignedPluginContext->setThreadPlacement(resolveThreadPlacement(job.name));
+		assignedPluginContext->setEngineEventBus(m_events);
+
+		// Charged from here on, so what it allocates while loading counts too
+		const auto budget = m_config.memoryBudgets.find(job.name);
+		auto memoryAccount = std::make_shared<PluginMemoryAccount>(job.name, budget != m_config.memoryBudgets.end() ? budget->second : PluginMemoryBudget{});
+		assignedPluginContext->setMemoryAccount(memoryAccount);
+
+		if (auto* uiLogSink = dynamic_cast<UILogSink*>(m_uiLogSink.get()))
+		{
+			uiLogSink->setMemoryResource(job.name, memoryAccount);
+		}
+
+		// The plugin's own logger. The REST and UI services follow the container, so a swapped backend reaches it live.
+		assignedPluginContext->registerService<ILogger>(pluginLogger);
+
+		if (job.descriptor && !job.isIsolated)
+		{
+			assignedPluginContext->setProvidedServices(job.descriptor->provides);
+		}
+
+		std::unique_ptr<IPlugin> plugin(job.isIsolated ? createIsolatedPlugin(job) : job.createPlugin());
+		if (!plugin)
+		{
+			throw std::runtime_error("'loadPlugin' returned nullptr");
+		}
+
+		// Handlers it registers while loading are timed from the start. A reload's take it over when they go live.
+		auto activity = std::make_shared<PluginActivity>(job.name);
+		activity->setHomeNode(CpuTopology::get().getPlacementNode(assignedPluginContext->getThreadPlacement()));
+		if (m_watchdog)
+		{
+			m_watchdog->track(activity);
+		}
+
+		if (!job.isReload)
+		{
+			m_dataPacketRegistry.setPluginActivity(job.name, activity);
+		}
+
+		auto loadResult = plugin->onPluginLoad(*assignedPluginContext);
+
+		// Handle issue loading plugin
+		if(!loadResult.has_value())
+		{
+			log(LogLevel::Error, std::format("Plugin '{}' failed to load: {}", job.name, loadResult.error()));
+
+			assignedPluginContext->withdrawProvidedServices();
 			plugin->onPluginUnload();
-			return false;
+			plugin.reset();
+
+			// Nothing it registered may outlive the library
+			assignedPluginContext->unregisterDataPacketHandler();
+			assignedPluginContext.reset();
+
+			if (job.handle)
+			{
+				UnloadLibrary(job.handle);
+				job.handle = nullptr;
+			}
+
+			job.timing.status = PluginLoadStatus::Failed;
+			job.timing.error = loadResult.error();
+			return;
+		}
+
+		// Package plugin instance
+		job.instance = std::make_unique<PluginInstance>(
+			job.handle,
+			std::move(plugin),
+			std::move(assignedPluginContext),
+			job.name,
+			std::move(activity)
+		);
+
+		job.handle = nullptr; // the instance closes it now
+		job.timing.status = PluginLoadStatus::Loaded;
+	}
+	catch (const std::exception& ex)
+	{
+		log(LogLevel::Error, std::format("Exception while loading plugin '{}': {}", job.name, ex.what()));
+
+		// The plugin and its context were destroyed while unwinding, drop anything they registered before closing the library
+		if (job.isReload)
+		{
+			m_dataPacketRegistry.discardStagedHandlers(job.name);
+		}
+		else
+		{
+			m_dataPacketRegistry.unregisterDataPacketHandlerForPlugin(job.name);
+		}
+
+		if (job.handle)
+		{
+			UnloadLibrary(job.handle);
+			job.handle = nullptr;
+		}
+
+		job.timing.status = PluginLoadStatus::Failed;
+		job.timing.error = ex.what();
+	}
+}
+
+bool PluginManager::isIsolatedPlugin(const std::string& name) const
+{
+	return std::ranges::find(m_config.isolatedPlugins, name) != m_config.isolatedPlugins.end();
+}
+
+IPlugin* PluginManager::createIsolatedPlugin(const PluginLoadJob& job) const
+{
+#ifdef VECTORIUM_PLUGIN_ISOLATION
+	return new RemotePlugin(job.name, job.path, m_dataPacketRegistry, RemotePluginOptions{ .hostExecutable = getExecutableDir() / pluginHostName });
+#else
+	(void)job;
+	return nullptr;
+#endif
+}
+
+bool PluginManager::reservePluginName(PluginLoadJob& job)
+{
+	// A reload replaces the loaded instance on purpose
+	if (job.isReload)
+	{
+		return true;
+	}
+
+	// Claimed before onPluginLoad, so a second load of the same plugin never runs it or registers anything
+	{
+		std::unique_lock lock(m_pluginsMutex);
+		job.hasReservedName = !m_loadedPlugins.contains(job.name) && m_reservedPluginNames.insert(job.name).second;
+	}
+
+	if (!job.hasReservedName)
+	{
+		if (job.handle)
+		{
+			UnloadLibrary(job.handle);
+			job.handle = nullptr;
+		}
+
+		job.timing.status = PluginLoadStatus::AlreadyLoaded;
+	}
+
+	return job.hasReservedName;
+}
+
+PluginLoadStatus PluginManager::commitPlugin(PluginLoadJob& job)
+{
+	if (job.hasReservedName)
+	{
+		// Released in the same step that publishes a loaded instance, so the name is never free in between
+		std::unique_lock lock(m_pluginsMutex);
+		m_reservedPluginNames.erase(job.name);
+		job.hasReservedName = false;
+
+		if (job.timing.status == PluginLoadStatus::Loaded)
+		{
+			m_loadedPlugins.emplace(job.name, std::move(job.instance));
+			publishLoadedPlugins();
+		}
+	}
+
+	switch (job.timing.status)
+	{
+		case PluginLoadStatus::Loaded:
+		{
+			setPluginLoadState(job, true);
+			log(LogLevel::Info, std::format("Successfully loaded plugin '{}'", job.name));
+
+			m_events.publish(EngineEventType::PluginLoaded, PluginLoadedEvent{
+				.pluginName = job.name,
+				.version = job.cachedDescriptor ? job.cachedDescriptor->version : std::string{},
+				.isReload = false
+			});
+			return PluginLoadStatus::Loaded;
+		}
+
+		case PluginLoadStatus::AlreadyLoaded:
+			log(LogLevel::Warning, std::format("Plugin '{}' is already loaded.", job.name));
+			return PluginLoadStatus::AlreadyLoaded;
+
+		case PluginLoadStatus::Dormant:
+		{
+			setPluginLoadState(job, false);
+			log(LogLevel::Info, job.activation.policy == PluginActivationPolicy::Scheduled
+				? std::format("Plugin '{}' is dormant for {}s", job.name, job.activation.delay.count())
+				: std::format("Plugin '{}' is dormant until {}", job.name, toString(job.activation.policy)));
+
+			job.activateAt = std::chrono::steady_clock::now() + job.activation.delay;
+
+			const LibraryHandle handle = job.handle;
+			if (!m_dormantPlugins.try_emplace(job.name, std::move(job)).second)
+			{
+				UnloadLibrary(handle);
+			}
+			return PluginLoadStatus::Dormant;
+		}
+
+		case PluginLoadStatus::Deferred:
+			setPluginLoadState(job, false);
+			log(LogLevel::Warning, std::format("Deferred plugin '{}': {}", job.name, job.timing.error));
+
+			if (std::ranges::none_of(m_deferredPlugins, [&](const PluginInfo& plugin) { return plugin.name == job.name; }))
+			{
+				m_deferredPlugins.push_back(PluginInfo{
+					.name = job.name,
+					.path = job.path,
+					.loaded = false,
+					.errorMessage = job.timing.error,
+					.descriptor = nullptr
+				});
+			}
+			return PluginLoadStatus::Deferred;
+
+		case PluginLoadStatus::Failed:
+			if (job.forgetPlugin)
+			{
+				removeKnownPlugin(job.name);
+			}
+			else
+			{
+				setPluginLoadState(job, false);
+			}
+			return PluginLoadStatus::Failed;
+	}
+
+	return job.timing.status;
+}
+
+std::optional<std::string> PluginManager::findMissingRequiredService(const CachedPluginDescriptor& desc) const
+{
+	for (const auto& service : desc.services)
+	{
+		if (!service.required)
+		{
+			continue;
 		}
 
-		// Package plugin instance
-		auto pluginInstance = std::make_unique<PluginInstance>(
-			handle,
-			std::move(plugin),
-			std::move(assignedPluginContext),
-			pluginName
-		);
+		const auto version = findRegisteredServiceVersion(service.typeName);
+		if (!version)
+		{
+			return service.name;
+		}
 
-		info.loaded = true;
-		info.errorMessage.clear();
+		// A range that doesn't parse was already rejected by the resolver
+		if (const auto range = VersionRange::parse(service.minVersion); range && !range->contains(*version))
+		{
+			return std::format("{} {}", service.name, service.minVersion);
+		}
+	}
 
-		m_loadedPlugins.emplace(pluginName, std::move(pluginInstance));
-		log(LogLevel::Info, std::format("Successfully loaded plugin '{}'", pluginName));
+	return std::nullopt;
+}
 
-		return true;
+std::optional<SemanticVersion> PluginManager::findRegisteredServiceVersion(std::string_view typeName) const
+{
+	// Every plugin gets its own logger from its context
+	if (typeName == typeid(ILogger).name())
+	{
+		return m_services.getServiceVersionByType(typeid(ILogger)).value_or(defaultServiceVersion);
 	}
-	catch (const std::exception& ex)
+
+	return m_services.getServiceVersionByTypeName(typeName);
+}
+
+std::shared_ptr<const CachedPluginDescriptor> PluginManager::findCachedDescriptor(const std::string& name, const std::filesystem::path& path) const
+{
+	std::lock_guard lock(m_discoveredMutex);
+
+	const auto it = m_discoveredPlugins.find(name);
+	if (it == m_discoveredPlugins.end() || it->second.path != path)
 	{
-		info.errorMessage = ex.what();
-		log(LogLevel::Error, std::format("Exception while loading plugin '{}': {}", pluginName, ex.what()));
-		return false;
+		return nullptr;
+	}
+
+	return it->second.descriptor;
+}
+
+unsigned PluginManager::getLoadThreadCount(std::size_t pluginCount) const
+{
+	if (!m_config.parallelLoading || pluginCount < 2)
+	{
+		return 1;
 	}
+
+	// onPluginLoad is often waiting on the network rather than the CPU, so use more threads than cores on small machines
+	constexpr unsigned minimumDefaultThreads = 4;
+	const unsigned threads = m_config.loadThreads != 0
+		? m_config.loadThreads
+		: std::max(minimumDefaultThreads, std::thread::hardware_concurrency());
+
+	return static_cast<unsigned>(std::min<std::size_t>(threads, pluginCount));
+}
+
+void PluginManager::setPluginLoadState(const PluginLoadJob& job, bool loaded)
+{
+	std::lock_guard lock(m_discoveredMutex);
+
+	auto [iter, inserted] = m_discoveredPlugins.try_emplace(job.name, PluginInfo
+		{
+			.name = job.name,
+			.path = job.path,
+			.loaded = false,
+			.errorMessage = "",
+			.descriptor = nullptr
+		});
+
+	iter->second.loaded = loaded;
+	iter->second.errorMessage = loaded ? "" : job.timing.error;
 }
 
 bool PluginManager::unloadPlugin(const std::string& name)
@@ -405,10 +1576,21 @@ bool PluginManager::unloadPlugin(const std::string& name)
 		return false;
 	}
 
+	// Never activated, so there is only the library to close
+	if (auto dormant = m_dormantPlugins.extract(name); !dormant.empty())
+	{
+		UnloadLibrary(dormant.mapped().handle);
+		updatePacketWatches();
+
+		log(LogLevel::Info, std::format("Removed dormant plugin '{}'", name));
+		return true;
+	}
+
 	try
 	{
+		std::lock_guard lock(m_discoveredMutex);
 		log(LogLevel::Debug, std::format("m_discoveredPlugins size: {}", m_discoveredPlugins.size()));
-		log(LogLevel::Debug, std::format("m_loadedPlugins size: {}", m_loadedPlugins.size()));
+		log(LogLevel::Debug, std::format("m_loadedPlugins size: {}", getLoadedPlugins().size()));
 	}
 	catch (const std::exception& e)
 	{
@@ -425,10 +1607,20 @@ bool PluginManager::unloadPlugin(const std::string& name)
 		{
 			log(LogLevel::Debug, std::format("Found loaded plugin '{}', removing...", name));
 
-			// Unload and remove from collection of loaded plugins
+			// Stop dispatching to it first - it's destroyed once the dispatches already in flight are done, and no
+			// reader holds a snapshot with it in
+			const auto dispatchFence = m_dataPacketRegistry.unregisterDataPacketHandlerForPlugin(name);
+			auto instance = std::move(pluginItr->second);
 			m_loadedPlugins.erase(pluginItr);
+			retirePlugin(std::move(instance), dispatchFence, publishLoadedPlugins());
+
+			if (auto* uiLogSink = dynamic_cast<UILogSink*>(m_uiLogSink.get()))
+			{
+				uiLogSink->removeMemoryResource(name);
+			}
 
 			// Update the collection of all known plugins
+			std::lock_guard discoveredLock(m_discoveredMutex);
 			auto discovered = m_discoveredPlugins.find(name);
 			if (discovered != m_discoveredPlugins.end())
 			{
@@ -436,6 +1628,7 @@ bool PluginManager::unloadPlugin(const std::string& name)
 			}
 
 			log(LogLevel::Info, std::format("Successfully unloaded plugin '{}'", name));
+			m_events.publish(EngineEventType::PluginUnloaded, PluginUnloadedEvent{ .pluginName = name });
 			return true;
 		}
 	}
@@ -450,14 +1643,219 @@ bool PluginManager::unloadPlugin(const std::string& name)
 }
 
 
+std::expected<void, std::string> PluginManager::reloadPlugin(const std::string& name)
+{
+	VECTORIUM_TRACE_ZONE_DETAIL("PluginManager::reloadPlugin", TraceRecorder::instance().internName(name));
+
+	const auto start = std::chrono::steady_clock::now();
+
+	// Main thread only, like unloadPlugin, so the instance can't go while this runs
+	PluginInstance* current = getLoadedPlugins().get(name);
+
+	if (!current)
+	{
+		return std::unexpected(std::format("Plugin '{}' is not loaded", name));
+	}
+
+	// Its handlers live in another process, there is nothing to hand over - unload and load it instead
+	if (!current->isInProcess())
+	{
+		return std::unexpected(std::format("Plugin '{}' runs in its own process and can't be hot reloaded", name));
+	}
+
+	std::filesystem::path pluginPath;
+	{
+		std::lock_guard lock(m_discoveredMutex);
+		if (const auto it = m_discoveredPlugins.find(name); it != m_discoveredPlugins.end())
+		{
+			pluginPath = it->second.path;
+		}
+	}
+
+	if (pluginPath.empty())
+	{
+		return std::unexpected(std::format("No plugin file known for '{}'", name));
+	}
+
+	// Opening the same path again would just hand back the library that is already loaded
+	auto shadowPath = makeShadowCopy(name, pluginPath);
+	if (!shadowPath)
+	{
+		return std::unexpected(shadowPath.error());
+	}
+
+	PluginLoadJob job;
+	job.name = name;
+	job.path = *shadowPath;
+	job.isReload = true;
+	job.timing.name = name;
+
+	openPluginLibrary(job);
+	if (job.handle && checkRequiredServices(job))
+	{
+		setupPlugin(job);
+	}
+
+	// The library is mapped by now. Windows keeps the file locked until it's closed, so that copy stays behind in temp.
+	std::error_code ec;
+	std::filesystem::remove(*shadowPath, ec);
+
+	if (job.timing.status != PluginLoadStatus::Loaded || !job.instance)
+	{
+		return std::unexpected(std::format("The new build of '{}' didn't load: {}", name, job.timing.error));
+	}
+
+	// From here the old instance's packets are buffered until one of the two instances takes them
+	const auto handoffFence = m_dataPacketRegistry.beginHandoff(name);
+
+	const auto abortReload = [&](std::string error) -> std::expected<void, std::string>
+	{
+		retirePlugin(std::move(job.instance), m_dataPacketRegistry.abortHandoff(name));
+		return std::unexpected(std::move(error));
+	};
+
+	if (!waitForDispatches(handoffFence))
+	{
+		return abortReload(std::format("Dispatches to '{}' didn't finish within {}ms", name, m_config.reloadDrainTimeout.count()));
+	}
+
+	// Nothing reaches the old instance now, so its state can't change under the handoff
+	std::size_t stateSize = 0;
+	try
+	{
+		const std::string state = current->getPlugin()->serializeState();
+		stateSize = state.size();
+
+		if (!state.empty())
+		{
+			if (auto restored = job.instance->getPlugin()->restoreState(state); !restored)
+			{
+				return abortReload(std::format("'{}' could not restore its state: {}", name, restored.error()));
+			}
+		}
+	}
+	catch (const std::exception& ex)
+	{
+		return abortReload(std::format("State handoff for '{}' threw: {}", name, ex.what()));
+	}
+
+	const auto swapFence = m_dataPacketRegistry.commitHandoff(name);
+	job.instance->getContext()->setStagingHandlers(false);
+
+	if (const auto& activity = job.instance->getActivity())
+	{
+		m_dataPacketRegistry.setPluginActivity(name, activity);
+	}
+
+	std::unique_ptr<PluginInstance>   outgoing;
+	DataPacketRegistry::DispatchFence snapshotFence;
+	{
+		std::unique_lock lock(m_pluginsMutex);
+		auto& loaded = m_loadedPlugins[name];
+		outgoing = std::exchange(loaded, std::move(job.instance));
+		snapshotFence = publishLoadedPlugins();
+	}
+
+	retirePlugin(std::move(outgoing), swapFence, snapshotFence);
+
+	log(LogLevel::Info, std::format("Reloaded plugin '{}' in {:.2f}ms, {} byte(s) of state handed over",
+		name, std::chrono::duration<double, std::milli>(elapsedSince(start)).count(), stateSize));
+
+	m_events.publish(EngineEventType::PluginLoaded, PluginLoadedEvent{
+		.pluginName = name,
+		.version = job.cachedDescriptor ? job.cachedDescriptor->version : std::string{},
+		.isReload = true
+	});
+	return {};
+}
+
+std::expected<std::filesystem::path, std::string> PluginManager::makeShadowCopy(const std::string& name, const std::filesystem::path& path)
+{
+	std::error_code ec;
+	const auto shadowDirectory = std::filesystem::temp_directory_path(ec) / "vectorium_reload";
+	std::filesystem::create_directories(shadowDirectory, ec);
+	if (ec)
+	{
+		return std::unexpected(std::format("Could not create '{}': {}", shadowDirectory.string(), ec.message()));
+	}
+
+	// Unique per process and reload, a library that is still open can't be overwritten
+	auto shadowPath = shadowDirectory / std::format("{}-{:x}-{}{}",
+		name, std::chrono::steady_clock::now().time_since_epoch().count(), ++m_reloadCount, PLUGIN_EXT);
+
+	if (!std::filesystem::copy_file(path, shadowPath, std::filesystem::copy_options::overwrite_existing, ec))
+	{
+		return std::unexpected(std::format("Could not copy '{}' for reloading: {}", path.string(), ec.message()));
+	}
+
+	return shadowPath;
+}
+
+bool PluginManager::waitForDispatches(const DataPacketRegistry::DispatchFence& fence) const
+{
+	const auto deadline = std::chrono::steady_clock::now() + m_config.reloadDrainTimeout;
+
+	while (!fence.expired())
+	{
+		if (std::chrono::steady_clock::now() >= deadline)
+		{
+			return false;
+		}
+
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+	}
+
+	return true;
+}
+
+void PluginManager::retirePlugin(std::unique_ptr<PluginInstance> instance, DataPacketRegistry::DispatchFence fence,
+                                 DataPacketRegistry::DispatchFence snapshotFence)
+{
+	if (!instance || (fence.expired() && snapshotFence.expired()))
+	{
+		return; // nothing can reach it, so it goes now
+	}
+
+	m_retiredPlugins.push_back(RetiredPlugin{
+		.fence = std::move(fence),
+		.snapshotFence = std::move(snapshotFence),
+		.instance = std::move(instance)
+	});
+}
+
+void PluginManager::destroyDrainedPlugins()
+{
+	std::erase_if(m_retiredPlugins, [](const RetiredPlugin& retired)
+	{
+		return retired.fence.expired() && retired.snapshotFence.expired();
+	});
+}
+
+DataPacketRegistry::DispatchFence PluginManager::publishLoadedPlugins()
+{
+	auto snapshot = std::make_shared<LoadedPluginSnapshot::State>();
+	snapshot->plugins.reserve(m_loadedPlugins.size());
+
+	for (const auto& [name, instance] : m_loadedPlugins)
+	{
+		snapshot->plugins.emplace(name, instance.get());
+	}
+
+	const auto current = m_loadedSnapshot.load(std::memory_order_acquire);
+	current->generation->next = snapshot->generation;
+
+	m_loadedSnapshot.store(std::move(snapshot), std::memory_order_release);
+	return current->generation;
+}
+
 std::vector<std::string> PluginManager::getNamesOfAllLoadedPlugins() const
 {
-	std::vector<std::string> keys;
-	keys.reserve(m_loadedPlugins.size());
+	const auto loadedPlugins = getLoadedPlugins();
 
-	std::shared_lock lock(m_pluginsMutex);
+	std::vector<std::string> keys;
+	keys.reserve(loadedPlugins.size());
 
-	for(const auto& key : m_loadedPlugins | std::views::keys )
+	for(const auto& key : loadedPlugins | std::views::keys )
 	{
 		keys.push_back(key);
 	}
@@ -465,9 +1863,69 @@ std::vector<std::string> PluginManager::getNamesOfAllLoadedPlugins() const
 	return keys;
 }
 
-const std::unordered_map<std::string, std::unique_ptr<PluginInstance>>& PluginManager::getLoadedPlugins() const
+void PluginManager::validateThreadPlacement() const
+{
+	const CpuTopology& topology = CpuTopology::get();
+	if (topology.isNuma())
+	{
+		log(LogLevel::Info, std::format("{} NUMA nodes, cross-node dispatches to placed plugins are counted", topology.getNodeCount()));
+	}
+
+	const auto validate = [&](const std::string& owner, const ThreadPlacement& placement)
+	{
+		if (placement.numaNode >= static_cast<int>(topology.getNodeCount()))
+		{
+			log(LogLevel::Warning, std::format("Thread placement of {} names NUMA node {}, this machine has {}", owner, placement.numaNode, topology.getNodeCount()));
+		}
+
+		for (const unsigned cpu : placement.cpus)
+		{
+			if (topology.getNodeOfCpu(cpu) < 0)
+			{
+				log(LogLevel::Warning, std::format("Thread placement of {} names CPU {}, which doesn't exist", owner, cpu));
+			}
+		}
+	};
+
+	validate("the engine's threads", m_config.engineThreadPlacement);
+	for (const auto& [pluginName, placement] : m_config.pluginThreadPlacement)
+	{
+		validate(std::format("'{}'", pluginName), placement);
+	}
+}
+
+ThreadPlacement PluginManager::resolveThreadPlacement(const std::string& pluginName) const
+{
+	auto placement = m_config.pluginThreadPlacement.find(pluginName);
+	if (placement == m_config.pluginThreadPlacement.end())
+	{
+		return {};
+	}
+
+	// Follow "near" to a plugin that is placed itself, sharing its node rather than its CPUs
+	ThreadPlacement resolved = placement->second;
+	for (std::size_t hops = 0; !resolved.nearPlugin.empty(); ++hops)
+	{
+		const auto near = m_config.pluginThreadPlacement.find(resolved.nearPlugin);
+		if (near == m_config.pluginThreadPlacement.end() || hops == m_config.pluginThreadPlacement.size())
+		{
+			log(LogLevel::Warning, std::format("'{}' is to be placed near '{}', which isn't placed", pluginName, resolved.nearPlugin));
+			return {};
+		}
+
+		resolved = ThreadPlacement{
+			.numaNode = CpuTopology::get().getPlacementNode(near->second),
+			.cpus = {},
+			.nearPlugin = near->second.nearPlugin
+		};
+	}
+
+	return resolved;
+}
+
+LoadedPluginSnapshot PluginManager::getLoadedPlugins() const
 {
-	return m_loadedPlugins;
+	return LoadedPluginSnapshot(m_loadedSnapshot.load(std::memory_order_acquire));
 }
 
 void PluginManager::log(const LogLevel logLvl, const std::string& msg) const
@@ -511,28 +1969,29 @@ std::filesystem::path PluginManager::getPortableConfigPath() const
 
 void PluginManager::startPluginAutoScan()
 {
-	log(LogLevel::Info, std::format("Starting plugin folder watcher: scanning '{}' every {}s", m_config.pluginDirectory, m_config.pluginScanInterval.count()));
-	if(!m_config.autoScan || m_scanningThread.joinable())
+	if(!m_config.autoScan || m_folderWatcher)
 	{
 		return;
 	}
 
-	// Start a thread that will periodically call scanPluginFolder
-	m_scanningThread = std::jthread([this](const std::stop_token& stop_token)
-	{
-		while (!stop_token.stop_requested())
-		{
-			scanPluginsFolder(m_config.pluginDirectory);
+	log(LogLevel::Info, std::format("Starting plugin folder watcher on '{}'", m_config.pluginDirectory));
 
-			std::this_thread::sleep_for(m_config.pluginScanInterval);
-		}
-	});
+	m_folderWatcher = std::make_unique<PluginFolderWatcher>(m_baseLogger,
+		getExecutableDir() / m_config.pluginDirectory,
+		PLUGIN_EXT,
+		m_config.pluginChangeDebounce,
+		m_config.pluginScanInterval,
+		[this](std::vector<PluginFolderChange> changes)
+		{
+			onPluginFolderChanges(std::move(changes));
+		},
+		m_config.engineThreadPlacement);
 }
 
 void PluginManager::stopPluginAutoScan()
 {
 	log(LogLevel::Info, "Stopping plugin folder watcher.");
-	m_scanningThread.request_stop();
+	m_folderWatcher.reset();
 }
 
 PluginManagerConfig& PluginManager::getConfig()
@@ -577,66 +2036,193 @@ void PluginManager::reloadPluginConfig()
 
 void PluginManager::enablePluginDebugLogging(const std::string& pluginName)
 {
-	auto it = m_loadedPlugins.find(pluginName);
-	if(it != m_loadedPlugins.end())
+	if(auto* plugin = getLoadedPlugins().get(pluginName))
 	{
-		it->second->enablePluginDebugLogging();
+		plugin->enablePluginDebugLogging();
 	}
 }
 
 void PluginManager::disablePluginDebugLogging(const std::string& pluginName)
 {
-	auto it = m_loadedPlugins.find(pluginName);
-	if(it != m_loadedPlugins.end())
+	if(auto* plugin = getLoadedPlugins().get(pluginName))
 	{
-		it->second->disablePluginDebugLogging();
+		plugin->disablePluginDebugLogging();
 	}
 }
 
 bool PluginManager::isPluginDebugLoggingEnabled(const std::string& pluginName) const
 {
-	auto it = m_loadedPlugins.find(pluginName);
-	if(it != m_loadedPlugins.end())
+	const auto* plugin = getLoadedPlugins().get(pluginName);
+	return plugin && plugin->isPluginDebugLoggingEnabled();
+}
+
+void PluginManager::tick()
+{
+	VECTORIUM_TRACE_ZONE("PluginManager::tick");
+
+	m_discoveryUpdates.drain();
+
+	if (!m_retiredPlugins.empty())
 	{
-		return it->second->isPluginDebugLoggingEnabled();
+		destroyDrainedPlugins();
 	}
 
-	return false;
+	if (!m_dormantPlugins.empty())
+	{
+		activateDuePlugins();
+	}
+
+	const auto loadedPlugins = getLoadedPlugins();
+	for(auto* plugin : loadedPlugins | std::views::values)
+	{
+		plugin->deliverEngineEvents();
+		plugin->tick();
+
+		// Services replaced while one of the plugin's calls was using them
+		if (auto* context = plugin->getContext(); context && context->hasRetiredServices()) [[unlikely]]
+		{
+			context->collectRetiredServices();
+		}
+	}
+
+	if (m_watchdog)
+	{
+		superviseOverruns(loadedPlugins);
+	}
+
+	superviseMemory(loadedPlugins);
+	superviseBackpressure(loadedPlugins);
 }
 
-void PluginManager::tick()
+void PluginManager::deliverEngineEvents()
 {
-	for(const auto& plugin : m_loadedPlugins | std::views::values)
+	for (auto* plugin : getLoadedPlugins() | std::views::values)
 	{
-		plugin->tick();
+		plugin->deliverEngineEvents();
 	}
 }
 
-//Need to work into things
-void PluginManager::registerServicesForPlugin(PluginRuntimeContext* context, const PluginDescriptor* desc) const
+void PluginManager::superviseBackpressure(const LoadedPluginSnapshot& loadedPlugins)
 {
-	// Simple policy logic inline
-	if (isTrustedPlugin(desc->name))
+	for (const auto& [name, plugin] : loadedPlugins)
 	{
-		if(const auto resClient = m_services.getService<IPluginRESTService>())
+		if (const std::uint64_t dropped = plugin->takeNewDroppedPackets(); dropped != 0)
+		{
+			const PluginWorker* worker = plugin->getWorker();
+			const std::size_t queued = worker ? worker->getQueuedPacketCount() : 0;
+
+			log(LogLevel::Warning, std::format("Plugin '{}' dropped {} packet(s) - its worker isn't keeping up, {} queued", name, dropped, queued));
+			m_events.publish(EngineEventType::Backpressure, BackpressureEvent{ .pluginName = name, .droppedPackets = dropped, .queuedPackets = queued });
+		}
+
+		const PluginRuntimeContext* context = plugin->getContext();
+		if (EngineEventQueue* queue = context ? context->getEngineEventQueue() : nullptr)
 		{
-			context->registerService<IPluginRESTService>(resClient);
+			if (const std::uint64_t droppedEvents = queue->takeNewDrops(); droppedEvents != 0)
+			{
+				log(LogLevel::Warning, std::format("Plugin '{}' missed {} engine event(s) - its queue was full", name, droppedEvents));
+			}
 		}
-		//context->registerService<IFileSystem>(m_fileSystem);
 	}
+}
 
-	if (desc->name.starts_with("Debug_"))
+void PluginManager::superviseMemory(const LoadedPluginSnapshot& loadedPlugins)
+{
+	constexpr double bytesPerMB = 1024.0 * 1024.0;
+
+	for (const auto& [name, plugin] : loadedPlugins)
 	{
-		//context->registerService<IDebugger>(m_debugger);
+		const PluginRuntimeContext* context = plugin->getContext();
+		if (!context || !context->getMemoryAccount())
+		{
+			continue;
+		}
+
+		const auto& account = context->getMemoryAccount();
+
+		const bool isOverWarning = account->isOverWarning();
+		if (account->setWarningReported(isOverWarning))
+		{
+			const auto stats = account->getStats();
+			if (isOverWarning)
+			{
+				log(LogLevel::Warning, std::format("Plugin '{}' holds {:.2f}MB, over its {:.2f}MB warning level",
+					name, stats.currentBytes / bytesPerMB, account->getBudget().warnBytes / bytesPerMB));
+			}
+			else
+			{
+				log(LogLevel::Info, std::format("Plugin '{}' is back under its memory warning level ({:.2f}MB)", name, stats.currentBytes / bytesPerMB));
+			}
+		}
+
+		if (const std::uint64_t rejected = account->takeNewRejections(); rejected != 0)
+		{
+			log(LogLevel::Warning, std::format("Plugin '{}' hit its {:.2f}MB memory limit, {} allocations refused",
+				name, account->getBudget().limitBytes / bytesPerMB, rejected));
+		}
 	}
+}
 
-	// Network plugins get REST client
-	if (needsNetworkAccess(desc))
+void PluginManager::superviseOverruns(const LoadedPluginSnapshot& loadedPlugins)
+{
+	for (const auto& [name, plugin] : loadedPlugins)
 	{
-		if(const auto restClient = m_services.getService<IPluginRESTService>())
+		const std::uint64_t newOverruns = plugin->takeNewOverruns();
+		if (newOverruns == 0)
+		{
+			continue;
+		}
+
+		const auto stats = plugin->getActivity()->getStats();
+		const std::uint64_t overruns = stats.getOverrunCount();
+		if (overruns == newOverruns)
+		{
+			log(LogLevel::Warning, std::format("Plugin '{}' overran its deadline (worst tick {:.2f}ms, worst handler {:.2f}ms)",
+				name,
+				std::chrono::duration<double, std::milli>(stats.worstTick).count(),
+				std::chrono::duration<double, std::milli>(stats.worstHandler).count()));
+		}
+
+		// Acted on once per watchdogStrikes overruns, so throttling keeps backing off while the plugin keeps overrunning
+		const std::uint64_t strikes = std::max(m_config.watchdogStrikes, 1u);
+		if (overruns / strikes == (overruns - newOverruns) / strikes)
+		{
+			continue;
+		}
+
+		const auto pluginAction = m_config.overrunActions.find(name);
+		switch (pluginAction != m_config.overrunActions.end() ? pluginAction->second : m_config.overrunAction)
 		{
-			context->registerService<IPluginRESTService>(restClient);
+			case PluginOverrunAction::Flag:
+				break;
+
+			case PluginOverrunAction::Throttle:
+			{
+				const std::uint32_t stride = std::min(plugin->getTickStride() * 2, maxThrottledTickStride);
+				if (stride != plugin->getTickStride())
+				{
+					plugin->setTickStride(stride);
+					log(LogLevel::Warning, std::format("Plugin '{}' overran its deadlines {} times, now ticked every {} frames", name, overruns, stride));
+				}
+				break;
+			}
+
+			case PluginOverrunAction::Isolate:
+			{
+				if (plugin->getWorker())
+				{
+					break;
+				}
+
+				PluginWorker* worker = plugin->moveToWorker();
+				m_dataPacketRegistry.wrapHandlersForPlugin(name, [&](std::shared_ptr<IDataPacketHandler> handler)
+				{
+					return worker->makeQueuedHandler(std::move(handler));
+				});
+
+				log(LogLevel::Warning, std::format("Plugin '{}' overran its deadlines {} times, moved to a worker thread", name, overruns));
+				break;
+			}
 		}
 	}
 }
-
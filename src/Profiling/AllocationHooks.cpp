@@ -0,0 +1,167 @@
+// Replacement global operator new/delete that report every allocation to AllocationTracker.
+// Built as an OBJECT library and only linked into executables when VECTORIUM_ALLOCATION_AUDIT is on. On Linux plugins
+// resolve operator new to the executable's definition, so their allocations are counted too. On Windows each DLL keeps
+// its own CRT allocator, so only allocations made by the executable's modules are seen.
+
+#include <cstdlib>
+#include <new>
+
+#include "Profiling/AllocationTracker.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace
+{
+	[[maybe_unused]] const bool g_hooksInstalled = (AllocationTracker::markHooksInstalled(), true);
+
+	void* allocate(std::size_t size) noexcept
+	{
+		AllocationTracker::onAllocation(size);
+		return std::malloc(size == 0 ? 1 : size);
+	}
+
+	void* allocateAligned(std::size_t size, std::align_val_t alignment) noexcept
+	{
+		AllocationTracker::onAllocation(size);
+
+		const auto align = static_cast<std::size_t>(alignment);
+		const std::size_t rounded = (size == 0 ? align : (size + align - 1) / align * align);
+
+#ifdef _WIN32
+		return _aligned_malloc(rounded, align);
+#else
+		return std::aligned_alloc(align, rounded);
+#endif
+	}
+
+	void deallocateAligned(void* ptr) noexcept
+	{
+#ifdef _WIN32
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	if (void* ptr = allocate(size))
+	{
+		return ptr;
+	}
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	if (void* ptr = allocate(size))
+	{
+		return ptr;
+	}
+
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	if (void* ptr = allocateAligned(size, alignment))
+	{
+		return ptr;
+	}
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	if (void* ptr = allocateAligned(size, alignment))
+	{
+		return ptr;
+	}
+
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocateAligned(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+	deallocateAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+	deallocateAligned(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+	deallocateAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+	deallocateAligned(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	deallocateAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	deallocateAligned(ptr);
+}
@@ -0,0 +1,279 @@
+#include "Profiling/AllocationTracker.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+
+#include "Profiling/TraceRecorder.h"
+
+namespace
+{
+	/// <summary>
+	/// Plain data so it is constant-initialised - touching it from inside operator new must never allocate
+	/// </summary>
+	struct ThreadAllocationState
+	{
+		std::uint64_t         allocations;
+		std::uint64_t         bytes;
+		ScopedAllocationZone* currentZone;
+		bool                  suspended; // set while the tracker itself allocates
+	};
+
+	constinit thread_local ThreadAllocationState t_state{};
+
+	std::atomic_bool g_hooksInstalled{false};
+
+	/// <summary>
+	/// Stops the tracker's own bookkeeping allocations from being counted
+	/// </summary>
+	class SuspendCounting
+	{
+	public:
+		SuspendCounting() : m_previous(t_state.suspended)
+		{
+			t_state.suspended = true;
+		}
+
+		~SuspendCounting()
+		{
+			t_state.suspended = m_previous;
+		}
+
+		SuspendCounting(const SuspendCounting&) = delete;
+		SuspendCounting& operator=(const SuspendCounting&) = delete;
+
+	private:
+		bool m_previous;
+	};
+}
+
+const char* toString(AllocationZoneKind kind)
+{
+	switch (kind)
+	{
+		case AllocationZoneKind::PluginTick: return "tick";
+		case AllocationZoneKind::Handler:    return "handler";
+		case AllocationZoneKind::Render:     return "render";
+	}
+
+	return "unknown";
+}
+
+AllocationTracker& AllocationTracker::instance()
+{
+	static AllocationTracker tracker;
+	return tracker;
+}
+
+void AllocationTracker::setEnabled(bool enabled)
+{
+	m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool AllocationTracker::areHooksInstalled() noexcept
+{
+	return g_hooksInstalled.load(std::memory_order_relaxed);
+}
+
+void AllocationTracker::markHooksInstalled() noexcept
+{
+	g_hooksInstalled.store(true, std::memory_order_relaxed);
+}
+
+void AllocationTracker::setAbortOnForbiddenAllocation(bool shouldAbort)
+{
+	m_abortOnForbiddenAllocation.store(shouldAbort, std::memory_order_relaxed);
+}
+
+bool AllocationTracker::isAbortOnForbiddenAllocationEnabled() const
+{
+	return m_abortOnForbiddenAllocation.load(std::memory_order_relaxed);
+}
+
+void AllocationTracker::setNoAlloc(AllocationZoneKind kind, std::string_view label, bool noAlloc)
+{
+	SuspendCounting suspend;
+	const ZoneKey key{kind, TraceRecorder::instance().internName(label)};
+
+	std::lock_guard lock(m_mutex);
+	if (noAlloc)
+	{
+		m_noAllocZones.insert(key);
+	}
+	else
+	{
+		m_noAllocZones.erase(key);
+	}
+
+	m_hasNoAllocZones.store(!m_noAllocZones.empty(), std::memory_order_relaxed);
+}
+
+bool AllocationTracker::isNoAlloc(AllocationZoneKind kind, const char* label) const
+{
+	if (!m_hasNoAllocZones.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	std::lock_guard lock(m_mutex);
+	return m_noAllocZones.contains(ZoneKey{kind, label});
+}
+
+std::vector<AllocationZoneStats> AllocationTracker::getZoneStats() const
+{
+	SuspendCounting suspend;
+	std::vector<AllocationZoneStats> stats;
+
+	{
+		std::lock_guard lock(m_mutex);
+		stats.reserve(m_zones.size());
+
+		for (const auto& [key, zone] : m_zones)
+		{
+			stats.push_back(zone);
+			stats.back().noAlloc = m_noAllocZones.contains(key);
+		}
+	}
+
+	std::ranges::sort(stats, std::greater{}, &AllocationZoneStats::getAllocationsPerEntry);
+	return stats;
+}
+
+std::string AllocationTracker::formatReport() const
+{
+	SuspendCounting suspend;
+	const auto stats = getZoneStats();
+
+	if (stats.empty())
+	{
+		return areHooksInstalled()
+			? "No allocations recorded"
+			: "No allocations recorded - build with VECTORIUM_ALLOCATION_AUDIT to install the counting operator new";
+	}
+
+	std::string report = std::format("{:<32} {:<8} {:>12} {:>12} {:>8} {:>12} {:>10}\n",
+		"Zone", "Kind", "Allocs/entry", "Bytes/entry", "Max", "Entries", "Forbidden");
+
+	for (const auto& zone : stats)
+	{
+		report += std::format("{:<32} {:<8} {:>12.2f} {:>12.1f} {:>8} {:>12} {:>10}{}\n",
+			zone.label,
+			toString(zone.kind),
+			zone.getAllocationsPerEntry(),
+			zone.getBytesPerEntry(),
+			zone.maxAllocationsPerEntry,
+			zone.entries,
+			zone.forbiddenAllocations,
+			zone.noAlloc ? "  [no-alloc]" : "");
+	}
+
+	return report;
+}
+
+void AllocationTracker::reset()
+{
+	SuspendCounting suspend;
+	std::lock_guard lock(m_mutex);
+	m_zones.clear();
+}
+
+void AllocationTracker::onAllocation(std::size_t bytes) noexcept
+{
+	ThreadAllocationState& state = t_state;
+	if (state.suspended)
+	{
+		return;
+	}
+
+	++state.allocations;
+	state.bytes += bytes;
+
+	ScopedAllocationZone* zone = state.currentZone;
+	if (zone && zone->m_noAlloc)
+	{
+		++zone->m_forbiddenAllocations;
+
+		if (instance().m_abortOnForbiddenAllocation.load(std::memory_order_relaxed))
+		{
+			abortOnForbiddenAllocation(*zone);
+		}
+	}
+}
+
+void AllocationTracker::recordZone(const ScopedAllocationZone& zone, std::uint64_t allocations, std::uint64_t bytes)
+{
+	SuspendCounting suspend;
+	std::lock_guard lock(m_mutex);
+
+	auto [it, inserted] = m_zones.try_emplace(ZoneKey{zone.m_kind, zone.m_label});
+	AllocationZoneStats& stats = it->second;
+
+	if (inserted)
+	{
+		stats.kind = zone.m_kind;
+		stats.label = zone.m_label ? zone.m_label : "(unnamed)";
+	}
+
+	++stats.entries;
+	stats.allocations += allocations;
+	stats.bytes += bytes;
+	stats.maxAllocationsPerEntry = std::max(stats.maxAllocationsPerEntry, allocations);
+	stats.forbiddenAllocations += zone.m_forbiddenAllocations;
+}
+
+void AllocationTracker::abortOnForbiddenAllocation(const ScopedAllocationZone& zone) noexcept
+{
+	// stdio on stderr is unbuffered, so this doesn't allocate from inside operator new
+	std::fputs("[AllocationTracker] allocation inside no-alloc zone '", stderr);
+	std::fputs(zone.m_label ? zone.m_label : "(unnamed)", stderr);
+	std::fputs("' (", stderr);
+	std::fputs(toString(zone.m_kind), stderr);
+	std::fputs(")\n", stderr);
+	std::abort();
+}
+
+ScopedAllocationZone::ScopedAllocationZone(AllocationZoneKind kind, const char* label) noexcept
+	: m_kind(kind)
+	, m_label(label)
+{
+	AllocationTracker& tracker = AllocationTracker::instance();
+	if (!tracker.isEnabled())
+	{
+		return;
+	}
+
+	ThreadAllocationState& state = t_state;
+
+	m_active = true;
+	m_noAlloc = tracker.isNoAlloc(kind, label);
+	m_parent = state.currentZone;
+	m_startAllocations = state.allocations;
+	m_startBytes = state.bytes;
+
+	state.currentZone = this;
+}
+
+ScopedAllocationZone::~ScopedAllocationZone()
+{
+	if (!m_active)
+	{
+		return;
+	}
+
+	ThreadAllocationState& state = t_state;
+
+	const std::uint64_t allocations = state.allocations - m_startAllocations;
+	const std::uint64_t bytes = state.bytes - m_startBytes;
+
+	state.currentZone = m_parent;
+
+	// A parent only keeps what was allocated outside its nested zones
+	if (m_parent)
+	{
+		m_parent->m_childAllocations += allocations;
+		m_parent->m_childBytes += bytes;
+	}
+
+	AllocationTracker::instance().recordZone(*this, allocations - m_childAllocations, bytes - m_childBytes);
+}
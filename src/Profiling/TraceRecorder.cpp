@@ -0,0 +1,331 @@
+#include "Profiling/TraceRecorder.h"
+
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <fstream>
+
+struct TraceRecorder::ThreadBuffer
+{
+	ThreadBuffer(std::size_t capacity, std::uint32_t id)
+		: events(capacity)
+		, mask(capacity - 1)
+		, threadId(id)
+	{}
+
+	std::vector<TraceEvent>    events;
+	std::size_t                mask;
+	std::atomic<std::uint64_t> head{0};        // only ever written by the owning thread
+	std::atomic<std::uint64_t> clearedHead{0}; // head when clear() was last called
+	std::uint32_t              threadId;
+	std::string                threadName;
+
+	// Set once the owning thread exits, then once an export has written it out - only then is it reused
+	std::atomic_bool isRetired{false};
+	std::atomic_bool isExported{false};
+};
+
+/// <summary>
+/// Retires the thread's buffer when the thread exits
+/// </summary>
+struct TraceRecorder::ThreadBufferLease
+{
+	ThreadBuffer* buffer = nullptr;
+
+	~ThreadBufferLease();
+};
+
+namespace
+{
+	// Trivially destructible, so still readable by zones closing after the lease is gone
+	thread_local bool isThreadExiting = false;
+}
+
+TraceRecorder::ThreadBufferLease::~ThreadBufferLease()
+{
+	isThreadExiting = true;
+
+	if (buffer)
+	{
+		buffer->isRetired.store(true, std::memory_order_release);
+	}
+}
+
+namespace
+{
+	std::string escapeJson(std::string_view text)
+	{
+		std::string escaped;
+		escaped.reserve(text.size());
+
+		for (const char c : text)
+		{
+			switch (c)
+			{
+				case '"':  escaped += "\\\""; break;
+				case '\\': escaped += "\\\\"; break;
+				case '\n': escaped += "\\n"; break;
+				case '\t': escaped += "\\t"; break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20)
+					{
+						escaped += std::format("\\u{:04x}", static_cast<int>(c));
+					}
+					else
+					{
+						escaped += c;
+					}
+			}
+		}
+
+		return escaped;
+	}
+}
+
+TraceRecorder::ClockSample TraceRecorder::sampleClock() noexcept
+{
+	return ClockSample{
+		.ticks = nowTicks(),
+		.ns = nowNs()
+	};
+}
+
+TraceRecorder& TraceRecorder::instance()
+{
+	static TraceRecorder recorder;
+	return recorder;
+}
+
+void TraceRecorder::setEnabled(bool enabled)
+{
+	m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void TraceRecorder::setEventsPerThread(std::size_t capacity)
+{
+	m_eventsPerThread.store(std::bit_ceil(std::max<std::size_t>(capacity, 64)), std::memory_order_relaxed);
+}
+
+size_t TraceRecorder::getEventsPerThread() const
+{
+	return m_eventsPerThread.load(std::memory_order_relaxed);
+}
+
+const char* TraceRecorder::internName(std::string_view name)
+{
+	std::lock_guard lock(m_namesMutex);
+
+	// Look up first so interning an existing name never allocates
+	if (const auto it = m_internedNames.find(name); it != m_internedNames.end())
+	{
+		return it->c_str();
+	}
+
+	return m_internedNames.emplace(name).first->c_str();
+}
+
+void TraceRecorder::setCurrentThreadName(std::string_view name)
+{
+	ThreadBuffer* buffer = currentThreadBuffer();
+	if (!buffer)
+	{
+		return;
+	}
+
+	std::lock_guard lock(m_buffersMutex);
+	buffer->threadName = name;
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::currentThreadBuffer()
+{
+	if (isThreadExiting)
+	{
+		return nullptr;
+	}
+
+	thread_local ThreadBufferLease lease;
+
+	if (!lease.buffer)
+	{
+		std::lock_guard lock(m_buffersMutex);
+
+		const std::size_t capacity = m_eventsPerThread.load(std::memory_order_relaxed);
+
+		// An exited thread's buffer once it's been exported, or the oldest one if too many are waiting to be
+		std::shared_ptr<ThreadBuffer> buffer;
+		std::size_t                   retiredCount = 0;
+		for (const auto& candidate : m_buffers)
+		{
+			if (!candidate->isRetired.load(std::memory_order_acquire))
+			{
+				continue;
+			}
+
+			if (!buffer || (candidate->isExported.load(std::memory_order_relaxed) && !buffer->isExported.load(std::memory_order_relaxed)))
+			{
+				buffer = candidate;
+			}
+
+			++retiredCount;
+		}
+
+		if (buffer && (buffer->isExported.load(std::memory_order_relaxed) || retiredCount >= maxRetiredBuffers))
+		{
+			// Its thread is gone and exports hold the mutex, so nothing else touches it
+			if (buffer->events.size() != capacity)
+			{
+				buffer->events.assign(capacity, TraceEvent{});
+				buffer->mask = capacity - 1;
+			}
+
+			buffer->head.store(0, std::memory_order_relaxed);
+			buffer->clearedHead.store(0, std::memory_order_relaxed);
+			buffer->threadId = m_nextThreadId++;
+			buffer->threadName.clear();
+			buffer->isExported.store(false, std::memory_order_relaxed);
+			buffer->isRetired.store(false, std::memory_order_release);
+		}
+		else
+		{
+			buffer = std::make_shared<ThreadBuffer>(capacity, m_nextThreadId++);
+			m_buffers.push_back(buffer);
+		}
+
+		lease.buffer = buffer.get();
+	}
+
+	return lease.buffer;
+}
+
+void TraceRecorder::record(const char* name, const char* detail, std::uint64_t startTicks, std::uint64_t endTicks) noexcept
+{
+	ThreadBuffer* buffer = currentThreadBuffer();
+	if (!buffer)
+	{
+		return;
+	}
+
+	const std::uint64_t index = buffer->head.load(std::memory_order_relaxed);
+	buffer->events[index & buffer->mask] = TraceEvent{
+		.name = name,
+		.detail = detail,
+		.startTicks = startTicks,
+		.durationTicks = endTicks - startTicks
+	};
+
+	buffer->head.store(index + 1, std::memory_order_release);
+}
+
+void TraceRecorder::clear()
+{
+	m_clearedAtTicks.store(nowTicks(), std::memory_order_relaxed);
+
+	std::lock_guard lock(m_buffersMutex);
+	for (const auto& buffer : m_buffers)
+	{
+		buffer->clearedHead.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+	}
+}
+
+std::size_t TraceRecorder::getRecordedEventCount() const
+{
+	std::lock_guard lock(m_buffersMutex);
+
+	std::size_t count = 0;
+	for (const auto& buffer : m_buffers)
+	{
+		const std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+		count += static_cast<std::size_t>(std::min<std::uint64_t>(head - std::min(head, buffer->clearedHead.load(std::memory_order_relaxed)), buffer->events.size()));
+	}
+
+	return count;
+}
+
+bool TraceRecorder::writeChromeTrace(const std::filesystem::path& path) const
+{
+	std::error_code ec;
+	if (path.has_parent_path())
+	{
+		std::filesystem::create_directories(path.parent_path(), ec);
+	}
+
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	const std::uint64_t clearedAtTicks = m_clearedAtTicks.load(std::memory_order_relaxed);
+
+	// Derive the tick rate from the span between construction and now
+	const ClockSample now        = sampleClock();
+	const double      nsPerTick  = now.ticks > m_calibration.ticks
+		? static_cast<double>(now.ns - m_calibration.ns) / static_cast<double>(now.ticks - m_calibration.ticks)
+		: 1.0;
+	const auto toMicroseconds = [&](std::uint64_t ticks)
+	{
+		return static_cast<double>(ticks) * nsPerTick / 1000.0;
+	};
+
+	file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool first = true;
+
+	std::lock_guard lock(m_buffersMutex);
+
+	for (const auto& buffer : m_buffers)
+	{
+		// Read before the events, so a buffer retired meanwhile is kept for the next export
+		const bool isRetired = buffer->isRetired.load(std::memory_order_acquire);
+
+		file << (first ? "" : ",") << std::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})",
+			buffer->threadId,
+			escapeJson(buffer->threadName.empty() ? std::format("Thread {}", buffer->threadId) : buffer->threadName));
+		first = false;
+
+		// The owning thread keeps writing while we copy; anything it overwrote during the copy is dropped below
+		const std::uint64_t head     = buffer->head.load(std::memory_order_acquire);
+		const std::uint64_t capacity = buffer->events.size();
+		const std::uint64_t begin    = head > capacity ? head - capacity : 0;
+
+		std::vector<TraceEvent> snapshot;
+		snapshot.reserve(static_cast<std::size_t>(head - begin));
+		for (std::uint64_t i = begin; i < head; ++i)
+		{
+			snapshot.push_back(buffer->events[i & buffer->mask]);
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const std::uint64_t headAfterCopy = buffer->head.load(std::memory_order_relaxed);
+		const std::uint64_t firstValid    = headAfterCopy > capacity ? headAfterCopy - capacity : 0;
+
+		for (std::uint64_t i = std::max(begin, firstValid); i < head; ++i)
+		{
+			const TraceEvent& event = snapshot[static_cast<std::size_t>(i - begin)];
+			if (!event.name || event.startTicks < clearedAtTicks || event.startTicks < m_calibration.ticks)
+			{
+				continue;
+			}
+
+			file << std::format(R"(,{{"name":"{}","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f})",
+				escapeJson(event.name),
+				buffer->threadId,
+				toMicroseconds(event.startTicks - m_calibration.ticks),
+				toMicroseconds(event.durationTicks));
+
+			if (event.detail)
+			{
+				file << std::format(R"(,"args":{{"detail":"{}"}})", escapeJson(event.detail));
+			}
+
+			file << "}";
+		}
+
+		if (isRetired)
+		{
+			buffer->isExported.store(true, std::memory_order_relaxed);
+		}
+	}
+
+	file << "]}\n";
+	return static_cast<bool>(file);
+}
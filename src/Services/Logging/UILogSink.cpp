@@ -1,17 +1,48 @@
 #include "Services/Logging/UILogSink.h"
 
+#include <new>
+
 
 void UILogSink::clearBuffer()
 {
 	logBuffer.clear();
 }
 
+void UILogSink::setMemoryResource(const std::string& loggerName, std::shared_ptr<std::pmr::memory_resource> resource)
+{
+	std::lock_guard lock(mutex_);
+	m_memoryResources[loggerName] = std::move(resource);
+}
+
+void UILogSink::removeMemoryResource(const std::string& loggerName)
+{
+	std::lock_guard lock(mutex_);
+	m_memoryResources.erase(loggerName);
+}
+
 void UILogSink::sink_it_(const spdlog::details::log_msg& msg)
 {
 	// Format the message using the current formatter
 	spdlog::memory_buf_t formatted;
 	base_sink<std::mutex>::formatter_->format(msg, formatted);
 
+	std::shared_ptr<std::pmr::memory_resource> resource;
+	if (const auto it = m_memoryResources.find(std::string_view(msg.logger_name.data(), msg.logger_name.size())); it != m_memoryResources.end())
+	{
+		resource = it->second;
+	}
+
+	std::pmr::string message(resource ? resource.get() : std::pmr::get_default_resource());
+	try
+	{
+		message.assign(formatted.data(), formatted.size());
+	}
+	catch (const std::bad_alloc&)
+	{
+		// Over its logger's memory budget
+		return;
+	}
+
 	// Remove oldest entries if we're at capacity
 	if (logBuffer.size() >= maxEntries)
 	{
@@ -20,7 +51,8 @@ void UILogSink::sink_it_(const spdlog::details::log_msg& msg)
 
 	// Add new entry
 	logBuffer.emplace_back(UILogEntry{
-		.message = fmt::to_string(formatted),
+		.resource = std::move(resource),
+		.message = std::move(message),
 		.level = msg.level,
 		.timestamp = std::chrono::system_clock::from_time_t(std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch()).count())
 		});
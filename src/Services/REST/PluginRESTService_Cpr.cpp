@@ -1,4 +1,5 @@
 #include "Services/REST/PluginRESTService_Cpr.h"
+#include "Profiling/TraceRecorder.h"
 
 #include <cpr/cpr.h>
 #include <cpr/session.h>
@@ -69,6 +70,7 @@ std::string PluginRESTService_Cpr::getBaseUrl() const
 
 std::expected<RESTResponse, RESTError> PluginRESTService_Cpr::GET(std::string_view path, const HeaderMap& headers)
 {
+	VECTORIUM_TRACE_ZONE("REST::GET");
 	std::scoped_lock lock(m_mutex);
 
 	try
@@ -104,6 +106,7 @@ std::expected<RESTResponse, RESTError> PluginRESTService_Cpr::POST(std::string_v
 	const HeaderMap& headers,
 	std::string_view content_type)
 {
+	VECTORIUM_TRACE_ZONE("REST::POST");
 	return {};
 }
 
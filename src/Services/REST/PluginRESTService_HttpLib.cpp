@@ -1,5 +1,6 @@
 #ifdef USE_HTTPLIB
 #include "Services/REST/PluginRESTService_HttpLib.h"
+#include "Profiling/TraceRecorder.h"
 
 #include <string>
 #include <utility>
@@ -54,6 +55,7 @@ void PluginRESTService_HttpLib::set_bearer_token(std::string_view token)
 
 std::expected<RESTResponse, RESTError> PluginRESTService_HttpLib::GET(const std::string_view path, const HeaderMap& headers)
 {
+	VECTORIUM_TRACE_ZONE("REST::GET");
 	std::scoped_lock lk(m_mutex);
 	httplib::Headers tmpHeaders;
 	apply_headers(tmpHeaders, m_defaultHeaders);
@@ -98,6 +100,7 @@ std::expected<RESTResponse, RESTError> PluginRESTService_HttpLib::POST(const std
 	const HeaderMap& headers,
 	std::string_view content_type)
 {
+	VECTORIUM_TRACE_ZONE("REST::POST");
 	std::scoped_lock lk(m_mutex);
 	httplib::Headers tmpHeaders;
 	apply_headers(tmpHeaders, m_defaultHeaders);
@@ -0,0 +1,318 @@
+#include "Services/SemanticVersion.h"
+
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <ranges>
+
+namespace
+{
+	constexpr std::string_view whitespace = " \t";
+
+	std::string_view trim(std::string_view text)
+	{
+		const auto first = text.find_first_not_of(whitespace);
+		if (first == std::string_view::npos)
+		{
+			return {};
+		}
+
+		return text.substr(first, text.find_last_not_of(whitespace) - first + 1);
+	}
+
+	bool isWildcard(std::string_view part)
+	{
+		return part == "x" || part == "X" || part == "*";
+	}
+
+	/// <summary>
+	/// A version that may stop early or end in wildcards - "1.2", "1.x", "*"
+	/// </summary>
+	struct PartialVersion
+	{
+		SemanticVersion version;
+		int             partCount = 0; // parts given before the first wildcard
+	};
+
+	std::expected<PartialVersion, std::string> parsePartial(std::string_view text)
+	{
+		const std::string_view original = text;
+
+		if (text.starts_with('v') || text.starts_with('V'))
+		{
+			text.remove_prefix(1);
+		}
+
+		// Pre-release and build metadata don't take part in matching
+		text = text.substr(0, text.find_first_of("-+"));
+
+		PartialVersion partial;
+		std::uint32_t* const parts[] = {&partial.version.major, &partial.version.minor, &partial.version.patch};
+
+		int index = 0;
+		bool isWild = false;
+		for (const auto part : text | std::views::split('.'))
+		{
+			const std::string_view partText(part.begin(), part.end());
+
+			if (index == 3)
+			{
+				return std::unexpected(std::format("'{}' has more than three parts", original));
+			}
+
+			if (isWildcard(partText))
+			{
+				isWild = true;
+			}
+			else if (isWild)
+			{
+				return std::unexpected(std::format("'{}' has a number after a wildcard", original));
+			}
+			else
+			{
+				const auto [end, error] = std::from_chars(partText.data(), partText.data() + partText.size(), *parts[index]);
+				if (partText.empty() || error != std::errc{} || end != partText.data() + partText.size())
+				{
+					return std::unexpected(std::format("'{}' is not a version", original));
+				}
+
+				partial.partCount = index + 1;
+			}
+
+			++index;
+		}
+
+		return partial;
+	}
+
+	/// <summary>
+	/// Takes the next comparator off the front of the text - an operator may be followed by spaces, ">= 1.2.0"
+	/// </summary>
+	std::string takeComparator(std::string_view& remaining)
+	{
+		const auto operatorEnd = remaining.find_first_not_of("<>=^~");
+		const auto versionStart = remaining.find_first_not_of(whitespace, operatorEnd == std::string_view::npos ? remaining.size() : operatorEnd);
+		const auto tokenEnd = versionStart == std::string_view::npos ? remaining.size() : std::min(remaining.find_first_of(whitespace, versionStart), remaining.size());
+
+		std::string token(remaining.substr(0, operatorEnd == std::string_view::npos ? remaining.size() : operatorEnd));
+		if (versionStart != std::string_view::npos)
+		{
+			token += remaining.substr(versionStart, tokenEnd - versionStart);
+		}
+
+		remaining = trim(remaining.substr(tokenEnd));
+		return token;
+	}
+
+	bool hasOperator(std::string_view comparator)
+	{
+		return comparator.find_first_of("<>=^~") != std::string_view::npos;
+	}
+
+	/// <summary>
+	/// The first version past everything a partial version matches - "1.2" gives 1.3.0
+	/// </summary>
+	SemanticVersion nextAfter(const PartialVersion& partial)
+	{
+		const SemanticVersion& v = partial.version;
+
+		switch (partial.partCount)
+		{
+			case 1:
+				return {v.major + 1, 0, 0};
+			case 2:
+				return {v.major, v.minor + 1, 0};
+			default:
+				return {v.major, v.minor, v.patch + 1};
+		}
+	}
+}
+
+std::expected<SemanticVersion, std::string> SemanticVersion::parse(std::string_view text)
+{
+	text = trim(text);
+
+	const auto partial = parsePartial(text);
+	if (!partial)
+	{
+		return std::unexpected(partial.error());
+	}
+
+	if (partial->partCount == 0)
+	{
+		return std::unexpected(std::format("'{}' is not a version", text));
+	}
+
+	return partial->version;
+}
+
+std::string SemanticVersion::toString() const
+{
+	return std::format("{}.{}.{}", major, minor, patch);
+}
+
+std::expected<VersionRange, std::string> VersionRange::parse(std::string_view text)
+{
+	VersionRange range;
+
+	for (const auto alternative : std::string_view(text) | std::views::split(std::string_view("||")))
+	{
+		std::string_view remaining = trim(std::string_view(alternative.begin(), alternative.end()));
+		ComparatorSet comparators;
+
+		while (!remaining.empty())
+		{
+			const std::string token = takeComparator(remaining);
+
+			// A hyphen range, "1.2.3 - 2.3" - a partial version on the right takes in every version it starts, as with "<="
+			if (remaining.starts_with('-') && (remaining.size() == 1 || whitespace.contains(remaining[1])))
+			{
+				remaining = trim(remaining.substr(1));
+				const std::string upper = remaining.empty() ? std::string() : takeComparator(remaining);
+				if (hasOperator(token) || upper.empty() || upper.starts_with('-') || hasOperator(upper))
+				{
+					return std::unexpected(std::format("Invalid version range '{}': a hyphen range needs a version without an operator on each side", text));
+				}
+
+				for (const std::string& comparator : {">=" + token, "<=" + upper})
+				{
+					if (const auto parsed = parseComparator(comparator, comparators); !parsed)
+					{
+						return std::unexpected(std::format("Invalid version range '{}': {}", text, parsed.error()));
+					}
+				}
+
+				continue;
+			}
+
+			if (const auto parsed = parseComparator(token, comparators); !parsed)
+			{
+				return std::unexpected(std::format("Invalid version range '{}': {}", text, parsed.error()));
+			}
+		}
+
+		// An alternative without comparators accepts every version, so the whole range does
+		if (comparators.empty())
+		{
+			range.m_alternatives.clear();
+			return range;
+		}
+
+		range.m_alternatives.push_back(std::move(comparators));
+	}
+
+	return range;
+}
+
+bool VersionRange::contains(const SemanticVersion& version) const
+{
+	if (m_alternatives.empty())
+	{
+		return true;
+	}
+
+	const auto holds = [&](const Comparator& comparator)
+	{
+		switch (comparator.op)
+		{
+			case Operator::Less:
+				return version < comparator.version;
+			case Operator::LessOrEqual:
+				return version <= comparator.version;
+			case Operator::GreaterOrEqual:
+				return version >= comparator.version;
+			case Operator::Equal:
+				return version == comparator.version;
+		}
+
+		return false;
+	};
+
+	return std::ranges::any_of(m_alternatives, [&](const ComparatorSet& comparators)
+	{
+		return std::ranges::all_of(comparators, holds);
+	});
+}
+
+std::expected<void, std::string> VersionRange::parseComparator(std::string_view text, ComparatorSet& comparators)
+{
+	const auto versionStart = std::min(text.find_first_not_of("<>=^~"), text.size());
+	const std::string_view op = text.substr(0, versionStart);
+
+	// A version starting with its suffix would otherwise be taken for "*" - a stray "-" of a hyphen range, or ">=" alone
+	if (versionStart == text.size() || text[versionStart] == '-' || text[versionStart] == '+')
+	{
+		return std::unexpected(std::format("'{}' has no version", text));
+	}
+
+	const auto partial = parsePartial(text.substr(versionStart));
+	if (!partial)
+	{
+		return std::unexpected(partial.error());
+	}
+
+	const SemanticVersion& version = partial->version;
+
+	if (partial->partCount == 0)
+	{
+		// "*", or an operator on a wildcard - no constraint
+		if (op.empty() || op == ">=" || op == "<=" || op == "=" || op == "^" || op == "~")
+		{
+			return {};
+		}
+
+		return std::unexpected(std::format("'{}' matches nothing", text));
+	}
+
+	if (op == "^")
+	{
+		// Changes that don't touch the left-most non-zero part
+		SemanticVersion upper = version.major != 0 || partial->partCount == 1 ? SemanticVersion{version.major + 1, 0, 0}
+			: version.minor != 0 || partial->partCount == 2 ? SemanticVersion{0, version.minor + 1, 0}
+			: SemanticVersion{0, 0, version.patch + 1};
+
+		comparators.push_back({Operator::GreaterOrEqual, version});
+		comparators.push_back({Operator::Less, upper});
+	}
+	else if (op == "~")
+	{
+		comparators.push_back({Operator::GreaterOrEqual, version});
+		comparators.push_back({Operator::Less, partial->partCount == 1 ? SemanticVersion{version.major + 1, 0, 0} : SemanticVersion{version.major, version.minor + 1, 0}});
+	}
+	else if (op.empty() || op == "=")
+	{
+		// A partial version is every version it starts - "1.2" is ">=1.2.0 <1.3.0"
+		if (partial->partCount == 3)
+		{
+			comparators.push_back({Operator::Equal, version});
+		}
+		else
+		{
+			comparators.push_back({Operator::GreaterOrEqual, version});
+			comparators.push_back({Operator::Less, nextAfter(*partial)});
+		}
+	}
+	else if (op == ">=")
+	{
+		comparators.push_back({Operator::GreaterOrEqual, version});
+	}
+	else if (op == ">")
+	{
+		// ">1.2" means past every 1.2.x
+		comparators.push_back({Operator::GreaterOrEqual, nextAfter(*partial)});
+	}
+	else if (op == "<=")
+	{
+		comparators.push_back(partial->partCount == 3 ? Comparator{Operator::LessOrEqual, version} : Comparator{Operator::Less, nextAfter(*partial)});
+	}
+	else if (op == "<")
+	{
+		comparators.push_back({Operator::Less, version});
+	}
+	else
+	{
+		return std::unexpected(std::format("unknown operator '{}'", op));
+	}
+
+	return {};
+}
@@ -1,9 +1,12 @@
 #include "Services/ServiceContainer.h"
 
+#include <algorithm>
 #include <iostream>
 #include <format>
+#include <ranges>
+#include <utility>
 
-void ServiceContainer::registerServiceByType(std::type_index typeIdx, std::shared_ptr<void> service)
+void ServiceContainer::registerServiceByType(std::type_index typeIdx, std::shared_ptr<void> service, SemanticVersion version)
 {
 	if(!service)
 	{
@@ -11,33 +14,193 @@ void ServiceContainer::registerServiceByType(std::type_index typeIdx, std::share
 		return;
 	}
 
-	m_services[typeIdx] = service;
+	setService(typeIdx, std::move(service), version);
+}
+
+std::shared_ptr<void> ServiceContainer::replaceServiceByType(std::type_index typeIdx, std::shared_ptr<void> service, SemanticVersion version)
+{
+	if(!service)
+	{
+		std::cout << std::format("WARNING: Attempting to replace service {} with null\n", typeIdx.name());
+		return nullptr;
+	}
+
+	return setService(typeIdx, std::move(service), version);
 }
 
 void ServiceContainer::unregisterServiceByType(std::type_index typeIdx)
 {
-	if (m_services.erase(typeIdx) > 0)
+	if (setService(typeIdx, nullptr, defaultServiceVersion))
 	{
 		std::cout << std::format("ServiceContainer: Unregistered service {}\n", typeIdx.name());
 	}
 }
 
+bool ServiceContainer::withdrawServiceByType(std::type_index typeIdx, const void* instance)
+{
+	if (!instance || !setService(typeIdx, nullptr, defaultServiceVersion, instance))
+	{
+		return false;
+	}
+
+	std::cout << std::format("ServiceContainer: Withdrew service {}\n", typeIdx.name());
+	return true;
+}
+
 std::shared_ptr<void> ServiceContainer::getServiceByType(std::type_index typeIdx) const
 {
+	std::shared_lock lock(m_mutex);
+
 	if (const auto it = m_services.find(typeIdx); it != m_services.end())
 	{
-		return it->second;
+		return it->second.service;
 	}
 
 	return nullptr;
 }
 
+std::optional<SemanticVersion> ServiceContainer::getServiceVersionByType(std::type_index typeIdx) const
+{
+	std::shared_lock lock(m_mutex);
+
+	if (const auto it = m_services.find(typeIdx); it != m_services.end() && it->second.service)
+	{
+		return it->second.version;
+	}
+
+	return std::nullopt;
+}
+
+std::optional<SemanticVersion> ServiceContainer::getServiceVersionByTypeName(std::string_view typeName) const
+{
+	std::shared_lock lock(m_mutex);
+
+	for (const auto& [type, entry] : m_services)
+	{
+		if (entry.service && typeName == type.name())
+		{
+			return entry.version;
+		}
+	}
+
+	return std::nullopt;
+}
+
+std::uint64_t ServiceContainer::getServiceRevisionByType(std::type_index typeIdx) const
+{
+	std::shared_lock lock(m_mutex);
+
+	const auto it = m_services.find(typeIdx);
+	return it != m_services.end() ? it->second.revision : 0;
+}
+
 void ServiceContainer::clear()
 {
+	std::lock_guard changeLock(m_changeMutex);
+
+	std::vector<std::type_index> types;
+	{
+		std::shared_lock lock(m_mutex);
+		for (const auto& [type, entry] : m_services)
+		{
+			if (entry.service)
+			{
+				types.push_back(type);
+			}
+		}
+	}
+
+	for (const std::type_index& type : types)
+	{
+		setService(type, nullptr, defaultServiceVersion);
+	}
+
+	std::unique_lock lock(m_mutex);
 	m_services.clear();
 }
 
 bool ServiceContainer::hasServiceByType(std::type_index tIdx) const
 {
-	return m_services.contains(tIdx);
+	std::shared_lock lock(m_mutex);
+
+	const auto it = m_services.find(tIdx);
+	return it != m_services.end() && it->second.service;
+}
+
+bool ServiceContainer::hasServiceByTypeName(std::string_view typeName) const
+{
+	std::shared_lock lock(m_mutex);
+
+	return std::ranges::any_of(m_services, [&](const auto& service)
+	{
+		return service.second.service && typeName == service.first.name();
+	});
+}
+
+ServiceSubscriptionId ServiceContainer::subscribe(ServiceChangedCallback callback)
+{
+	std::lock_guard lock(m_changeMutex);
+
+	const ServiceSubscriptionId id = m_nextSubscriptionId++;
+	m_subscribers.push_back(Subscriber{.id = id, .callback = std::move(callback)});
+	return id;
+}
+
+ServiceSubscriptionId ServiceContainer::subscribeByType(std::type_index typeIdx, ServiceChangedCallback callback)
+{
+	std::lock_guard lock(m_changeMutex);
+
+	const ServiceSubscriptionId id = m_nextSubscriptionId++;
+	m_subscribers.push_back(Subscriber{.id = id, .isAllTypes = false, .type = typeIdx, .callback = std::move(callback)});
+	return id;
+}
+
+void ServiceContainer::unsubscribe(ServiceSubscriptionId id)
+{
+	std::lock_guard lock(m_changeMutex);
+
+	std::erase_if(m_subscribers, [id](const Subscriber& subscriber)
+	{
+		return subscriber.id == id;
+	});
+}
+
+std::shared_ptr<void> ServiceContainer::setService(std::type_index typeIdx, std::shared_ptr<void> service, SemanticVersion version, const void* expected)
+{
+	std::lock_guard changeLock(m_changeMutex);
+
+	std::shared_ptr<void> previous;
+	std::uint64_t revision = 0;
+	{
+		std::unique_lock lock(m_mutex);
+
+		// Nothing to unregister
+		if (const auto it = m_services.find(typeIdx); !service && (it == m_services.end() || !it->second.service))
+		{
+			return nullptr;
+		}
+
+		ServiceEntry& entry = m_services[typeIdx];
+		if (expected && entry.service.get() != expected)
+		{
+			return nullptr;
+		}
+
+		previous = std::exchange(entry.service, service);
+		entry.version = version;
+		revision = ++entry.revision;
+	}
+
+	// A copy, so a subscriber can unsubscribe from its callback - and one that did isn't called after it
+	const std::vector<Subscriber> subscribers = m_subscribers;
+	for (const Subscriber& subscriber : subscribers)
+	{
+		const bool isSubscribed = std::ranges::find(m_subscribers, subscriber.id, &Subscriber::id) != m_subscribers.end();
+		if (isSubscribed && (subscriber.isAllTypes || subscriber.type == typeIdx))
+		{
+			subscriber.callback(typeIdx, service, revision);
+		}
+	}
+
+	return previous;
 }
@@ -0,0 +1,90 @@
+#include "Services/ServiceSlot.h"
+
+#include <ranges>
+
+ServiceSlot& ServiceSlotTable::getFixedSlot(std::size_t slotIndex)
+{
+	return m_fixed[slotIndex];
+}
+
+ServiceSlot& ServiceSlotTable::getSlot(std::type_index type, std::size_t slotIndex)
+{
+	if (slotIndex < fixedServiceSlotCount)
+	{
+		return m_fixed[slotIndex];
+	}
+
+	std::lock_guard lock(m_mutex);
+	return getSlotLocked(type, slotIndex);
+}
+
+const ServiceSlot* ServiceSlotTable::findSlot(std::type_index type, std::size_t slotIndex) const
+{
+	if (slotIndex < fixedServiceSlotCount)
+	{
+		return &m_fixed[slotIndex];
+	}
+
+	std::lock_guard lock(m_mutex);
+	const auto slot = m_dynamic.find(type);
+	return slot != m_dynamic.end() ? slot->second.get() : nullptr;
+}
+
+void ServiceSlotTable::store(std::type_index type, std::size_t slotIndex, std::shared_ptr<void> service)
+{
+	std::lock_guard lock(m_mutex);
+
+	ServiceSlot& slot = getSlotLocked(type, slotIndex);
+	slot.store(std::move(service));
+	if (slot.collectRetired())
+	{
+		m_hasRetired.store(true, std::memory_order_relaxed);
+	}
+}
+
+ServiceSlot& ServiceSlotTable::storeIfEmpty(std::type_index type, std::size_t slotIndex, std::shared_ptr<void> service)
+{
+	std::lock_guard lock(m_mutex);
+
+	ServiceSlot& slot = getSlotLocked(type, slotIndex);
+	if (!slot.isOccupied() && service)
+	{
+		slot.store(std::move(service));
+	}
+
+	return slot;
+}
+
+void ServiceSlotTable::collectRetired()
+{
+	std::lock_guard lock(m_mutex);
+
+	bool isWaiting = false;
+	for (ServiceSlot& slot : m_fixed)
+	{
+		isWaiting |= slot.collectRetired();
+	}
+
+	for (const auto& slot : m_dynamic | std::views::values)
+	{
+		isWaiting |= slot->collectRetired();
+	}
+
+	m_hasRetired.store(isWaiting, std::memory_order_relaxed);
+}
+
+ServiceSlot& ServiceSlotTable::getSlotLocked(std::type_index type, std::size_t slotIndex)
+{
+	if (slotIndex < fixedServiceSlotCount)
+	{
+		return m_fixed[slotIndex];
+	}
+
+	auto& slot = m_dynamic[type];
+	if (!slot)
+	{
+		slot = std::make_unique<ServiceSlot>();
+	}
+
+	return *slot;
+}
@@ -0,0 +1,223 @@
+#include "Threading/ThreadPlacement.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <thread>
+
+#ifdef PLATFORM_LINUX
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef PLATFORM_LINUX
+	constexpr int mpolPreferred = 1; // MPOL_PREFERRED, from numaif.h - set_mempolicy is called directly to not need libnuma
+
+	/// <summary>
+	/// Parses a sysfs CPU list, eg. "0-3,8-11"
+	/// </summary>
+	std::vector<unsigned> parseCpuList(const std::string& text)
+	{
+		std::vector<unsigned> cpus;
+		std::size_t start = 0;
+		while (start < text.size())
+		{
+			const std::size_t end = std::min(text.find(',', start), text.size());
+			const std::string range = text.substr(start, end - start);
+			start = end + 1;
+
+			unsigned first = 0;
+			unsigned last = 0;
+			if (std::sscanf(range.c_str(), "%u-%u", &first, &last) == 2)
+			{
+				for (unsigned cpu = first; cpu <= last; ++cpu)
+				{
+					cpus.push_back(cpu);
+				}
+			}
+			else if (std::sscanf(range.c_str(), "%u", &first) == 1)
+			{
+				cpus.push_back(first);
+			}
+		}
+
+		return cpus;
+	}
+
+	std::vector<std::vector<unsigned>> readNodeCpus()
+	{
+		std::vector<std::vector<unsigned>> nodeCpus;
+
+		std::error_code ec;
+		for (unsigned node = 0; std::filesystem::exists(std::format("/sys/devices/system/node/node{}", node), ec); ++node)
+		{
+			std::ifstream file(std::format("/sys/devices/system/node/node{}/cpulist", node));
+			std::string text;
+			std::getline(file, text);
+			nodeCpus.push_back(parseCpuList(text));
+		}
+
+		return nodeCpus;
+	}
+#endif
+}
+
+const CpuTopology& CpuTopology::get()
+{
+	static const CpuTopology topology;
+	return topology;
+}
+
+CpuTopology::CpuTopology()
+{
+#ifdef PLATFORM_LINUX
+	m_nodeCpus = readNodeCpus();
+#endif
+
+	if (m_nodeCpus.empty())
+	{
+		std::vector<unsigned> cpus(std::max(std::thread::hardware_concurrency(), 1u));
+		for (unsigned cpu = 0; cpu < cpus.size(); ++cpu)
+		{
+			cpus[cpu] = cpu;
+		}
+
+		m_nodeCpus.push_back(std::move(cpus));
+	}
+
+	for (unsigned node = 0; node < m_nodeCpus.size(); ++node)
+	{
+		for (const unsigned cpu : m_nodeCpus[node])
+		{
+			if (cpu >= m_cpuNodes.size())
+			{
+				m_cpuNodes.resize(cpu + 1, -1);
+			}
+
+			m_cpuNodes[cpu] = static_cast<int>(node);
+		}
+	}
+}
+
+unsigned CpuTopology::getNodeCount() const
+{
+	return static_cast<unsigned>(m_nodeCpus.size());
+}
+
+std::span<const unsigned> CpuTopology::getNodeCpus(unsigned node) const
+{
+	if (node >= m_nodeCpus.size())
+	{
+		return {};
+	}
+
+	return m_nodeCpus[node];
+}
+
+int CpuTopology::getNodeOfCpu(unsigned cpu) const
+{
+	return cpu < m_cpuNodes.size() ? m_cpuNodes[cpu] : -1;
+}
+
+int CpuTopology::getCurrentNode() const
+{
+#ifdef PLATFORM_LINUX
+	const int cpu = sched_getcpu();
+	return cpu >= 0 ? getNodeOfCpu(static_cast<unsigned>(cpu)) : -1;
+#else
+	return isNuma() ? -1 : 0;
+#endif
+}
+
+int CpuTopology::getPlacementNode(const ThreadPlacement& placement) const
+{
+	if (placement.numaNode >= 0)
+	{
+		return placement.numaNode;
+	}
+
+	// Pinned to CPUs alone - on a node only if they all share one
+	int node = -1;
+	for (const unsigned cpu : placement.cpus)
+	{
+		const int cpuNode = getNodeOfCpu(cpu);
+		if (cpuNode < 0 || (node >= 0 && cpuNode != node))
+		{
+			return -1;
+		}
+
+		node = cpuNode;
+	}
+
+	return node;
+}
+
+std::expected<void, std::string> placeCurrentThread(const ThreadPlacement& placement)
+{
+	const CpuTopology& topology = CpuTopology::get();
+	if (placement.numaNode >= static_cast<int>(topology.getNodeCount()))
+	{
+		return std::unexpected(std::format("NUMA node {} doesn't exist, this machine has {}", placement.numaNode, topology.getNodeCount()));
+	}
+
+#ifdef PLATFORM_LINUX
+	std::vector<unsigned> cpus = placement.cpus;
+	if (placement.numaNode >= 0)
+	{
+		const auto nodeCpus = topology.getNodeCpus(static_cast<unsigned>(placement.numaNode));
+		if (cpus.empty())
+		{
+			cpus.assign(nodeCpus.begin(), nodeCpus.end());
+		}
+		else
+		{
+			std::erase_if(cpus, [&](unsigned cpu) { return std::ranges::find(nodeCpus, cpu) == nodeCpus.end(); });
+			if (cpus.empty())
+			{
+				return std::unexpected(std::format("None of the CPUs listed are on NUMA node {}", placement.numaNode));
+			}
+		}
+	}
+
+	if (!cpus.empty())
+	{
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		for (const unsigned cpu : cpus)
+		{
+			if (cpu < CPU_SETSIZE)
+			{
+				CPU_SET(cpu, &cpuSet);
+			}
+		}
+
+		if (const int error = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet); error != 0)
+		{
+			return std::unexpected(std::format("Could not set the thread's CPU affinity: {}", std::strerror(error)));
+		}
+	}
+
+	// Memory the thread touches first comes from its own node by default anyway, this keeps it there under pressure
+	if (const int node = topology.getPlacementNode(placement); node >= 0 && topology.isNuma())
+	{
+		constexpr std::size_t bitsPerWord = sizeof(unsigned long) * 8;
+		std::vector<unsigned long> nodeMask(topology.getNodeCount() / bitsPerWord + 1, 0);
+		nodeMask[static_cast<std::size_t>(node) / bitsPerWord] |= 1ul << (static_cast<std::size_t>(node) % bitsPerWord);
+
+		if (syscall(SYS_set_mempolicy, mpolPreferred, nodeMask.data(), nodeMask.size() * bitsPerWord + 1) != 0)
+		{
+			return std::unexpected(std::format("Could not prefer NUMA node {} for the thread's memory: {}", node, std::strerror(errno)));
+		}
+	}
+#endif
+
+	return {};
+}